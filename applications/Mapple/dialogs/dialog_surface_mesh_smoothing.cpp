@@ -39,7 +39,7 @@
 using namespace easy3d;
 
 DialogSurfaceMeshSmoothing::DialogSurfaceMeshSmoothing(MainWindow *window)
-        : Dialog(window) {
+        : Dialog(window), mesh_(nullptr), smoother_(nullptr) {
     setupUi(this);
 
     comboBoxScheme->addItem("Explicit Smoothing");
@@ -54,6 +54,21 @@ DialogSurfaceMeshSmoothing::DialogSurfaceMeshSmoothing(MainWindow *window)
 
 
 DialogSurfaceMeshSmoothing::~DialogSurfaceMeshSmoothing() {
+    releaseSmoother();
+}
+
+
+void DialogSurfaceMeshSmoothing::closeEvent(QCloseEvent *e) {
+    releaseSmoother();
+    QDialog::closeEvent(e);
+}
+
+
+void DialogSurfaceMeshSmoothing::releaseSmoother() {
+    // the smoother doesn't access the mesh on destruction, so it is safe even if the mesh has been deleted
+    delete smoother_;
+    smoother_ = nullptr;
+    mesh_ = nullptr;
 }
 
 
@@ -76,11 +91,15 @@ void DialogSurfaceMeshSmoothing::apply() {
 
     const bool uniform_laplace = checkBoxUniformLaplace->isChecked();
 
-    SurfaceMeshSmoothing smoother(mesh);
+    if (mesh != mesh_ || !smoother_) {
+        releaseSmoother();
+        smoother_ = new SurfaceMeshSmoothing(mesh);
+        mesh_ = mesh;
+    }
 
     if (comboBoxScheme->currentText() == "Explicit Smoothing") {
         const int iter = spinBoxIterations->value();
-        smoother.explicit_smoothing(iter, uniform_laplace);
+        smoother_->explicit_smoothing(iter, uniform_laplace);
     }
     else {    // Implicit Smoothing
         const float timestep = 0.001f;
@@ -95,7 +114,7 @@ void DialogSurfaceMeshSmoothing::apply() {
         const bool rescale = !has_boundary;
         const float scene_radius = viewer_->camera()->sceneRadius();
         const float dt = uniform_laplace ? timestep : timestep * scene_radius * scene_radius;
-        smoother.implicit_smoothing(dt, uniform_laplace, rescale);
+        smoother_->implicit_smoothing(dt, uniform_laplace, rescale);
     }
 
     mesh->renderer()->update();
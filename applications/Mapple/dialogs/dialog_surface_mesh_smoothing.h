@@ -32,6 +32,12 @@
 #include "ui_dialog_surface_mesh_smoothing.h"
 
 
+namespace easy3d {
+    class SurfaceMesh;
+    class SurfaceMeshSmoothing;
+}
+
+
 class DialogSurfaceMeshSmoothing : public Dialog, public Ui::DialogSurfaceMeshSmoothing {
 Q_OBJECT
 
@@ -42,6 +48,16 @@ public:
 private Q_SLOTS:
     void apply();
     void setSmoothingScheme(const QString &);
+
+protected:
+    virtual void closeEvent(QCloseEvent* e);
+
+    void releaseSmoother();
+
+private:
+    // the smoother is kept alive for the same mesh, so repeated implicit smoothing reuses the factorized system
+    easy3d::SurfaceMesh* mesh_;
+    easy3d::SurfaceMeshSmoothing* smoother_;
 };
 
 #endif // DIALOG_SURFACE_SMOOTHING_H
@@ -63,8 +63,7 @@
 #include <easy3d/fileio/graph_io.h>
 #include <easy3d/fileio/surface_mesh_io.h>
 #include <easy3d/fileio/poly_mesh_io.h>
-#include <easy3d/fileio/ply_reader_writer.h>
-#include <easy3d/fileio/point_cloud_io_ptx.h>
+#include <easy3d/fileio/scene_loader.h>
 #include <easy3d/fileio/translator.h>
 #include <easy3d/algo/point_cloud_normals.h>
 #include <easy3d/algo/surface_mesh_components.h>
@@ -117,6 +116,7 @@ using namespace easy3d;
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , sceneLoader_(nullptr)
     , ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
@@ -208,6 +208,7 @@ MainWindow::MainWindow(QWidget *parent)
 
 
 MainWindow::~MainWindow() {
+    delete sceneLoader_;
     LOG(INFO) << "Mapple terminated. Bye!";
 }
 
@@ -381,19 +382,47 @@ void MainWindow::dropEvent(QDropEvent *e) {
     if (e->mimeData()->hasUrls())
         e->acceptProposedAction();
 
-    int count = 0;
-    foreach (const QUrl &url, e->mimeData()->urls()) {
-        const QString &fileName = url.toLocalFile();
-        if (open(fileName.toStdString()))
-            ++count;
-    }
+    QStringList fileNames;
+    foreach (const QUrl &url, e->mimeData()->urls())
+        fileNames << url.toLocalFile();
 
-    if (count > 0)
+    if (openFiles(fileNames) > 0)
         viewer_->update();
 }
 
 
 int MainWindow::openFiles(const QStringList &fileNames) {
+    if (fileNames.size() > 1) {
+        // Multiple files are parsed concurrently in the background, and the loaded models are added to the viewer
+        // (a limited amount at a time) in the GUI thread, so the UI keeps responding while loading a large scene.
+        std::vector<std::string> names;
+        for (const auto& name : fileNames) {
+            const std::string file_name = name.toStdString();
+            bool exists = false;
+            for (auto m : viewer_->models()) {
+                if (m->name() == file_name) {
+                    LOG(WARNING) << "model already loaded: " << file_name;
+                    exists = true;
+                    break;
+                }
+            }
+            if (!exists)
+                names.push_back(file_name);
+        }
+        if (names.empty())
+            return 0;
+
+        if (!sceneLoader_) {
+            sceneLoader_ = new SceneLoader;
+            sceneLoader_->set_callback([this]() {
+                QMetaObject::invokeMethod(this, "addLoadedModels", Qt::QueuedConnection);
+            });
+        }
+        LOG(INFO) << "loading " << names.size() << " files in the background...";
+        sceneLoader_->add(names);
+        return static_cast<int>(names.size());
+    }
+
     int count = 0;
     ProgressLogger progress(fileNames.size(), true, false);
     for (const auto& name : fileNames) {
@@ -406,7 +435,7 @@ int MainWindow::openFiles(const QStringList &fileNames) {
         progress.next();
     }
 
-    return count > 0;
+    return count;
 }
 
 
@@ -431,11 +460,12 @@ bool MainWindow::onOpen() {
                 this,
                 "Open file(s)",
                 curDataDirectory_,
-                "Supported formats (*.ply *.obj *.off *.stl *.sm *.geojson *.trilist *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.ptx *.plm *.pm *.mesh)\n"
+                "Supported formats (*.ply *.obj *.off *.stl *.sm *.geojson *.trilist *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.ptx *.plm *.pm *.mesh *.e3d)\n"
                 "Surface Mesh (*.ply *.obj *.off *.stl *.sm *.geojson *.trilist)\n"
                 "Point Cloud (*.ply *.bin *.ptx *.las *.laz *.xyz *.bxyz *.vg *.bvg *.ptx)\n"
                 "Polyhedral Mesh (*.plm *.pm *.mesh)\n"
                 "Graph (*.ply)\n"
+                "Easy3D native format (*.e3d)\n"
                 "All formats (*.*)"
             );
 
@@ -445,7 +475,7 @@ bool MainWindow::onOpen() {
     if (fileNames.empty())
         return false;
 
-    return openFiles(fileNames);
+    return openFiles(fileNames) > 0;
 }
 
 
@@ -464,11 +494,12 @@ bool MainWindow::onSave() {
                 this,
                 "Save file",
                 QString::fromStdString(default_file_name),
-                "Supported formats (*.ply *.obj *.off *.stl *.sm *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.plm *.pm *.mesh)\n"
+                "Supported formats (*.ply *.obj *.off *.stl *.sm *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.plm *.pm *.mesh *.e3d)\n"
                 "Surface Mesh (*.ply *.obj *.off *.stl *.sm)\n"
                 "Point Cloud (*.ply *.bin *.ptx *.las *.laz *.xyz *.bxyz *.vg *.bvg)\n"
                 "Polyhedral Mesh (*.plm *.pm *.mesh)\n"
                 "Graph (*.ply)\n"
+                "Easy3D native format (*.e3d)\n"
                 "All formats (*.*)"
     );
 
@@ -512,50 +543,59 @@ Model* MainWindow::open(const std::string& file_name) {
         }
     }
 
-    const std::string& ext = file_system::extension(file_name, true);
-    bool is_ply_mesh = false;
-    if (ext == "ply")
-        is_ply_mesh = (io::PlyReader::num_instances(file_name, "face") > 0);
-
     Model* model = nullptr;
-    if ((ext == "ply" && is_ply_mesh) || ext == "obj" || ext == "off" || ext == "stl" || ext == "sm" || ext == "geojson" || ext == "trilist") { // mesh
-        model = SurfaceMeshIO::load(file_name);
-    }
-    else if (ext == "ply" && io::PlyReader::num_instances(file_name, "edge") > 0) {
-        model = GraphIO::load(file_name);
-    } else if (ext == "plm" || ext == "pm" || ext == "mesh") {
-        model = PolyMeshIO::load(file_name);
-    }
-    else { // point cloud
-        if (ext == "ptx") {
-            io::PointCloudIO_ptx serializer(file_name);
-            PointCloud* cloud = nullptr;
-            while ((cloud = serializer.load_next())) {
-                viewer_->addModel(cloud);
-                ui->treeWidgetModels->addModel(cloud, true);
-            }
-        }
-        else
-            model = PointCloudIO::load(file_name);
+    for (auto m : SceneLoader::load(file_name)) {
+        addLoadedModel(m);
+        model = m;
     }
 
-    if (model) {
-        model->set_name(file_name);
-        viewer_->addModel(model);
-        ui->treeWidgetModels->addModel(model, true);
-        setCurrentFile(QString::fromStdString(file_name));
-
-        const auto keyframe_file = file_system::replace_extension(model->name(), "kf");
-        if (file_system::is_file(keyframe_file)) {
-            if (viewer_->walkThrough()->interpolator()->read_keyframes(keyframe_file)) {
-                LOG(INFO) << "model has an accompanying animation file \'"
-                          << file_system::simple_name(keyframe_file) << "\' (loaded)";
-                viewer_->walkThrough()->set_scene({model});
-            }
+    return model;
+}
+
+
+void MainWindow::addLoadedModel(Model* model) {
+    viewer_->addModel(model);
+    ui->treeWidgetModels->addModel(model, true);
+
+    // a PTX file contains multiple scans, whose names are not file names
+    if (!file_system::is_file(model->name()))
+        return;
+    setCurrentFile(QString::fromStdString(model->name()));
+
+    const auto keyframe_file = file_system::replace_extension(model->name(), "kf");
+    if (file_system::is_file(keyframe_file)) {
+        if (viewer_->walkThrough()->interpolator()->read_keyframes(keyframe_file)) {
+            LOG(INFO) << "model has an accompanying animation file \'"
+                      << file_system::simple_name(keyframe_file) << "\' (loaded)";
+            viewer_->walkThrough()->set_scene({model});
         }
     }
+}
 
-    return model;
+
+void MainWindow::addLoadedModels() {
+    if (!sceneLoader_)
+        return;
+
+    // Drawables are created and the data is uploaded to the GPU (when drawing) only for a limited number of
+    // points at a time, such that the UI keeps responding.
+    static const std::size_t max_num_points_per_update = 4000000;
+    const std::vector<Model*>& models = sceneLoader_->take(max_num_points_per_update);
+    if (models.empty())
+        return;
+
+    for (auto model : models)
+        addLoadedModel(model);
+
+    if (sceneLoader_->is_idle()) {
+        LOG(INFO) << "all files loaded (" << viewer_->models().size() << " models in the scene)";
+        viewer_->fitScreen();
+    }
+    else {
+        viewer_->update();
+        // continue with the next batch after the viewer has been repainted
+        QMetaObject::invokeMethod(this, "addLoadedModels", Qt::QueuedConnection);
+    }
 }
 
 
@@ -55,6 +55,7 @@ namespace Ui {
 namespace easy3d {
     class Model;
     class Drawable;
+    class SceneLoader;
 }
 
 
@@ -66,6 +67,8 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow() override;
 
+    // Opens the files and returns the number of models loaded (a single file), or queued for loading in the
+    // background (multiple files). Files that have already been loaded are skipped.
     int openFiles(const QStringList &fileNames);
 
     PaintCanvas* viewer() { return viewer_; }
@@ -179,6 +182,10 @@ public slots:
     void onAbout();
     void showManual();
 
+private slots:
+    // Adds (a limited amount of) the models loaded in the background to the viewer
+    void addLoadedModels();
+
 protected:
     void dragEnterEvent(QDragEnterEvent *e) override;
     void dropEvent(QDropEvent *) override;
@@ -187,6 +194,8 @@ protected:
 private:
     // Open a file with file name given. On success, the model has been added to the viewer
     easy3d::Model* open(const std::string& file_name);
+    // Adds a loaded model to the viewer and the model list
+    void addLoadedModel(easy3d::Model* model);
 
 private:
     void createActionsForFileMenu();
@@ -215,6 +224,9 @@ private:
 private:
     PaintCanvas*   viewer_;
 
+    // loads models (from multiple files) in the background
+    easy3d::SceneLoader* sceneLoader_;
+
     QStringList recentFiles_;
     QString		curDataDirectory_;
 
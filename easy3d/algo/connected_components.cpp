@@ -0,0 +1,273 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/connected_components.h>
+#include <easy3d/kdtree/kdtree_search_flann.h>
+#include <easy3d/kdtree/kdtree_search_nanoflann.h>
+
+#include <atomic>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        // A concurrent union-find (disjoint sets) of integers [0, n). A root is always linked to a root with a
+        // smaller index, so the parent of an element is never larger than the element itself, and the root of a
+        // set is its smallest element.
+        class UnionFind {
+        public:
+            explicit UnionFind(int n) : parent_(n) {
+#pragma omp parallel for
+                for (int i = 0; i < n; ++i)
+                    parent_[i].store(i, std::memory_order_relaxed);
+            }
+
+            // finds the root of x (with path halving)
+            int find(int x) {
+                while (true) {
+                    int p = parent_[x].load(std::memory_order_relaxed);
+                    if (p == x)
+                        return x;
+                    const int gp = parent_[p].load(std::memory_order_relaxed);
+                    if (p != gp)
+                        parent_[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+                    x = gp;
+                }
+            }
+
+            // merges the sets containing a and b
+            void unite(int a, int b) {
+                while (true) {
+                    a = find(a);
+                    b = find(b);
+                    if (a == b)
+                        return;
+                    if (a < b)
+                        std::swap(a, b);
+                    int expected = a;   // a must still be a root
+                    if (parent_[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                        return;
+                }
+            }
+
+            // Labels each element by its component, numbered in the order of the roots (i.e., their smallest
+            // elements). Deleted elements are labeled -1. The union-find can not be used anymore afterwards.
+            // Returns the number of components.
+            template<typename IsDeleted>
+            int label(std::vector<int> &label, IsDeleted is_deleted) {
+                const int n = static_cast<int>(parent_.size());
+                label.resize(n);
+#pragma omp parallel for
+                for (int i = 0; i < n; ++i)
+                    label[i] = is_deleted(i) ? -1 : find(i);
+
+                // the parent of each root is replaced by the index of its component
+                int num = 0;
+                for (int i = 0; i < n; ++i) {
+                    if (label[i] == i)
+                        parent_[i].store(num++, std::memory_order_relaxed);
+                }
+
+#pragma omp parallel for
+                for (int i = 0; i < n; ++i) {
+                    if (label[i] != -1)
+                        label[i] = parent_[label[i]].load(std::memory_order_relaxed);
+                }
+                return num;
+            }
+
+        private:
+            std::vector<std::atomic<int> > parent_;
+        };
+
+
+        // the area of a (planar) polygonal face
+        inline double face_area(const SurfaceMesh *mesh, SurfaceMesh::Face f) {
+            dvec3 n(0, 0, 0);
+            for (auto h : mesh->halfedges(f))
+                n += cross(dvec3(mesh->position(mesh->source(h))), dvec3(mesh->position(mesh->target(h))));
+            return 0.5 * length(n);
+        }
+
+    }
+
+
+    int ConnectedComponents::label(SurfaceMesh *mesh, SurfaceMesh::VertexProperty<int> label,
+                                   std::vector<Stats> *stats) {
+        const int num_vertices = static_cast<int>(mesh->vertices_size());
+        const int num_edges = static_cast<int>(mesh->edges_size());
+
+        details::UnionFind uf(num_vertices);
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (!mesh->is_deleted(e))
+                uf.unite(mesh->vertex(e, 0).idx(), mesh->vertex(e, 1).idx());
+        }
+
+        auto &labels = label.vector();
+        const int num = uf.label(labels, [mesh](int i) -> bool {
+            return mesh->is_deleted(SurfaceMesh::Vertex(i));
+        });
+
+        if (stats) {
+            stats->assign(num, Stats());
+            for (auto v : mesh->vertices()) {
+                Stats &s = (*stats)[labels[v.idx()]];
+                ++s.size;
+                s.bbox.grow(mesh->position(v));
+            }
+            for (auto f : mesh->faces()) {
+                const int id = labels[mesh->target(mesh->halfedge(f)).idx()];
+                (*stats)[id].area += details::face_area(mesh, f);
+            }
+        }
+
+        return num;
+    }
+
+
+    int ConnectedComponents::label(SurfaceMesh *mesh, SurfaceMesh::FaceProperty<int> label,
+                                   std::vector<Stats> *stats) {
+        const int num_faces = static_cast<int>(mesh->faces_size());
+        const int num_edges = static_cast<int>(mesh->edges_size());
+
+        details::UnionFind uf(num_faces);
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (mesh->is_deleted(e))
+                continue;
+            const auto h0 = mesh->halfedge(e, 0);
+            const auto h1 = mesh->halfedge(e, 1);
+            if (!mesh->is_border(h0) && !mesh->is_border(h1))
+                uf.unite(mesh->face(h0).idx(), mesh->face(h1).idx());
+        }
+
+        auto &labels = label.vector();
+        const int num = uf.label(labels, [mesh](int i) -> bool {
+            return mesh->is_deleted(SurfaceMesh::Face(i));
+        });
+
+        if (stats) {
+            stats->assign(num, Stats());
+            for (auto f : mesh->faces()) {
+                Stats &s = (*stats)[labels[f.idx()]];
+                ++s.size;
+                s.area += details::face_area(mesh, f);
+                for (auto v : mesh->vertices(f))
+                    s.bbox.grow(mesh->position(v));
+            }
+        }
+
+        return num;
+    }
+
+
+    int ConnectedComponents::label(Graph *graph, Graph::VertexProperty<int> label, std::vector<Stats> *stats) {
+        const int num_vertices = static_cast<int>(graph->vertices_size());
+        const int num_edges = static_cast<int>(graph->edges_size());
+
+        details::UnionFind uf(num_vertices);
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const Graph::Edge e(i);
+            if (!graph->is_deleted(e))
+                uf.unite(graph->vertex(e, 0).idx(), graph->vertex(e, 1).idx());
+        }
+
+        auto &labels = label.vector();
+        const int num = uf.label(labels, [graph](int i) -> bool {
+            return graph->is_deleted(Graph::Vertex(i));
+        });
+
+        if (stats) {
+            stats->assign(num, Stats());
+            for (auto v : graph->vertices()) {
+                Stats &s = (*stats)[labels[v.idx()]];
+                ++s.size;
+                s.bbox.grow(graph->position(v));
+            }
+        }
+
+        return num;
+    }
+
+
+    int ConnectedComponents::label(PointCloud *cloud, float radius, PointCloud::VertexProperty<int> label,
+                                   std::vector<Stats> *stats, const KdTreeSearch *kdtree) {
+        KdTreeSearch_NanoFLANN *own_kdtree = nullptr;
+        if (!kdtree) {
+            own_kdtree = new KdTreeSearch_NanoFLANN;
+            own_kdtree->begin();
+            own_kdtree->add_point_cloud(cloud);
+            own_kdtree->end();
+            kdtree = own_kdtree;
+        }
+
+        // only the FLANN and NanoFLANN kd-trees can be queried concurrently
+        const bool thread_safe = dynamic_cast<const KdTreeSearch_NanoFLANN *>(kdtree) ||
+                                 dynamic_cast<const KdTreeSearch_FLANN *>(kdtree);
+
+        const std::vector<vec3> &points = cloud->points();
+        const int num_points = static_cast<int>(cloud->vertices_size());
+        const float squared_radius = radius * radius;
+
+        details::UnionFind uf(num_points);
+#pragma omp parallel for schedule(dynamic, 1024) if (thread_safe)
+        for (int i = 0; i < num_points; ++i) {
+            if (cloud->is_deleted(PointCloud::Vertex(i)))
+                continue;
+            std::vector<int> neighbors;
+            kdtree->find_points_in_range(points[i], squared_radius, neighbors);
+            for (auto j : neighbors) {
+                // each pair is visited from both sides, so only one is needed
+                if (j > i && !cloud->is_deleted(PointCloud::Vertex(j)))
+                    uf.unite(i, j);
+            }
+        }
+        delete own_kdtree;
+
+        auto &labels = label.vector();
+        const int num = uf.label(labels, [cloud](int i) -> bool {
+            return cloud->is_deleted(PointCloud::Vertex(i));
+        });
+
+        if (stats) {
+            stats->assign(num, Stats());
+            for (auto v : cloud->vertices()) {
+                Stats &s = (*stats)[labels[v.idx()]];
+                ++s.size;
+                s.bbox.grow(points[v.idx()]);
+            }
+        }
+
+        return num;
+    }
+
+} // namespace easy3d
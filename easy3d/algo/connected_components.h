@@ -0,0 +1,104 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_CONNECTED_COMPONENTS_H
+#define EASY3D_ALGO_CONNECTED_COMPONENTS_H
+
+
+#include <vector>
+
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/core/graph.h>
+
+
+namespace easy3d {
+
+    class KdTreeSearch;
+
+    /// \brief Labels the connected components of surface meshes (faces or vertices), graphs, and point clouds.
+    /// \class ConnectedComponents easy3d/algo/connected_components.h
+    /// \details The labeling uses a concurrent union-find: all the connections (e.g., edges) are processed in
+    ///     parallel, and each set is always linked to the set with the smaller root. So the root of a component is
+    ///     its element with the smallest index, and the components are numbered in the order of their first
+    ///     elements (i.e., the same order as a sequential flood fill), regardless of the number of threads.
+    ///     Deleted elements are labeled -1.
+    class ConnectedComponents {
+    public:
+        /// \brief Statistics of a connected component.
+        struct Stats {
+            Stats() : size(0), area(0.0) {}
+            std::size_t size;   ///< The number of elements.
+            double area;        ///< The surface area (only for surface meshes).
+            Box3 bbox;          ///< The bounding box of the elements (the vertices of the faces for face labeling).
+        };
+
+        /**
+         * \brief Labels the connected components of a surface mesh from its vertices (connected by edges).
+         * @param mesh The input mesh.
+         * @param label The vertex property storing the result.
+         * @param stats If not null, returns the statistics of each component.
+         * @return The number of connected components.
+         */
+        static int label(SurfaceMesh *mesh, SurfaceMesh::VertexProperty<int> label, std::vector<Stats> *stats = nullptr);
+
+        /**
+         * \brief Labels the connected components of a surface mesh from its faces (connected by edges).
+         * @param mesh The input mesh.
+         * @param label The face property storing the result.
+         * @param stats If not null, returns the statistics of each component.
+         * @return The number of connected components.
+         */
+        static int label(SurfaceMesh *mesh, SurfaceMesh::FaceProperty<int> label, std::vector<Stats> *stats = nullptr);
+
+        /**
+         * \brief Labels the connected components of a graph from its vertices (connected by edges).
+         * @param graph The input graph.
+         * @param label The vertex property storing the result.
+         * @param stats If not null, returns the statistics of each component.
+         * @return The number of connected components.
+         */
+        static int label(Graph *graph, Graph::VertexProperty<int> label, std::vector<Stats> *stats = nullptr);
+
+        /**
+         * \brief Labels the clusters of a point cloud, in which two points are connected if their distance is
+         *      smaller than (or equal to) \p radius.
+         * @param cloud The input point cloud.
+         * @param radius The connectivity radius.
+         * @param label The vertex property storing the result.
+         * @param stats If not null, returns the statistics of each component.
+         * @param kdtree The kd-tree of the point cloud. If null, a temporary one will be built. The kd-tree is
+         *      queried in parallel only if it is thread-safe (i.e., KdTreeSearch_FLANN or KdTreeSearch_NanoFLANN),
+         *      and serially otherwise.
+         * @return The number of connected components.
+         */
+        static int label(PointCloud *cloud, float radius, PointCloud::VertexProperty<int> label,
+                         std::vector<Stats> *stats = nullptr, const KdTreeSearch *kdtree = nullptr);
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_ALGO_CONNECTED_COMPONENTS_H
@@ -10,9 +10,14 @@
 
 
 #include <easy3d/algo/delaunay.h>
+#include <easy3d/util/stop_watch.h>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <fstream>
+#include <numeric>
+#include <random>
 #include <string>
 
 
@@ -30,6 +35,150 @@ namespace easy3d {
             }
             return result;
         }
+
+        // twice the signed area of triangle (a, b, c)
+        inline double orient_2d(const float *a, const float *b, const float *c) {
+            return (double(b[0]) - a[0]) * (double(c[1]) - a[1]) - (double(b[1]) - a[1]) * (double(c[0]) - a[0]);
+        }
+
+        // six times the signed volume of tetrahedron (a, b, c, d)
+        inline double orient_3d(const float *a, const float *b, const float *c, const float *d) {
+            const double bx = double(b[0]) - a[0], by = double(b[1]) - a[1], bz = double(b[2]) - a[2];
+            const double cx = double(c[0]) - a[0], cy = double(c[1]) - a[1], cz = double(c[2]) - a[2];
+            const double dx = double(d[0]) - a[0], dy = double(d[1]) - a[1], dz = double(d[2]) - a[2];
+            return bx * (cy * dz - cz * dy) - by * (cx * dz - cz * dx) + bz * (cx * dy - cy * dx);
+        }
+
+        inline double orient(unsigned int dim, const float *const *v) {
+            return dim == 2 ? orient_2d(v[0], v[1], v[2]) : orient_3d(v[0], v[1], v[2], v[3]);
+        }
+
+        // interleaves the lowest 10 bits of x, y, and z (for 2D, z = 0 gives the 2D Morton code on x and y)
+        inline uint32_t morton_code(uint32_t x, uint32_t y, uint32_t z) {
+            uint32_t code = 0;
+            for (int i = 0; i < 10; ++i) {
+                code |= ((x >> i) & 1u) << (3 * i);
+                code |= ((y >> i) & 1u) << (3 * i + 1);
+                code |= ((z >> i) & 1u) << (3 * i + 2);
+            }
+            return code;
+        }
+
+        // the Morton code of point p in the bounding box [min_coord, max_coord]
+        inline uint32_t morton_key(unsigned int dim, const float *p, const float *min_coord, const float *max_coord) {
+            uint32_t cell[3] = {0, 0, 0};
+            for (unsigned int k = 0; k < dim; ++k) {
+                const float range = max_coord[k] - min_coord[k];
+                if (range > 0)
+                    cell[k] = static_cast<uint32_t>((p[k] - min_coord[k]) / range * 1023.0f);
+            }
+            return morton_code(cell[0], cell[1], cell[2]);
+        }
+
+        // sorts the points (given by their indices) along a Morton curve so that consecutive points are close
+        inline void spatial_sort(unsigned int dim, const float *points, unsigned int *begin, unsigned int *end) {
+            const std::size_t n = end - begin;
+            if (n < 2)
+                return;
+            float min_coord[3] = {0, 0, 0}, max_coord[3] = {0, 0, 0};
+            for (unsigned int k = 0; k < dim; ++k)
+                min_coord[k] = max_coord[k] = points[begin[0] * dim + k];
+            for (const unsigned int *id = begin + 1; id != end; ++id) {
+                for (unsigned int k = 0; k < dim; ++k) {
+                    min_coord[k] = std::min(min_coord[k], points[*id * dim + k]);
+                    max_coord[k] = std::max(max_coord[k], points[*id * dim + k]);
+                }
+            }
+            std::vector<std::pair<uint32_t, unsigned int> > keys(n);
+#pragma omp parallel for
+            for (int i = 0; i < static_cast<int>(n); ++i)
+                keys[i] = std::make_pair(morton_key(dim, points + begin[i] * dim, min_coord, max_coord), begin[i]);
+            std::sort(keys.begin(), keys.end());
+            for (std::size_t i = 0; i < n; ++i)
+                begin[i] = keys[i].second;
+        }
+
+        // sorts the n query points along a Morton curve so that consecutive queries are close to each other
+        inline std::vector<unsigned int> spatial_order(unsigned int dim, unsigned int n, const float *points) {
+            std::vector<unsigned int> order(n);
+            for (unsigned int i = 0; i < n; ++i)
+                order[i] = i;
+            if (n > 0)
+                spatial_sort(dim, points, order.data(), order.data() + n);
+            return order;
+        }
+
+        // The lifted determinant |a-p, |a-p|^2; b-p, |b-p|^2; ...|, which tells if p is inside the circumscribed
+        // circle/sphere of the cell. It is positive (in 2D) or negative (in 3D) if p is inside the circumscribed
+        // circle/sphere of a positively oriented cell.
+        inline double lifted_2d(const float *a, const float *b, const float *c, const float *p) {
+            const double adx = double(a[0]) - p[0], ady = double(a[1]) - p[1];
+            const double bdx = double(b[0]) - p[0], bdy = double(b[1]) - p[1];
+            const double cdx = double(c[0]) - p[0], cdy = double(c[1]) - p[1];
+            return (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+                   + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy)
+                   + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+        }
+
+        inline double det_3x3(const double *a, const double *b, const double *c) {
+            return a[0] * (b[1] * c[2] - b[2] * c[1]) - a[1] * (b[0] * c[2] - b[2] * c[0]) +
+                   a[2] * (b[0] * c[1] - b[1] * c[0]);
+        }
+
+        inline double lifted_3d(const float *a, const float *b, const float *c, const float *d, const float *p) {
+            double r[4][3], lift[4];
+            const float *v[4] = {a, b, c, d};
+            for (int i = 0; i < 4; ++i) {
+                for (int k = 0; k < 3; ++k)
+                    r[i][k] = double(v[i][k]) - p[k];
+                lift[i] = r[i][0] * r[i][0] + r[i][1] * r[i][1] + r[i][2] * r[i][2];
+            }
+            // expansion along the last column
+            return -lift[0] * det_3x3(r[1], r[2], r[3]) + lift[1] * det_3x3(r[0], r[2], r[3])
+                   - lift[2] * det_3x3(r[0], r[1], r[3]) + lift[3] * det_3x3(r[0], r[1], r[2]);
+        }
+
+        // positive if p is strictly inside the circumscribed circle/sphere of the positively oriented cell v
+        inline double in_sphere(unsigned int dim, const float *const *v, const float *p) {
+            return dim == 2 ? lifted_2d(v[0], v[1], v[2], p) : -lifted_3d(v[0], v[1], v[2], v[3], p);
+        }
+
+        // Pairs the facets incident to vertex 'exclude' of the cells stored consecutively in cells (cs vertices each).
+        // Two cells are adjacent if they share a facet, which is identified by its vertices other than 'exclude' (the
+        // infinite vertex -1 is stored as 0). Each pair is (cell * cs + slot, cell * cs + slot), and false is returned
+        // if a facet is not shared by exactly two cells.
+        inline bool pair_facets(unsigned int cs, const std::vector<int> &cells, int exclude,
+                                std::vector<std::pair<int, int> > &pairs) {
+            std::vector<std::pair<uint64_t, int> > facets;  // (key, cell * cs + slot)
+            facets.reserve(cells.size());
+            for (std::size_t c = 0; c < cells.size() / cs; ++c) {
+                const int *cv = &cells[c * cs];
+                if (cv[0] == -2)
+                    continue;   // deleted
+                for (unsigned int i = 0; i < cs; ++i) {
+                    if (cv[i] == exclude)
+                        continue;
+                    uint32_t ids[2] = {0, 0};
+                    unsigned int n = 0;
+                    for (unsigned int j = 0; j < cs; ++j) {
+                        if (j != i && cv[j] != exclude)
+                            ids[n++] = static_cast<uint32_t>(cv[j] + 1);
+                    }
+                    if (n == 2 && ids[0] > ids[1])
+                        std::swap(ids[0], ids[1]);
+                    facets.emplace_back((static_cast<uint64_t>(ids[0]) << 32) | ids[1], static_cast<int>(c * cs + i));
+                }
+            }
+            std::sort(facets.begin(), facets.end());
+            pairs.clear();
+            for (std::size_t i = 0; i < facets.size(); i += 2) {
+                if (i + 1 == facets.size() || facets[i].first != facets[i + 1].first ||
+                    (i + 2 < facets.size() && facets[i].first == facets[i + 2].first))
+                    return false;
+                pairs.emplace_back(facets[i].second, facets[i + 1].second);
+            }
+            return true;
+        }
     }
     // \endcond
 
@@ -45,6 +194,10 @@ namespace easy3d {
         cell_to_v_ = nullptr;
         cell_to_cell_ = nullptr;
         is_locked_ = false;
+        last_cell_ = -1;
+        jump_grid_res_ = 0;
+        jump_grid_nb_vertices_ = 0;
+        incremental_ = false;
     }
 
 
@@ -53,6 +206,20 @@ namespace easy3d {
 
 
     void Delaunay::set_vertices(unsigned int nb_vertices, const float *vertices) {
+        // a new triangulation replaces the incremental one (if any)
+        incremental_ = false;
+        inc_cell_to_v_.clear();
+        inc_cell_to_cell_.clear();
+        inf_cell_to_v_.clear();
+        inf_cell_to_cell_.clear();
+        inc_hull_.clear();
+        inc_free_cells_.clear();
+        inf_free_cells_.clear();
+        inc_dirty_.clear();
+        inc_dirty_marks_.clear();
+        if (vertices != own_vertices_.data())
+            std::vector<float>().swap(own_vertices_);
+
         nb_vertices_ = nb_vertices;
         vertices_ = vertices;
         if (nb_vertices_ < dimension() + 1) {
@@ -65,9 +232,11 @@ namespace easy3d {
         nb_cells_ = nb_cells;
         cell_to_v_ = cell_to_v;
         cell_to_cell_ = cell_to_cell;
+        last_cell_ = -1;
         if (cell_to_cell != nullptr) {
             update_v_to_cell();
             update_cicl();
+            update_jump_grid();
             if (dimension() >= 6) {
                 update_neighbors();
             }
@@ -75,22 +244,802 @@ namespace easy3d {
     }
 
 
+    int Delaunay::walk(const float *p, int start, int &last) const {
+        // Visibility walk: move to a neighbor cell whenever p is on the other side of the facet shared with it.
+        // The first facet to test is chosen pseudo-randomly, which guarantees termination for non-Delaunay
+        // (e.g., due to rounding) configurations with probability 1. The number of steps is bounded anyway.
+        const unsigned int dim = dimension();
+        const unsigned int size = cell_size();
+        unsigned int seed = static_cast<unsigned int>(start) * 2654435761u + 1u;
+        int previous = -1;
+        int c = start;
+        const float *v[4];
+        for (unsigned int step = 0; step < nb_cells(); ++step) {
+            last = c;
+            for (unsigned int lv = 0; lv < size; ++lv)
+                v[lv] = vertex_ptr(cell_vertex(c, lv));
+            const double sign = details::orient(dim, v);
+            seed = seed * 1664525u + 1013904223u;
+            const unsigned int first = (seed >> 16) % size;
+            int next = c;
+            for (unsigned int i = 0; i < size; ++i) {
+                const unsigned int lf = (first + i) % size;
+                const int neighbor = cell_adjacent(c, lf);
+                if (neighbor == previous && neighbor != -1)
+                    continue;   // p cannot be on the other side of the facet we just crossed
+                const float *opposite = v[lf];
+                v[lf] = p;
+                const double o = details::orient(dim, v);
+                v[lf] = opposite;
+                if (o * sign < 0) { // p is on the other side of facet lf
+                    if (neighbor == -1)
+                        return -1;  // outside the convex hull
+                    next = neighbor;
+                    break;
+                }
+            }
+            if (next == c)
+                return c;
+            previous = c;
+            c = next;
+        }
+        return -1;
+    }
+
+
+    unsigned int Delaunay::descend(const float *p, unsigned int v) const {
+        // In a Delaunay triangulation, a vertex that is not the nearest one to p always has a neighbor closer to p.
+        float d = details::squared_distance(dimension(), vertex_ptr(v), p);
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            const int vt = v_to_cell_[v];
+            if (vt == -1)
+                break;
+            int t = vt;
+            do {
+                unsigned int lvit = index(t, v);
+                for (unsigned int lv = 0; lv < cell_size(); lv++) {
+                    if (lv == lvit)
+                        continue;
+                    const unsigned int w = cell_vertex(t, lv);
+                    const float cur_d = details::squared_distance(dimension(), vertex_ptr(w), p);
+                    if (cur_d < d) {
+                        d = cur_d;
+                        v = w;
+                        improved = true;
+                    }
+                }
+                if (improved)
+                    break;
+                t = next_around_vertex(t, lvit);
+            } while (t != vt);
+        }
+        return v;
+    }
+
+
+    void Delaunay::update_jump_grid() {
+        jump_grid_.clear();
+        jump_grid_res_ = 0;
+        jump_grid_nb_vertices_ = nb_vertices();
+        if (nb_cells() == 0 || nb_vertices() == 0)
+            return;
+
+        const unsigned int dim = dimension();
+        float max_coord[3] = {0, 0, 0};
+        for (unsigned int k = 0; k < dim; ++k)
+            jump_grid_min_[k] = max_coord[k] = vertices_[k];
+        for (unsigned int v = 1; v < nb_vertices(); ++v) {
+            for (unsigned int k = 0; k < dim; ++k) {
+                jump_grid_min_[k] = std::min(jump_grid_min_[k], vertex_ptr(v)[k]);
+                max_coord[k] = std::max(max_coord[k], vertex_ptr(v)[k]);
+            }
+        }
+
+        // about 8 vertices per grid cell, so a walk from the grid is only a few steps
+        const double num_grid_cells = std::max(1.0, nb_vertices() / 8.0);
+        jump_grid_res_ = std::max(1u, static_cast<unsigned int>(std::pow(num_grid_cells, 1.0 / dim)));
+        for (unsigned int k = 0; k < dim; ++k)
+            jump_grid_step_[k] = std::max((max_coord[k] - jump_grid_min_[k]) / jump_grid_res_, 1e-30f);
+
+        jump_grid_.assign(static_cast<std::size_t>(std::pow(jump_grid_res_, dim) + 0.5), -1);
+        for (unsigned int v = 0; v < nb_vertices(); ++v) {
+            if (v_to_cell_[v] != -1)
+                jump_grid_[jump_grid_index(vertex_ptr(v))] = v_to_cell_[v];
+        }
+    }
+
+
+    std::size_t Delaunay::jump_grid_index(const float *p) const {
+        std::size_t id = 0;
+        for (int k = static_cast<int>(dimension()) - 1; k >= 0; --k) {
+            const float x = (p[k] - jump_grid_min_[k]) / jump_grid_step_[k];
+            const unsigned int i = std::min(jump_grid_res_ - 1, static_cast<unsigned int>(std::max(x, 0.0f)));
+            id = id * jump_grid_res_ + i;
+        }
+        return id;
+    }
+
+
+    int Delaunay::start_cell(const float *p, int hint) const {
+        if (hint >= 0 && hint < static_cast<int>(nb_cells()))
+            return hint;
+
+        int last = last_cell_.load(std::memory_order_relaxed);
+        if (last < 0 || last >= static_cast<int>(nb_cells()))
+            last = 0;
+        if (jump_grid_res_ == 0)
+            return last;
+
+        const int jump = jump_grid_[jump_grid_index(p)];
+        if (jump < 0 || jump >= static_cast<int>(nb_cells()))
+            return last;
+
+        const float d_last = details::squared_distance(dimension(), vertex_ptr(cell_vertex(last, 0)), p);
+        const float d_jump = details::squared_distance(dimension(), vertex_ptr(cell_vertex(jump, 0)), p);
+        return d_jump < d_last ? jump : last;
+    }
+
+
+    int Delaunay::locate(const float *p, int hint) const {
+        if (nb_cells() == 0)
+            return -1;
+        hint = start_cell(p, hint);
+        int last = hint;
+        const int c = walk(p, hint, last);
+        last_cell_.store(last, std::memory_order_relaxed);
+        return c;
+    }
+
+
     unsigned int Delaunay::nearest_vertex(const float *p) const {
-        // Inefficient implementation (but at least it works).
-        std::cerr << "TODO: replace with line walk (or maybe we could use kd-tree here)" << std::endl;
+        return nearest_vertex(p, -1);
+    }
+
+
+    unsigned int Delaunay::nearest_vertex(const float *p, int hint) const {
         assert(nb_vertices() > 0);
-        unsigned int result = 0;
-        float d = details::squared_distance(dimension(), vertex_ptr(0), p);
-        for (unsigned int i = 1; i < nb_vertices(); i++) {
-            float cur_d = details::squared_distance(dimension(), vertex_ptr(i), p);
+        if (nb_cells() == 0 || cell_to_cell_ == nullptr) {    // no triangulation: brute force
+            unsigned int result = 0;
+            float d = details::squared_distance(dimension(), vertex_ptr(0), p);
+            for (unsigned int i = 1; i < nb_vertices(); i++) {
+                float cur_d = details::squared_distance(dimension(), vertex_ptr(i), p);
+                if (cur_d < d) {
+                    d = cur_d;
+                    result = i;
+                }
+            }
+            return result;
+        }
+
+        hint = start_cell(p, hint);
+        int last = hint;
+        walk(p, hint, last);    // inside or not, the last cell visited is close to p
+        last_cell_.store(last, std::memory_order_relaxed);
+
+        // start from the nearest vertex of that cell
+        unsigned int v = cell_vertex(last, 0);
+        float d = details::squared_distance(dimension(), vertex_ptr(v), p);
+        for (unsigned int lv = 1; lv < cell_size(); ++lv) {
+            const unsigned int w = cell_vertex(last, lv);
+            const float cur_d = details::squared_distance(dimension(), vertex_ptr(w), p);
             if (cur_d < d) {
                 d = cur_d;
-                result = i;
+                v = w;
             }
         }
-        return result;
+        return descend(p, v);
+    }
+
+
+    void Delaunay::nearest_vertices(unsigned int n, const float *points, std::vector<unsigned int> &result) const {
+        result.resize(n);
+        if (n == 0)
+            return;
+        const std::vector<unsigned int> order = details::spatial_order(dimension(), n, points);
+        const int chunk_size = 4096;
+        const int num_chunks = static_cast<int>((n + chunk_size - 1) / chunk_size);
+#pragma omp parallel for schedule(dynamic)
+        for (int chunk = 0; chunk < num_chunks; ++chunk) {
+            const unsigned int begin = chunk * chunk_size;
+            const unsigned int end = std::min(n, begin + chunk_size);
+            int hint = -1;
+            for (unsigned int i = begin; i < end; ++i) {
+                const unsigned int id = order[i];
+                const float *p = points + id * dimension();
+                result[id] = nearest_vertex(p, hint);
+                if (nb_cells() > 0 && v_to_cell_[result[id]] != -1)
+                    hint = v_to_cell_[result[id]];
+            }
+        }
+    }
+
+
+    void Delaunay::locate(unsigned int n, const float *points, std::vector<int> &result) const {
+        result.resize(n);
+        if (n == 0)
+            return;
+        const std::vector<unsigned int> order = details::spatial_order(dimension(), n, points);
+        const int chunk_size = 4096;
+        const int num_chunks = static_cast<int>((n + chunk_size - 1) / chunk_size);
+#pragma omp parallel for schedule(dynamic)
+        for (int chunk = 0; chunk < num_chunks; ++chunk) {
+            const unsigned int begin = chunk * chunk_size;
+            const unsigned int end = std::min(n, begin + chunk_size);
+            int hint = -1;
+            for (unsigned int i = begin; i < end; ++i) {
+                const unsigned int id = order[i];
+                if (nb_cells() == 0) {
+                    result[id] = -1;
+                    continue;
+                }
+                const float *p = points + id * dimension();
+                int last = start_cell(p, hint);
+                result[id] = walk(p, last, last);
+                hint = last;
+            }
+        }
+    }
+
+    void Delaunay::insert_vertices(unsigned int nb_vertices, const float *vertices) {
+        if (nb_vertices == 0)
+            return;
+        const unsigned int dim = dimension();
+
+        if (nb_cells() == 0 && !incremental_) {
+            // nothing has been triangulated yet: triangulate all the vertices at once
+            std::vector<float> coords;
+            coords.reserve((nb_vertices_ + nb_vertices) * dim);
+            if (vertices_)
+                coords.insert(coords.end(), vertices_, vertices_ + nb_vertices_ * dim);
+            coords.insert(coords.end(), vertices, vertices + nb_vertices * dim);
+            own_vertices_.swap(coords);
+            set_vertices(static_cast<unsigned int>(own_vertices_.size() / dim), own_vertices_.data());
+            return;
+        }
+
+        StopWatch w;
+        if (!incremental_) {
+            if (vertices_ != own_vertices_.data())
+                own_vertices_.assign(vertices_, vertices_ + nb_vertices_ * dim);
+            vertices_ = own_vertices_.data();
+            import_cells();
+            incremental_ = true;
+        }
+
+        const unsigned int first = nb_vertices_;
+        own_vertices_.insert(own_vertices_.end(), vertices, vertices + nb_vertices * dim);
+        vertices_ = own_vertices_.data();
+        nb_vertices_ += nb_vertices;
+        v_to_cell_.resize(nb_vertices_, -1);
+        inc_dirty_marks_.resize(nb_vertices_, 0);
+
+        // biased randomized insertion order: the vertices are shuffled and split into rounds of doubling sizes, and
+        // each round is sorted along a space-filling curve.
+        std::vector<unsigned int> order(nb_vertices);
+        std::iota(order.begin(), order.end(), first);
+        std::mt19937 rng(first);
+        std::shuffle(order.begin(), order.end(), rng);
+        std::vector<unsigned int> bounds(1, nb_vertices);
+        while (bounds.back() > 128)
+            bounds.push_back(bounds.back() / 2);
+        bounds.push_back(0);
+        for (std::size_t i = bounds.size() - 1; i > 0; --i)
+            details::spatial_sort(dim, vertices_, order.data() + bounds[i], order.data() + bounds[i - 1]);
+
+        int hint = -1;
+        unsigned int num_inserted = 0, num_failed = 0;
+        for (auto v : order) {
+            const int status = insert_vertex(v, hint);
+            if (status == 1)
+                ++num_inserted;
+            else if (status == -1)
+                ++num_failed;
+        }
+
+        if (num_failed > 0) {
+            LOG(WARNING) << num_failed << " vertices could not be inserted incrementally. Triangulating all the "
+                         << nb_vertices_ << " vertices again";
+            set_vertices(nb_vertices_, own_vertices_.data());
+            return;
+        }
+        finish_insertion(first);
+
+        LOG_IF(num_inserted < nb_vertices, WARNING) << nb_vertices - num_inserted << " duplicated vertices ignored";
+        LOG(INFO) << num_inserted << " vertices inserted. time: " << w.time_string();
     }
 
+
+    int Delaunay::inc_adjacent(int c, unsigned int lf) const {
+        const unsigned int cs = cell_size();
+        if (c <= -2)
+            return inf_cell_to_cell_[(-2 - c) * cs + lf];
+        const int n = inc_cell_to_cell_[c * cs + lf];
+        if (n != -1)
+            return n;
+        const auto pos = inc_hull_.find(static_cast<int>(c * cs + lf));
+        return pos == inc_hull_.end() ? -1 : pos->second;
+    }
+
+
+    void Delaunay::set_inc_adjacent(int c, unsigned int lf, int n) {
+        const unsigned int cs = cell_size();
+        if (c <= -2) {
+            inf_cell_to_cell_[(-2 - c) * cs + lf] = n;
+            return;
+        }
+        const int key = static_cast<int>(c * cs + lf);
+        if (n <= -2) {  // a hull facet
+            inc_cell_to_cell_[key] = -1;
+            inc_hull_[key] = n;
+        } else {
+            if (inc_cell_to_cell_[key] == -1)
+                inc_hull_.erase(key);
+            inc_cell_to_cell_[key] = n;
+        }
+    }
+
+
+    int Delaunay::new_inc_cell(const int *vertices) {
+        const unsigned int cs = cell_size();
+        const bool infinite = std::find(vertices, vertices + cs, -1) != vertices + cs;
+        std::vector<int> &free_cells = infinite ? inf_free_cells_ : inc_free_cells_;
+        std::vector<int> &cell_to_v = infinite ? inf_cell_to_v_ : inc_cell_to_v_;
+        std::vector<int> &cell_to_cell = infinite ? inf_cell_to_cell_ : inc_cell_to_cell_;
+        int id = 0;
+        if (!free_cells.empty()) {
+            id = free_cells.back();
+            free_cells.pop_back();
+        } else {
+            id = static_cast<int>(cell_to_v.size() / cs);
+            cell_to_v.resize(cell_to_v.size() + cs);
+            cell_to_cell.resize(cell_to_cell.size() + cs);
+        }
+        std::copy(vertices, vertices + cs, cell_to_v.begin() + id * cs);
+        std::fill(cell_to_cell.begin() + id * cs, cell_to_cell.begin() + (id + 1) * cs, -1);
+        if (infinite)
+            return -2 - id;
+
+        for (unsigned int lv = 0; lv < cs; ++lv) {
+            v_to_cell_[vertices[lv]] = id;
+            if (!inc_dirty_marks_[vertices[lv]]) {
+                inc_dirty_marks_[vertices[lv]] = 1;
+                inc_dirty_.push_back(vertices[lv]);
+            }
+        }
+        return id;
+    }
+
+
+    void Delaunay::delete_inc_cell(int c) {
+        const unsigned int cs = cell_size();
+        if (c <= -2) {
+            const int id = -2 - c;
+            std::fill(inf_cell_to_v_.begin() + id * cs, inf_cell_to_v_.begin() + (id + 1) * cs, -2);
+            inf_free_cells_.push_back(id);
+            return;
+        }
+        for (unsigned int lf = 0; lf < cs; ++lf) {
+            if (inc_cell_to_cell_[c * cs + lf] == -1)
+                inc_hull_.erase(static_cast<int>(c * cs + lf));
+        }
+        std::fill(inc_cell_to_v_.begin() + c * cs, inc_cell_to_v_.begin() + (c + 1) * cs, -2);
+        inc_free_cells_.push_back(c);
+    }
+
+
+    void Delaunay::move_inc_cell(int from, int to) {
+        const unsigned int cs = cell_size();
+        for (unsigned int lf = 0; lf < cs; ++lf) {
+            const int v = inc_cell_to_v_[from * cs + lf];
+            inc_cell_to_v_[to * cs + lf] = v;
+            v_to_cell_[v] = to;
+            if (!inc_dirty_marks_[v]) {
+                inc_dirty_marks_[v] = 1;
+                inc_dirty_.push_back(v);
+            }
+
+            const int n = inc_adjacent(from, lf);
+            inc_cell_to_cell_[to * cs + lf] = inc_cell_to_cell_[from * cs + lf];
+            if (inc_cell_to_cell_[from * cs + lf] == -1) {
+                inc_hull_.erase(static_cast<int>(from * cs + lf));
+                if (n != -1)
+                    inc_hull_[static_cast<int>(to * cs + lf)] = n;
+            }
+            if (n == -1)
+                continue;
+            std::vector<int> &cell_to_cell = n <= -2 ? inf_cell_to_cell_ : inc_cell_to_cell_;
+            const int id = n <= -2 ? -2 - n : n;
+            for (unsigned int s = 0; s < cs; ++s) {
+                if (cell_to_cell[id * cs + s] == from)
+                    cell_to_cell[id * cs + s] = to;
+            }
+        }
+        std::fill(inc_cell_to_v_.begin() + from * cs, inc_cell_to_v_.begin() + (from + 1) * cs, -2);
+    }
+
+
+    void Delaunay::import_cells() {
+        const unsigned int cs = cell_size();
+        const unsigned int num = nb_cells();
+        inc_cell_to_v_.assign(cell_to_v_, cell_to_v_ + num * cs);
+        inc_cell_to_cell_.assign(cell_to_cell_, cell_to_cell_ + num * cs);
+        inf_cell_to_v_.clear();
+        inf_cell_to_cell_.clear();
+        inc_hull_.clear();
+        inc_free_cells_.clear();
+        inf_free_cells_.clear();
+        inc_dirty_.clear();
+        inc_dirty_marks_.assign(nb_vertices(), 0);
+
+        // all cells are positively oriented
+        const float *v[4];
+        for (unsigned int c = 0; c < num; ++c) {
+            int *cv = &inc_cell_to_v_[c * cs];
+            for (unsigned int lv = 0; lv < cs; ++lv)
+                v[lv] = vertex_ptr(cv[lv]);
+            if (details::orient(dimension(), v) < 0) {
+                std::swap(cv[0], cv[1]);
+                std::swap(inc_cell_to_cell_[c * cs], inc_cell_to_cell_[c * cs + 1]);
+                std::swap(cicl_[c * cs], cicl_[c * cs + 1]);
+            }
+        }
+
+        // an infinite cell for each facet on the convex hull. Replacing the vertex opposite to the facet by the
+        // infinite vertex flips the orientation, so two other vertices are swapped.
+        int iv[4];
+        for (unsigned int c = 0; c < num; ++c) {
+            for (unsigned int lf = 0; lf < cs; ++lf) {
+                if (inc_cell_to_cell_[c * cs + lf] != -1)
+                    continue;
+                std::copy(&inc_cell_to_v_[c * cs], &inc_cell_to_v_[c * cs] + cs, iv);
+                iv[lf] = -1;
+                std::swap(iv[(lf + 1) % cs], iv[(lf + 2) % cs]);
+                const int ic = new_inc_cell(iv);
+                set_inc_adjacent(ic, lf, static_cast<int>(c));
+                set_inc_adjacent(static_cast<int>(c), lf, ic);
+            }
+        }
+        std::vector<std::pair<int, int> > pairs;
+        if (!details::pair_facets(cs, inf_cell_to_v_, -1, pairs))
+            LOG(WARNING) << "the convex hull is not closed";
+        for (const auto &pair : pairs) {
+            const int c1 = -2 - pair.first / static_cast<int>(cs), c2 = -2 - pair.second / static_cast<int>(cs);
+            set_inc_adjacent(c1, pair.first % cs, c2);
+            set_inc_adjacent(c2, pair.second % cs, c1);
+        }
+
+        // the finite cells have been copied, so they are no longer needed
+        release_cells();
+        cell_to_v_ = inc_cell_to_v_.data();
+        cell_to_cell_ = inc_cell_to_cell_.data();
+    }
+
+
+    void Delaunay::finish_insertion(unsigned int first) {
+        const unsigned int cs = cell_size();
+
+        // fill the holes left by the deleted cells with the last cells, so the finite cells are stored compactly
+        std::sort(inc_free_cells_.begin(), inc_free_cells_.end());
+        int num = static_cast<int>(inc_cell_to_v_.size() / cs);
+        for (auto hole : inc_free_cells_) {
+            while (num > 0 && inc_cell_to_v_[(num - 1) * cs] == -2)
+                --num;
+            if (hole >= num)
+                break;
+            move_inc_cell(num - 1, hole);
+            --num;
+        }
+        inc_free_cells_.clear();
+        inc_cell_to_v_.resize(num * cs);
+        inc_cell_to_cell_.resize(num * cs);
+        nb_cells_ = num;
+        cell_to_v_ = inc_cell_to_v_.data();
+        cell_to_cell_ = inc_cell_to_cell_.data();
+        last_cell_ = -1;
+
+        // Only the cells around the vertices whose incident cells have changed are linked again. If there are many
+        // such vertices, it is faster to link all the cells again (which visits the cells in order).
+        cicl_.resize(num * cs);
+        if (inc_dirty_.size() * 8 > nb_vertices()) {
+            update_v_to_cell();
+            update_cicl();
+        } else {
+            inc_ring_marks_.resize(num * cs, 0);
+#pragma omp parallel
+            {
+                std::vector<int> ring;
+#pragma omp for
+                for (int i = 0; i < static_cast<int>(inc_dirty_.size()); ++i)
+                    link_around_vertex(inc_dirty_[i], ring);
+            }
+        }
+        for (auto v : inc_dirty_)
+            inc_dirty_marks_[v] = 0;
+        inc_dirty_.clear();
+
+        // the jump grid is built again when the number of vertices has doubled, and is updated locally otherwise
+        if (jump_grid_res_ == 0 || nb_vertices() > 2 * jump_grid_nb_vertices_)
+            update_jump_grid();
+        else {
+            for (unsigned int v = first; v < nb_vertices(); ++v) {
+                if (v_to_cell_[v] != -1)
+                    jump_grid_[jump_grid_index(vertex_ptr(v))] = v_to_cell_[v];
+            }
+        }
+
+        if (dimension() >= 6)
+            update_neighbors();
+    }
+
+
+    void Delaunay::link_around_vertex(int v, std::vector<int> &ring) {
+        // The cells around v are collected by turning around v across the facets incident to it. A cell is stored in
+        // the ring as cell * cell_size + the slot of v, which is marked once visited.
+        const unsigned int cs = cell_size();
+        const int start = v_to_cell_[v];
+        if (start < 0 || start >= static_cast<int>(nb_cells()))
+            return;
+        ring.assign(1, static_cast<int>(start * cs + index(start, v)));
+        inc_ring_marks_[ring[0]] = 1;
+        for (std::size_t i = 0; i < ring.size(); ++i) {
+            const int c = ring[i] / static_cast<int>(cs);
+            for (unsigned int lf = 0; lf < cs; ++lf) {
+                const int n = cell_to_cell_[c * cs + lf];
+                if (cell_to_v_[c * cs + lf] == v || n == -1)
+                    continue;
+                const int slot = static_cast<int>(n * cs + index(n, v));
+                if (!inc_ring_marks_[slot]) {
+                    inc_ring_marks_[slot] = 1;
+                    ring.push_back(slot);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < ring.size(); ++i) {
+            cicl_[ring[i]] = ring[(i + 1) % ring.size()] / static_cast<int>(cs);
+            inc_ring_marks_[ring[i]] = 0;
+        }
+    }
+
+
+    bool Delaunay::in_conflict(int c, const float *p) const {
+        const unsigned int cs = cell_size();
+        const int *cv = inc_cell(c);
+        const float *v[4];
+        int infinite = -1;
+        for (unsigned int lv = 0; lv < cs; ++lv) {
+            if (cv[lv] < 0)
+                infinite = static_cast<int>(lv);
+            else
+                v[lv] = vertex_ptr(cv[lv]);
+        }
+        if (infinite == -1)
+            return details::in_sphere(dimension(), v, p) > 0;
+
+        // An infinite cell is in conflict if p is on the outer side of its hull facet. If p is on the plane of the
+        // facet, it is in conflict if the finite cell on the other side is.
+        v[infinite] = p;
+        const double o = details::orient(dimension(), v);
+        if (o != 0)
+            return o > 0;
+        return in_conflict(inc_adjacent(c, infinite), p);
+    }
+
+
+    int Delaunay::locate_conflict(const float *p, int hint) const {
+        // a visibility walk (see walk()) in the incremental triangulation until a cell in conflict with p is met
+        const unsigned int cs = cell_size();
+        const int num_finite = static_cast<int>(inc_cell_to_v_.size() / cs);
+        const int num_infinite = static_cast<int>(inf_cell_to_v_.size() / cs);
+        int c = hint;
+        if (c >= num_finite || -2 - c >= num_infinite || (c != -1 && inc_cell(c)[0] == -2))
+            c = -1;
+        for (int i = 0; i < num_finite && c == -1; ++i) {
+            if (inc_cell_to_v_[i * cs] != -2)
+                c = i;
+        }
+        if (c == -1)
+            return -1;
+
+        unsigned int seed = static_cast<unsigned int>(c) * 2654435761u + 1u;
+        int previous = -1;
+        const float *v[4];
+        for (int step = 0; step < num_finite + num_infinite; ++step) {
+            const int *cv = inc_cell(c);
+            int infinite = -1;
+            for (unsigned int lv = 0; lv < cs; ++lv) {
+                if (cv[lv] < 0)
+                    infinite = static_cast<int>(lv);
+                else
+                    v[lv] = vertex_ptr(cv[lv]);
+            }
+            if (infinite != -1) {
+                if (in_conflict(c, p))
+                    return c;
+                previous = c;
+                c = inc_adjacent(c, infinite);   // back into the hull
+                continue;
+            }
+
+            seed = seed * 1664525u + 1013904223u;
+            const unsigned int first = (seed >> 16) % cs;
+            int next = c;
+            for (unsigned int i = 0; i < cs; ++i) {
+                const unsigned int lf = (first + i) % cs;
+                const int neighbor = inc_adjacent(c, lf);
+                if (neighbor == previous)
+                    continue;
+                const float *opposite = v[lf];
+                v[lf] = p;
+                const double o = details::orient(dimension(), v);
+                v[lf] = opposite;
+                if (o < 0) {
+                    next = neighbor;
+                    break;
+                }
+            }
+            if (next == -1)
+                return -1;  // broken adjacency
+            if (next == c)
+                return c;   // p is in (or on the boundary of) c, which is thus in conflict with p
+            previous = c;
+            c = next;
+        }
+        return -1;
+    }
+
+
+    int Delaunay::insert_vertex(unsigned int v, int &hint) {
+        const unsigned int cs = cell_size();
+        const float *p = vertex_ptr(v);
+        const int start = locate_conflict(p, hint);
+        if (start == -1)
+            return -1;
+        hint = start;
+        for (unsigned int lv = 0; lv < cs; ++lv) {
+            const int w = inc_cell(start)[lv];
+            if (w >= 0 && details::squared_distance(dimension(), vertex_ptr(w), p) == 0)
+                return 0;   // duplicated vertex
+        }
+
+        // The cavity consists of the cells in conflict with p, grown from the start cell. Marks: 1 for cells in the
+        // cavity, 2 for cells known not to be in the cavity.
+        inc_marks_.resize(inc_cell_to_v_.size() / cs, 0);
+        inf_marks_.resize(inf_cell_to_v_.size() / cs, 0);
+        inc_cavity_.assign(1, start);
+        inc_touched_.assign(1, start);
+        inc_mark(start) = 1;
+        bool valid = true;
+        for (std::size_t i = 0; i < inc_cavity_.size() && valid; ++i) {
+            const int c = inc_cavity_[i];
+            for (unsigned int lf = 0; lf < cs; ++lf) {
+                const int n = inc_adjacent(c, lf);
+                if (n == -1) {
+                    valid = false;
+                    break;
+                }
+                if (inc_mark(n) != 0)
+                    continue;
+                inc_touched_.push_back(n);
+                if (in_conflict(n, p)) {
+                    inc_mark(n) = 1;
+                    inc_cavity_.push_back(n);
+                } else
+                    inc_mark(n) = 2;
+            }
+        }
+
+        // Due to rounding errors, the cavity may not be star-shaped w.r.t. p. Cells whose boundary facets do not
+        // form positively oriented cells with p are removed from the cavity, and so are the cells no longer
+        // connected to the start cell. If this does not converge, p is not inserted.
+        const float *vp[4];
+        bool star_shaped = false;
+        for (int iter = 0; iter < 8 && valid; ++iter) {
+            bool removed = false;
+            for (auto c : inc_cavity_) {
+                if (c == start || c <= -2)
+                    continue;   // the infinite cells have been checked by in_conflict()
+                const int *cv = inc_cell(c);
+                for (unsigned int lf = 0; lf < cs; ++lf) {
+                    if (inc_mark(inc_adjacent(c, lf)) == 1)
+                        continue;
+                    for (unsigned int lv = 0; lv < cs; ++lv)
+                        vp[lv] = (lv == lf) ? p : vertex_ptr(cv[lv]);
+                    if (details::orient(dimension(), vp) <= 0) {
+                        inc_mark(c) = 2;
+                        removed = true;
+                        break;
+                    }
+                }
+            }
+            if (removed) {
+                std::vector<int> connected(1, start);
+                inc_mark(start) = 3;
+                for (std::size_t i = 0; i < connected.size(); ++i) {
+                    for (unsigned int lf = 0; lf < cs; ++lf) {
+                        const int n = inc_adjacent(connected[i], lf);
+                        if (inc_mark(n) == 1) {
+                            inc_mark(n) = 3;
+                            connected.push_back(n);
+                        }
+                    }
+                }
+                for (auto c : inc_cavity_)
+                    inc_mark(c) = (inc_mark(c) == 3) ? 1 : 2;
+                inc_cavity_.swap(connected);
+            } else {
+                star_shaped = true;
+                break;
+            }
+        }
+
+        // the boundary facets of the cavity: (outside cell, slot of p, slot in outside), and the new cells
+        struct Facet {
+            int outside;
+            unsigned int slot;
+            unsigned int outside_slot;
+        };
+        std::vector<Facet> boundary;
+        std::vector<int> new_cells;     // the vertices of the new cells
+        for (std::size_t i = 0; i < inc_cavity_.size() && star_shaped; ++i) {
+            const int c = inc_cavity_[i];
+            for (unsigned int lf = 0; lf < cs && star_shaped; ++lf) {
+                const int n = inc_adjacent(c, lf);
+                if (inc_mark(n) == 1)
+                    continue;
+                Facet f;
+                f.outside = n;
+                f.slot = lf;
+                f.outside_slot = 0;
+                while (f.outside_slot < cs && inc_adjacent(n, f.outside_slot) != c)
+                    ++f.outside_slot;
+                boundary.push_back(f);
+                const int *cv = inc_cell(c);
+                for (unsigned int lv = 0; lv < cs; ++lv)
+                    new_cells.push_back((lv == lf) ? static_cast<int>(v) : cv[lv]);
+                star_shaped = f.outside_slot < cs;
+            }
+        }
+
+        for (auto c : inc_touched_)
+            inc_mark(c) = 0;
+
+        // check the new cells before modifying the triangulation: the finite ones must be positively oriented, and
+        // each facet incident to p must be shared by exactly two new cells.
+        std::vector<std::pair<int, int> > pairs;
+        if (!star_shaped || !details::pair_facets(cs, new_cells, static_cast<int>(v), pairs))
+            return -1;
+        for (std::size_t i = 0; i < boundary.size(); ++i) {
+            const int *cv = &new_cells[i * cs];
+            if (std::find(cv, cv + cs, -1) != cv + cs)
+                continue;
+            for (unsigned int lv = 0; lv < cs; ++lv)
+                vp[lv] = vertex_ptr(cv[lv]);
+            if (details::orient(dimension(), vp) <= 0)
+                return -1;
+        }
+
+        // replace the cavity by the cells connecting p to the boundary facets
+        for (auto c : inc_cavity_)
+            delete_inc_cell(c);
+        std::vector<int> cells(boundary.size());
+        for (std::size_t i = 0; i < boundary.size(); ++i) {
+            const Facet &f = boundary[i];
+            cells[i] = new_inc_cell(&new_cells[i * cs]);
+            set_inc_adjacent(cells[i], f.slot, f.outside);
+            set_inc_adjacent(f.outside, f.outside_slot, cells[i]);
+        }
+        for (const auto &pair : pairs) {
+            set_inc_adjacent(cells[pair.first / cs], pair.first % cs, cells[pair.second / cs]);
+            set_inc_adjacent(cells[pair.second / cs], pair.second % cs, cells[pair.first / cs]);
+        }
+
+        hint = cells.front();
+        return 1;
+    }
+
+
     void Delaunay::get_neighbors(unsigned int v, std::vector<unsigned int> &neighbors) const {
         assert(v < nb_vertices());
         if (neighbors_.size() != 0) {
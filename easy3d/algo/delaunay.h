@@ -12,6 +12,8 @@
 #define EASY3D_ALGO_DELAUNAY_H
 
 #include <cassert>
+#include <atomic>
+#include <unordered_map>
 
 #include <easy3d/core/types.h>
 #include <easy3d/util/logging.h>
@@ -41,6 +43,19 @@ namespace easy3d {
         /// \brief Sets the vertices.
         virtual void set_vertices(unsigned int nb_vertices, const float *vertices);
 
+        /**
+         * \brief Inserts vertices into the triangulation incrementally, without re-triangulating the existing ones.
+         * \details The first batch (i.e., when the triangulation is empty) is triangulated by set_vertices().
+         *      The next batches are inserted by the Bowyer-Watson algorithm in a biased randomized insertion order
+         *      (BRIO, i.e., random rounds of increasing size, each sorted along a space-filling curve), so each point
+         *      is located by a short walk from the previous one. The coordinates are copied into an internal array,
+         *      and the query functions (e.g., locate(), nearest_vertex()) can be used after each batch.
+         *      If some vertices cannot be inserted (e.g., due to rounding errors in degenerate configurations), all
+         *      the vertices are triangulated again by set_vertices().
+         * \note Vertices coinciding with existing ones are ignored (i.e., they are not in any cell).
+         */
+        void insert_vertices(unsigned int nb_vertices, const float *vertices);
+
         /// \brief Returns the pointer to the vertices.
         const float *vertices_ptr() const { return vertices_; }
 
@@ -60,8 +75,29 @@ namespace easy3d {
 
         const int *cell_to_cell() const { return cell_to_cell_; }
 
+        /// \brief Returns the index of the vertex nearest to \p p.
+        /// \details The query starts from the cell found by the previous query or from a coarse grid of cells,
+        ///     whichever is closer, so it only takes a few steps of walk.
         virtual unsigned int nearest_vertex(const float *p) const;
 
+        /// \brief Returns the index of the vertex nearest to \p p, starting the search from the cell \p hint.
+        /// \details The cell containing \p p (or the hull cell nearest to \p p) is located by a visibility walk, and
+        ///     then the nearest vertex is found by a greedy descent in the Delaunay graph.
+        unsigned int nearest_vertex(const float *p, int hint) const;
+
+        /// \brief Returns the index of the cell containing \p p, or -1 if \p p is outside the convex hull.
+        /// \param hint A cell close to \p p to start the walk from, e.g., the result of a previous nearby query. If
+        ///     it is -1, the cell found by the previous query is used.
+        int locate(const float *p, int hint = -1) const;
+
+        /// \brief Batched version of nearest_vertex() for \p n points stored consecutively in \p points.
+        /// \details The queries are sorted along a space-filling curve and processed in parallel, each chunk reusing
+        ///     the result of its previous query as the hint.
+        void nearest_vertices(unsigned int n, const float *points, std::vector<unsigned int> &result) const;
+
+        /// \brief Batched version of locate() for \p n points stored consecutively in \p points.
+        void locate(unsigned int n, const float *points, std::vector<int> &result) const;
+
         /// \brief Returns the index of the \p lv_th vertex in the \p c_th cell.
         int cell_vertex(unsigned int c, unsigned int lv) const {
             assert(c < nb_cells());
@@ -121,6 +157,47 @@ namespace easy3d {
 
     protected:
 
+        // Walks from cell \p start towards \p p. Returns the cell containing p, or -1 if p is outside the convex hull
+        // (or if the walk failed). In any case, \p last is the last cell visited.
+        int walk(const float *p, int start, int &last) const;
+
+        // Greedy descent in the Delaunay graph from vertex v towards the nearest vertex of p
+        unsigned int descend(const float *p, unsigned int v) const;
+
+        // Chooses the cell to start a walk towards p: the given hint if valid, otherwise the one closer to p among the
+        // cell of the previous query and the cell stored in the jump grid.
+        int start_cell(const float *p, int hint) const;
+
+        // Builds a coarse uniform grid storing for each grid cell a Delaunay cell inside it (for jump-and-walk).
+        void update_jump_grid();
+
+        // Returns the index of the jump grid cell containing p.
+        std::size_t jump_grid_index(const float *p) const;
+
+        // Incremental insertion (see insert_vertices()). The finite cells are stored in inc_cell_to_v_ and
+        // inc_cell_to_cell_, which the regular arrays point to. Each facet on the convex hull is closed by an infinite
+        // cell (i.e., connected to an infinite vertex with index -1), so that the adjacency is always valid. The
+        // infinite cells are stored separately, so the regular adjacency is still -1 on the hull. Internally, a cell
+        // c >= 0 is a finite cell, and a cell c <= -2 is the infinite cell -2 - c.
+        void import_cells();
+        void finish_insertion(unsigned int first);
+        void link_around_vertex(int v, std::vector<int> &ring);
+        int insert_vertex(unsigned int v, int &hint);   // 1: inserted, 0: duplicated, -1: failed
+        int locate_conflict(const float *p, int hint) const;
+        bool in_conflict(int c, const float *p) const;
+        const int *inc_cell(int c) const {
+            return c >= 0 ? &inc_cell_to_v_[c * cell_size()] : &inf_cell_to_v_[(-2 - c) * cell_size()];
+        }
+        int inc_adjacent(int c, unsigned int lf) const;
+        void set_inc_adjacent(int c, unsigned int lf, int n);
+        char &inc_mark(int c) { return c >= 0 ? inc_marks_[c] : inf_marks_[-2 - c]; }
+        int new_inc_cell(const int *vertices);
+        void delete_inc_cell(int c);
+        void move_inc_cell(int from, int to);
+
+        // Releases the cells computed by the triangulation library (once they are copied for incremental insertion)
+        virtual void release_cells() {}
+
         void get_neighbors_internal(
                 unsigned int v, std::vector<unsigned int> &neighbors
         ) const;
@@ -158,6 +235,30 @@ namespace easy3d {
         std::vector<int> cicl_;
         std::vector <std::vector<unsigned int>> neighbors_;
         bool is_locked_;
+        mutable std::atomic<int> last_cell_;    // hint for the next query
+        // the incremental triangulation (see insert_vertices())
+        bool incremental_;
+        std::vector<float> own_vertices_;
+        std::vector<int> inc_cell_to_v_;        // the finite cells
+        std::vector<int> inc_cell_to_cell_;
+        std::vector<int> inf_cell_to_v_;        // the infinite cells
+        std::vector<int> inf_cell_to_cell_;
+        std::unordered_map<int, int> inc_hull_; // hull facet (finite cell * cell_size + facet) -> infinite cell
+        std::vector<int> inc_free_cells_;       // deleted finite cells
+        std::vector<int> inf_free_cells_;       // deleted infinite cells
+        std::vector<char> inc_marks_;   // buffers for insert_vertex()
+        std::vector<char> inf_marks_;
+        std::vector<int> inc_dirty_;    // vertices whose incident cells changed since the last finish_insertion()
+        std::vector<char> inc_dirty_marks_;
+        std::vector<char> inc_ring_marks_;  // buffer for link_around_vertex()
+        std::vector<int> inc_cavity_;
+        std::vector<int> inc_touched_;
+
+        std::vector<int> jump_grid_;
+        float jump_grid_min_[3];
+        float jump_grid_step_[3];
+        unsigned int jump_grid_res_;
+        unsigned int jump_grid_nb_vertices_;    // the number of vertices when the jump grid was built
     };
 
 }   // namespace easy3d
@@ -90,4 +90,9 @@ namespace easy3d {
         LOG(INFO) << "done. time: " << t.time_string();
     }
 
+
+    void Delaunay2::release_cells() {
+        free_triangulateio(triangle_out_);
+    }
+
 }
\ No newline at end of file
@@ -46,6 +46,36 @@ namespace easy3d {
             return nearest_vertex(p.data());
         }
 
+        /// \brief Inserts vertices into the triangulation incrementally. \see Delaunay::insert_vertices().
+        void insert_vertices(const std::vector<vec2> &vertices) {
+            if (!vertices.empty())
+                Delaunay::insert_vertices((unsigned int) vertices.size(), vertices[0].data());
+        }
+
+        using Delaunay::insert_vertices;
+        using Delaunay::locate;
+        using Delaunay::nearest_vertices;
+
+        /// \brief Returns the index of the vertex nearest to \p p, starting the search from the cell \p hint.
+        unsigned int nearest_vertex(const vec2 &p, int hint) const {
+            return Delaunay::nearest_vertex(p.data(), hint);
+        }
+
+        /// \brief Returns the index of the triangle containing \p p, or -1 if \p p is outside the convex hull.
+        int locate(const vec2 &p, int hint = -1) const {
+            return Delaunay::locate(p.data(), hint);
+        }
+
+        /// \brief Returns the indices of the vertices nearest to each of the query points (computed in parallel).
+        void nearest_vertices(const std::vector<vec2> &points, std::vector<unsigned int> &result) const {
+            Delaunay::nearest_vertices((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
+        }
+
+        /// \brief Returns the indices of the triangles containing each of the query points (computed in parallel).
+        void locate(const std::vector<vec2> &points, std::vector<int> &result) const {
+            Delaunay::locate((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
+        }
+
         const vec2 &vertex(unsigned int i) const {
             return *(const vec2 *) vertex_ptr(i);
         }
@@ -68,6 +98,9 @@ namespace easy3d {
             return cell_adjacent(t, le);
         }
 
+    protected:
+        virtual void release_cells();
+
     protected:
         struct triangulateio *triangle_out_;
         struct triangulateio *triangle_in_;
@@ -11,6 +11,12 @@
 #include <easy3d/algo/delaunay_3d.h>
 #include <easy3d/util/stop_watch.h>
 
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <unordered_map>
+
 #include <3rd_party/tetgen/tetgen.h>
 
 
@@ -48,8 +54,9 @@ namespace easy3d {
             tetgenbehavior tetgen_args_;
             // Q: quiet
             // n: output tet neighbors
+            // J: no jettison of unused (e.g., duplicated) vertices, which would shift the indices of the others
             // V: verbose
-            tetgen_args_.parse_commandline((char *) ("Qn"));
+            tetgen_args_.parse_commandline((char *) ("QnJ"));
             ::tetrahedralize(&tetgen_args_, tetgen_in_, tetgen_out_);
         } catch (const std::exception& e) {
             LOG(ERROR) << "encountered a problem: " << e.what();
@@ -64,6 +71,12 @@ namespace easy3d {
     }
 
 
+    void Delaunay3::release_cells() {
+        tetgen_out_->clean_memory();
+        tetgen_out_->initialize();
+    }
+
+
 
 
 
@@ -117,6 +130,211 @@ namespace easy3d {
             return 4;
         }
 
+
+        // A vertex of a clipped Voronoi cell where exactly three planes meet is identified by the site of the cell and
+        // the tags of the three planes (sorted), i.e., the four Delaunay vertices it is equidistant to, with the faces
+        // of the box tagged by -1, ..., -6. Other vertices (in degenerate configurations) have no key.
+        typedef std::array<int, 4> VertexKey;
+        static const VertexKey no_key = {{INT_MIN, INT_MIN, INT_MIN, INT_MIN}};
+
+        struct VertexKeyHash {
+            std::size_t operator()(const VertexKey &key) const {
+                uint64_t h = 0;
+                for (int k : key)
+                    h = (h ^ static_cast<uint32_t>(k)) * 0x100000001b3ull;
+                return static_cast<std::size_t>(h ^ (h >> 29));
+            }
+        };
+
+
+        // A convex polyhedron (in double precision) that is successively clipped by planes.
+        class ConvexCell {
+        public:
+            void init(const Box3 &box) {
+                const dvec3 a(box.min_point().data()), b(box.max_point().data());
+                vertices_ = {
+                        dvec3(a.x, a.y, a.z), dvec3(b.x, a.y, a.z), dvec3(b.x, b.y, a.z), dvec3(a.x, b.y, a.z),
+                        dvec3(a.x, a.y, b.z), dvec3(b.x, a.y, b.z), dvec3(b.x, b.y, b.z), dvec3(a.x, b.y, b.z)
+                };
+                faces_ = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4}, {2, 3, 7, 6}, {0, 4, 7, 3}, {1, 2, 6, 5}};
+                tags_ = {-1, -2, -3, -4, -5, -6};   // the faces of the box
+            }
+
+            bool empty() const { return faces_.size() < 4; }
+
+            // Keeps the part of the polyhedron where dot(x - point, normal) <= 0 (normal must be unit). The new face
+            // is tagged with 'tag'. Points within 'eps' to the plane are considered on the plane.
+            void clip(const dvec3 &point, const dvec3 &normal, int tag, double eps) {
+                const std::size_t nv = vertices_.size();
+                side_.resize(nv);
+                dist_.resize(nv);
+                bool has_outside = false, has_inside = false;
+                for (std::size_t i = 0; i < nv; ++i) {
+                    dist_[i] = dot(vertices_[i] - point, normal);
+                    side_[i] = dist_[i] > eps ? 1 : (dist_[i] < -eps ? -1 : 0);
+                    has_outside |= (side_[i] > 0);
+                    has_inside |= (side_[i] < 0);
+                }
+                if (!has_outside)
+                    return;
+                if (!has_inside) {
+                    faces_.clear();
+                    tags_.clear();
+                    return;
+                }
+
+                intersections_.clear();
+                cap_.clear();
+                std::size_t num_faces = 0;
+                for (std::size_t f = 0; f < faces_.size(); ++f) {
+                    const std::vector<int> &face = faces_[f];
+                    loop_.clear();
+                    for (std::size_t i = 0; i < face.size(); ++i) {
+                        const int a = face[i];
+                        const int b = face[(i + 1) % face.size()];
+                        if (side_[a] <= 0)
+                            loop_.push_back(a);
+                        if (side_[a] * side_[b] < 0)  // strictly crossing
+                            loop_.push_back(intersection(a, b));
+                    }
+                    if (loop_.size() >= 3) {
+                        faces_[num_faces] = loop_;
+                        tags_[num_faces] = tags_[f];
+                        ++num_faces;
+                    }
+                }
+                faces_.resize(num_faces);
+                tags_.resize(num_faces);
+
+                // the cap face consists of the new vertices and the vertices on the plane
+                for (std::size_t i = 0; i < nv; ++i) {
+                    if (side_[i] == 0)
+                        cap_.push_back(static_cast<int>(i));
+                }
+                for (const auto &e : intersections_)
+                    cap_.push_back(e.second);
+                if (cap_.size() >= 3) {
+                    sort_around(cap_, normal);
+                    faces_.push_back(cap_);
+                    tags_.push_back(tag);
+                }
+                compact();
+            }
+
+            // Appends this cell (of the given site) to the output: the positions and the keys of the vertices, and the
+            // faces (the faces of the box have no bisector).
+            void output(int site, std::vector<vec3> &vertices, std::vector<VertexKey> &keys,
+                        std::vector<unsigned int> &face_ptr, std::vector<unsigned int> &face_vertices,
+                        std::vector<int> &face_bisector) {
+                const unsigned int offset = static_cast<unsigned int>(vertices.size());
+                for (const auto &p : vertices_)
+                    vertices.emplace_back(static_cast<float>(p.x), static_cast<float>(p.y), static_cast<float>(p.z));
+                for (std::size_t f = 0; f < faces_.size(); ++f) {
+                    for (auto v : faces_[f])
+                        face_vertices.push_back(offset + v);
+                    face_ptr.push_back(static_cast<unsigned int>(face_vertices.size()));
+                    face_bisector.push_back(std::max(tags_[f], -1));
+                }
+
+                // the keys of the vertices
+                cell_keys_.assign(vertices_.size(), VertexKey{{site, 0, 0, 0}});
+                valences_.assign(vertices_.size(), 0);    // the number of faces incident to each vertex
+                for (std::size_t f = 0; f < faces_.size(); ++f) {
+                    for (auto v : faces_[f]) {
+                        if (valences_[v] < 3)
+                            cell_keys_[v][1 + valences_[v]] = tags_[f];
+                        ++valences_[v];
+                    }
+                }
+                for (std::size_t v = 0; v < vertices_.size(); ++v) {
+                    if (valences_[v] == 3)
+                        std::sort(cell_keys_[v].begin(), cell_keys_[v].end());
+                    else
+                        cell_keys_[v] = no_key;
+                }
+                // keys must be unique within the cell
+                sorted_keys_ = cell_keys_;
+                std::sort(sorted_keys_.begin(), sorted_keys_.end());
+                for (auto &key : cell_keys_) {
+                    if (key != no_key &&
+                        std::upper_bound(sorted_keys_.begin(), sorted_keys_.end(), key) -
+                        std::lower_bound(sorted_keys_.begin(), sorted_keys_.end(), key) > 1)
+                        key = no_key;
+                }
+                keys.insert(keys.end(), cell_keys_.begin(), cell_keys_.end());
+            }
+
+        private:
+            // Returns the index of the intersection point of edge (a, b) with the plane. The point is computed with
+            // the endpoints in a canonical order, and each edge is intersected only once.
+            int intersection(int a, int b) {
+                if (a > b)
+                    std::swap(a, b);
+                const uint64_t key = (static_cast<uint64_t>(a) << 32) | static_cast<uint64_t>(b);
+                for (const auto &e : intersections_) {
+                    if (e.first == key)
+                        return e.second;
+                }
+                const double t = dist_[a] / (dist_[a] - dist_[b]);
+                vertices_.push_back(vertices_[a] + (vertices_[b] - vertices_[a]) * t);
+                const int id = static_cast<int>(vertices_.size()) - 1;
+                intersections_.emplace_back(key, id);
+                return id;
+            }
+
+            // Sorts the (coplanar) vertices counter-clockwise around the normal
+            void sort_around(std::vector<int> &ids, const dvec3 &normal) const {
+                dvec3 center(0, 0, 0);
+                for (auto id : ids)
+                    center += vertices_[id];
+                center /= static_cast<double>(ids.size());
+                const dvec3 u = orthogonal(normal).normalize();
+                const dvec3 w = cross(normal, u);
+                std::vector<std::pair<double, int> > angles;
+                angles.reserve(ids.size());
+                for (auto id : ids) {
+                    const dvec3 d = vertices_[id] - center;
+                    angles.emplace_back(std::atan2(dot(d, w), dot(d, u)), id);
+                }
+                std::sort(angles.begin(), angles.end());
+                for (std::size_t i = 0; i < ids.size(); ++i)
+                    ids[i] = angles[i].second;
+            }
+
+            // Removes the vertices that are not referenced by any face
+            void compact() {
+                remap_.assign(vertices_.size(), -1);
+                compacted_.clear();
+                for (auto &face : faces_) {
+                    for (auto &v : face) {
+                        if (remap_[v] == -1) {
+                            remap_[v] = static_cast<int>(compacted_.size());
+                            compacted_.push_back(vertices_[v]);
+                        }
+                        v = remap_[v];
+                    }
+                }
+                vertices_.swap(compacted_);
+            }
+
+        private:
+            std::vector<dvec3> vertices_;
+            std::vector<std::vector<int> > faces_;
+            std::vector<int> tags_;
+            // buffers reused by clip()
+            std::vector<double> dist_;
+            std::vector<int> side_;
+            std::vector<int> loop_;
+            std::vector<int> cap_;
+            std::vector<int> remap_;
+            std::vector<dvec3> compacted_;
+            std::vector<std::pair<uint64_t, int> > intersections_;
+            // buffers reused by output()
+            std::vector<int> valences_;
+            std::vector<VertexKey> cell_keys_;
+            std::vector<VertexKey> sorted_keys_;
+        };
+
     }
     // \endcond
 
@@ -218,4 +436,118 @@ namespace easy3d {
         cell.end_facet();
     }
 
-}
\ No newline at end of file
+
+
+    void Delaunay3::get_voronoi_cells(
+            const Box3 &box, VoronoiCells3d &cells, const std::vector<unsigned int> *vertices
+    ) const {
+        cells.clear();
+        const unsigned int num = vertices ? static_cast<unsigned int>(vertices->size()) : nb_vertices();
+        if (num == 0 || !box.is_valid())
+            return;
+
+        const double eps = 1e-9 * box.diagonal_length();
+
+        // The cells are computed in parallel in chunks, and the chunks are appended to the result in order. The
+        // number of chunks computed at a time is bounded, so is the memory of the intermediate results.
+        const unsigned int chunk_size = 1024;
+        const int chunks_per_batch = 64;
+        const unsigned int num_chunks = (num + chunk_size - 1) / chunk_size;
+        std::vector<VoronoiCells3d> buffers(chunks_per_batch);
+        std::vector<std::vector<details::VertexKey> > buffer_keys(chunks_per_batch);
+
+        // The vertices shared by several cells are merged while appending the chunks. A vertex is shared by the
+        // cells of the (non-negative) Delaunay vertices in its key, and it is forgotten once all of them are seen.
+        struct SharedVertex {
+            unsigned int index;
+            int remaining;  // the number of cells that have not yet used this vertex
+        };
+        std::unordered_map<details::VertexKey, SharedVertex, details::VertexKeyHash> shared;
+        std::vector<unsigned int> remap;
+
+        for (unsigned int batch = 0; batch < num_chunks; batch += chunks_per_batch) {
+            const int count = static_cast<int>(std::min<unsigned int>(chunks_per_batch, num_chunks - batch));
+#pragma omp parallel for schedule(dynamic)
+            for (int c = 0; c < count; ++c) {
+                VoronoiCells3d &buffer = buffers[c];
+                std::vector<details::VertexKey> &keys = buffer_keys[c];
+                buffer.clear();
+                keys.clear();
+                details::ConvexCell cell;
+                std::vector<unsigned int> neighbors;
+                std::vector<std::pair<double, unsigned int> > sorted;
+                const unsigned int begin = (batch + c) * chunk_size;
+                const unsigned int end = std::min(num, begin + chunk_size);
+                for (unsigned int i = begin; i < end; ++i) {
+                    const unsigned int v = vertices ? (*vertices)[i] : i;
+                    buffer.sites_.push_back(v);
+                    if (v < nb_vertices() && v_to_cell_[v] != -1) {
+                        const dvec3 site(vertex(v).data());
+                        // clipping by the nearest neighbors first cuts the cell down quickly
+                        get_neighbors_internal(v, neighbors);
+                        sorted.clear();
+                        for (auto w : neighbors)
+                            sorted.emplace_back(distance2(dvec3(vertex(w).data()), site), w);
+                        std::sort(sorted.begin(), sorted.end());
+
+                        cell.init(box);
+                        for (const auto &n : sorted) {
+                            const dvec3 q(vertex(n.second).data());
+                            const dvec3 normal = q - site;
+                            const double length = normal.norm();
+                            if (length <= 0)  // duplicate vertex
+                                continue;
+                            cell.clip((site + q) * 0.5, normal / length, static_cast<int>(n.second), eps);
+                            if (cell.empty())
+                                break;
+                        }
+                        if (!cell.empty())
+                            cell.output(static_cast<int>(v), buffer.vertices_, keys, buffer.face_ptr_,
+                                        buffer.face_vertices_, buffer.face_bisector_);
+                    }
+                    buffer.cell_ptr_.push_back(static_cast<unsigned int>(buffer.face_bisector_.size()));
+                }
+            }
+
+            // append the chunks in order
+            for (int c = 0; c < count; ++c) {
+                const VoronoiCells3d &buffer = buffers[c];
+                const std::vector<details::VertexKey> &keys = buffer_keys[c];
+                remap.resize(buffer.vertices_.size());
+                for (std::size_t i = 0; i < buffer.vertices_.size(); ++i) {
+                    const details::VertexKey &key = keys[i];
+                    if (key != details::no_key) {
+                        auto pos = shared.find(key);
+                        if (pos != shared.end()) {
+                            remap[i] = pos->second.index;
+                            if (--pos->second.remaining == 0)
+                                shared.erase(pos);
+                            continue;
+                        }
+                    }
+                    remap[i] = static_cast<unsigned int>(cells.vertices_.size());
+                    cells.vertices_.push_back(buffer.vertices_[i]);
+                    if (key != details::no_key) {
+                        const int num_cells = static_cast<int>(
+                                std::count_if(key.begin(), key.end(), [](int k) { return k >= 0; }));
+                        if (num_cells > 1)
+                            shared.emplace(key, SharedVertex{remap[i], num_cells - 1});
+                    }
+                }
+
+                const unsigned int face_offset = static_cast<unsigned int>(cells.face_bisector_.size());
+                const unsigned int index_offset = static_cast<unsigned int>(cells.face_vertices_.size());
+                cells.sites_.insert(cells.sites_.end(), buffer.sites_.begin(), buffer.sites_.end());
+                for (std::size_t i = 1; i < buffer.cell_ptr_.size(); ++i)
+                    cells.cell_ptr_.push_back(face_offset + buffer.cell_ptr_[i]);
+                for (std::size_t i = 1; i < buffer.face_ptr_.size(); ++i)
+                    cells.face_ptr_.push_back(index_offset + buffer.face_ptr_[i]);
+                for (auto id : buffer.face_vertices_)
+                    cells.face_vertices_.push_back(remap[id]);
+                cells.face_bisector_.insert(cells.face_bisector_.end(), buffer.face_bisector_.begin(),
+                                            buffer.face_bisector_.end());
+            }
+        }
+    }
+
+}
@@ -23,6 +23,7 @@ class tetgenio;
 namespace easy3d {
 
     class VoronoiCell3d;
+    class VoronoiCells3d;
 
     /// \brief 3D Delaunay triangulation, using Hang Si's tetgen.
     /// \class Delaunay3 easy3d/algo/delaunay_3d.h
@@ -64,6 +65,36 @@ namespace easy3d {
             return nearest_vertex(p.data());
         }
 
+        /// \brief Inserts vertices into the triangulation incrementally. \see Delaunay::insert_vertices().
+        void insert_vertices(const std::vector<vec3> &vertices) {
+            if (!vertices.empty())
+                Delaunay::insert_vertices((unsigned int) vertices.size(), vertices[0].data());
+        }
+
+        using Delaunay::insert_vertices;
+        using Delaunay::locate;
+        using Delaunay::nearest_vertices;
+
+        /// \brief Returns the index of the vertex nearest to \p p, starting the search from the cell \p hint.
+        unsigned int nearest_vertex(const vec3 &p, int hint) const {
+            return Delaunay::nearest_vertex(p.data(), hint);
+        }
+
+        /// \brief Returns the index of the tetrahedron containing \p p, or -1 if \p p is outside the convex hull.
+        int locate(const vec3 &p, int hint = -1) const {
+            return Delaunay::locate(p.data(), hint);
+        }
+
+        /// \brief Returns the indices of the vertices nearest to each of the query points (computed in parallel).
+        void nearest_vertices(const std::vector<vec3> &points, std::vector<unsigned int> &result) const {
+            Delaunay::nearest_vertices((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
+        }
+
+        /// \brief Returns the indices of the tetrahedra containing each of the query points (computed in parallel).
+        void locate(const std::vector<vec3> &points, std::vector<int> &result) const {
+            Delaunay::locate((unsigned int) points.size(), points.empty() ? nullptr : points[0].data(), result);
+        }
+
         const vec3 &vertex(unsigned int i) const {
             return *(const vec3 *) vertex_ptr(i);
         }
@@ -119,6 +150,19 @@ namespace easy3d {
                 unsigned int v, VoronoiCell3d &cell, bool geometry = true
         ) const;
 
+        /**
+         * \brief Computes the Voronoi cells of all vertices (or of the given subset of vertices) in parallel.
+         * \details Each cell is obtained by clipping \p box by the bisector planes between its vertex and the
+         *      Delaunay neighbors of the vertex. So the cells are bounded (cells at the convex hull are cut by the box)
+         *      and the cells of vertices far outside the box may be empty.
+         * \param box The bounding box to clip the cells against.
+         * \param cells Returns the clipped cells, in the order of \p vertices (or of the vertex indices).
+         * \param vertices The indices of the vertices whose cells are computed. If null, all cells are computed.
+         */
+        void get_voronoi_cells(
+                const Box3 &box, VoronoiCells3d &cells, const std::vector<unsigned int> *vertices = nullptr
+        ) const;
+
     protected:
         void get_voronoi_facet(
                 VoronoiCell3d &cell, unsigned int t,
@@ -144,6 +188,9 @@ namespace easy3d {
             return 4;
         }
 
+    protected:
+        virtual void release_cells();
+
     protected:
         static unsigned int next_around_halfedge_[4][4];
         static unsigned int facet_vertex_[4][3];
@@ -297,6 +344,75 @@ namespace easy3d {
         std::vector<bool> infinite_;
     };
 
+    //________________________________________________________________________________
+
+    /**
+     * \brief A compact representation of a set of (clipped) 3D Voronoi cells.
+     * \class VoronoiCells3d easy3d/algo/delaunay_3d.h
+     * \details The cells are convex polyhedra stored in Compressed Row Storage arrays: cell \c c consists of the
+     *      faces in the range [cell_begin(c), cell_end(c)), and face \c f of the vertex indices in the range
+     *      [face_begin(f), face_end(f)). The faces are oriented outward (counter-clockwise seen from outside). The
+     *      vertices are shared by the faces of a cell and by the neighboring cells, except for vertices in degenerate
+     *      configurations (i.e., where more than three planes meet), which may be duplicated.
+     */
+    class VoronoiCells3d {
+    public:
+        VoronoiCells3d() { clear(); }
+
+        void clear() {
+            vertices_.clear();
+            sites_.clear();
+            cell_ptr_.assign(1, 0);
+            face_ptr_.assign(1, 0);
+            face_vertices_.clear();
+            face_bisector_.clear();
+        }
+
+        /// \brief Returns the number of cells.
+        unsigned int nb_cells() const { return (unsigned int) sites_.size(); }
+
+        /// \brief Returns the Delaunay vertex (i.e., the Voronoi site) of cell \p c.
+        unsigned int site(unsigned int c) const { return sites_[c]; }
+
+        unsigned int cell_begin(unsigned int c) const { return cell_ptr_[c]; }
+
+        unsigned int cell_end(unsigned int c) const { return cell_ptr_[c + 1]; }
+
+        /// \brief Returns the total number of faces.
+        unsigned int nb_faces() const { return (unsigned int) face_bisector_.size(); }
+
+        unsigned int face_begin(unsigned int f) const { return face_ptr_[f]; }
+
+        unsigned int face_end(unsigned int f) const { return face_ptr_[f + 1]; }
+
+        /// \brief Returns the index (into vertices()) of the \p i_th entry of the face vertex array.
+        unsigned int face_vertex(unsigned int i) const { return face_vertices_[i]; }
+
+        /**
+         * \brief Returns the Delaunay vertex on the other side of face \p f, i.e., the face lies on the bisector
+         *      plane between site(c) and face_bisector(f). It is -1 for faces on the clipping box.
+         */
+        int face_bisector(unsigned int f) const { return face_bisector_[f]; }
+
+        /// \brief Returns all the vertices.
+        const std::vector<vec3> &vertices() const { return vertices_; }
+
+        const vec3 &vertex(unsigned int i) const { return vertices_[i]; }
+
+        /// \brief Returns true if the cell \p c is empty (e.g., its site is outside the clipping box).
+        bool is_empty(unsigned int c) const { return cell_begin(c) == cell_end(c); }
+
+    private:
+        friend class Delaunay3;
+
+        std::vector<vec3> vertices_;
+        std::vector<unsigned int> sites_;
+        std::vector<unsigned int> cell_ptr_;
+        std::vector<unsigned int> face_ptr_;
+        std::vector<unsigned int> face_vertices_;
+        std::vector<int> face_bisector_;
+    };
+
 /*
  * The commented one is enough for basic 3D Delaunay implementation.
  * The above one is verbose for easy understanding of the interface 
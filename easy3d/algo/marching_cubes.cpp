@@ -0,0 +1,408 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/marching_cubes.h>
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/surface_mesh_builder.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        // The blocks have block_size^3 cells, and thus (block_size + 1)^3 grid points.
+        const int block_size = SparseGrid<float>::block_size;
+        const int block_points = block_size + 1;
+        const int block_volume = block_points * block_points * block_points;
+
+        // The corners of a cube are indexed by x + 2 * y + 4 * z, and the edges by axis * 4 + a + 2 * b, where a
+        // and b are the coordinates of the edge along the other two axes (in the order of x, y, z).
+        int cube_edge(int c0, int c1) {
+            const int axis = (c0 ^ c1) == 1 ? 0 : ((c0 ^ c1) == 2 ? 1 : 2);
+            const int base = c0 & c1;
+            const int a = (base >> (axis == 0 ? 1 : 0)) & 1;
+            const int b = (base >> (axis == 2 ? 1 : 2)) & 1;
+            return axis * 4 + a + 2 * b;
+        }
+
+        // The lower end point (offsets of the three coordinates) and the axis of a cube edge.
+        void cube_edge_geometry(int e, int offset[3], int &axis) {
+            axis = e / 4;
+            const int u = (axis == 0 ? 1 : 0), v = (axis == 2 ? 1 : 2);
+            offset[axis] = 0;
+            offset[u] = e & 1;
+            offset[v] = (e >> 1) & 1;
+        }
+
+        // Do two cube edges lie on a common face of the cube?
+        bool share_face(int e0, int e1) {
+            int offset0[3], offset1[3], axis0, axis1;
+            cube_edge_geometry(e0, offset0, axis0);
+            cube_edge_geometry(e1, offset1, axis1);
+            for (int d = 0; d < 3; ++d) {
+                if (d != axis0 && d != axis1 && offset0[d] == offset1[d])
+                    return true;
+            }
+            return false;
+        }
+
+        // The triangles (as cube edges) of the 256 configurations of a cube. The table is generated from the
+        // contours on the six faces of the cube: walking around each face counterclockwise (viewed from the outside
+        // of the cube), a contour segment goes from each edge entering the inside corners to the next edge leaving
+        // them. On an ambiguous face, this separates the inside corners, consistently for the two cubes sharing the
+        // face. The segments of all faces are chained into loops that are triangulated as fans, oriented toward the
+        // outside. The apex of a fan is chosen such that no diagonal connects two points on the same face of the
+        // cube (otherwise, the two cubes sharing that face may create the same diagonal, i.e., a non-manifold edge).
+        struct CaseTable {
+            int num_triangles[256];
+            int triangles[256][15];
+        };
+
+        CaseTable make_case_table() {
+            CaseTable table;
+            for (int config = 0; config < 256; ++config) {
+                int next[12];
+                std::fill(next, next + 12, -1);
+                for (int d = 0; d < 3; ++d) {
+                    const int u = (d + 1) % 3, v = (d + 2) % 3;
+                    for (int s = 0; s < 2; ++s) {
+                        // the corners of the face in counterclockwise order about its outward normal
+                        static const int uv[2][4][2] = {{{0, 0}, {0, 1}, {1, 1}, {1, 0}},
+                                                        {{0, 0}, {1, 0}, {1, 1}, {0, 1}}};
+                        int corners[4];
+                        for (int k = 0; k < 4; ++k)
+                            corners[k] = (s << d) | (uv[s][k][0] << u) | (uv[s][k][1] << v);
+
+                        int crossings[4], entering[4], num = 0;
+                        for (int k = 0; k < 4; ++k) {
+                            const int a = corners[k], b = corners[(k + 1) % 4];
+                            const bool in_a = (config >> a) & 1, in_b = (config >> b) & 1;
+                            if (in_a != in_b) {
+                                crossings[num] = cube_edge(a, b);
+                                entering[num++] = in_b;
+                            }
+                        }
+                        for (int k = 0; k < num; ++k) {
+                            if (entering[k])
+                                next[crossings[k]] = crossings[(k + 1) % num];
+                        }
+                    }
+                }
+
+                int count = 0;
+                bool visited[12] = {false};
+                for (int e = 0; e < 12; ++e) {
+                    if (next[e] < 0 || visited[e])
+                        continue;
+                    int loop[12], size = 0;
+                    for (int x = e; !visited[x]; x = next[x]) {
+                        visited[x] = true;
+                        loop[size++] = x;
+                    }
+                    int apex = 0;
+                    for (; apex < size; ++apex) {
+                        bool valid = true;
+                        for (int k = 2; k + 1 < size && valid; ++k)
+                            valid = !share_face(loop[apex], loop[(apex + k) % size]);
+                        if (valid)
+                            break;
+                    }
+                    for (int k = 1; k + 1 < size; ++k) {
+                        table.triangles[config][3 * count] = loop[apex % size];
+                        table.triangles[config][3 * count + 1] = loop[(apex + k) % size];
+                        table.triangles[config][3 * count + 2] = loop[(apex + k + 1) % size];
+                        ++count;
+                    }
+                }
+                table.num_triangles[config] = count;
+            }
+            return table;
+        }
+
+        const CaseTable &case_table() {
+            static const CaseTable table = make_case_table();
+            return table;
+        }
+
+
+        // A dense grid, split into blocks of block_size^3 cells. The blocks cover all the grid points (the last
+        // block along an axis may only own the grid points on the boundary), so each grid edge has an owner.
+        class DenseSource {
+        public:
+            DenseSource(const std::vector<float> &values, int nx, int ny, int nz) : values_(values) {
+                size_[0] = nx;
+                size_[1] = ny;
+                size_[2] = nz;
+                for (int a = 0; a < 3; ++a)
+                    blocks_[a] = size_[a] > 0 ? (size_[a] - 1) / block_size + 1 : 0;
+            }
+
+            int num_blocks() const { return blocks_[0] * blocks_[1] * blocks_[2]; }
+
+            void coordinates(int b, int coord[3]) const {
+                coord[0] = b % blocks_[0];
+                coord[1] = (b / blocks_[0]) % blocks_[1];
+                coord[2] = b / (blocks_[0] * blocks_[1]);
+            }
+
+            int find_block(int bx, int by, int bz) const {
+                if (bx >= blocks_[0] || by >= blocks_[1] || bz >= blocks_[2])
+                    return -1;
+                return bx + blocks_[0] * (by + blocks_[1] * bz);
+            }
+
+            // Loads the values of the grid points of a block (and those shared with the next blocks).
+            void load(int b, float *values, bool *valid) const {
+                int coord[3];
+                coordinates(b, coord);
+                for (int lk = 0; lk < block_points; ++lk) {
+                    const int k = coord[2] * block_size + lk;
+                    for (int lj = 0; lj < block_points; ++lj) {
+                        const int j = coord[1] * block_size + lj;
+                        const std::size_t row = static_cast<std::size_t>(size_[0]) * (j + static_cast<std::size_t>(size_[1]) * k);
+                        for (int li = 0; li < block_points; ++li) {
+                            const int i = coord[0] * block_size + li;
+                            const int idx = li + block_points * (lj + block_points * lk);
+                            valid[idx] = i < size_[0] && j < size_[1] && k < size_[2];
+                            if (valid[idx])
+                                values[idx] = values_[row + i];
+                        }
+                    }
+                }
+            }
+
+        private:
+            const std::vector<float> &values_;
+            int size_[3];
+            int blocks_[3];
+        };
+
+
+        // A sparse grid. The cells are grouped into blocks the same way as the grid points.
+        class SparseSource {
+        public:
+            explicit SparseSource(const SparseGrid<float> &grid) : grid_(grid) {}
+
+            int num_blocks() const { return static_cast<int>(grid_.num_blocks()); }
+
+            void coordinates(int b, int coord[3]) const {
+                const auto &block = grid_.block(b);
+                coord[0] = block.x;
+                coord[1] = block.y;
+                coord[2] = block.z;
+            }
+
+            int find_block(int bx, int by, int bz) const { return grid_.find_block(bx, by, bz); }
+
+            // Loads the values of the grid points of a block (and those shared with the next blocks).
+            void load(int b, float *values, bool *valid) const {
+                int coord[3];
+                coordinates(b, coord);
+                const SparseGrid<float>::Block *neighbors[8];
+                for (int n = 0; n < 8; ++n) {
+                    const int idx = find_block(coord[0] + (n & 1), coord[1] + ((n >> 1) & 1), coord[2] + (n >> 2));
+                    neighbors[n] = idx >= 0 ? &grid_.block(idx) : nullptr;
+                }
+                for (int lk = 0; lk < block_points; ++lk) {
+                    for (int lj = 0; lj < block_points; ++lj) {
+                        for (int li = 0; li < block_points; ++li) {
+                            const int idx = li + block_points * (lj + block_points * lk);
+                            const int n = (li / block_size) | ((lj / block_size) << 1) | ((lk / block_size) << 2);
+                            valid[idx] = neighbors[n] != nullptr;
+                            if (valid[idx]) {
+                                values[idx] = neighbors[n]->values[li % block_size +
+                                              block_size * (lj % block_size + block_size * (lk % block_size))];
+                            }
+                        }
+                    }
+                }
+            }
+
+        private:
+            const SparseGrid<float> &grid_;
+        };
+
+
+        template<typename Source>
+        SurfaceMesh *extract(const Source &source, const vec3 &origin, float voxel_size, float isovalue) {
+            const CaseTable &table = case_table();
+            const int num_blocks = source.num_blocks();
+            const int steps[3] = {1, block_points, block_points * block_points};
+
+            // the intersection points on the edges owned by each block, sorted by the (local) indices of the edges
+            std::vector<std::vector<uint16_t> > block_edges(num_blocks);
+            std::vector<std::vector<vec3> > block_positions(num_blocks);
+            std::vector<char> active(num_blocks, 0);
+#pragma omp parallel for schedule(dynamic, 16)
+            for (int b = 0; b < num_blocks; ++b) {
+                float values[block_volume];
+                bool valid[block_volume];
+                source.load(b, values, valid);
+                bool has_inside = false, has_outside = false;
+                for (int idx = 0; idx < block_volume; ++idx) {
+                    if (valid[idx]) {
+                        if (values[idx] < isovalue)
+                            has_inside = true;
+                        else
+                            has_outside = true;
+                    }
+                }
+                if (!has_inside || !has_outside)
+                    continue;
+                active[b] = 1;
+
+                int coord[3];
+                source.coordinates(b, coord);
+                int local[3];
+                for (local[2] = 0; local[2] < block_size; ++local[2]) {
+                    for (local[1] = 0; local[1] < block_size; ++local[1]) {
+                        for (local[0] = 0; local[0] < block_size; ++local[0]) {
+                            const int idx = local[0] + block_points * (local[1] + block_points * local[2]);
+                            if (!valid[idx])
+                                continue;
+                            const float v0 = values[idx];
+                            for (int axis = 0; axis < 3; ++axis) {
+                                const int other = idx + steps[axis];
+                                if (!valid[other] || (v0 < isovalue) == (values[other] < isovalue))
+                                    continue;
+                                vec3 p(static_cast<float>(coord[0] * block_size + local[0]),
+                                       static_cast<float>(coord[1] * block_size + local[1]),
+                                       static_cast<float>(coord[2] * block_size + local[2]));
+                                p[axis] += (isovalue - v0) / (values[other] - v0);
+                                block_edges[b].push_back(static_cast<uint16_t>(
+                                        axis + 3 * (local[0] + block_size * (local[1] + block_size * local[2]))));
+                                block_positions[b].push_back(origin + p * voxel_size);
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::vector<int> vertex_offsets(num_blocks + 1, 0);
+            for (int b = 0; b < num_blocks; ++b)
+                vertex_offsets[b + 1] = vertex_offsets[b] + static_cast<int>(block_edges[b].size());
+
+            // the triangles of the cells of each block
+            std::vector<std::vector<int> > block_triangles(num_blocks);
+#pragma omp parallel for schedule(dynamic, 16)
+            for (int b = 0; b < num_blocks; ++b) {
+                if (!active[b])
+                    continue;
+                float values[block_volume];
+                bool valid[block_volume];
+                source.load(b, values, valid);
+                int coord[3];
+                source.coordinates(b, coord);
+                int neighbors[8];
+                for (int n = 0; n < 8; ++n)
+                    neighbors[n] = source.find_block(coord[0] + (n & 1), coord[1] + ((n >> 1) & 1), coord[2] + (n >> 2));
+
+                auto &triangles = block_triangles[b];
+                for (int lk = 0; lk < block_size; ++lk) {
+                    for (int lj = 0; lj < block_size; ++lj) {
+                        for (int li = 0; li < block_size; ++li) {
+                            int config = 0;
+                            bool complete = true;
+                            for (int c = 0; c < 8 && complete; ++c) {
+                                const int idx = (li + (c & 1)) + block_points * ((lj + ((c >> 1) & 1)) + block_points * (lk + (c >> 2)));
+                                complete = valid[idx];
+                                if (complete && values[idx] < isovalue)
+                                    config |= (1 << c);
+                            }
+                            if (!complete || table.num_triangles[config] == 0)
+                                continue;
+
+                            int vertices[12];
+                            std::fill(vertices, vertices + 12, -1);
+                            const int *edges = table.triangles[config];
+                            for (int t = 0; t < 3 * table.num_triangles[config]; ++t) {
+                                const int e = edges[t];
+                                if (vertices[e] >= 0)
+                                    continue;
+                                int offset[3], axis;
+                                cube_edge_geometry(e, offset, axis);
+                                const int pi = li + offset[0], pj = lj + offset[1], pk = lk + offset[2];
+                                // the block owning the edge, and the index of the edge in that block
+                                const int owner = neighbors[(pi / block_size) | ((pj / block_size) << 1) | ((pk / block_size) << 2)];
+                                const uint16_t id = static_cast<uint16_t>(axis + 3 * (pi % block_size +
+                                                    block_size * (pj % block_size + block_size * (pk % block_size))));
+                                const auto &owned = block_edges[owner];
+                                const auto pos = std::lower_bound(owned.begin(), owned.end(), id);
+                                vertices[e] = vertex_offsets[owner] + static_cast<int>(pos - owned.begin());
+                            }
+                            for (int t = 0; t < 3 * table.num_triangles[config]; ++t)
+                                triangles.push_back(vertices[edges[t]]);
+                        }
+                    }
+                }
+            }
+
+            std::vector<vec3> points;
+            points.reserve(vertex_offsets[num_blocks]);
+            for (auto &bp : block_positions) {
+                points.insert(points.end(), bp.begin(), bp.end());
+                std::vector<vec3>().swap(bp);
+            }
+            std::vector<int> indices;
+            for (auto &bt : block_triangles) {
+                indices.insert(indices.end(), bt.begin(), bt.end());
+                std::vector<int>().swap(bt);
+            }
+            std::vector<int> offsets(indices.size() / 3 + 1);
+            for (std::size_t i = 0; i < offsets.size(); ++i)
+                offsets[i] = static_cast<int>(3 * i);
+
+            SurfaceMesh *mesh = new SurfaceMesh;
+            SurfaceMeshBuilder builder(mesh);
+            builder.build(points, indices, offsets);
+            return mesh;
+        }
+
+    }
+
+
+    SurfaceMesh *MarchingCubes::apply(const std::vector<float> &values, int nx, int ny, int nz,
+                                      const vec3 &origin, float voxel_size, float isovalue) {
+        if (nx < 0 || ny < 0 || nz < 0 ||
+            values.size() != static_cast<std::size_t>(nx) * static_cast<std::size_t>(ny) * static_cast<std::size_t>(nz)) {
+            LOG(WARNING) << "the number of values (" << values.size() << ") doesn't match the grid size ("
+                         << nx << " x " << ny << " x " << nz << ")";
+            return nullptr;
+        }
+        return details::extract(details::DenseSource(values, nx, ny, nz), origin, voxel_size, isovalue);
+    }
+
+
+    SurfaceMesh *MarchingCubes::apply(const SparseGrid<float> &grid, float isovalue) {
+        return details::extract(details::SparseSource(grid), grid.origin(), grid.voxel_size(), isovalue);
+    }
+
+}
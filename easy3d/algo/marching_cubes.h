@@ -0,0 +1,88 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_MARCHING_CUBES_H
+#define EASY3D_ALGO_MARCHING_CUBES_H
+
+
+#include <vector>
+
+#include <easy3d/core/sparse_grid.h>
+
+
+namespace easy3d {
+
+    class SurfaceMesh;
+
+    /**
+     * \brief Extracts iso-surfaces from scalar grids (dense or sparse) using the marching cubes algorithm.
+     * \class MarchingCubes easy3d/algo/marching_cubes.h
+     * \details The grid is processed in blocks of SparseGrid::block_size^3 cells in parallel. Each intersection
+     *      point is created once by the block owning its grid edge (i.e., the block containing the lower end point of
+     *      the edge), and the triangles of the neighboring cells find it by the index of the edge within that block.
+     *      So the resulted mesh has no duplicated vertices. The ambiguous faces of the cubes are always resolved by
+     *      separating the grid points below the iso-value, which makes the results closed 2-manifolds (except at the
+     *      boundary of the grid).
+     *      The grid points with values below the iso-value are considered inside, and the faces of the resulted mesh
+     *      are oriented toward the outside. So the iso-surface of a signed distance field (negative inside) has the
+     *      same orientation as the original surface.
+     *
+     * Example usage:
+     *  \code
+     *      const SparseGrid<float> sdf = SurfaceMeshSDF::signed_distance(mesh, voxel_size, 3 * voxel_size);
+     *      SurfaceMesh* result = MarchingCubes::apply(sdf);
+     *  \endcode
+     * \see SparseGrid, SurfaceMeshSDF
+     */
+    class MarchingCubes {
+    public:
+        /**
+         * \brief Extracts the iso-surface of a dense grid.
+         * @param values The values of the nx * ny * nz grid points. The value of grid point (i, j, k) is
+         *      values[i + nx * (j + ny * k)].
+         * @param nx, ny, nz The number of grid points along the x, y, and z axes.
+         * @param origin The position of grid point (0, 0, 0).
+         * @param voxel_size The distance between two adjacent grid points.
+         * @param isovalue The iso-value.
+         * @return The iso-surface (can be empty). nullptr if the size of \p values doesn't match the grid size.
+         */
+        static SurfaceMesh *apply(const std::vector<float> &values, int nx, int ny, int nz,
+                                  const vec3 &origin, float voxel_size, float isovalue = 0.0f);
+
+        /**
+         * \brief Extracts the iso-surface of a sparse grid.
+         * @param grid The sparse grid.
+         * @param isovalue The iso-value.
+         * @return The iso-surface (can be empty).
+         * @details Only the cells whose corners are all stored are processed, i.e., the background value is never
+         *      used. For narrow-band signed distance fields, the band must be wider than the diagonal of a voxel.
+         */
+        static SurfaceMesh *apply(const SparseGrid<float> &grid, float isovalue = 0.0f);
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_ALGO_MARCHING_CUBES_H
@@ -28,6 +28,8 @@
 
 #include <set>
 #include <cassert>
+#include <limits>
+#include <algorithm>
 
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/util/logging.h>
@@ -84,50 +86,193 @@ namespace easy3d {
     //  \cond
     namespace details {
 
-        /// Utility class for grid simplification of point set.
-        /// LessEpsilonPoints defines a 3D points order: two points are equal
-        /// iff they belong to the same cell of a grid of cell size = epsilon.
-        template<class Point>
-        class LessEpsilonPoints {
-        public:
-            LessEpsilonPoints(float epsilon) : m_epsilon(epsilon) {
-                assert(epsilon > 0);
+        /// Utility for grid simplification of point set: groups the points into the cells of a regular grid of cell
+        /// size = epsilon (a point belongs to the cell floor(p / epsilon)).
+        /// To bound the memory, the points are grouped into slabs (along the X axis, never splitting a cell) of at
+        /// most 'max_slab_size' points (unless a single column of cells is larger), and consecutive slabs into
+        /// windows of at most 'max_window_size' points. Only the points of one window are stored at a time: they are
+        /// collected by scanning the point cloud (twice, counting and then writing), and then the slabs of the window
+        /// are sorted by cells and processed in parallel. For each non-empty cell, 'func(indices, count)' is called
+        /// with the indices of its points in increasing order. \c func must be thread-safe for distinct cells. The
+        /// bin of each point is computed once, so \c func may move the points of its cell (e.g., to their centroid).
+        template<typename Func>
+        bool for_each_grid_cell(const PointCloud *cloud, float epsilon, Func func,
+                                std::size_t max_slab_size = (std::size_t(1) << 20),
+                                std::size_t max_window_size = (std::size_t(1) << 25)) {
+            const auto &points = cloud->points();
+            if (points.size() >= static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+                LOG(ERROR) << "too many points (" << points.size() << ") for grid simplification";
+                return false;
+            }
+
+            // the cell coordinates (relative to the cell of the bounding box's min corner)
+            const Box3 &box = cloud->bounding_box();
+            const int64_t offset[3] = {
+                    static_cast<int64_t>(std::floor(box.min_coord(0) / epsilon)),
+                    static_cast<int64_t>(std::floor(box.min_coord(1) / epsilon)),
+                    static_cast<int64_t>(std::floor(box.min_coord(2) / epsilon))
+            };
+            int64_t dims[3];
+            for (int i = 0; i < 3; ++i) {
+                dims[i] = static_cast<int64_t>(std::floor(box.max_coord(i) / epsilon)) - offset[i] + 1;
+                if (dims[i] >= std::numeric_limits<int32_t>::max()) {
+                    LOG(ERROR) << "cell size (" << epsilon << ") too small w.r.t. the extent of the point cloud";
+                    return false;
+                }
             }
+            auto cell_coord = [&](const vec3 &p, int axis) -> int32_t {
+                const int64_t c = static_cast<int64_t>(std::floor(p[axis] / epsilon)) - offset[axis];
+                return static_cast<int32_t>(std::min<int64_t>(dims[axis] - 1, std::max<int64_t>(0, c)));
+            };
+
+            // step 1: histogram of the points over the bins along the X axis (a bin contains whole cells). The bins
+            // (at most 2^16, so 16 bits each) are kept to assign the points to the slabs later.
+            const int64_t num_bins = std::min<int64_t>(dims[0], 1 << 16);
+            const int num_points = static_cast<int>(points.size());
+            std::vector<uint16_t> bins(num_points);
+            std::vector<std::size_t> bin_sizes(num_bins, 0);
+#pragma omp parallel
+            {
+                std::vector<std::size_t> local_sizes(num_bins, 0);
+#pragma omp for
+                for (int i = 0; i < num_points; ++i) {
+                    bins[i] = static_cast<uint16_t>(cell_coord(points[i], 0) * num_bins / dims[0]);
+                    if (!cloud->is_deleted(PointCloud::Vertex(i)))
+                        ++local_sizes[bins[i]];
+                }
+#pragma omp critical
+                for (int64_t b = 0; b < num_bins; ++b)
+                    bin_sizes[b] += local_sizes[b];
+            }
+
+            // step 2: group consecutive bins into slabs
+            std::vector<int> slab_of_bin(num_bins, 0);
+            std::vector<std::size_t> slab_starts(1, 0);
+            std::size_t slab_size = 0;
+            for (int64_t b = 0; b < num_bins; ++b) {
+                if (slab_size > 0 && slab_size + bin_sizes[b] > max_slab_size) {
+                    slab_starts.push_back(slab_starts.back() + slab_size);
+                    slab_size = 0;
+                }
+                slab_of_bin[b] = static_cast<int>(slab_starts.size() - 1);
+                slab_size += bin_sizes[b];
+            }
+            slab_starts.push_back(slab_starts.back() + slab_size);
+            const int num_slabs = static_cast<int>(slab_starts.size() - 1);
+
+            // step 3: for each window of slabs, collect its points, sort each slab by cells, and process the cells
+            struct Item {
+                int32_t coord[3];
+                uint32_t index;
+                bool operator<(const Item &other) const {
+                    if (coord[0] != other.coord[0]) return coord[0] < other.coord[0];
+                    if (coord[1] != other.coord[1]) return coord[1] < other.coord[1];
+                    if (coord[2] != other.coord[2]) return coord[2] < other.coord[2];
+                    return index < other.index;
+                }
+                bool same_cell(const Item &other) const {
+                    return coord[0] == other.coord[0] && coord[1] == other.coord[1] && coord[2] == other.coord[2];
+                }
+            };
+
+            // the points are scanned in chunks, which fill their (precomputed) ranges of each slab in order, so the
+            // result does not depend on the number of threads
+            const int chunk_size = 1 << 16;
+            const int num_chunks = std::max(1, (num_points + chunk_size - 1) / chunk_size);
+            std::vector<Item> items;
+            std::vector<std::size_t> positions;
+            for (int first_slab = 0; first_slab < num_slabs;) {
+                int end_slab = first_slab + 1;
+                while (end_slab < num_slabs && slab_starts[end_slab + 1] - slab_starts[first_slab] <= max_window_size)
+                    ++end_slab;
+                const int window_slabs = end_slab - first_slab;
+                const std::size_t window_start = slab_starts[first_slab];
+                items.resize(slab_starts[end_slab] - window_start);
+
+                // counts the points of each chunk in each slab of the window, and then turns them into positions
+                positions.assign(static_cast<std::size_t>(num_chunks) * window_slabs, 0);
+#pragma omp parallel for
+                for (int c = 0; c < num_chunks; ++c) {
+                    const int end = std::min(num_points, (c + 1) * chunk_size);
+                    for (int i = c * chunk_size; i < end; ++i) {
+                        if (cloud->is_deleted(PointCloud::Vertex(i)))
+                            continue;
+                        const int s = slab_of_bin[bins[i]];
+                        if (s >= first_slab && s < end_slab)
+                            ++positions[static_cast<std::size_t>(c) * window_slabs + (s - first_slab)];
+                    }
+                }
+                for (int s = 0; s < window_slabs; ++s) {
+                    std::size_t pos = slab_starts[first_slab + s] - window_start;
+                    for (int c = 0; c < num_chunks; ++c) {
+                        std::size_t &p = positions[static_cast<std::size_t>(c) * window_slabs + s];
+                        const std::size_t count = p;
+                        p = pos;
+                        pos += count;
+                    }
+                }
+#pragma omp parallel for
+                for (int c = 0; c < num_chunks; ++c) {
+                    const int end = std::min(num_points, (c + 1) * chunk_size);
+                    for (int i = c * chunk_size; i < end; ++i) {
+                        if (cloud->is_deleted(PointCloud::Vertex(i)))
+                            continue;
+                        const int s = slab_of_bin[bins[i]];
+                        if (s < first_slab || s >= end_slab)
+                            continue;
+                        const vec3 &p = points[i];
+                        Item &item = items[positions[static_cast<std::size_t>(c) * window_slabs + (s - first_slab)]++];
+                        item.coord[0] = cell_coord(p, 0);
+                        item.coord[1] = cell_coord(p, 1);
+                        item.coord[2] = cell_coord(p, 2);
+                        item.index = static_cast<uint32_t>(i);
+                    }
+                }
 
-            // Round points to multiples of m_epsilon, then compare.
-            bool operator()(const Point &a, const Point &b) const {
-                const vec3 *a_n = (a.pos);
-                const vec3 *b_n = (b.pos);
-
-                vec3 rounded_a(round_epsilon(a_n->x, m_epsilon), round_epsilon(a_n->y, m_epsilon),
-                               round_epsilon(a_n->z, m_epsilon));
-                vec3 rounded_b(round_epsilon(b_n->x, m_epsilon), round_epsilon(b_n->y, m_epsilon),
-                               round_epsilon(b_n->z, m_epsilon));
-
-                //return (rounded_a < rounded_b);
-                if (rounded_a.x < rounded_b.x)
-                    return true;
-                else if (rounded_a.x == rounded_b.x) {
-                    if (rounded_a.y < rounded_b.y)
-                        return true;
-                    else if (rounded_a.y == rounded_b.y) {
-                        if (rounded_a.z < rounded_b.z)
-                            return true;
+#pragma omp parallel
+                {
+                    // per-thread buffer, reused for all the slabs processed by this thread
+                    std::vector<uint32_t> cell;
+#pragma omp for schedule(dynamic)
+                    for (int s = first_slab; s < end_slab; ++s) {
+                        const auto begin = items.begin() + (slab_starts[s] - window_start);
+                        const auto end = items.begin() + (slab_starts[s + 1] - window_start);
+                        std::sort(begin, end);
+                        for (auto it = begin; it != end;) {
+                            cell.clear();
+                            auto next = it;
+                            for (; next != end && next->same_cell(*it); ++next)
+                                cell.push_back(next->index);
+                            func(cell.data(), cell.size());
+                            it = next;
+                        }
                     }
                 }
 
-                return false;
+                first_slab = end_slab;
             }
 
-        private:
-            // Round number to multiples of epsilon
-            static inline float round_epsilon(float value, float epsilon) {
-                return std::floor(value / epsilon) * epsilon;
+            return true;
+        }
+
+
+        /// Averages a vertex property of type T over each cell and stores the average at the representative point.
+        template<typename T>
+        class CellAverage {
+        public:
+            CellAverage(PointCloud::VertexProperty<T> prop) : prop_(prop) {}
+
+            void apply(const uint32_t *indices, std::size_t count, uint32_t representative) {
+                T sum = prop_.vector()[indices[0]];
+                for (std::size_t i = 1; i < count; ++i)
+                    sum += prop_.vector()[indices[i]];
+                prop_.vector()[representative] = sum / static_cast<float>(count);
             }
 
         private:
-            float m_epsilon;
+            PointCloud::VertexProperty<T> prop_;
         };
+
     }
     //  \endcond
 
@@ -135,27 +280,94 @@ namespace easy3d {
     std::vector<PointCloud::Vertex> PointCloudSimplification::grid_simplification(PointCloud *cloud, float epsilon) {
         assert(epsilon > 0);
 
-        struct Point {
-            const vec3 *pos;
-            PointCloud::Vertex vertex;
-        };
-
         // Merges points which belong to the same cell of a grid of cell size = epsilon.
-        // points_to_keep will contain 1 point per cell; the others will be in points_to_remove.
-        std::set<Point, details::LessEpsilonPoints<Point> > points_to_keep(epsilon);
+        // 1 point (the first one) per cell will be kept; the others will be in points_to_remove.
+        std::vector<char> remove(cloud->vertices_size(), 0);
+        details::for_each_grid_cell(cloud, epsilon, [&](const uint32_t *indices, std::size_t count) {
+            for (std::size_t i = 1; i < count; ++i)
+                remove[indices[i]] = 1;
+        });
+
         std::vector<PointCloud::Vertex> points_to_remove;
+        for (std::size_t i = 0; i < remove.size(); ++i) {
+            if (remove[i])
+                points_to_remove.push_back(PointCloud::Vertex(static_cast<int>(i)));
+        }
+
+        return points_to_remove;
+    }
+
+
+    unsigned int PointCloudSimplification::grid_downsampling(PointCloud *cloud, float cell_size,
+                                                             Representative representative,
+                                                             std::size_t max_window_size) {
+        assert(cell_size > 0);
+
+        // the properties to be averaged (for CENTROID)
+        std::vector<details::CellAverage<vec3> > vec3_averages;
+        std::vector<details::CellAverage<float> > float_averages;
+        std::vector<details::CellAverage<double> > double_averages;
+        if (representative == CENTROID) {
+            for (const auto &name : cloud->vertex_properties()) {
+                const auto &type = cloud->get_vertex_property_type(name);
+                if (type == typeid(vec3))
+                    vec3_averages.emplace_back(cloud->get_vertex_property<vec3>(name));
+                else if (type == typeid(float))
+                    float_averages.emplace_back(cloud->get_vertex_property<float>(name));
+                else if (type == typeid(double))
+                    double_averages.emplace_back(cloud->get_vertex_property<double>(name));
+            }
+        }
 
         const auto &points = cloud->points();
-        for (auto v : cloud->vertices()) {
-            Point p;
-            p.pos = &(points[v.idx()]);
-            p.vertex = v;
-            const auto &result = points_to_keep.insert(p);
-            if (!result.second) // if not inserted
-                points_to_remove.push_back(v);
+        std::vector<char> remove(cloud->vertices_size(), 0);
+        const bool success = details::for_each_grid_cell(
+                cloud, cell_size, [&](const uint32_t *indices, std::size_t count) {
+                    uint32_t keep = indices[0];
+                    if (count > 1) {
+                        if (representative == CENTROID) {
+                            for (auto &prop : vec3_averages) prop.apply(indices, count, keep);
+                            for (auto &prop : float_averages) prop.apply(indices, count, keep);
+                            for (auto &prop : double_averages) prop.apply(indices, count, keep);
+                        } else if (representative == MEDOID) {
+                            dvec3 center(0.0);
+                            for (std::size_t i = 0; i < count; ++i)
+                                center += dvec3(points[indices[i]]);
+                            const vec3 centroid(center / static_cast<double>(count));
+                            float min_dist = distance2(points[keep], centroid);
+                            for (std::size_t i = 1; i < count; ++i) {
+                                const float d = distance2(points[indices[i]], centroid);
+                                if (d < min_dist) {
+                                    min_dist = d;
+                                    keep = indices[i];
+                                }
+                            }
+                        }
+                    }
+                    for (std::size_t i = 0; i < count; ++i) {
+                        if (indices[i] != keep)
+                            remove[indices[i]] = 1;
+                    }
+                }, std::min<std::size_t>(std::size_t(1) << 20, max_window_size), max_window_size);
+        if (!success)
+            return cloud->n_vertices();
+
+        // re-normalize the averaged normals
+        auto normals = cloud->get_vertex_property<vec3>("v:normal");
+        if (representative == CENTROID && normals) {
+            for (auto v : cloud->vertices()) {
+                if (!remove[v.idx()] && length2(normals[v]) > 0.0f)
+                    normals[v].normalize();
+            }
         }
 
-        return points_to_remove;
+        for (std::size_t i = 0; i < remove.size(); ++i) {
+            if (remove[i])
+                cloud->delete_vertex(PointCloud::Vertex(static_cast<int>(i)));
+        }
+        cloud->collect_garbage();
+
+        return cloud->n_vertices();
     }
 
 
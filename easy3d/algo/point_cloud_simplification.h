@@ -61,14 +61,39 @@ namespace easy3d {
 
         /**
          * \brief Simplification of a point cloud using a regular grid covering the bounding box of the points. Simplification
-         * is done by keeping a representative point (chosen arbitrarily) for each cell of the grid. This is non-uniform
-         * simplification since the representative point is chosen arbitrarily.
+         * is done by keeping a representative point (i.e., the point with the smallest index) for each cell of the grid.
+         * This is non-uniform simplification since the representative point is chosen arbitrarily.
          * @param cloud The point cloud.
          * @param cell_size The size of the cells of the grid.
          * @return The indices of points to be deleted.
          */
         static std::vector<PointCloud::Vertex> grid_simplification(PointCloud *cloud, float cell_size);
 
+        /// \brief The representative point of a grid cell (see grid_downsampling()).
+        enum Representative {
+            FIRST,      ///< the point with the smallest index in the cell.
+            CENTROID,   ///< the first point, with its position and attributes replaced by the average of the cell.
+            MEDOID      ///< the point closest to the centroid of the cell.
+        };
+
+        /**
+         * \brief Downsample a point cloud (in place) by keeping a representative point for each cell of a regular
+         * grid covering the bounding box of the points.
+         * \details The points are processed in windows (along the X axis) of a bounded number of points, so apart
+         * from three bytes per point, the memory overhead is bounded even for huge point clouds. Each window is split into
+         * slabs, which are sorted by cells and processed in parallel. For CENTROID, all the
+         * vertex properties of type vec3, float, and double (e.g., "v:point", "v:color", and scalar fields) are
+         * averaged over each cell, and "v:normal" is re-normalized after averaging. For the other representatives,
+         * and for properties of other types, the values of the representative point are kept.
+         * @param cloud The point cloud.
+         * @param cell_size The size of the cells of the grid.
+         * @param representative The representative point of a cell.
+         * @param max_window_size The maximum number of points processed at a time (the result does not depend on it).
+         * @return The number of points after downsampling.
+         */
+        static unsigned int grid_downsampling(PointCloud *cloud, float cell_size, Representative representative = CENTROID,
+                                              std::size_t max_window_size = (std::size_t(1) << 25));
+
         //----- uniform simplification (specifying distance threshold) ------------------------------------
 
         /**
@@ -0,0 +1,1204 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/surface_mesh_boolean.h>
+#include <easy3d/algo/surface_mesh_winding_number.h>
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/surface_mesh_builder.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        // The triangles of an input mesh (compactly indexed), together with the edges and their incident faces.
+        struct Input {
+            int offset;     // the global index of the first vertex
+            std::vector<std::array<int, 3> > faces;         // global vertex indices
+            std::vector<std::array<int, 3> > face_edges;    // edge k: faces[k] -> faces[(k + 1) % 3]
+            std::vector<std::array<int, 2> > edges;         // global vertex indices (the smaller one first)
+            std::vector<std::array<int, 2> > edge_faces;    // the incident faces (-1 for a border)
+        };
+
+        // Collects the triangles of a mesh. The vertices are appended to 'points' (so the vertices of the two
+        // meshes have different global indices). Returns false if the mesh has non-triangular faces.
+        bool collect(const SurfaceMesh *mesh, std::vector<dvec3> &points, Input &input) {
+            input.offset = static_cast<int>(points.size());
+            std::vector<int> vertex_id(mesh->vertices_size(), -1);
+            for (auto v : mesh->vertices()) {
+                vertex_id[v.idx()] = static_cast<int>(points.size());
+                points.emplace_back(dvec3(mesh->position(v)));
+            }
+
+            std::vector<int> edge_id(mesh->edges_size(), -1);
+            for (auto e : mesh->edges()) {
+                edge_id[e.idx()] = static_cast<int>(input.edges.size());
+                const int a = vertex_id[mesh->vertex(e, 0).idx()];
+                const int b = vertex_id[mesh->vertex(e, 1).idx()];
+                input.edges.push_back({std::min(a, b), std::max(a, b)});
+                input.edge_faces.push_back({-1, -1});
+            }
+
+            for (auto f : mesh->faces()) {
+                std::array<int, 3> vts, eds;
+                int k = 0;
+                for (auto h : mesh->halfedges(f)) {
+                    if (k == 3)
+                        return false;
+                    vts[k] = vertex_id[mesh->source(h).idx()];
+                    eds[k] = edge_id[mesh->edge(h).idx()];
+                    ++k;
+                }
+                if (k != 3)
+                    return false;
+                const int id = static_cast<int>(input.faces.size());
+                input.faces.push_back(vts);
+                input.face_edges.push_back(eds);
+                for (auto e : eds) {
+                    auto &ef = input.edge_faces[e];
+                    (ef[0] == -1 ? ef[0] : ef[1]) = id;
+                }
+            }
+            return true;
+        }
+
+
+        // A bounding volume hierarchy of the faces of a mesh.
+        class FaceBVH {
+        public:
+            FaceBVH(const std::vector<dvec3> &points, const Input &input) {
+                const int num = static_cast<int>(input.faces.size());
+                min_.resize(num);
+                max_.resize(num);
+                std::vector<dvec3> centers(num);
+                for (int i = 0; i < num; ++i) {
+                    const auto &f = input.faces[i];
+                    min_[i] = max_[i] = points[f[0]];
+                    for (int k = 1; k < 3; ++k) {
+                        min_[i] = comp_min(min_[i], points[f[k]]);
+                        max_[i] = comp_max(max_[i], points[f[k]]);
+                    }
+                    centers[i] = (min_[i] + max_[i]) * 0.5;
+                }
+                indices_.resize(num);
+                for (int i = 0; i < num; ++i)
+                    indices_[i] = i;
+                if (num > 0) {
+                    nodes_.push_back(Node());
+                    build(centers, 0, 0, num);
+                }
+            }
+
+            // calls f(face) for all the faces whose bounding boxes intersect the box [bmin, bmax]
+            template<typename F>
+            void query(const dvec3 &bmin, const dvec3 &bmax, F f) const {
+                if (nodes_.empty())
+                    return;
+                int stack[64];
+                int top = 0;
+                stack[top++] = 0;
+                while (top > 0) {
+                    const Node &node = nodes_[stack[--top]];
+                    if (!overlap(node.min, node.max, bmin, bmax))
+                        continue;
+                    if (node.left < 0) {
+                        for (int i = node.begin; i < node.end; ++i) {
+                            const int id = indices_[i];
+                            if (overlap(min_[id], max_[id], bmin, bmax))
+                                f(id);
+                        }
+                    } else {
+                        stack[top++] = node.left;
+                        stack[top++] = node.left + 1;
+                    }
+                }
+            }
+
+        private:
+            struct Node {
+                dvec3 min, max;
+                int left;           // the first child (the second one is left + 1), or -1 for a leaf
+                int begin, end;     // the range in 'indices_'
+            };
+
+            static dvec3 comp_min(const dvec3 &a, const dvec3 &b) {
+                return dvec3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+            }
+
+            static dvec3 comp_max(const dvec3 &a, const dvec3 &b) {
+                return dvec3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+            }
+
+            static bool overlap(const dvec3 &amin, const dvec3 &amax, const dvec3 &bmin, const dvec3 &bmax) {
+                return amin.x <= bmax.x && bmin.x <= amax.x && amin.y <= bmax.y && bmin.y <= amax.y &&
+                       amin.z <= bmax.z && bmin.z <= amax.z;
+            }
+
+            // builds the subtree of the faces in [begin, end) into nodes_[slot]
+            void build(const std::vector<dvec3> &centers, int slot, int begin, int end) {
+                Node node;
+                node.min = min_[indices_[begin]];
+                node.max = max_[indices_[begin]];
+                dvec3 cmin = centers[indices_[begin]], cmax = cmin;
+                for (int i = begin + 1; i < end; ++i) {
+                    node.min = comp_min(node.min, min_[indices_[i]]);
+                    node.max = comp_max(node.max, max_[indices_[i]]);
+                    cmin = comp_min(cmin, centers[indices_[i]]);
+                    cmax = comp_max(cmax, centers[indices_[i]]);
+                }
+                node.begin = begin;
+                node.end = end;
+                node.left = -1;
+
+                if (end - begin > 4) {
+                    // split at the median along the longest axis of the centers
+                    const dvec3 ext = cmax - cmin;
+                    const int axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+                    const int mid = (begin + end) / 2;
+                    std::nth_element(indices_.begin() + begin, indices_.begin() + mid, indices_.begin() + end,
+                                     [&centers, axis](int a, int b) -> bool {
+                                         return centers[a][axis] < centers[b][axis];
+                                     });
+                    // the two children are stored contiguously
+                    node.left = static_cast<int>(nodes_.size());
+                    nodes_.push_back(Node());
+                    nodes_.push_back(Node());
+                    build(centers, node.left, begin, mid);
+                    build(centers, node.left + 1, mid, end);
+                }
+                nodes_[slot] = node;
+            }
+
+        private:
+            std::vector<dvec3> min_, max_;
+            std::vector<int> indices_;
+            std::vector<Node> nodes_;
+        };
+
+
+        // The orientation of d w.r.t. the plane (a, b, c) in double precision. The sign is filtered using the static
+        // error bound of the orient3d predicate from
+        //      J. R. Shewchuk. Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates.
+        //      Discrete & Computational Geometry, 18(3):305-363, 1997.
+        // An uncertain sign is resolved as positive (i.e., a symbolic perturbation). All the predicates below are
+        // evaluated with a canonical order of their arguments, so the decisions are consistent everywhere.
+        inline int orient_3d(const dvec3 &a, const dvec3 &b, const dvec3 &c, const dvec3 &d, double *value = nullptr) {
+            const double adx = a.x - d.x, ady = a.y - d.y, adz = a.z - d.z;
+            const double bdx = b.x - d.x, bdy = b.y - d.y, bdz = b.z - d.z;
+            const double cdx = c.x - d.x, cdy = c.y - d.y, cdz = c.z - d.z;
+
+            const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+            const double cdxady = cdx * ady, adxcdy = adx * cdy;
+            const double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+            const double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+            const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz)
+                                     + (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz)
+                                     + (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz);
+            if (value)
+                *value = det;
+            return (det < -7.7715611723761027e-16 * permanent) ? -1 : 1;
+        }
+
+
+        // The crossings of the edges of one mesh with the faces of the other mesh.
+        class Crossings {
+        public:
+            explicit Crossings(const std::vector<dvec3> &points) : points_(points) {}
+
+            // does edge e of mesh 'em' cross face f of mesh 'fm'?
+            bool test(const Input &em, int e, const Input &fm, int f) const {
+                const auto &ev = em.edges[e];
+                const auto &fv = fm.faces[f];
+                if (side(ev[0], fv) == side(ev[1], fv))
+                    return false;
+                // the line of the edge passes through the triangle
+                const int s0 = edge_edge(ev[0], ev[1], fv[0], fv[1]);
+                const int s1 = edge_edge(ev[0], ev[1], fv[1], fv[2]);
+                const int s2 = edge_edge(ev[0], ev[1], fv[2], fv[0]);
+                return s0 == s1 && s1 == s2;
+            }
+
+            // the parameter of the crossing point along edge e (from its smaller vertex to its larger vertex)
+            double parameter(const Input &em, int e, const Input &fm, int f) const {
+                const auto &ev = em.edges[e];
+                const auto &fv = fm.faces[f];
+                double d0, d1;
+                orient_3d(points_[fv[0]], points_[fv[1]], points_[fv[2]], points_[ev[0]], &d0);
+                orient_3d(points_[fv[0]], points_[fv[1]], points_[fv[2]], points_[ev[1]], &d1);
+                const double denominator = d0 - d1;
+                if (denominator == 0.0)
+                    return 0.5;
+                return std::min(1.0, std::max(0.0, d0 / denominator));
+            }
+
+        private:
+            int side(int v, const std::array<int, 3> &f) const {
+                return orient_3d(points_[f[0]], points_[f[1]], points_[f[2]], points_[v]);
+            }
+
+            int edge_edge(int p, int q, int a, int b) const {
+                if (a < b)
+                    return orient_3d(points_[p], points_[q], points_[a], points_[b]);
+                return -orient_3d(points_[p], points_[q], points_[b], points_[a]);
+            }
+
+        private:
+            const std::vector<dvec3> &points_;
+        };
+
+
+        // A constrained Delaunay triangulation of a triangle (given by its first three points in ccw order) with
+        // additional points on its edges, points in its interior, and constraint segments. It is designed for the
+        // small inputs resulted from intersecting a face with the faces of another mesh.
+        class FaceTriangulation {
+        public:
+            explicit FaceTriangulation(const std::vector<dvec2> &points)
+                    : points_(points), vertex_triangle_(points.size(), -1), last_(-1) {
+                add(0, 1, 2);
+                const dvec2 ext = comp_max(points[0], comp_max(points[1], points[2]))
+                                  - comp_min(points[0], comp_min(points[1], points[2]));
+                scale_ = dot(ext, ext);
+                epsilon_ = 1e-14 * scale_;
+            }
+
+            // inserts a point on the edge from corner k to corner k + 1. The points on an edge must be inserted in
+            // their order along the edge.
+            void insert_on_edge(int p, int k) {
+                const int end = (k + 1) % 3;
+                // the last point inserted on this edge
+                int start = k;
+                auto pos = last_on_edge_.find(k);
+                if (pos != last_on_edge_.end())
+                    start = pos->second;
+                split_edge(start, end, p);
+                last_on_edge_[k] = p;
+            }
+
+            // inserts a point in the interior
+            void insert(int p) {
+                double value = 0.0;
+                int edge = 0;
+                const int t = locate(p, value, edge);
+                if (t < 0)
+                    return;
+
+                const auto tri = triangles_[t];
+                const int a = tri[edge], b = tri[(edge + 1) % 3];
+                if (value <= epsilon_ && find(b, a) >= 0)  // (almost) on an interior edge
+                    split_edge(a, b, p);
+                else {
+                    remove(t);
+                    add(tri[0], tri[1], p);
+                    add(tri[1], tri[2], p);
+                    add(tri[2], tri[0], p);
+                }
+            }
+
+            // enforces the segment (a, b) to be an edge (by flipping the crossing edges)
+            bool insert_segment(int a, int b) {
+                if (a == b)
+                    return false;
+                std::vector<std::pair<int, int> > crossed;
+                for (int iter = 0; iter < 1000; ++iter) {
+                    if (find(a, b) >= 0 || find(b, a) >= 0) {
+                        constrained_.insert(undirected_key(a, b));
+                        return true;
+                    }
+                    if (!crossed_edges(a, b, crossed))
+                        crossed_edges_exhaustive(a, b, crossed);
+                    // flips the crossing edges whose quadrilaterals are convex
+                    bool flipped = false;
+                    for (const auto &e : crossed) {
+                        if (constrained_.count(undirected_key(e.first, e.second)) == 0 && flip(e.first, e.second))
+                            flipped = true;
+                    }
+                    if (!flipped)
+                        return false;
+                }
+                return false;
+            }
+
+            // makes the triangulation (constrained) Delaunay by flipping the illegal edges. Nearly co-circular
+            // configurations are left untouched to avoid flipping back and forth.
+            void make_delaunay() {
+                const std::size_t max_flips = 10 * triangles_.size() + 100;
+                std::size_t num_flips = 0;
+                bool changed = true;
+                while (changed && num_flips < max_flips) {
+                    changed = false;
+                    const std::size_t num = triangles_.size();
+                    for (std::size_t t = 0; t < num && num_flips < max_flips; ++t) {
+                        if (!alive_[t])
+                            continue;
+                        const auto tri = triangles_[t];
+                        for (int k = 0; k < 3; ++k) {
+                            const int u = tri[k], v = tri[(k + 1) % 3];
+                            if (constrained_.count(undirected_key(u, v)))
+                                continue;
+                            const int t2 = find(v, u);
+                            if (t2 < 0)
+                                continue;
+                            const int x = tri[(k + 2) % 3];
+                            const int y = third(t2, v, u);
+                            if (in_circle(u, v, x, y) > 1e-14 * scale_ * scale_ && flip(u, v)) {
+                                changed = true;
+                                ++num_flips;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // the resulting triangles (ccw)
+            std::vector<std::array<int, 3> > triangles() const {
+                std::vector<std::array<int, 3> > result;
+                for (std::size_t t = 0; t < triangles_.size(); ++t) {
+                    if (alive_[t])
+                        result.push_back(triangles_[t]);
+                }
+                return result;
+            }
+
+        private:
+            // finds the triangle containing p (the one maximizing the smallest orientation w.r.t. its edges). It
+            // walks from the last created triangle towards p, and visits all triangles only if the walk fails
+            // (e.g., p is slightly outside due to rounding). 'value' is the smallest orientation and 'edge' the
+            // corresponding edge.
+            int locate(int p, double &value, int &edge) const {
+                int t = last_;
+                for (std::size_t step = 0; t >= 0 && alive_[t] && step < triangles_.size(); ++step) {
+                    const auto &tri = triangles_[t];
+                    value = std::numeric_limits<double>::max();
+                    for (int k = 0; k < 3; ++k) {
+                        const double o = orient(tri[k], tri[(k + 1) % 3], p);
+                        if (o < value) {
+                            value = o;
+                            edge = k;
+                        }
+                    }
+                    if (value >= 0)
+                        return t;
+                    t = find(tri[(edge + 1) % 3], tri[edge]);   // across the edge p is outside of
+                }
+
+                int best = -1;
+                double best_value = -std::numeric_limits<double>::max();
+                int best_edge = 0;
+                for (std::size_t i = 0; i < triangles_.size(); ++i) {
+                    if (!alive_[i])
+                        continue;
+                    const auto &tri = triangles_[i];
+                    double v = std::numeric_limits<double>::max();
+                    int e = 0;
+                    for (int k = 0; k < 3; ++k) {
+                        const double o = orient(tri[k], tri[(k + 1) % 3], p);
+                        if (o < v) {
+                            v = o;
+                            e = k;
+                        }
+                    }
+                    if (v > best_value) {
+                        best_value = v;
+                        best = static_cast<int>(i);
+                        best_edge = e;
+                    }
+                }
+                value = best_value;
+                edge = best_edge;
+                return best;
+            }
+
+            // collects the edges crossed by the segment (a, b) by walking from a to b. Returns false if the walk
+            // fails (e.g., the segment passes through a vertex).
+            bool crossed_edges(int a, int b, std::vector<std::pair<int, int> > &edges) const {
+                edges.clear();
+                const int start = vertex_triangle_[a];
+                if (start < 0 || !alive_[start])
+                    return false;
+
+                // the triangle around a whose opposite edge is crossed (visiting the triangles ccw, then cw in case
+                // a is on the border)
+                int u = -1, v = -1;
+                for (int dir = 0; dir < 2 && u < 0; ++dir) {
+                    int t = start;
+                    for (std::size_t step = 0; step < triangles_.size(); ++step) {
+                        const auto &tri = triangles_[t];
+                        const int i = tri[0] == a ? 0 : (tri[1] == a ? 1 : 2);
+                        const int p = tri[(i + 1) % 3], q = tri[(i + 2) % 3];
+                        if (cross(a, b, p, q)) {
+                            u = p;
+                            v = q;
+                            break;
+                        }
+                        t = dir == 0 ? find(a, q) : find(p, a);
+                        if (t < 0 || t == start)
+                            break;
+                    }
+                }
+                if (u < 0)
+                    return false;
+
+                // the edge (u, v) is always directed as in the triangle on a's side
+                edges.emplace_back(u, v);
+                for (std::size_t step = 0; step < triangles_.size(); ++step) {
+                    const int t = find(v, u);
+                    if (t < 0)
+                        return false;
+                    const int w = third(t, v, u);
+                    if (w == b)
+                        return true;
+                    if (cross(a, b, u, w))
+                        v = w;
+                    else if (cross(a, b, w, v))
+                        u = w;
+                    else
+                        return false;
+                    edges.emplace_back(u, v);
+                }
+                return false;
+            }
+
+            // collects the edges crossed by the segment (a, b) by visiting all triangles
+            void crossed_edges_exhaustive(int a, int b, std::vector<std::pair<int, int> > &edges) const {
+                edges.clear();
+                for (std::size_t t = 0; t < triangles_.size(); ++t) {
+                    if (!alive_[t])
+                        continue;
+                    const auto &tri = triangles_[t];
+                    for (int k = 0; k < 3; ++k) {
+                        const int u = tri[k], v = tri[(k + 1) % 3];
+                        if (u < v && u != a && u != b && v != a && v != b && cross(a, b, u, v))
+                            edges.emplace_back(u, v);
+                    }
+                }
+            }
+
+            static uint64_t key(int a, int b) { return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b); }
+
+            static uint64_t undirected_key(int a, int b) { return a < b ? key(a, b) : key(b, a); }
+
+            static dvec2 comp_min(const dvec2 &a, const dvec2 &b) {
+                return dvec2(std::min(a.x, b.x), std::min(a.y, b.y));
+            }
+
+            static dvec2 comp_max(const dvec2 &a, const dvec2 &b) {
+                return dvec2(std::max(a.x, b.x), std::max(a.y, b.y));
+            }
+
+            double orient(int a, int b, int c) const {
+                const dvec2 &pa = points_[a], &pb = points_[b], &pc = points_[c];
+                return (pb.x - pa.x) * (pc.y - pa.y) - (pb.y - pa.y) * (pc.x - pa.x);
+            }
+
+            // positive if d is inside the circumcircle of the ccw triangle (a, b, c)
+            double in_circle(int a, int b, int c, int d) const {
+                const dvec2 ad = points_[a] - points_[d], bd = points_[b] - points_[d], cd = points_[c] - points_[d];
+                const double al = dot(ad, ad), bl = dot(bd, bd), cl = dot(cd, cd);
+                return ad.x * (bd.y * cl - bl * cd.y) - ad.y * (bd.x * cl - bl * cd.x) + al * (bd.x * cd.y - bd.y * cd.x);
+            }
+
+            // do the segments (a, b) and (u, v) properly cross each other?
+            bool cross(int a, int b, int u, int v) const {
+                const double o1 = orient(a, b, u), o2 = orient(a, b, v);
+                if (!((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)))
+                    return false;
+                const double o3 = orient(u, v, a), o4 = orient(u, v, b);
+                return (o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0);
+            }
+
+            void add(int a, int b, int c) {
+                const int t = static_cast<int>(triangles_.size());
+                triangles_.push_back({a, b, c});
+                alive_.push_back(true);
+                edges_[key(a, b)] = t;
+                edges_[key(b, c)] = t;
+                edges_[key(c, a)] = t;
+                vertex_triangle_[a] = vertex_triangle_[b] = vertex_triangle_[c] = t;
+                last_ = t;
+            }
+
+            void remove(int t) {
+                alive_[t] = false;
+                const auto &tri = triangles_[t];
+                for (int k = 0; k < 3; ++k)
+                    edges_.erase(key(tri[k], tri[(k + 1) % 3]));
+            }
+
+            // the triangle with the directed edge (a, b)
+            int find(int a, int b) const {
+                auto pos = edges_.find(key(a, b));
+                return pos == edges_.end() ? -1 : pos->second;
+            }
+
+            int third(int t, int a, int b) const {
+                const auto &tri = triangles_[t];
+                for (int k = 0; k < 3; ++k) {
+                    if (tri[k] != a && tri[k] != b)
+                        return tri[k];
+                }
+                return -1;
+            }
+
+            // splits the edge (a, b) at point p (p is on the edge)
+            void split_edge(int a, int b, int p) {
+                const int t1 = find(a, b);
+                if (t1 >= 0) {
+                    const int c = third(t1, a, b);
+                    remove(t1);
+                    add(a, p, c);
+                    add(p, b, c);
+                }
+                const int t2 = find(b, a);
+                if (t2 >= 0) {
+                    const int d = third(t2, b, a);
+                    remove(t2);
+                    add(b, p, d);
+                    add(p, a, d);
+                }
+                if (constrained_.erase(undirected_key(a, b))) {
+                    constrained_.insert(undirected_key(a, p));
+                    constrained_.insert(undirected_key(p, b));
+                }
+            }
+
+            // flips the interior edge (u, v) if the quadrilateral is strictly convex
+            bool flip(int u, int v) {
+                const int t1 = find(u, v);
+                const int t2 = find(v, u);
+                if (t1 < 0 || t2 < 0)
+                    return false;
+                const int x = third(t1, u, v);
+                const int y = third(t2, v, u);
+                if (orient(u, y, x) <= 0 || orient(y, v, x) <= 0)
+                    return false;
+                remove(t1);
+                remove(t2);
+                add(u, y, x);
+                add(y, v, x);
+                return true;
+            }
+
+        private:
+            const std::vector<dvec2> &points_;
+            std::vector<std::array<int, 3> > triangles_;
+            std::vector<bool> alive_;
+            std::unordered_map<uint64_t, int> edges_;     // directed edge -> triangle
+            std::unordered_set<uint64_t> constrained_;    // undirected constrained edges
+            std::unordered_map<int, int> last_on_edge_;   // the last point inserted on each edge of the triangle
+            std::vector<int> vertex_triangle_;            // a triangle incident to each point
+            int last_;                                    // the last created triangle (where locating starts)
+            double scale_;      // the squared size of the triangle
+            double epsilon_;    // the tolerance of the orientation test
+        };
+
+    }
+
+
+    SurfaceMesh *SurfaceMeshBoolean::apply(const SurfaceMesh *a, const SurfaceMesh *b, Operation operation) {
+        if (!a || !b)
+            return nullptr;
+
+        std::vector<dvec3> points;
+        details::Input inputs[2];
+        if (!details::collect(a, points, inputs[0]) || !details::collect(b, points, inputs[1])) {
+            LOG(WARNING) << "boolean operations require triangle meshes";
+            return nullptr;
+        }
+        const details::Input &A = inputs[0];
+        const details::Input &B = inputs[1];
+        const int num_a_faces = static_cast<int>(A.faces.size());
+        const int num_faces = num_a_faces + static_cast<int>(B.faces.size());
+
+        // whether to keep a triangle of a side, given whether it is inside the other mesh
+        auto keep = [operation](int side, bool in) -> bool {
+            switch (operation) {
+                case UNION:
+                    return !in;
+                case INTERSECTION:
+                    return in;
+                case DIFFERENCE:
+                    return side == 0 ? !in : in;
+            }
+            return false;
+        };
+
+        // nothing is inside an empty mesh, so the result is (a copy of) the kept faces of the other one
+        if (A.faces.empty() || B.faces.empty()) {
+            auto result = new SurfaceMesh;
+            SurfaceMeshBuilder builder(result);
+            builder.begin_surface();
+            std::vector<SurfaceMesh::Vertex> vertices(points.size());
+            for (int side = 0; side < 2; ++side) {
+                if (!keep(side, false))
+                    continue;
+                for (const auto &f : inputs[side].faces) {
+                    SurfaceMesh::Vertex vts[3];
+                    for (int k = 0; k < 3; ++k) {
+                        if (!vertices[f[k]].is_valid())
+                            vertices[f[k]] = builder.add_vertex(vec3(points[f[k]]));
+                        vts[k] = vertices[f[k]];
+                    }
+                    builder.add_triangle(vts[0], vts[1], vts[2]);
+                }
+            }
+            builder.end_surface(false);
+            return result;
+        }
+
+        // --------------------------------------------------------------------------------------------------
+        // broad phase + narrow phase.
+        // A crossing is identified by (the mesh of the edge, the edge, the face of the other mesh), encoded in
+        // a 64-bit key. A segment of the intersection curve connects the two crossings of a pair of faces.
+
+        auto crossing_key = [](int side, int edge, int face) -> uint64_t {
+            return (static_cast<uint64_t>(side) << 63) | (static_cast<uint64_t>(edge) << 32) |
+                   static_cast<uint32_t>(face);
+        };
+        struct Segment {
+            uint64_t keys[2];
+            int faces[2];   // the global face indices (the faces of B are offset by the number of faces of A)
+        };
+
+        const details::FaceBVH bvh(points, B);
+        const details::Crossings crossings(points);
+
+        const int chunk_size = 4096;
+        const int num_chunks = (num_a_faces + chunk_size - 1) / chunk_size;
+        std::vector<std::vector<uint64_t> > chunk_keys(num_chunks);
+        std::vector<std::vector<Segment> > chunk_segments(num_chunks);
+#pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < num_chunks; ++c) {
+            auto &keys = chunk_keys[c];
+            auto &segments = chunk_segments[c];
+            const int end = std::min(num_a_faces, (c + 1) * chunk_size);
+            for (int fa = c * chunk_size; fa < end; ++fa) {
+                const auto &f = A.faces[fa];
+                dvec3 bmin = points[f[0]], bmax = points[f[0]];
+                for (int k = 1; k < 3; ++k) {
+                    const dvec3 &p = points[f[k]];
+                    bmin = dvec3(std::min(bmin.x, p.x), std::min(bmin.y, p.y), std::min(bmin.z, p.z));
+                    bmax = dvec3(std::max(bmax.x, p.x), std::max(bmax.y, p.y), std::max(bmax.z, p.z));
+                }
+                bvh.query(bmin, bmax, [&](int fb) {
+                    uint64_t found[6];
+                    int num = 0;
+                    for (int k = 0; k < 3; ++k) {
+                        const int e = A.face_edges[fa][k];
+                        if (crossings.test(A, e, B, fb))
+                            found[num++] = crossing_key(0, e, fb);
+                    }
+                    for (int k = 0; k < 3; ++k) {
+                        const int e = B.face_edges[fb][k];
+                        if (crossings.test(B, e, A, fa))
+                            found[num++] = crossing_key(1, e, fa);
+                    }
+                    keys.insert(keys.end(), found, found + num);
+                    if (num == 2) // otherwise degenerate (e.g., coplanar), and the points are kept isolated
+                        segments.push_back({{found[0], found[1]}, {fa, num_a_faces + fb}});
+                });
+            }
+        }
+
+        std::vector<uint64_t> keys;
+        std::vector<Segment> segments;
+        for (int c = 0; c < num_chunks; ++c) {
+            keys.insert(keys.end(), chunk_keys[c].begin(), chunk_keys[c].end());
+            segments.insert(segments.end(), chunk_segments[c].begin(), chunk_segments[c].end());
+        }
+        std::vector<std::vector<uint64_t> >().swap(chunk_keys);
+        std::vector<std::vector<Segment> >().swap(chunk_segments);
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        // the intersection points
+        const int num_input_points = static_cast<int>(points.size());
+        const int num_crossings = static_cast<int>(keys.size());
+        points.resize(num_input_points + num_crossings);
+        std::vector<double> params(num_crossings);
+#pragma omp parallel for
+        for (int i = 0; i < num_crossings; ++i) {
+            const int side = static_cast<int>(keys[i] >> 63);
+            const int edge = static_cast<int>((keys[i] >> 32) & 0x7fffffff);
+            const int face = static_cast<int>(keys[i] & 0xffffffff);
+            const details::Input &em = inputs[side];
+            const details::Input &fm = inputs[1 - side];
+            const double t = crossings.parameter(em, edge, fm, face);
+            params[i] = t;
+            points[num_input_points + i] = points[em.edges[edge][0]] * (1.0 - t) + points[em.edges[edge][1]] * t;
+        }
+
+        // In degenerate configurations (e.g., an edge passing through an edge or a vertex of the other mesh),
+        // different crossings give (nearly) the same point. Such points are merged, and the ones coinciding with a
+        // vertex of the involved edge or face are snapped to that vertex.
+        std::vector<int> merged(num_crossings);
+        {
+            dvec3 bmin = points[0], bmax = points[0];
+            for (int i = 1; i < num_input_points; ++i) {
+                const dvec3 &p = points[i];
+                bmin = dvec3(std::min(bmin.x, p.x), std::min(bmin.y, p.y), std::min(bmin.z, p.z));
+                bmax = dvec3(std::max(bmax.x, p.x), std::max(bmax.y, p.y), std::max(bmax.z, p.z));
+            }
+            const double tolerance = std::max(1e-10 * length(bmax - bmin), std::numeric_limits<double>::min());
+            // the cells are twice the tolerance in size, so the points close to p are in the 2x2x2 cells around it
+            const double cell_size = 2.0 * tolerance;
+            auto cell_key = [](int64_t x, int64_t y, int64_t z) -> uint64_t {
+                return static_cast<uint64_t>(x * 73856093) ^ static_cast<uint64_t>(y * 19349663) ^
+                       static_cast<uint64_t>(z * 83492791);
+            };
+            auto cell_of = [&](const dvec3 &p, int64_t c[3], int dir[3]) {
+                for (int a = 0; a < 3; ++a) {
+                    const double x = (p[a] - bmin[a]) / cell_size;
+                    c[a] = static_cast<int64_t>(std::floor(x));
+                    dir[a] = (x - static_cast<double>(c[a]) < 0.5) ? -1 : 1;
+                }
+            };
+
+            // a hash grid (the cells store linked lists of the merged points)
+            std::unordered_map<uint64_t, int> grid;
+            std::vector<std::pair<int, int> > cell_points;  // (point, next)
+            grid.reserve(num_crossings);
+            cell_points.reserve(num_crossings);
+            for (int i = 0; i < num_crossings; ++i) {
+                const int side = static_cast<int>(keys[i] >> 63);
+                const int edge = static_cast<int>((keys[i] >> 32) & 0x7fffffff);
+                const int face = static_cast<int>(keys[i] & 0xffffffff);
+                const dvec3 &p = points[num_input_points + i];
+
+                int id = num_input_points + i;
+                double best = tolerance;
+                const auto &ev = inputs[side].edges[edge];
+                const auto &fv = inputs[1 - side].faces[face];
+                for (int v : {ev[0], ev[1], fv[0], fv[1], fv[2]}) {
+                    const double d = distance(points[v], p);
+                    if (d <= best) {
+                        best = d;
+                        id = v;
+                    }
+                }
+                int64_t c[3];
+                int dir[3];
+                cell_of(p, c, dir);
+                for (int n = 0; n < 8; ++n) {
+                    auto pos = grid.find(cell_key(c[0] + ((n & 1) ? dir[0] : 0), c[1] + ((n & 2) ? dir[1] : 0),
+                                                  c[2] + ((n & 4) ? dir[2] : 0)));
+                    if (pos == grid.end())
+                        continue;
+                    for (int k = pos->second; k >= 0; k = cell_points[k].second) {
+                        const int j = cell_points[k].first;
+                        const double d = distance(points[j], p);
+                        if (d < best) {
+                            best = d;
+                            id = j;
+                        }
+                    }
+                }
+                merged[i] = id;
+                if (id == num_input_points + i || id < num_input_points) {
+                    cell_of(points[id], c, dir);
+                    auto pos = grid.emplace(cell_key(c[0], c[1], c[2]), -1).first;
+                    cell_points.emplace_back(id, pos->second);
+                    pos->second = static_cast<int>(cell_points.size()) - 1;
+                }
+            }
+        }
+        auto point_id = [&](uint64_t key) -> int {
+            return merged[std::lower_bound(keys.begin(), keys.end(), key) - keys.begin()];
+        };
+
+        // --------------------------------------------------------------------------------------------------
+        // the intersection points and segments of each intersected face
+
+        struct FaceData {
+            int face;   // the global face index
+            std::vector<std::pair<double, int> > edge_points[3];
+            std::vector<int> interior_points;
+            std::vector<std::pair<int, int> > segments;
+        };
+        std::vector<int> touched(num_faces, -1);
+        std::vector<FaceData> data;
+        auto face_data = [&](int face) -> FaceData & {
+            if (touched[face] < 0) {
+                touched[face] = static_cast<int>(data.size());
+                data.emplace_back();
+                data.back().face = face;
+            }
+            return data[touched[face]];
+        };
+
+        for (int i = 0; i < num_crossings; ++i) {
+            const int side = static_cast<int>(keys[i] >> 63);
+            const int edge = static_cast<int>((keys[i] >> 32) & 0x7fffffff);
+            const int face = static_cast<int>(keys[i] & 0xffffffff);
+            const details::Input &em = inputs[side];
+            const int em_offset = side == 0 ? 0 : num_a_faces;
+            const int fm_offset = side == 0 ? num_a_faces : 0;
+            for (auto f : em.edge_faces[edge]) {
+                if (f < 0)
+                    continue;
+                const auto &eds = em.face_edges[f];
+                const int k = eds[0] == edge ? 0 : (eds[1] == edge ? 1 : 2);
+                face_data(em_offset + f).edge_points[k].emplace_back(params[i], merged[i]);
+            }
+            face_data(fm_offset + face).interior_points.push_back(merged[i]);
+        }
+        for (const auto &s : segments) {
+            const int p = point_id(s.keys[0]), q = point_id(s.keys[1]);
+            if (p == q)
+                continue;
+            face_data(s.faces[0]).segments.emplace_back(p, q);
+            face_data(s.faces[1]).segments.emplace_back(p, q);
+        }
+        std::vector<Segment>().swap(segments);
+        std::vector<double>().swap(params);
+
+        // --------------------------------------------------------------------------------------------------
+        // re-triangulate the intersected faces
+
+        const int num_touched = static_cast<int>(data.size());
+        std::vector<std::vector<std::array<int, 3> > > new_triangles(num_touched);
+        std::vector<char> failed(num_touched, 0);
+        int num_failures = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:num_failures)
+        for (int i = 0; i < num_touched; ++i) {
+            FaceData &fd = data[i];
+            const int side = fd.face < num_a_faces ? 0 : 1;
+            const int f = side == 0 ? fd.face : fd.face - num_a_faces;
+            const auto &vts = inputs[side].faces[f];
+            const auto &eds = inputs[side].face_edges[f];
+
+            // the local points: the corners, the points on the edges (in their order along the edges), and the
+            // interior points. A merged point is used only once.
+            std::vector<int> global;
+            std::unordered_map<int, int> local_id;
+            auto add_point = [&global, &local_id](int id) -> bool {
+                if (!local_id.emplace(id, static_cast<int>(global.size())).second)
+                    return false;
+                global.push_back(id);
+                return true;
+            };
+            for (int k = 0; k < 3; ++k)
+                add_point(vts[k]);
+            std::vector<int> edge_of_point;
+            for (int k = 0; k < 3; ++k) {
+                auto &ep = fd.edge_points[k];
+                std::sort(ep.begin(), ep.end());
+                if (inputs[side].edges[eds[k]][0] != vts[k])
+                    std::reverse(ep.begin(), ep.end());
+                for (const auto &p : ep) {
+                    if (add_point(p.second))
+                        edge_of_point.push_back(k);
+                }
+            }
+            std::sort(fd.interior_points.begin(), fd.interior_points.end());
+            for (auto id : fd.interior_points)
+                add_point(id);
+
+            // projected onto the dominant plane (keeping the orientation)
+            const dvec3 n = cross(points[vts[1]] - points[vts[0]], points[vts[2]] - points[vts[0]]);
+            const int axis = (std::abs(n.x) >= std::abs(n.y) && std::abs(n.x) >= std::abs(n.z)) ? 0 :
+                             (std::abs(n.y) >= std::abs(n.z) ? 1 : 2);
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            const bool flip = n[axis] < 0;
+            std::vector<dvec2> local(global.size());
+            for (std::size_t j = 0; j < global.size(); ++j) {
+                const dvec3 &p = points[global[j]];
+                local[j] = flip ? dvec2(p[v], p[u]) : dvec2(p[u], p[v]);
+            }
+
+            details::FaceTriangulation cdt(local);
+            int next = 3;
+            for (auto k : edge_of_point)
+                cdt.insert_on_edge(next++, k);
+            for (; next < static_cast<int>(global.size()); ++next)
+                cdt.insert(next);
+            for (const auto &s : fd.segments) {
+                if (!cdt.insert_segment(local_id[s.first], local_id[s.second])) {
+                    failed[i] = 1;
+                    ++num_failures;
+                }
+            }
+            cdt.make_delaunay();
+
+            for (const auto &t : cdt.triangles())
+                new_triangles[i].push_back({global[t[0]], global[t[1]], global[t[2]]});
+        }
+        if (num_failures > 0)
+            LOG(WARNING) << num_failures << " intersection segments could not be recovered (degenerate input?). "
+                         << "The triangles of the faces containing them are classified individually";
+
+        // --------------------------------------------------------------------------------------------------
+        // the triangles of both meshes, grouped into patches separated by the intersection curves
+
+        std::vector<std::array<int, 3> > triangles;
+        std::vector<int> triangle_side;
+        std::vector<char> origin;   // 0: an untouched face, 1: re-triangulated, 2: re-triangulated with failures
+        std::vector<int> face_triangle(num_faces, -1);     // the triangle of an untouched face
+        triangles.reserve(num_faces + 2 * num_crossings);
+        for (int f = 0; f < num_faces; ++f) {
+            const int side = f < num_a_faces ? 0 : 1;
+            if (touched[f] < 0) {
+                face_triangle[f] = static_cast<int>(triangles.size());
+                triangles.push_back(inputs[side].faces[side == 0 ? f : f - num_a_faces]);
+                triangle_side.push_back(side);
+                origin.push_back(0);
+            } else {
+                for (const auto &t : new_triangles[touched[f]]) {
+                    triangles.push_back(t);
+                    triangle_side.push_back(side);
+                    origin.push_back(failed[touched[f]] ? 2 : 1);
+                }
+            }
+        }
+        std::vector<std::vector<std::array<int, 3> > >().swap(new_triangles);
+
+        const int num_triangles = static_cast<int>(triangles.size());
+        std::vector<int> parent(num_triangles);
+        for (int i = 0; i < num_triangles; ++i)
+            parent[i] = i;
+        auto find = [&parent](int x) -> int {
+            while (parent[x] != x) {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        };
+        auto unite = [&](int x, int y) {
+            x = find(x);
+            y = find(y);
+            if (x != y)
+                parent[std::max(x, y)] = std::min(x, y);
+        };
+
+        std::vector<uint64_t> constraints;
+        for (const auto &fd : data) {
+            for (const auto &s : fd.segments)
+                constraints.push_back(crossing_key(0, std::min(s.first, s.second), std::max(s.first, s.second)));
+        }
+        std::sort(constraints.begin(), constraints.end());
+
+        // The untouched faces are connected using the adjacency of the input meshes. The triangles around the
+        // intersected faces are connected by matching their (non-constrained) edges, i.e., sorted by the (mesh,
+        // edge) keys. The triangles of the faces with unrecovered segments are left isolated (so the patches never
+        // leak through them).
+        std::vector<std::pair<uint64_t, int> > edge_triangle;
+        auto connect = [&](int t, int side, int p, int q) {
+            edge_triangle.emplace_back(crossing_key(side, std::min(p, q), std::max(p, q)), t);
+        };
+        for (int f = 0; f < num_faces; ++f) {
+            const int side = f < num_a_faces ? 0 : 1;
+            const int offset = side == 0 ? 0 : num_a_faces;
+            const details::Input &input = inputs[side];
+            if (touched[f] >= 0)
+                continue;
+            const int t = face_triangle[f];
+            const auto &eds = input.face_edges[f - offset];
+            for (int k = 0; k < 3; ++k) {
+                for (auto g : input.edge_faces[eds[k]]) {
+                    if (g < 0 || g == f - offset)
+                        continue;
+                    if (touched[offset + g] < 0)
+                        unite(t, face_triangle[offset + g]);
+                    else {
+                        const auto &vts = input.faces[f - offset];
+                        connect(t, side, vts[k], vts[(k + 1) % 3]);
+                    }
+                }
+            }
+        }
+        for (int t = 0; t < num_triangles; ++t) {
+            if (origin[t] != 1)
+                continue;
+            const auto &vts = triangles[t];
+            for (int k = 0; k < 3; ++k)
+                connect(t, triangle_side[t], vts[k], vts[(k + 1) % 3]);
+        }
+        std::sort(edge_triangle.begin(), edge_triangle.end());
+
+        std::vector<std::pair<int, int> > opposite;     // the pairs of triangles across the intersection curves
+        for (std::size_t i = 0; i + 1 < edge_triangle.size(); ++i) {
+            const uint64_t key = edge_triangle[i].first;
+            if (edge_triangle[i + 1].first != key)
+                continue;
+            const uint64_t undirected = key & ~(static_cast<uint64_t>(1) << 63);
+            if (std::binary_search(constraints.begin(), constraints.end(), undirected))
+                opposite.emplace_back(edge_triangle[i].second, edge_triangle[i + 1].second);
+            else
+                unite(edge_triangle[i].second, edge_triangle[i + 1].second);
+        }
+        std::vector<std::pair<uint64_t, int> >().swap(edge_triangle);
+
+        // --------------------------------------------------------------------------------------------------
+        // classify each patch (by a point of its largest triangle) using the generalized winding number w.r.t.
+        // the other mesh
+
+        std::vector<int> patch(num_triangles, -1);
+        std::vector<int> representative;
+        std::vector<double> largest;
+        for (int t = 0; t < num_triangles; ++t) {
+            const int root = find(t);
+            if (patch[root] < 0) {
+                patch[root] = static_cast<int>(representative.size());
+                representative.push_back(t);
+                largest.push_back(-1.0);
+            }
+            const int id = patch[root];
+            patch[t] = id;
+            const auto &vts = triangles[t];
+            const double area = length(cross(points[vts[1]] - points[vts[0]], points[vts[2]] - points[vts[0]]));
+            if (area > largest[id]) {
+                largest[id] = area;
+                representative[id] = t;
+            }
+        }
+
+        dvec3 bmin[2], bmax[2];
+        for (int side = 0; side < 2; ++side) {
+            const int begin = inputs[side].offset;
+            const int end = side == 0 ? inputs[1].offset : num_input_points;
+            bmin[side] = bmax[side] = begin < end ? points[begin] : dvec3(0, 0, 0);
+            for (int i = begin + 1; i < end; ++i) {
+                const dvec3 &p = points[i];
+                bmin[side] = dvec3(std::min(bmin[side].x, p.x), std::min(bmin[side].y, p.y), std::min(bmin[side].z, p.z));
+                bmax[side] = dvec3(std::max(bmax[side].x, p.x), std::max(bmax[side].y, p.y), std::max(bmax[side].z, p.z));
+            }
+        }
+
+        // The status flips across the intersection curves. So only one patch (the one with the largest triangle)
+        // of each group of patches connected by the curves is evaluated. All the patches of a group are evaluated
+        // if the flips are inconsistent (e.g., caused by unrecovered segments).
+        const int num_patches = static_cast<int>(representative.size());
+        std::vector<std::vector<int> > adjacency(num_patches);
+        std::vector<bool> consistent(num_patches, true);
+        for (const auto &o : opposite) {
+            const int p = patch[o.first], q = patch[o.second];
+            if (p == q)
+                consistent[p] = false;
+            else {
+                adjacency[p].push_back(q);
+                adjacency[q].push_back(p);
+            }
+        }
+
+        std::vector<int> group(num_patches, -1);
+        std::vector<bool> parity(num_patches, false);
+        std::vector<int> to_evaluate;
+        for (int i = 0; i < num_patches; ++i) {
+            if (group[i] >= 0)
+                continue;
+            std::vector<int> members(1, i);
+            group[i] = i;
+            bool ok = consistent[i];
+            int seed = i;
+            for (std::size_t k = 0; k < members.size(); ++k) {
+                const int p = members[k];
+                if (largest[p] > largest[seed])
+                    seed = p;
+                for (auto q : adjacency[p]) {
+                    if (group[q] < 0) {
+                        group[q] = i;
+                        parity[q] = !parity[p];
+                        ok = ok && consistent[q];
+                        members.push_back(q);
+                    } else if (parity[q] == parity[p])
+                        ok = false;
+                }
+            }
+            if (ok) {
+                for (auto p : members)
+                    group[p] = seed;
+                to_evaluate.push_back(seed);
+            } else {
+                for (auto p : members)
+                    group[p] = p;
+                to_evaluate.insert(to_evaluate.end(), members.begin(), members.end());
+            }
+        }
+
+        std::vector<vec3> queries[2];       // the query points w.r.t. each mesh
+        std::vector<int> query_patch[2];
+        for (auto i : to_evaluate) {
+            const int t = representative[i];
+            const auto &vts = triangles[t];
+            const dvec3 c = (points[vts[0]] + points[vts[1]] + points[vts[2]]) / 3.0;
+            const int other = 1 - triangle_side[t];
+            if (c.x < bmin[other].x || c.y < bmin[other].y || c.z < bmin[other].z ||
+                c.x > bmax[other].x || c.y > bmax[other].y || c.z > bmax[other].z)
+                continue;
+            queries[other].push_back(vec3(c));
+            query_patch[other].push_back(i);
+        }
+        std::vector<bool> inside(num_patches, false);
+        for (int side = 0; side < 2; ++side) {
+            if (queries[side].empty())
+                continue;
+            const SurfaceMeshWindingNumber winding(side == 0 ? a : b);
+            const std::vector<float> values = winding.winding_numbers(queries[side]);
+            for (std::size_t k = 0; k < values.size(); ++k)
+                inside[query_patch[side][k]] = std::abs(values[k]) > 0.5f;
+        }
+        for (int i = 0; i < num_patches; ++i)
+            inside[i] = inside[group[i]] != (parity[i] != parity[group[i]]);
+
+        // --------------------------------------------------------------------------------------------------
+        // collect the result
+
+        auto result = new SurfaceMesh;
+        SurfaceMeshBuilder builder(result);
+        builder.begin_surface();
+        std::vector<SurfaceMesh::Vertex> vertices(points.size());
+        for (int t = 0; t < num_triangles; ++t) {
+            const int side = triangle_side[t];
+            if (!keep(side, inside[patch[t]]))
+                continue;
+            SurfaceMesh::Vertex vts[3];
+            for (int k = 0; k < 3; ++k) {
+                const int id = triangles[t][k];
+                if (!vertices[id].is_valid())
+                    vertices[id] = builder.add_vertex(vec3(points[id]));
+                vts[k] = vertices[id];
+            }
+            if (operation == DIFFERENCE && side == 1)
+                builder.add_triangle(vts[0], vts[2], vts[1]);
+            else
+                builder.add_triangle(vts[0], vts[1], vts[2]);
+        }
+        builder.end_surface(false);
+
+        return result;
+    }
+
+}
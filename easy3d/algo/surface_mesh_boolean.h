@@ -0,0 +1,75 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_SURFACE_MESH_BOOLEAN_H
+#define EASY3D_ALGO_SURFACE_MESH_BOOLEAN_H
+
+
+namespace easy3d {
+
+    class SurfaceMesh;
+
+    /**
+     * \brief Boolean operations (i.e., union, intersection, and difference) of two closed triangle meshes.
+     * \class SurfaceMeshBoolean easy3d/algo/surface_mesh_boolean.h
+     * \details The pipeline uses only floating-point arithmetic:
+     *  - Broad phase: a bounding volume hierarchy of the faces of one mesh is queried by the faces of the other
+     *    mesh (in parallel).
+     *  - Narrow phase: each intersection point is the crossing of an edge of one mesh with a face of the other
+     *    mesh, and it is identified by the (edge, face) pair. So the faces sharing an edge always agree on the
+     *    intersection points on that edge. The crossings are decided by filtered orientation predicates, in which
+     *    the uncertain (i.e., near-degenerate) cases are resolved by a consistent symbolic perturbation.
+     *  - Each intersected face is re-triangulated (in parallel) by a constrained Delaunay triangulation of its
+     *    intersection points and segments.
+     *  - The faces are grouped into patches separated by the intersection curves, and each patch is classified
+     *    as inside or outside of the other mesh using the generalized winding number.
+     *
+     * \pre Both meshes are closed, consistently oriented, and free of self-intersections. Coplanar overlapping
+     *      faces of the two meshes are not supported (they are treated as if slightly perturbed).
+     */
+    class SurfaceMeshBoolean {
+    public:
+        /// The boolean operations.
+        enum Operation {
+            UNION,          ///< The union of the two meshes.
+            INTERSECTION,   ///< The intersection of the two meshes.
+            DIFFERENCE      ///< The first mesh minus the second mesh.
+        };
+
+        /**
+         * \brief Computes a boolean operation of two closed triangle meshes.
+         * @param a The first mesh.
+         * @param b The second mesh.
+         * @param operation The boolean operation.
+         * @return The result (a new mesh), or nullptr if the operation failed. The result may be empty, e.g., the
+         *      intersection of two disjoint meshes.
+         */
+        static SurfaceMesh *apply(const SurfaceMesh *a, const SurfaceMesh *b, Operation operation);
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_ALGO_SURFACE_MESH_BOOLEAN_H
@@ -28,40 +28,56 @@ namespace easy3d {
 
     //-----------------------------------------------------------------------------
 
-    void SurfaceMeshCurvature::analyze(unsigned int post_smoothing_steps) {
-        float kmin, kmax, mean, gauss;
-        float area, sum_angles;
-        float weight, sum_weights;
-        vec3 p0, p1, p2, laplace;
+    namespace details {
+
+        // Precomputes the cotan weight of each edge. The weights are stored in the contiguous array of the edge
+        // property, so the passes (curvature analysis, smoothing) share them and access them by edge index.
+        void compute_cotan_weights(const SurfaceMesh *mesh, SurfaceMesh::EdgeProperty<double> cotan) {
+            const int num = static_cast<int>(mesh->edges_size());
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i) {
+                const SurfaceMesh::Edge e(i);
+                cotan[e] = mesh->is_deleted(e) ? 0.0 : geom::cotan_weight(mesh, e);
+            }
+        }
+
+    }
+
+    //-----------------------------------------------------------------------------
 
-        // cotan weight per edge
+    void SurfaceMeshCurvature::analyze(unsigned int post_smoothing_steps) {
+        // cotan weight per edge (also used by the post smoothing)
         auto cotan = mesh_->add_edge_property<double>("curv:cotan");
-        for (auto e : mesh_->edges())
-            cotan[e] = geom::cotan_weight(mesh_, e);
+        details::compute_cotan_weights(mesh_, cotan);
 
         // Voronoi area per vertex
         // Laplace per vertex
         // angle sum per vertex
         // -> mean, Gauss -> min, max curvature
-        for (auto v : mesh_->vertices()) {
-            kmin = kmax = 0.0;
-
+        const int num = static_cast<int>(mesh_->vertices_size());
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const SurfaceMesh::Vertex v(i);
+            if (mesh_->is_deleted(v))
+                continue;
+
+            float kmin = 0.0f, kmax = 0.0f;
             if (!mesh_->is_isolated(v) && !mesh_->is_border(v)) {
-                laplace = vec3(0.0);
-                sum_weights = 0.0;
-                sum_angles = 0.0;
-                p0 = mesh_->position(v);
+                vec3 laplace(0.0f);
+                float sum_weights = 0.0f;
+                float sum_angles = 0.0f;
+                const vec3 &p0 = mesh_->position(v);
 
                 // Voronoi area
-                area = geom::voronoi_area(mesh_, v);
+                const float area = geom::voronoi_area(mesh_, v);
 
                 // Laplace & angle sum
                 for (auto vh : mesh_->halfedges(v)) {
-                    p1 = mesh_->position(mesh_->target(vh));
-                    p2 = mesh_->position(
+                    vec3 p1 = mesh_->position(mesh_->target(vh));
+                    vec3 p2 = mesh_->position(
                             mesh_->target(mesh_->prev_around_source(vh)));
 
-                    weight = cotan[mesh_->edge(vh)];
+                    const float weight = cotan[mesh_->edge(vh)];
                     sum_weights += weight;
                     laplace += weight * p1;
 
@@ -71,11 +87,11 @@ namespace easy3d {
                     p2.normalize();
                     sum_angles += acos(geom::clamp_cos(dot(p1, p2)));
                 }
-                laplace -= sum_weights * mesh_->position(v);
+                laplace -= sum_weights * p0;
                 laplace /= float(2.0) * area;
 
-                mean = float(0.5) * norm(laplace);
-                gauss = (2.0 * M_PI - sum_angles) / area;
+                const float mean = float(0.5) * norm(laplace);
+                const float gauss = (2.0 * M_PI - sum_angles) / area;
 
                 const float s = sqrt(std::max(float(0.0), mean * mean - gauss));
                 kmin = mean - s;
@@ -86,36 +102,39 @@ namespace easy3d {
             max_curvature_[v] = kmax;
         }
 
-        // boundary vertices: interpolate from interior neighbors
-        for (auto v : mesh_->vertices()) {
-            if (mesh_->is_border(v)) {
-                kmin = kmax = sum_weights = 0.0;
-
-                for (auto vh : mesh_->halfedges(v)) {
-                    v = mesh_->target(vh);
-                    if (!mesh_->is_border(v)) {
-                        weight = cotan[mesh_->edge(vh)];
-                        sum_weights += weight;
-                        kmin += weight * min_curvature_[v];
-                        kmax += weight * max_curvature_[v];
-                    }
-                }
-
-                if (sum_weights) {
-                    kmin /= sum_weights;
-                    kmax /= sum_weights;
+        // boundary vertices: interpolate from interior neighbors (only the values of interior vertices are read, so
+        // the boundary vertices can be processed in parallel)
+#pragma omp parallel for
+        for (int i = 0; i < num; ++i) {
+            const SurfaceMesh::Vertex v(i);
+            if (mesh_->is_deleted(v) || !mesh_->is_border(v))
+                continue;
+
+            float kmin = 0.0f, kmax = 0.0f, sum_weights = 0.0f;
+            for (auto vh : mesh_->halfedges(v)) {
+                const auto vv = mesh_->target(vh);
+                if (!mesh_->is_border(vv)) {
+                    const float weight = cotan[mesh_->edge(vh)];
+                    sum_weights += weight;
+                    kmin += weight * min_curvature_[vv];
+                    kmax += weight * max_curvature_[vv];
                 }
+            }
 
-                min_curvature_[v] = kmin;
-                max_curvature_[v] = kmax;
+            if (sum_weights) {
+                kmin /= sum_weights;
+                kmax /= sum_weights;
             }
-        }
 
-        // clean-up properties
-        mesh_->remove_edge_property(cotan);
+            min_curvature_[v] = kmin;
+            max_curvature_[v] = kmax;
+        }
 
         // smooth curvature values
         smooth_curvatures(post_smoothing_steps);
+
+        // clean-up properties
+        mesh_->remove_edge_property(cotan);
     }
 
     //-----------------------------------------------------------------------------
@@ -127,38 +146,42 @@ namespace easy3d {
         auto evec = mesh_->add_edge_property<dvec3>("curv:evec", dvec3(0, 0, 0));
         auto angle = mesh_->add_edge_property<double>("curv:angle", 0.0);
 
-        dvec3 p0, p1, n0, n1, ev;
-        double l, A, beta, a1, a2, a3;
-        dmat3 tensor;
-
-        double eval1, eval2, eval3, kmin, kmax;
-        dvec3 evec1, evec2, evec3;
-
-        std::vector<SurfaceMesh::Vertex> neighborhood;
-        neighborhood.reserve(15);
+        const int num_vertices = static_cast<int>(mesh_->vertices_size());
+        const int num_edges = static_cast<int>(mesh_->edges_size());
+        const int num_faces = static_cast<int>(mesh_->faces_size());
 
         // precompute Voronoi area per vertex
-        for (auto v : mesh_->vertices()) {
-            area[v] = geom::voronoi_area(mesh_, v);
+#pragma omp parallel for
+        for (int i = 0; i < num_vertices; ++i) {
+            const SurfaceMesh::Vertex v(i);
+            if (!mesh_->is_deleted(v))
+                area[v] = geom::voronoi_area(mesh_, v);
         }
 
         // precompute face normals
-        for (auto f : mesh_->faces()) {
-            normal[f] = (dvec3) mesh_->compute_face_normal(f);
+#pragma omp parallel for
+        for (int i = 0; i < num_faces; ++i) {
+            const SurfaceMesh::Face f(i);
+            if (!mesh_->is_deleted(f))
+                normal[f] = (dvec3) mesh_->compute_face_normal(f);
         }
 
         // precompute dihedralAngle*edge_length*edge per edge
-        for (auto e : mesh_->edges()) {
+#pragma omp parallel for
+        for (int i = 0; i < num_edges; ++i) {
+            const SurfaceMesh::Edge e(i);
+            if (mesh_->is_deleted(e))
+                continue;
             auto h0 = mesh_->halfedge(e, 0);
             auto h1 = mesh_->halfedge(e, 1);
             auto f0 = mesh_->face(h0);
             auto f1 = mesh_->face(h1);
             if (f0.is_valid() && f1.is_valid()) {
-                n0 = normal[f0];
-                n1 = normal[f1];
-                ev = (dvec3) mesh_->position(mesh_->target(h0));
+                const dvec3 &n0 = normal[f0];
+                const dvec3 &n1 = normal[f1];
+                dvec3 ev = (dvec3) mesh_->position(mesh_->target(h0));
                 ev -= (dvec3) mesh_->position(mesh_->target(h1));
-                l = norm(ev);
+                double l = norm(ev);
                 if (l != 0) {   // avoid overflow in case of 0-length edges
                     ev /= l;
                     l *= 0.5; // only consider half of the edge (matching Voronoi area)
@@ -169,97 +192,101 @@ namespace easy3d {
         }
 
         // compute curvature tensor for each vertex
-        for (auto v : mesh_->vertices()) {
-            kmin = 0.0;
-            kmax = 0.0;
-
-            if (!mesh_->is_isolated(v)) {
-                // one-ring or two-ring neighborhood?
-                neighborhood.clear();
-                neighborhood.push_back(v);
-                if (two_ring_neighborhood) {
-                    for (auto vv : mesh_->vertices(v))
-                        neighborhood.push_back(vv);
-                }
+#pragma omp parallel
+        {
+            // per-thread scratch buffers, reused for all the vertices processed by this thread
+            std::vector<SurfaceMesh::Vertex> neighborhood;
+            neighborhood.reserve(15);
+            // Liangliang: eigen solver requires FT** as input matrix :-(
+            double storage[3][3];
+            double *matrix[3] = {storage[0], storage[1], storage[2]};
+            EigenSolver<double> solver(3);
+
+#pragma omp for
+            for (int idx = 0; idx < num_vertices; ++idx) {
+                const SurfaceMesh::Vertex v(idx);
+                if (mesh_->is_deleted(v))
+                    continue;
 
-                A = 0.0;
-                tensor = dmat3(0.0);
-
-                // compute tensor over vertex neighborhood stored in vertices
-                for (auto nit : neighborhood) {
-                    // accumulate tensor from dihedral angles around vertices
-                    for (auto hv : mesh_->halfedges(nit)) {
-                        auto ee = mesh_->edge(hv);
-                        ev = evec[ee];
-                        beta = angle[ee];
-                        for (int i = 0; i < 3; ++i)
-                            for (int j = 0; j < 3; ++j)
-                                tensor(i, j) += beta * ev[i] * ev[j];
+                double kmin = 0.0;
+                double kmax = 0.0;
+
+                if (!mesh_->is_isolated(v)) {
+                    // one-ring or two-ring neighborhood?
+                    neighborhood.clear();
+                    neighborhood.push_back(v);
+                    if (two_ring_neighborhood) {
+                        for (auto vv : mesh_->vertices(v))
+                            neighborhood.push_back(vv);
                     }
 
-                    // accumulate area
-                    A += area[nit];
-                }
+                    double A = 0.0;
+                    dmat3 tensor(0.0);
+
+                    // compute tensor over vertex neighborhood stored in vertices
+                    for (auto nit : neighborhood) {
+                        // accumulate tensor from dihedral angles around vertices
+                        for (auto hv : mesh_->halfedges(nit)) {
+                            auto ee = mesh_->edge(hv);
+                            const dvec3 &ev = evec[ee];
+                            const double beta = angle[ee];
+                            for (int i = 0; i < 3; ++i)
+                                for (int j = 0; j < 3; ++j)
+                                    tensor(i, j) += beta * ev[i] * ev[j];
+                        }
+
+                        // accumulate area
+                        A += area[nit];
+                    }
 
-                // normalize tensor by accumulated
-                if (A != 0)     // avoid overflow in case of 0-area
-                    tensor /= A;
+                    // normalize tensor by accumulated
+                    if (A != 0)     // avoid overflow in case of 0-area
+                        tensor /= A;
 
-                // Liangliang: eigen solver requires FT** as input matrix :-(
-                double **matrix = new double *[3];
-                for (int i = 0; i < 3; ++i) {
-                    matrix[i] = new double[3];
-                    for (int j = 0; j < 3; ++j)
-                        matrix[i][j] = tensor(i, j);
-                }
-                // Eigen-decomposition
-                EigenSolver<double> solver(3);
-                solver.solve(matrix, EigenSolver<double>::DECREASING);
-                eval1 = solver.eigen_value(0);
-                eval2 = solver.eigen_value(1);
-                eval3 = solver.eigen_value(2);
-                for (int i = 0; i < 3; ++i) {
-                    evec1[i] = solver.eigen_vector(i, 0);
-                    evec2[i] = solver.eigen_vector(i, 1);
-                    evec3[i] = solver.eigen_vector(i, 2);
-                }
-                for (int i = 0; i < 3; ++i)
-                    delete[] matrix[i];
-                delete[] matrix;
-
-                // curvature values:
-                //   normal vector -> eval with smallest absolute value
-                //   evals are sorted in decreasing order
-                a1 = fabs(eval1);
-                a2 = fabs(eval2);
-                a3 = fabs(eval3);
-                if (a1 < a2) {
-                    if (a1 < a3) {
-                        // e1 is normal
-                        kmax = eval2;
-                        kmin = eval3;
-                    } else {
-                        // e3 is normal
-                        kmax = eval1;
-                        kmin = eval2;
+                    for (int i = 0; i < 3; ++i) {
+                        for (int j = 0; j < 3; ++j)
+                            matrix[i][j] = tensor(i, j);
                     }
-                } else {
-                    if (a2 < a3) {
-                        // e2 is normal
-                        kmax = eval1;
-                        kmin = eval3;
+                    // Eigen-decomposition
+                    solver.solve(matrix, EigenSolver<double>::DECREASING);
+                    const double eval1 = solver.eigen_value(0);
+                    const double eval2 = solver.eigen_value(1);
+                    const double eval3 = solver.eigen_value(2);
+
+                    // curvature values:
+                    //   normal vector -> eval with smallest absolute value
+                    //   evals are sorted in decreasing order
+                    const double a1 = fabs(eval1);
+                    const double a2 = fabs(eval2);
+                    const double a3 = fabs(eval3);
+                    if (a1 < a2) {
+                        if (a1 < a3) {
+                            // e1 is normal
+                            kmax = eval2;
+                            kmin = eval3;
+                        } else {
+                            // e3 is normal
+                            kmax = eval1;
+                            kmin = eval2;
+                        }
                     } else {
-                        // e3 is normal
-                        kmax = eval1;
-                        kmin = eval2;
+                        if (a2 < a3) {
+                            // e2 is normal
+                            kmax = eval1;
+                            kmin = eval3;
+                        } else {
+                            // e3 is normal
+                            kmax = eval1;
+                            kmin = eval2;
+                        }
                     }
                 }
-            }
 
-            assert(kmin <= kmax);
+                assert(kmin <= kmax);
 
-            min_curvature_[v] = kmin;
-            max_curvature_[v] = kmax;
+                min_curvature_[v] = kmin;
+                max_curvature_[v] = kmax;
+            }
         }
 
         // clean-up properties
@@ -275,26 +302,38 @@ namespace easy3d {
     //-----------------------------------------------------------------------------
 
     void SurfaceMeshCurvature::smooth_curvatures(unsigned int iterations) {
-        float kmin, kmax;
-        float weight, sum_weights;
+        if (iterations == 0)
+            return;
 
         // properties
         auto vfeature = mesh_->get_vertex_property<bool>("v:feature");
-        auto cotan = mesh_->add_edge_property<double>("curv:cotan");
 
-        // cotan weight per edge
-        for (auto e : mesh_->edges()) {
-            cotan[e] = geom::cotan_weight(mesh_, e);
+        // cotan weight per edge: reuse the weights of the analysis (if available)
+        auto cotan = mesh_->get_edge_property<double>("curv:cotan");
+        const bool own_cotan = !cotan;
+        if (own_cotan) {
+            cotan = mesh_->add_edge_property<double>("curv:cotan");
+            details::compute_cotan_weights(mesh_, cotan);
         }
 
-        for (unsigned int i = 0; i < iterations; ++i) {
-            for (auto v : mesh_->vertices()) {
+        // the smoothed values of an iteration are computed from the values of the previous iteration (Jacobi-style
+        // update), such that all vertices can be processed in parallel
+        auto new_min_curvature = mesh_->add_vertex_property<float>("curv:new-min");
+        auto new_max_curvature = mesh_->add_vertex_property<float>("curv:new-max");
+
+        const int num = static_cast<int>(mesh_->vertices_size());
+        for (unsigned int iter = 0; iter < iterations; ++iter) {
+#pragma omp parallel for
+            for (int i = 0; i < num; ++i) {
+                const SurfaceMesh::Vertex v(i);
+                new_min_curvature[v] = min_curvature_[v];
+                new_max_curvature[v] = max_curvature_[v];
+
                 // don't smooth feature vertices
-                if (vfeature && vfeature[v])
+                if (mesh_->is_deleted(v) || (vfeature && vfeature[v]))
                     continue;
 
-                kmin = kmax = sum_weights = 0.0;
-
+                float kmin = 0.0f, kmax = 0.0f, sum_weights = 0.0f;
                 for (auto vh : mesh_->halfedges(v)) {
                     auto tv = mesh_->target(vh);
 
@@ -302,21 +341,27 @@ namespace easy3d {
                     if (vfeature && vfeature[tv])
                         continue;
 
-                    weight = std::max(0.0, geom::cotan_weight(mesh_, mesh_->edge(vh)));
+                    const float weight = std::max(0.0, cotan[mesh_->edge(vh)]);
                     sum_weights += weight;
                     kmin += weight * min_curvature_[tv];
                     kmax += weight * max_curvature_[tv];
                 }
 
                 if (sum_weights) {
-                    min_curvature_[v] = kmin / sum_weights;
-                    max_curvature_[v] = kmax / sum_weights;
+                    new_min_curvature[v] = kmin / sum_weights;
+                    new_max_curvature[v] = kmax / sum_weights;
                 }
             }
+
+            min_curvature_.vector().swap(new_min_curvature.vector());
+            max_curvature_.vector().swap(new_max_curvature.vector());
         }
 
-        // remove property
-        mesh_->remove_edge_property(cotan);
+        // remove properties
+        mesh_->remove_vertex_property(new_min_curvature);
+        mesh_->remove_vertex_property(new_max_curvature);
+        if (own_cotan)
+            mesh_->remove_edge_property(cotan);
     }
 
     //-----------------------------------------------------------------------------
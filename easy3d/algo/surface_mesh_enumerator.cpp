@@ -10,6 +10,7 @@
 
 
 #include <easy3d/algo/surface_mesh_enumerator.h>
+#include <easy3d/algo/connected_components.h>
 
 #include <stack>
 
@@ -37,16 +38,8 @@ namespace easy3d {
 
 
     int SurfaceMeshEnumerator::enumerate_connected_components(SurfaceMesh *mesh, SurfaceMesh::VertexProperty<int> id) {
-        id.vector().assign(mesh->n_vertices(), -1);
-
-        int cur_id = 0;
-        for (auto v : mesh->vertices()) {
-            if (id[v] == -1) {
-                propagate_connected_component(mesh, id, v, cur_id);
-                ++cur_id;
-            }
-        }
-        return cur_id;
+        // same result as propagating from each unvisited vertex, but in parallel
+        return ConnectedComponents::label(mesh, id);
     }
 
 
@@ -76,17 +69,8 @@ namespace easy3d {
 
 
     int SurfaceMeshEnumerator::enumerate_connected_components(SurfaceMesh *mesh, SurfaceMesh::FaceProperty<int> id) {
-        id.vector().assign(mesh->n_faces(), -1);
-
-        int cur_id = 0;
-        for (auto f : mesh->faces()) {
-            if (id[f] == -1) {
-                propagate_connected_component(mesh, id, f, cur_id);
-                ++cur_id;
-            }
-        }
-
-        return cur_id;
+        // same result as propagating from each unvisited face, but in parallel
+        return ConnectedComponents::label(mesh, id);
     }
 
 
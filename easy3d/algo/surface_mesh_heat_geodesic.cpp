@@ -0,0 +1,328 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/surface_mesh_heat_geodesic.h>
+
+#include <float.h>
+
+#include <Eigen/Sparse>
+
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+    // \cond
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+    using Triplet = Eigen::Triplet<double>;
+
+    class SurfaceMeshHeatGeodesic::Solver {
+    public:
+        // factorization of the heat diffusion system: (M + t * L) u = u0
+        Eigen::SimplicialLDLT<SparseMatrix> heat;
+        // factorization of the Poisson system: L phi = -div(X), with one vertex pinned per connected component
+        Eigen::SimplicialLDLT<SparseMatrix> poisson;
+
+        // Per halfedge h (inside a face): the contribution of the corner vertex target(h) to the gradient of the
+        // face, and the coefficients of the face's vector field X in the divergence at the corner vertex.
+        std::vector<dvec3> gradient;
+        std::vector<dvec3> divergence;
+
+        // the connected component of each vertex (-1 for deleted vertices)
+        std::vector<int> component;
+        // the pinned vertex of each connected component
+        std::vector<int> pinned;
+    };
+    // \endcond
+
+    //-----------------------------------------------------------------------------
+
+    SurfaceMeshHeatGeodesic::SurfaceMeshHeatGeodesic(SurfaceMesh *mesh, float time_factor)
+            : mesh_(mesh) {
+        distance_ = mesh_->vertex_property<float>("v:geodesic:distance");
+
+        if (!mesh_->is_triangle_mesh()) {
+            LOG(ERROR) << "heat geodesic requires a triangle mesh (call triangulate() before)";
+            return;
+        }
+
+        const int num_vertices = static_cast<int>(mesh_->vertices_size());
+        const int num_halfedges = static_cast<int>(mesh_->halfedges_size());
+
+        solver_.reset(new Solver);
+        solver_->gradient.resize(num_halfedges, dvec3(0.0));
+        solver_->divergence.resize(num_halfedges, dvec3(0.0));
+
+        // per-corner operators, lumped mass, and the cotan Laplacian
+        std::vector<double> mass(num_vertices, 0.0);
+        std::vector<Triplet> laplace;
+        laplace.reserve(mesh_->n_faces() * 12);
+        for (auto f : mesh_->faces()) {
+            SurfaceMesh::Halfedge h[3];
+            h[0] = mesh_->halfedge(f);
+            h[1] = mesh_->next(h[0]);
+            h[2] = mesh_->next(h[1]);
+
+            dvec3 p[3];
+            int id[3];
+            for (int i = 0; i < 3; ++i) {
+                const auto v = mesh_->target(h[i]);
+                p[i] = (dvec3) mesh_->position(v);
+                id[i] = v.idx();
+            }
+
+            dvec3 n = cross(p[1] - p[0], p[2] - p[0]);
+            const double double_area = norm(n);
+            if (double_area <= std::numeric_limits<double>::min())
+                continue;   // degenerate face
+            n /= double_area;
+
+            // the cotangent of the angle at each corner
+            double cot[3];
+            for (int i = 0; i < 3; ++i) {
+                const dvec3 d0 = p[(i + 1) % 3] - p[i];
+                const dvec3 d1 = p[(i + 2) % 3] - p[i];
+                cot[i] = dot(d0, d1) / double_area;
+            }
+
+            for (int i = 0; i < 3; ++i) {
+                const int j = (i + 1) % 3;
+                const int k = (i + 2) % 3;
+                // gradient: (N x e_i) / 2A, with e_i the counterclockwise edge opposite to corner i
+                solver_->gradient[h[i].idx()] = cross(n, p[k] - p[j]) / double_area;
+                // divergence: 1/2 * (cot_k * <e_ij, X> + cot_j * <e_ik, X>)
+                solver_->divergence[h[i].idx()] = 0.5 * (cot[k] * (p[j] - p[i]) + cot[j] * (p[k] - p[i]));
+
+                // the edge (j, k) opposite to corner i
+                const double w = 0.5 * cot[i];
+                laplace.emplace_back(id[j], id[k], -w);
+                laplace.emplace_back(id[k], id[j], -w);
+                laplace.emplace_back(id[j], id[j], w);
+                laplace.emplace_back(id[k], id[k], w);
+
+                mass[id[i]] += double_area / 6.0;
+            }
+        }
+
+        // connected components (through edges). Each component has a pinned vertex for the Poisson system.
+        auto &component = solver_->component;
+        component.assign(num_vertices, -1);
+        std::vector<SurfaceMesh::Vertex> stack;
+        for (auto v : mesh_->vertices()) {
+            if (component[v.idx()] != -1)
+                continue;
+            const int id = static_cast<int>(solver_->pinned.size());
+            solver_->pinned.push_back(v.idx());
+            component[v.idx()] = id;
+            stack.push_back(v);
+            while (!stack.empty()) {
+                const auto vv = stack.back();
+                stack.pop_back();
+                for (auto w : mesh_->vertices(vv)) {
+                    if (component[w.idx()] == -1) {
+                        component[w.idx()] = id;
+                        stack.push_back(w);
+                    }
+                }
+            }
+        }
+
+        // the time step: t = time_factor * h^2, where h is the mean edge length
+        double h = 0.0;
+        for (auto e : mesh_->edges())
+            h += mesh_->edge_length(e);
+        h /= std::max(1u, mesh_->n_edges());
+        const double t = time_factor * h * h;
+
+        std::vector<Triplet> heat_triplets, poisson_triplets;
+        heat_triplets.reserve(laplace.size() + num_vertices);
+        poisson_triplets.reserve(laplace.size() + num_vertices);
+        std::vector<bool> is_pinned(num_vertices, false);
+        for (auto id : solver_->pinned)
+            is_pinned[id] = true;
+        for (const auto &tri : laplace) {
+            heat_triplets.emplace_back(tri.row(), tri.col(), t * tri.value());
+            if (!is_pinned[tri.row()] && !is_pinned[tri.col()])
+                poisson_triplets.emplace_back(tri.row(), tri.col(), tri.value());
+        }
+        for (int i = 0; i < num_vertices; ++i) {
+            // isolated (or deleted) vertices have neither mass nor neighbors: keep the systems non-singular
+            heat_triplets.emplace_back(i, i, mass[i] > 0.0 ? mass[i] : 1.0);
+            if (is_pinned[i])
+                poisson_triplets.emplace_back(i, i, 1.0);
+        }
+
+        SparseMatrix A(num_vertices, num_vertices);
+        A.setFromTriplets(heat_triplets.begin(), heat_triplets.end());
+        solver_->heat.compute(A);
+
+        SparseMatrix B(num_vertices, num_vertices);
+        B.setFromTriplets(poisson_triplets.begin(), poisson_triplets.end());
+        solver_->poisson.compute(B);
+
+        if (solver_->heat.info() != Eigen::Success || solver_->poisson.info() != Eigen::Success) {
+            LOG(ERROR) << "heat geodesic: failed to factorize the linear systems";
+            solver_.reset();
+        }
+    }
+
+    //-----------------------------------------------------------------------------
+
+    // defined here, where Solver is complete
+    SurfaceMeshHeatGeodesic::~SurfaceMeshHeatGeodesic() = default;
+
+    //-----------------------------------------------------------------------------
+
+    bool SurfaceMeshHeatGeodesic::compute(const std::vector<SurfaceMesh::Vertex> &seed) {
+        if (!solver_)
+            return false;
+
+        std::vector<float> dist;
+        if (!solve(seed, dist))
+            return false;
+
+        distance_.vector() = dist;
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    bool SurfaceMeshHeatGeodesic::compute(const std::vector<std::vector<SurfaceMesh::Vertex> > &seeds,
+                                          std::vector<std::vector<float> > &distances) const {
+        if (!solver_)
+            return false;
+
+        distances.resize(seeds.size());
+        const int num = static_cast<int>(seeds.size());
+        bool success = true;
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < num; ++i) {
+            if (!solve(seeds[i], distances[i])) {
+#pragma omp critical
+                success = false;
+            }
+        }
+        return success;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    bool SurfaceMeshHeatGeodesic::solve(const std::vector<SurfaceMesh::Vertex> &seed, std::vector<float> &dist) const {
+        const int num_vertices = static_cast<int>(mesh_->vertices_size());
+        const int num_faces = static_cast<int>(mesh_->faces_size());
+        const auto &component = solver_->component;
+
+        dist.assign(num_vertices, FLT_MAX);
+
+        // step 1: heat diffusion from the seeds
+        Eigen::VectorXd u0 = Eigen::VectorXd::Zero(num_vertices);
+        std::vector<bool> has_seed(solver_->pinned.size(), false);
+        for (auto v : seed) {
+            if (!mesh_->is_valid(v) || component[v.idx()] == -1)
+                continue;
+            u0[v.idx()] = 1.0;
+            has_seed[component[v.idx()]] = true;
+        }
+        const Eigen::VectorXd u = solver_->heat.solve(u0);
+        if (solver_->heat.info() != Eigen::Success)
+            return false;
+
+        // step 2: the normalized (negated) gradient of the heat per face
+        std::vector<dvec3> field(num_faces, dvec3(0.0));
+#pragma omp parallel for
+        for (int i = 0; i < num_faces; ++i) {
+            const SurfaceMesh::Face f(i);
+            if (mesh_->is_deleted(f))
+                continue;
+            dvec3 grad(0.0);
+            for (auto h : mesh_->halfedges(f))
+                grad += u[mesh_->target(h).idx()] * solver_->gradient[h.idx()];
+            const double len = norm(grad);
+            if (len > std::numeric_limits<double>::min())
+                field[i] = -grad / len;
+        }
+
+        // step 3: the divergence of the vector field per vertex
+        Eigen::VectorXd div = Eigen::VectorXd::Zero(num_vertices);
+#pragma omp parallel for
+        for (int i = 0; i < num_vertices; ++i) {
+            const SurfaceMesh::Vertex v(i);
+            if (mesh_->is_deleted(v) || mesh_->is_isolated(v))
+                continue;
+            double d = 0.0;
+            for (auto h : mesh_->halfedges(v)) {
+                const auto f = mesh_->face(h);
+                if (f.is_valid())   // the incoming halfedge prev(h) is inside face f
+                    d += dot(solver_->divergence[mesh_->prev(h).idx()], field[f.idx()]);
+            }
+            div[i] = -d;
+        }
+        for (auto id : solver_->pinned)
+            div[id] = 0.0;
+
+        // step 4: recover the distances such that their gradient matches the vector field
+        const Eigen::VectorXd phi = solver_->poisson.solve(div);
+        if (solver_->poisson.info() != Eigen::Success)
+            return false;
+
+        // shift the distances of each component such that the (closest) seed has zero distance
+        std::vector<double> offset(solver_->pinned.size(), DBL_MAX);
+        for (auto v : seed) {
+            if (!mesh_->is_valid(v) || component[v.idx()] == -1)
+                continue;
+            double &o = offset[component[v.idx()]];
+            o = std::min(o, phi[v.idx()]);
+        }
+        for (int i = 0; i < num_vertices; ++i) {
+            const int c = component[i];
+            if (c != -1 && has_seed[c])
+                dist[i] = static_cast<float>(std::max(0.0, phi[i] - offset[c]));
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+
+    void SurfaceMeshHeatGeodesic::distance_to_texture_coordinates() {
+        // find maximum distance
+        float maxdist(0);
+        for (auto v : mesh_->vertices()) {
+            if (distance_[v] < FLT_MAX) {
+                maxdist = std::max(maxdist, distance_[v]);
+            }
+        }
+
+        auto tex = mesh_->vertex_property<vec2>("v:texcoord");
+        for (auto v : mesh_->vertices()) {
+            if (distance_[v] < FLT_MAX) {
+                tex[v] = vec2(distance_[v] / maxdist, 0.0);
+            } else {
+                tex[v] = vec2(1.0, 0.0);
+            }
+        }
+    }
+
+} // namespace easy3d
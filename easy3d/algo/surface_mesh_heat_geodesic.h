@@ -0,0 +1,110 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_SURFACE_MESH_HEAT_GEODESIC_H
+#define EASY3D_ALGO_SURFACE_MESH_HEAT_GEODESIC_H
+
+#include <easy3d/core/surface_mesh.h>
+#include <memory>
+#include <vector>
+
+
+namespace easy3d {
+
+    /**
+     * \brief This class computes geodesic distance from a set of seed vertices using the heat method.
+     * \class SurfaceMeshHeatGeodesic easy3d/algo/surface_mesh_heat_geodesic.h
+     * \details The two linear systems of the heat method (i.e., heat diffusion and Poisson) are factorized once on
+     * construction. Each query for a new set of seed vertices then only requires two back-substitutions, which makes
+     * this class an alternative to SurfaceMeshGeodesic when geodesic distances are repeatedly queried on the same
+     * mesh. Multiple sets of seeds can also be answered in a batch (in parallel). See the following paper for more
+     * details:
+     *  - Keenan Crane et al. Geodesics in heat: A new approach to computing distance based on heat flow.
+     *    ACM Transactions on Graphics, 32(5), 2013.
+     * \note The mesh must be a triangle mesh. Boundaries are handled with Neumann conditions. The distances computed
+     *      by the heat method are approximate (the accuracy is comparable to fast marching).
+     */
+    class SurfaceMeshHeatGeodesic {
+    public:
+        //! \brief Construct from mesh and factorize the linear systems.
+        //! \param mesh The mesh on which to compute the geodesic distances.
+        //! \param time_factor The time step of heat diffusion is \p time_factor * h^2, where h is the mean edge
+        //!     length. Larger values result in smoother (but less accurate) distances. Default: 1.
+        //! \note The geometry of the mesh is captured on construction. Construct a new instance if the mesh changes.
+        SurfaceMeshHeatGeodesic(SurfaceMesh *mesh, float time_factor = 1.0f);
+
+        // destructor
+        ~SurfaceMeshHeatGeodesic();
+
+        // the factorized systems are bound to the mesh and owned by this instance, so it can not be copied
+        SurfaceMeshHeatGeodesic(const SurfaceMeshHeatGeodesic &) = delete;
+        SurfaceMeshHeatGeodesic &operator=(const SurfaceMeshHeatGeodesic &) = delete;
+
+        //! \brief Compute geodesic distances from specified seed vertices.
+        //! \details The results are stored as SurfaceMesh::VertexProperty<float> with a name "v:geodesic:distance"
+        //!     (same as SurfaceMeshGeodesic). Vertices that cannot be reached from any seed have a distance FLT_MAX.
+        //! \param[in] seed The vector of seed vertices.
+        //! \return \c true on success.
+        bool compute(const std::vector<SurfaceMesh::Vertex> &seed);
+
+        //! \brief Compute geodesic distances for a batch of seed sets (in parallel).
+        //! \details This function does not modify the mesh, i.e., the results are returned in \p distances.
+        //! \param[in] seeds The seed sets. Each seed set is a multi-source query.
+        //! \param[out] distances The geodesic distances of all vertices (indexed by the vertex index) for each
+        //!     seed set.
+        //! \return \c true on success.
+        bool compute(const std::vector< std::vector<SurfaceMesh::Vertex> > &seeds,
+                     std::vector< std::vector<float> > &distances) const;
+
+        //! \brief Access the computed geodesic distance.
+        //! \param[in] v The vertex for which to return the geodesic distance.
+        //! \return The geodesic distance of vertex \p v.
+        //! \pre The function compute() has been called before.
+        float operator()(SurfaceMesh::Vertex v) const { return distance_[v]; }
+
+        //! \brief Use the normalized distances as texture coordinates
+        //! \details Stores the normalized distances in a vertex property of type
+        //! TexCoord named "v:texcoord". Re-uses any existing vertex property of the
+        //! same type and name.
+        void distance_to_texture_coordinates();
+
+    private:
+        // compute the distances from a single seed set into 'dist' (thread-safe)
+        bool solve(const std::vector<SurfaceMesh::Vertex> &seed, std::vector<float> &dist) const;
+
+    private:
+        SurfaceMesh *mesh_;
+        SurfaceMesh::VertexProperty<float> distance_;
+
+        // the factorized systems and the precomputed per-corner operators (hidden from the interface)
+        class Solver;
+        std::unique_ptr<Solver> solver_;
+    };
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_ALGO_SURFACE_MESH_HEAT_GEODESIC_H
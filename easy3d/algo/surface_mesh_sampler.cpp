@@ -25,6 +25,11 @@
  ********************************************************************/
 
 #include <easy3d/algo/surface_mesh_sampler.h>
+
+#include <random>
+#include <unordered_map>
+#include <algorithm>
+
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/util/file_system.h>
@@ -34,9 +39,115 @@
 
 namespace easy3d {
 
+    namespace details {
+
+        // number of triangles processed by a random number stream
+        const std::size_t chunk_size = 4096;
+
+        struct Triangle {
+            SurfaceMesh::Vertex vertices[3];
+            SurfaceMesh::Face face;
+        };
+
+        // Collects all triangles (faces are fan-triangulated) and the accumulated areas, i.e., accumulated_areas[i]
+        // is the total area of the first i triangles.
+        void collect_triangles(const SurfaceMesh *mesh, std::vector<Triangle> &triangles,
+                               std::vector<double> &accumulated_areas) {
+            auto mesh_points = mesh->get_vertex_property<vec3>("v:point");
+            triangles.clear();
+            triangles.reserve(mesh->n_faces());
+            accumulated_areas.clear();
+            accumulated_areas.reserve(mesh->n_faces() + 1);
+            accumulated_areas.push_back(0.0);
+            for (auto f : mesh->faces()) {
+                SurfaceMesh::Halfedge start = mesh->halfedge(f);
+                SurfaceMesh::Halfedge cur = mesh->next(mesh->next(start));
+                SurfaceMesh::Vertex va = mesh->target(start);
+                while (cur != start) {
+                    Triangle tri;
+                    tri.vertices[0] = va;
+                    tri.vertices[1] = mesh->source(cur);
+                    tri.vertices[2] = mesh->target(cur);
+                    tri.face = f;
+                    triangles.push_back(tri);
+                    const float area = geom::triangle_area(mesh_points[tri.vertices[0]], mesh_points[tri.vertices[1]],
+                                                           mesh_points[tri.vertices[2]]);
+                    accumulated_areas.push_back(accumulated_areas.back() + area);
+                    cur = mesh->next(cur);
+                }
+            }
+        }
+
+        // Distributes 'num' samples over the triangles w.r.t. their areas. The samples of triangle i are in the range
+        // [offsets[i], offsets[i+1]). The accumulated rounding error is carried over, so the total is exactly 'num'.
+        void distribute_samples(const std::vector<double> &accumulated_areas, std::size_t num,
+                                std::vector<std::size_t> &offsets) {
+            const std::size_t n = accumulated_areas.size();
+            offsets.resize(n);
+            const double density = num / accumulated_areas.back();
+            for (std::size_t i = 0; i < n; ++i)
+                offsets[i] = std::min(num, static_cast<std::size_t>(accumulated_areas[i] * density));
+            offsets[n - 1] = num;
+        }
+
+        // The random number stream of a chunk. Seeding by the chunk index (instead of the thread index) makes the
+        // result independent of the number of threads.
+        inline std::mt19937 chunk_generator(unsigned int seed, std::size_t chunk) {
+            std::seed_seq seq{seed, static_cast<unsigned int>(chunk), static_cast<unsigned int>(chunk >> 32)};
+            return std::mt19937(seq);
+        }
+
+        // Generates the samples of the triangles in [offsets[0], offsets.back()), in parallel. The samples are written
+        // into 'points' at index 'first + k' (k being the sample index) and 'triangle_of(k, t)' is called to record
+        // the triangle of each sample.
+        template<typename Func>
+        bool generate_samples(const SurfaceMesh *mesh, const std::vector<Triangle> &triangles,
+                              const std::vector<std::size_t> &offsets, unsigned int seed,
+                              std::vector<vec3> &points, std::size_t first, Func triangle_of) {
+            auto mesh_points = mesh->get_vertex_property<vec3>("v:point");
+
+            const std::size_t num_chunks = (triangles.size() + chunk_size - 1) / chunk_size;
+            // chunks are processed in blocks, such that the progress is reported (and cancellation is checked) by the
+            // calling thread only
+            const std::size_t block_size = 256;
+            ProgressLogger progress(num_chunks, false, false);
+            for (std::size_t block = 0; block < num_chunks; block += block_size) {
+                if (progress.is_canceled())
+                    return false;
+
+                const int block_end = static_cast<int>(std::min(num_chunks, block + block_size));
+#pragma omp parallel for schedule(dynamic)
+                for (int chunk = static_cast<int>(block); chunk < block_end; ++chunk) {
+                    std::mt19937 rng = chunk_generator(seed, chunk);
+                    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+                    const std::size_t tri_end = std::min(triangles.size(), (chunk + 1) * chunk_size);
+                    for (std::size_t t = chunk * chunk_size; t < tri_end; ++t) {
+                        const Triangle &tri = triangles[t];
+                        const vec3 &a = mesh_points[tri.vertices[0]];
+                        const vec3 &b = mesh_points[tri.vertices[1]];
+                        const vec3 &c = mesh_points[tri.vertices[2]];
+                        for (std::size_t k = offsets[t]; k < offsets[t + 1]; ++k) {
+                            // compute barycentric coords
+                            const double s = std::sqrt(uniform(rng));
+                            const double r = uniform(rng);
+                            points[first + k] = static_cast<float>(1.0 - s) * a
+                                                + static_cast<float>(s * (1.0 - r)) * b
+                                                + static_cast<float>(s * r) * c;
+                            triangle_of(k, t);
+                        }
+                    }
+                }
+                progress.notify(block_end);
+            }
+            return true;
+        }
+
+    }
+
 
     PointCloud *SurfaceMeshSampler::apply(const SurfaceMesh *input_mesh, int expected_num /* = 1000000 */) {
-        auto func = [](const SurfaceMesh *mesh, int num) -> PointCloud * {
+        auto func = [this](const SurfaceMesh *mesh, int num) -> PointCloud * {
             PointCloud *cloud = new PointCloud;
             const std::string &name = file_system::name_less_extension(mesh->name()) + "_sampled.ply";
             cloud->set_name(name);
@@ -67,92 +178,32 @@ namespace easy3d {
             if (num_needed <= 0)
                 return cloud;   // we got enough points already
 
-            // collect triangles and compute their areas
-            struct Triangle : std::vector<SurfaceMesh::Vertex> {
-            };
+            // collect triangles and distribute the samples w.r.t. their areas
+            std::vector<details::Triangle> triangles;
+            std::vector<double> accumulated_areas;
+            details::collect_triangles(mesh, triangles, accumulated_areas);
+            if (triangles.empty() || accumulated_areas.back() <= 0.0)
+                return cloud;
 
-            std::vector<Triangle> triangles;
-            std::vector<float> triangle_areas;
-            std::vector<vec3> triangle_normals;
+            std::vector<std::size_t> offsets;
+            details::distribute_samples(accumulated_areas, num_needed, offsets);
 
+            // generate the points directly into the property arrays
+            const std::size_t first = cloud->n_vertices();
+            cloud->resize(static_cast<unsigned int>(first + num_needed));
+            auto &points = cloud->get_vertex_property<vec3>("v:point").vector();
+            auto &cloud_normals = normals.vector();
             auto mesh_face_normals = mesh->get_face_property<vec3>("f:normal");
-            float surface_area = 0.0f;
-            for (auto f : mesh->faces()) {
-                const vec3 &n = mesh_face_normals[f];
-                SurfaceMesh::Halfedge start = mesh->halfedge(f);
-                SurfaceMesh::Halfedge cur = mesh->next(mesh->next(start));
-                SurfaceMesh::Vertex va = mesh->target(start);
-                while (cur != start) {
-                    SurfaceMesh::Vertex vb = mesh->source(cur);
-                    SurfaceMesh::Vertex vc = mesh->target(cur);
-
-                    Triangle tri;
-                    tri.push_back(va);
-                    tri.push_back(vb);
-                    tri.push_back(vc);
-                    triangles.push_back(tri);
-                    float area = geom::triangle_area(mesh_points[va], mesh_points[vb], mesh_points[vc]);
-                    triangle_areas.push_back(area);
-                    triangle_normals.push_back(n);
-                    surface_area += area;
-
-                    cur = mesh->next(cur);
-                }
-            }
-
-            float density = num_needed / surface_area;
-            float samples_error = 0.0;
-            std::size_t triangle_num = triangles.size();
-            std::size_t num_generated = 0;
-            std::size_t triangles_done = 0;
-            ProgressLogger progress(triangle_num, false, false);
-            for (std::size_t idx = 0; idx < triangle_num; ++idx) {
-                if (progress.is_canceled()) {
-                    LOG(WARNING) << "sampling surface mesh cancelled";
-                    delete cloud;
-                    return nullptr;
-                }
-
-                const Triangle &tri = triangles[idx];
-                const vec3 &n = triangle_normals[idx];
-
-                // samples number considering the facet size (i.e., area)
-                float samples_num = triangle_areas[idx] * density;
-                std::size_t quant_samples_num = (std::size_t) samples_num;
-
-                // adjust w.r.t. accumulated error
-                samples_error += samples_num - quant_samples_num;
-                if (samples_error > 1.0) {
-                    samples_error -= 1.0;
-                    quant_samples_num++;
-                }
-
-                if (triangles_done ==
-                    triangle_num - 1)        // override number to gather all remaining points if last facet
-                    quant_samples_num = num_needed - num_generated;
-
-                // generate points
-                for (unsigned int j = 0; j < quant_samples_num; j++) {
-                    // compute barycentric coords
-                    double s = sqrt((double) rand() / (double) RAND_MAX);
-                    double t = (double) rand() / (double) RAND_MAX;
-                    double c[3];
-
-                    c[0] = 1.0 - s;
-                    c[1] = s * (1.0 - t);
-                    c[2] = s * t;
-
-                    vec3 p;
-                    for (std::size_t i = 0; i < 3; i++)
-                        p = p + c[i] * mesh_points[tri[i]];
-
-                    PointCloud::Vertex v = cloud->add_vertex(p);
-                    normals[v] = n;
-                }
-
-                num_generated += quant_samples_num;
-                triangles_done++;
-                progress.next();
+            const bool success = details::generate_samples(
+                    mesh, triangles, offsets, seed_, points, first,
+                    [&](std::size_t k, std::size_t t) {
+                        cloud_normals[first + k] = mesh_face_normals[triangles[t].face];
+                    }
+            );
+            if (!success) {
+                LOG(WARNING) << "sampling surface mesh cancelled";
+                delete cloud;
+                return nullptr;
             }
 
             LOG(INFO) << "done. resulted point cloud has " << cloud->n_vertices() << " points";
@@ -171,4 +222,164 @@ namespace easy3d {
         }
     }
 
+
+    PointCloud *SurfaceMeshSampler::apply_poisson_disk(const SurfaceMesh *mesh, int num /* = 1000000 */) {
+        if (num <= 0)
+            return nullptr;
+
+        LOG(INFO) << "sampling surface (Poisson disk)...";
+
+        std::vector<details::Triangle> triangles;
+        std::vector<double> accumulated_areas;
+        details::collect_triangles(mesh, triangles, accumulated_areas);
+        if (triangles.empty() || accumulated_areas.back() <= 0.0) {
+            LOG(WARNING) << "the surface mesh has no (non-degenerate) faces";
+            return nullptr;
+        }
+
+        // The radius is estimated from the surface area. With the oversampling below, each accepted sample roughly
+        // covers an area of ~1.9 * r^2 (a maximal Poisson-disk sampling would be ~1.44 * r^2).
+        const double area = accumulated_areas.back();
+        const float radius = static_cast<float>(std::sqrt(area / (1.9 * num)));
+        const float sqr_radius = radius * radius;
+
+        // step 1: generate the candidates (random, area-weighted)
+        const std::size_t oversampling = 4;
+        const std::size_t num_candidates = oversampling * static_cast<std::size_t>(num);
+        std::vector<std::size_t> offsets;
+        details::distribute_samples(accumulated_areas, num_candidates, offsets);
+
+        std::vector<vec3> candidates(num_candidates);
+        std::vector<uint32_t> candidate_triangles(num_candidates);    // bounded by the number of halfedges
+        const bool success = details::generate_samples(
+                mesh, triangles, offsets, seed_, candidates, 0,
+                [&](std::size_t k, std::size_t t) { candidate_triangles[k] = static_cast<uint32_t>(t); }
+        );
+        if (!success) {
+            LOG(WARNING) << "sampling surface mesh cancelled";
+            return nullptr;
+        }
+
+        // step 2: hash the candidates into grid cells. The cell size is the radius, enlarged (for very elongated
+        // models) until the linear cell index fits in 62 bits. Any cell size >= radius works for the tests below.
+        const vec3 &origin = mesh->bounding_box().min_point();
+        const vec3 extent = mesh->bounding_box().diagonal_vector();
+        double cell_size = radius;
+        int64_t nx, ny, nz;
+        while (true) {
+            const double dx = std::floor(extent.x / cell_size) + 1.0;
+            const double dy = std::floor(extent.y / cell_size) + 1.0;
+            const double dz = std::floor(extent.z / cell_size) + 1.0;
+            if (dx * dy * dz < 4.0e18) {
+                nx = static_cast<int64_t>(dx);
+                ny = static_cast<int64_t>(dy);
+                nz = static_cast<int64_t>(dz);
+                break;
+            }
+            cell_size *= 2.0;
+        }
+        auto cell_coords = [&](const vec3 &p, int64_t &ix, int64_t &iy, int64_t &iz) {
+            ix = std::min<int64_t>(nx - 1, std::max<int64_t>(0, static_cast<int64_t>((p.x - origin.x) / cell_size)));
+            iy = std::min<int64_t>(ny - 1, std::max<int64_t>(0, static_cast<int64_t>((p.y - origin.y) / cell_size)));
+            iz = std::min<int64_t>(nz - 1, std::max<int64_t>(0, static_cast<int64_t>((p.z - origin.z) / cell_size)));
+        };
+        auto cell_key = [&](int64_t ix, int64_t iy, int64_t iz) -> uint64_t {
+            return (static_cast<uint64_t>(ix) * ny + static_cast<uint64_t>(iy)) * nz + static_cast<uint64_t>(iz);
+        };
+
+        // (cell key, candidate index), sorted by the cell and then by a scrambled candidate index. The scrambling
+        // (a bijection of the 64-bit indices) randomizes the order in which the candidates of a cell are tested.
+        struct Item {
+            uint64_t key;
+            uint64_t index;
+            uint64_t order() const { return index * 0x9E3779B97F4A7C15ull; }
+            bool operator<(const Item &other) const {
+                return key < other.key || (key == other.key && order() < other.order());
+            }
+        };
+        std::vector<Item> items(num_candidates);
+#pragma omp parallel for
+        for (int64_t i = 0; i < static_cast<int64_t>(num_candidates); ++i) {
+            int64_t ix, iy, iz;
+            cell_coords(candidates[i], ix, iy, iz);
+            items[i].key = cell_key(ix, iy, iz);
+            items[i].index = static_cast<uint64_t>(i);
+        }
+        std::sort(items.begin(), items.end());
+
+        // the non-empty cells: each cell is a range of the sorted items
+        std::vector<std::size_t> cell_starts;
+        std::unordered_map<uint64_t, std::size_t> cell_of_key;
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            if (i == 0 || items[i].key != items[i - 1].key) {
+                cell_of_key[items[i].key] = cell_starts.size();
+                cell_starts.push_back(i);
+            }
+        }
+        const std::size_t num_cells = cell_starts.size();
+        cell_starts.push_back(items.size());
+
+        // step 3: dart throwing. Cells in the same group (i.e., same coordinates modulo 3) are at least three cells
+        // apart, so their neighborhoods do not overlap and they can be processed in parallel. Processing the groups
+        // in a fixed order makes the result deterministic.
+        std::vector<std::vector<std::size_t> > groups(27);
+        for (std::size_t c = 0; c < num_cells; ++c) {
+            const vec3 &p = candidates[items[cell_starts[c]].index];
+            int64_t ix, iy, iz;
+            cell_coords(p, ix, iy, iz);
+            groups[(ix % 3) * 9 + (iy % 3) * 3 + (iz % 3)].push_back(c);
+        }
+
+        std::vector<char> accepted(items.size(), 0);
+        for (const auto &group : groups) {
+            const int group_size = static_cast<int>(group.size());
+#pragma omp parallel for schedule(dynamic, 64)
+            for (int g = 0; g < group_size; ++g) {
+                const std::size_t c = group[g];
+                int64_t ix, iy, iz;
+                cell_coords(candidates[items[cell_starts[c]].index], ix, iy, iz);
+                for (std::size_t i = cell_starts[c]; i < cell_starts[c + 1]; ++i) {
+                    const vec3 &p = candidates[items[i].index];
+                    bool conflict = false;
+                    for (int64_t x = std::max<int64_t>(0, ix - 1); x <= ix + 1 && x < nx && !conflict; ++x) {
+                        for (int64_t y = std::max<int64_t>(0, iy - 1); y <= iy + 1 && y < ny && !conflict; ++y) {
+                            for (int64_t z = std::max<int64_t>(0, iz - 1); z <= iz + 1 && z < nz && !conflict; ++z) {
+                                const auto pos = cell_of_key.find(cell_key(x, y, z));
+                                if (pos == cell_of_key.end())
+                                    continue;
+                                for (std::size_t j = cell_starts[pos->second]; j < cell_starts[pos->second + 1]; ++j) {
+                                    if (accepted[j] && distance2(p, candidates[items[j].index]) < sqr_radius) {
+                                        conflict = true;
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    if (!conflict)
+                        accepted[i] = 1;
+                }
+            }
+        }
+
+        // step 4: collect the accepted candidates
+        const_cast<SurfaceMesh *>(mesh)->update_face_normals();
+        auto mesh_face_normals = mesh->get_face_property<vec3>("f:normal");
+
+        PointCloud *cloud = new PointCloud;
+        const std::string &name = file_system::name_less_extension(mesh->name()) + "_sampled.ply";
+        cloud->set_name(name);
+        auto normals = cloud->add_vertex_property<vec3>("v:normal");
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            if (accepted[i]) {
+                const uint64_t idx = items[i].index;
+                PointCloud::Vertex v = cloud->add_vertex(candidates[idx]);
+                normals[v] = mesh_face_normals[triangles[candidate_triangles[idx]].face];
+            }
+        }
+
+        LOG(INFO) << "done. resulted point cloud has " << cloud->n_vertices() << " points (radius: " << radius << ")";
+        return cloud;
+    }
+
 }
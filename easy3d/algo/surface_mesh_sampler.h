@@ -35,10 +35,31 @@ namespace easy3d {
 
     /// \brief Sample a surface mesh (near uniformly) into a point cloud.
     /// \class SurfaceMeshSampler easy3d/algo/surface_mesh_sampler.h
+    /// \details The samples are distributed over the triangles w.r.t. their areas and generated in parallel. Each
+    ///     chunk of triangles has its own random number stream (derived from the seed), so the result only depends
+    ///     on the seed (not on the number of threads).
     class SurfaceMeshSampler {
     public:
+        SurfaceMeshSampler() : seed_(0) {}
+
+        /// @brief Sets the seed of the random number generators. Default: 0.
+        void set_seed(unsigned int seed) { seed_ = seed; }
+
+        /// @brief Random (area-weighted) sampling. The vertices of the mesh are included in the result.
         /// @param num The expected point number, must be greater than the number of vertices of the surface mesh.
         PointCloud *apply(const SurfaceMesh *mesh, int num = 1000000);
+
+        /// @brief Poisson-disk (i.e., blue noise) sampling. No two samples are closer than a radius, which is
+        ///     estimated from the expected number of points. The vertices of the mesh are not included in the result.
+        /// @param num The expected point number. The number of the resulted points is close to (but not exactly)
+        ///     \p num.
+        /// @details Candidates are generated by random sampling and then accepted/rejected using a spatial hash
+        ///     grid with the cell size (at least) equal to the radius. Cells more than two cells apart cannot
+        ///     conflict, so the cells are processed in 27 interleaved groups, each in parallel.
+        PointCloud *apply_poisson_disk(const SurfaceMesh *mesh, int num = 1000000);
+
+    private:
+        unsigned int seed_;
     };
 
 } // namespace easy3d
@@ -0,0 +1,394 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/surface_mesh_sdf.h>
+#include <easy3d/algo/surface_mesh_winding_number.h>
+#include <easy3d/algo/triangle_mesh_kdtree.h>
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/util/logging.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        typedef std::array<int, 3> BlockCoord;
+
+        // The triangles (fans of the faces) of a mesh, three points each
+        std::vector<vec3> collect_triangles(const SurfaceMesh *mesh) {
+            std::vector<vec3> points;
+            for (auto f : mesh->faces()) {
+                const auto h0 = mesh->halfedge(f);
+                const vec3 &p0 = mesh->position(mesh->source(h0));
+                for (auto h = mesh->next(h0); mesh->target(h) != mesh->source(h0); h = mesh->next(h)) {
+                    points.push_back(p0);
+                    points.push_back(mesh->position(mesh->source(h)));
+                    points.push_back(mesh->position(mesh->target(h)));
+                }
+            }
+            return points;
+        }
+
+        // The pairs of (block, triangle), such that the grid points of the block (of a grid with the given origin
+        // and voxel size) may be within 'distance' to the triangle. The result is sorted by the blocks.
+        std::vector<std::pair<BlockCoord, int> > block_triangles(const std::vector<vec3> &points, const vec3 &origin,
+                                                                 float voxel_size, float distance) {
+            const int bs = SparseGrid<float>::block_size;
+            const float half = 0.5f * (bs - 1);   // the center of a block in its local grid coordinates
+            // a block is needed if its center is within this distance to a triangle
+            const float radius = distance + half * voxel_size * std::sqrt(3.0f);
+
+            const int num = static_cast<int>(points.size() / 3);
+            const int chunk_size = 4096;
+            const int num_chunks = (num + chunk_size - 1) / chunk_size;
+            std::vector<std::vector<std::pair<BlockCoord, int> > > chunk_pairs(num_chunks);
+#pragma omp parallel for schedule(dynamic)
+            for (int c = 0; c < num_chunks; ++c) {
+                auto &pairs = chunk_pairs[c];
+                const int end = std::min(num, (c + 1) * chunk_size);
+                for (int t = c * chunk_size; t < end; ++t) {
+                    const vec3 &a = points[3 * t], &b = points[3 * t + 1], &p = points[3 * t + 2];
+                    int lo[3], hi[3];
+                    for (int k = 0; k < 3; ++k) {
+                        const float tmin = std::min(a[k], std::min(b[k], p[k])) - radius;
+                        const float tmax = std::max(a[k], std::max(b[k], p[k])) + radius;
+                        lo[k] = static_cast<int>(std::ceil(((tmin - origin[k]) / voxel_size - half) / bs));
+                        hi[k] = static_cast<int>(std::floor(((tmax - origin[k]) / voxel_size - half) / bs));
+                    }
+                    vec3 nearest;
+                    for (int x = lo[0]; x <= hi[0]; ++x) {
+                        for (int y = lo[1]; y <= hi[1]; ++y) {
+                            for (int z = lo[2]; z <= hi[2]; ++z) {
+                                const vec3 center = origin + vec3(x * bs + half, y * bs + half, z * bs + half) * voxel_size;
+                                if (geom::dist_point_triangle(center, a, b, p, nearest) <= radius)
+                                    pairs.push_back(std::make_pair(BlockCoord{x, y, z}, t));
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::vector<std::pair<BlockCoord, int> > pairs;
+            for (const auto &cp : chunk_pairs)
+                pairs.insert(pairs.end(), cp.begin(), cp.end());
+            std::sort(pairs.begin(), pairs.end());
+            return pairs;
+        }
+
+
+        // The angle-weighted pseudo-normals of the faces, edges, and vertices of a triangle mesh, using the method
+        // described in
+        //      J. A. Baerentzen and H. Aanaes. Signed Distance Computation Using the Angle Weighted Pseudonormal.
+        //      IEEE Transactions on Visualization and Computer Graphics, 11(3):243-253, 2005.
+        class PseudoNormals {
+        public:
+            explicit PseudoNormals(const SurfaceMesh *mesh) : mesh_(mesh) {
+                face_normals_.assign(mesh->faces_size(), dvec3(0, 0, 0));
+                edge_normals_.assign(mesh->edges_size(), dvec3(0, 0, 0));
+                vertex_normals_.assign(mesh->vertices_size(), dvec3(0, 0, 0));
+                for (auto f : mesh->faces()) {
+                    auto h = mesh->halfedge(f);
+                    const dvec3 a(mesh->position(mesh->source(h)));
+                    const dvec3 b(mesh->position(mesh->target(h)));
+                    const dvec3 c(mesh->position(mesh->target(mesh->next(h))));
+                    dvec3 n = cross(b - a, c - a);
+                    const double len = length(n);
+                    if (len > 0.0)
+                        n /= len;
+                    face_normals_[f.idx()] = n;
+                    for (auto fh : mesh->halfedges(f)) {
+                        edge_normals_[mesh->edge(fh).idx()] += n;
+                        // the angle at the target of fh
+                        const dvec3 p(mesh->position(mesh->target(fh)));
+                        const dvec3 d0 = dvec3(mesh->position(mesh->source(fh))) - p;
+                        const dvec3 d1 = dvec3(mesh->position(mesh->target(mesh->next(fh)))) - p;
+                        const double angle = std::atan2(length(cross(d0, d1)), dot(d0, d1));
+                        vertex_normals_[mesh->target(fh).idx()] += n * angle;
+                    }
+                }
+            }
+
+            // the pseudo-normal at point q on face f
+            const dvec3 &normal(SurfaceMesh::Face f, const dvec3 &q) const {
+                SurfaceMesh::Halfedge hs[3];
+                int k = 0;
+                for (auto h : mesh_->halfedges(f))
+                    hs[k++] = h;
+                // the barycentric coordinates of q w.r.t. the sources of the halfedges
+                dvec3 p[3];
+                for (int i = 0; i < 3; ++i)
+                    p[i] = dvec3(mesh_->position(mesh_->source(hs[i])));
+                const dvec3 n = cross(p[1] - p[0], p[2] - p[0]);
+                const double area = dot(n, n);
+                if (area <= 0.0)
+                    return face_normals_[f.idx()];
+                double w[3];
+                for (int i = 0; i < 3; ++i)
+                    w[i] = dot(cross(p[(i + 2) % 3] - p[(i + 1) % 3], q - p[(i + 1) % 3]), n) / area;
+
+                const double epsilon = 1e-5;
+                int num_zeros = 0, last_nonzero = -1, last_zero = -1;
+                for (int i = 0; i < 3; ++i) {
+                    if (w[i] < epsilon) {
+                        ++num_zeros;
+                        last_zero = i;
+                    } else
+                        last_nonzero = i;
+                }
+                if (num_zeros >= 2 && last_nonzero >= 0)      // at a vertex
+                    return vertex_normals_[mesh_->source(hs[last_nonzero]).idx()];
+                else if (num_zeros == 1)                    // on the edge opposite to the vertex
+                    return edge_normals_[mesh_->edge(hs[(last_zero + 1) % 3]).idx()];
+                return face_normals_[f.idx()];
+            }
+
+        private:
+            const SurfaceMesh *mesh_;
+            std::vector<dvec3> face_normals_;
+            std::vector<dvec3> edge_normals_;
+            std::vector<dvec3> vertex_normals_;
+        };
+
+    }
+
+
+    SparseGrid<float> SurfaceMeshSDF::signed_distance(const SurfaceMesh *mesh, float voxel_size, float band_width,
+                                                      SignMethod method) {
+        const Box3 &box = mesh->bounding_box();
+        const vec3 origin = box.min_point() - vec3(band_width, band_width, band_width);
+        SparseGrid<float> grid(origin, voxel_size, band_width);
+        if (!mesh->is_triangle_mesh()) {
+            LOG(WARNING) << "signed distance fields can only be computed for triangle meshes";
+            return grid;
+        }
+
+        const std::vector<vec3> points = details::collect_triangles(mesh);
+        const std::vector<std::pair<details::BlockCoord, int> > pairs = details::block_triangles(
+                points, origin, voxel_size, band_width);
+        // the range of the triangles of each block in 'pairs'
+        std::vector<std::size_t> starts;
+        for (std::size_t i = 0; i < pairs.size(); ++i) {
+            if (i == 0 || pairs[i].first != pairs[i - 1].first) {
+                grid.add_block(pairs[i].first[0], pairs[i].first[1], pairs[i].first[2]);
+                starts.push_back(i);
+            }
+        }
+        starts.push_back(pairs.size());
+
+        // the faces of the triangles
+        std::vector<SurfaceMesh::Face> faces;
+        faces.reserve(mesh->n_faces());
+        for (auto f : mesh->faces())
+            faces.push_back(f);
+
+        const details::PseudoNormals *normals = nullptr;
+        const SurfaceMeshWindingNumber *winding = nullptr;
+        if (method == PSEUDO_NORMAL)
+            normals = new details::PseudoNormals(mesh);
+        else
+            winding = new SurfaceMeshWindingNumber(mesh);
+        // for the grid points whose signs can't be propagated (rare)
+        const TriangleMeshKdTree kdtree(mesh);
+
+        // Each block is processed by scattering its triangles to the grid points within the band around them.
+        // The grid points farther than the band width only need the sign, which doesn't change between adjacent
+        // grid points if one of them is outside the band (as long as the band is wider than a voxel). So the signs
+        // are propagated from the grid points within the band to the others. Those that can't be reached this way
+        // are resolved by exact queries.
+        const int bs = SparseGrid<float>::block_size;
+        const int bv = SparseGrid<float>::block_volume;
+        const int num_blocks = static_cast<int>(grid.num_blocks());
+#pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < num_blocks; ++b) {
+            auto &block = grid.block(b);
+            auto is_inside = [&](const vec3 &p, SurfaceMesh::Face face, const vec3 &nearest) -> bool {
+                if (normals)
+                    return dot(dvec3(p - nearest), normals->normal(face, dvec3(nearest))) < 0.0;
+                return winding->is_inside(p);
+            };
+
+            // the nearest triangles of the grid points within the band
+            float dist[bv];
+            int triangle[bv];
+            vec3 nearest[bv];
+            std::fill(dist, dist + bv, band_width);
+            std::fill(triangle, triangle + bv, -1);
+            const int base[3] = {block.x * bs, block.y * bs, block.z * bs};
+            vec3 q;
+            for (std::size_t idx = starts[b]; idx < starts[b + 1]; ++idx) {
+                const int t = pairs[idx].second;
+                const vec3 &v0 = points[3 * t], &v1 = points[3 * t + 1], &v2 = points[3 * t + 2];
+                int lo[3], hi[3];
+                for (int k = 0; k < 3; ++k) {
+                    const float tmin = std::min(v0[k], std::min(v1[k], v2[k])) - band_width - origin[k];
+                    const float tmax = std::max(v0[k], std::max(v1[k], v2[k])) + band_width - origin[k];
+                    lo[k] = std::max(0, static_cast<int>(std::ceil(tmin / voxel_size)) - base[k]);
+                    hi[k] = std::min(bs - 1, static_cast<int>(std::floor(tmax / voxel_size)) - base[k]);
+                }
+                for (int lk = lo[2]; lk <= hi[2]; ++lk) {
+                    for (int lj = lo[1]; lj <= hi[1]; ++lj) {
+                        for (int li = lo[0]; li <= hi[0]; ++li) {
+                            const int v = li + bs * (lj + bs * lk);
+                            const vec3 p = grid.position(base[0] + li, base[1] + lj, base[2] + lk);
+                            const float d = geom::dist_point_triangle(p, v0, v1, v2, q);
+                            if (d < dist[v]) {
+                                dist[v] = d;
+                                triangle[v] = t;
+                                nearest[v] = q;
+                            }
+                        }
+                    }
+                }
+            }
+
+            int queue[bv];
+            int head = 0, tail = 0;
+            bool known[bv];
+            int i, j, k;
+            for (int v = 0; v < bv; ++v) {
+                known[v] = triangle[v] >= 0 || band_width <= voxel_size;
+                if (known[v]) {
+                    block.grid_point(v, i, j, k);
+                    const vec3 p = grid.position(i, j, k);
+                    bool inside;
+                    if (triangle[v] >= 0)
+                        inside = is_inside(p, faces[triangle[v]], nearest[v]);
+                    else {
+                        const auto nn = kdtree.nearest(p);
+                        inside = is_inside(p, nn.face, nn.nearest);
+                    }
+                    block.values[v] = inside ? -dist[v] : dist[v];
+                    queue[tail++] = v;
+                }
+            }
+
+            for (int seed = 0; seed < bv; ++seed) {
+                if (!known[seed]) { // not reachable from the known ones, so an exact query is needed
+                    block.grid_point(seed, i, j, k);
+                    const vec3 p = grid.position(i, j, k);
+                    const auto nn = kdtree.nearest(p);
+                    block.values[seed] = is_inside(p, nn.face, nn.nearest) ? -band_width : band_width;
+                    known[seed] = true;
+                    queue[tail++] = seed;
+                }
+                // flood fill the signs to the unknown neighbors
+                while (head < tail) {
+                    const int v = queue[head++];
+                    const float sign = block.values[v] < 0.0f ? -band_width : band_width;
+                    const int li = v % bs, lj = (v / bs) % bs, lk = v / (bs * bs);
+                    const int neighbors[6][2] = {{li > 0, -1}, {li < bs - 1, 1},
+                                                 {lj > 0, -bs}, {lj < bs - 1, bs},
+                                                 {lk > 0, -bs * bs}, {lk < bs - 1, bs * bs}};
+                    for (const auto &n : neighbors) {
+                        const int w = v + n[1];
+                        if (n[0] && !known[w]) {
+                            block.values[w] = sign;
+                            known[w] = true;
+                            queue[tail++] = w;
+                        }
+                    }
+                }
+            }
+        }
+
+        delete normals;
+        delete winding;
+        return grid;
+    }
+
+
+    SparseGrid<unsigned char> SurfaceMeshSDF::voxelize(const SurfaceMesh *mesh, float voxel_size) {
+        const Box3 &box = mesh->bounding_box();
+        const vec3 origin = box.min_point();
+        SparseGrid<unsigned char> grid(origin, voxel_size, 0);
+        if (mesh->n_faces() == 0)
+            return grid;
+
+        // the blocks intersecting the surface
+        std::vector<details::BlockCoord> surface_blocks;
+        for (const auto &pair : details::block_triangles(details::collect_triangles(mesh), origin, voxel_size, 0.0f)) {
+            if (surface_blocks.empty() || surface_blocks.back() != pair.first)
+                surface_blocks.push_back(pair.first);
+        }
+
+        // all the blocks in the bounding box
+        const int bs = SparseGrid<unsigned char>::block_size;
+        int num[3];
+        for (int a = 0; a < 3; ++a)
+            num[a] = static_cast<int>(std::floor(box.diagonal_vector()[a] / voxel_size)) / bs + 1;
+        const long long total = static_cast<long long>(num[0]) * num[1] * num[2];
+
+        // classify the blocks: 0 (outside), 1 (inside), or 2 (intersecting the surface)
+        const SurfaceMeshWindingNumber winding(mesh);
+        const float half = 0.5f * (bs - 1);
+        std::vector<unsigned char> status(total, 0);
+#pragma omp parallel for schedule(dynamic, 64)
+        for (long long idx = 0; idx < total; ++idx) {
+            const int x = static_cast<int>(idx % num[0]);
+            const int y = static_cast<int>((idx / num[0]) % num[1]);
+            const int z = static_cast<int>(idx / (static_cast<long long>(num[0]) * num[1]));
+            if (std::binary_search(surface_blocks.begin(), surface_blocks.end(), details::BlockCoord{x, y, z}))
+                status[idx] = 2;
+            else {
+                const vec3 center = origin + vec3(x * bs + half, y * bs + half, z * bs + half) * voxel_size;
+                status[idx] = winding.is_inside(center) ? 1 : 0;
+            }
+        }
+
+        for (long long idx = 0; idx < total; ++idx) {
+            if (status[idx] == 0)
+                continue;
+            const int x = static_cast<int>(idx % num[0]);
+            const int y = static_cast<int>((idx / num[0]) % num[1]);
+            const int z = static_cast<int>(idx / (static_cast<long long>(num[0]) * num[1]));
+            const int b = grid.add_block(x, y, z);
+            if (status[idx] == 1)
+                std::fill(grid.block(b).values.begin(), grid.block(b).values.end(), 1);
+        }
+
+        // the grid points in the blocks intersecting the surface
+        const int num_blocks = static_cast<int>(grid.num_blocks());
+#pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < num_blocks; ++b) {
+            auto &block = grid.block(b);
+            if (block.values[0] == 1)   // entirely inside
+                continue;
+            int i, j, k;
+            for (int v = 0; v < SparseGrid<unsigned char>::block_volume; ++v) {
+                block.grid_point(v, i, j, k);
+                block.values[v] = winding.is_inside(grid.position(i, j, k)) ? 1 : 0;
+            }
+        }
+
+        return grid;
+    }
+
+}
@@ -0,0 +1,85 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_SURFACE_MESH_SDF_H
+#define EASY3D_ALGO_SURFACE_MESH_SDF_H
+
+
+#include <easy3d/core/sparse_grid.h>
+
+
+namespace easy3d {
+
+    class SurfaceMesh;
+
+    /**
+     * \brief Signed distance fields and voxelization of surface meshes, stored in sparse grids.
+     * \class SurfaceMeshSDF easy3d/algo/surface_mesh_sdf.h
+     * \details Only the blocks of the grid near the surface (or inside it, for voxelization) are stored, and the
+     *      blocks are processed in parallel.
+     * \see SparseGrid, SurfaceMeshWindingNumber
+     */
+    class SurfaceMeshSDF {
+    public:
+        /// \brief The methods to determine the sign of the distances.
+        enum SignMethod {
+            PSEUDO_NORMAL,  ///< Using the angle-weighted pseudo-normals. Fast, but requires a closed and
+                            ///< consistently oriented mesh.
+            WINDING_NUMBER  ///< Using the generalized winding numbers. Robust to holes and self-intersections.
+        };
+
+        /**
+         * \brief Computes the narrow-band signed distance field of a triangle mesh (negative inside).
+         * @param mesh The triangle mesh.
+         * @param voxel_size The distance between two adjacent grid points.
+         * @param band_width The width of the narrow band. All the blocks containing grid points within this
+         *      distance to the surface are stored, and the distances of their grid points are clamped to
+         *      [-band_width, band_width]. The background value of the grid is band_width.
+         * @param method The method to determine the sign of the distances.
+         * @return The signed distance field. It is empty if the mesh is not a triangle mesh.
+         * @details Within each block, the triangles near it are scattered to the grid points within the band
+         *      around them, and the signs are propagated to the other grid points of the block. The grid points far
+         *      away from the surface are not stored, so use SurfaceMeshWindingNumber to test if they are inside.
+         */
+        static SparseGrid<float> signed_distance(const SurfaceMesh *mesh, float voxel_size, float band_width,
+                                                 SignMethod method = PSEUDO_NORMAL);
+
+        /**
+         * \brief Solid voxelization of a surface mesh.
+         * @param mesh The surface mesh. It can have holes or self-intersections.
+         * @param voxel_size The distance between two adjacent grid points.
+         * @return The grid, in which the grid points inside the mesh have value 1 (and 0 otherwise). Only the blocks
+         *      intersecting the surface or inside the mesh are stored.
+         * @details The blocks that do not intersect the surface are entirely inside or outside, so each of them is
+         *      classified by the generalized winding number of its center. The grid points of the other blocks are
+         *      classified individually.
+         */
+        static SparseGrid<unsigned char> voxelize(const SurfaceMesh *mesh, float voxel_size);
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_ALGO_SURFACE_MESH_SDF_H
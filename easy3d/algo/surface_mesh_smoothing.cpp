@@ -15,6 +15,7 @@
 #include <Eigen/Sparse>
 
 #include <easy3d/algo/surface_mesh_geometry.h>
+#include <easy3d/core/hash.h>
 
 
 namespace easy3d {
@@ -26,53 +27,121 @@ namespace easy3d {
 
     //-----------------------------------------------------------------------------
 
-    SurfaceMeshSmoothing::SurfaceMeshSmoothing(SurfaceMesh *mesh) : mesh_(mesh) {
-        how_many_edge_weights_ = 0;
-        how_many_vertex_weights_ = 0;
+    // \cond
+    namespace internal {
+
+        // a fingerprint of the connectivity of a mesh, which changes if any element is added, removed, or relinked
+        uint64_t connectivity_revision(const SurfaceMesh *mesh) {
+            uint64_t seed = 0;
+            hash_combine(seed, mesh->n_vertices());
+            hash_combine(seed, mesh->n_faces());
+            for (auto h : mesh->halfedges()) {
+                hash_combine(seed, h.idx());
+                hash_combine(seed, mesh->target(h).idx());
+                hash_combine(seed, mesh->next(h).idx());
+                hash_combine(seed, mesh->face(h).idx());
+            }
+            return seed;
+        }
+
+        // a fingerprint of the vertex positions of a mesh
+        uint64_t geometry_revision(const SurfaceMesh *mesh) {
+            uint64_t seed = 0;
+            for (auto v : mesh->vertices()) {
+                const vec3 &p = mesh->position(v);
+                hash_combine(seed, p.x);
+                hash_combine(seed, p.y);
+                hash_combine(seed, p.z);
+            }
+            return seed;
+        }
+
     }
 
-    //-----------------------------------------------------------------------------
 
-    SurfaceMeshSmoothing::~SurfaceMeshSmoothing() {
-        auto vweight = mesh_->get_vertex_property<float>("v:area");
-        if (vweight)
-            mesh_->remove_vertex_property(vweight);
+    class SurfaceMeshSmoothing::ImplicitSystem {
+    public:
+        // check if the system was built for the current mesh (i.e., not modified elsewhere) and the given parameters
+        bool is_valid(const SurfaceMesh *mesh, float timestep, bool use_uniform_laplace) const {
+            return timestep == this->timestep && use_uniform_laplace == this->use_uniform_laplace &&
+                   solver.info() == Eigen::Success &&
+                   internal::connectivity_revision(mesh) == connectivity &&
+                   internal::geometry_revision(mesh) == geometry;
+        }
+
+    public:
+        // the parameters the system was built for
+        float timestep;
+        bool use_uniform_laplace;
 
-        auto eweight = mesh_->get_edge_property<float>("e:cotan");
-        if (eweight)
-            mesh_->remove_edge_property(eweight);
+        // the revisions of the connectivity and the geometry the system is valid for. The geometry revision is
+        // updated after each smoothing step, so only modifications made elsewhere invalidate the system.
+        uint64_t connectivity;
+        uint64_t geometry;
+
+        // the free (non-boundary) vertices, i.e., the unknowns
+        std::vector<SurfaceMesh::Vertex> free_vertices;
+        // per free vertex: the inverse of the vertex weight (that scales the right hand side)
+        std::vector<double> inv_vweights;
+
+        // the contribution of a fixed boundary vertex to the right hand side of a free vertex
+        struct BorderTerm {
+            unsigned int row;
+            SurfaceMesh::Vertex vertex;
+            double weight;
+        };
+        std::vector<BorderTerm> border_terms;
+
+        // the factorization of the system matrix
+        Eigen::SimplicialLDLT<SparseMatrix> solver;
+    };
+    // \endcond
+
+    //-----------------------------------------------------------------------------
+
+    SurfaceMeshSmoothing::SurfaceMeshSmoothing(SurfaceMesh *mesh) : mesh_(mesh), edge_weights_uniform_(false) {
     }
 
     //-----------------------------------------------------------------------------
 
+    // defined here, where ImplicitSystem is complete
+    SurfaceMeshSmoothing::~SurfaceMeshSmoothing() = default;
+
+    //-----------------------------------------------------------------------------
+
     void SurfaceMeshSmoothing::compute_edge_weights(bool use_uniform_laplace) {
-        auto eweight = mesh_->edge_property<float>("e:cotan");
+        auto &eweight = edge_weights_;
+        eweight.assign(mesh_->edges_size(), 0.0f);
+        edge_weights_uniform_ = use_uniform_laplace;
 
         if (use_uniform_laplace) {
             for (auto e : mesh_->edges())
-                eweight[e] = 1.0;
+                eweight[e.idx()] = 1.0;
         } else {
             for (auto e : mesh_->edges())
-                eweight[e] = std::max(0.0, geom::cotan_weight(mesh_, e));
+                eweight[e.idx()] = std::max(0.0, geom::cotan_weight(mesh_, e));
         }
-
-        how_many_edge_weights_ = mesh_->n_edges();
     }
 
     //-----------------------------------------------------------------------------
 
     void SurfaceMeshSmoothing::compute_vertex_weights(bool use_uniform_laplace) {
-        auto vweight = mesh_->vertex_property<float>("v:area");
+        auto &vweight = vertex_weights_;
+        vweight.assign(mesh_->vertices_size(), 0.0f);
 
         if (use_uniform_laplace) {
             for (auto v : mesh_->vertices())
-                vweight[v] = 1.0 / mesh_->valence(v);
+                vweight[v.idx()] = 1.0 / mesh_->valence(v);
         } else {
             for (auto v : mesh_->vertices())
-                vweight[v] = 0.5 / geom::voronoi_area(mesh_, v);
+                vweight[v.idx()] = 0.5 / geom::voronoi_area(mesh_, v);
         }
+    }
+
+    //-----------------------------------------------------------------------------
 
-        how_many_vertex_weights_ = mesh_->n_vertices();
+    void SurfaceMeshSmoothing::clear_cache() {
+        implicit_system_.reset();
     }
 
     //-----------------------------------------------------------------------------
@@ -83,10 +152,10 @@ namespace easy3d {
             return;
 
         // compute Laplace weight per edge: cotan or uniform
-        auto eweight = mesh_->get_edge_property<float>("e:cotan");
-        if (!eweight || how_many_edge_weights_ != mesh_->n_edges())
+        // recompute if the number of edges changed (i.e. mesh has changed) or the other Laplacian was used
+        if (edge_weights_.size() != mesh_->edges_size() || edge_weights_uniform_ != use_uniform_laplace)
             compute_edge_weights(use_uniform_laplace);
-        eweight = mesh_->get_edge_property<float>("e:cotan");
+        const auto &eweight = edge_weights_;
 
         auto points = mesh_->get_vertex_property<vec3>("v:point");
         auto laplace = mesh_->add_vertex_property<vec3>("v:laplace");
@@ -105,8 +174,8 @@ namespace easy3d {
                     for (auto h : mesh_->halfedges(v)) {
                         vv = mesh_->target(h);
                         e = mesh_->edge(h);
-                        l += eweight[e] * (points[vv] - points[v]);
-                        w += eweight[e];
+                        l += eweight[e.idx()] * (points[vv] - points[v]);
+                        w += eweight[e.idx()];
                     }
 
                     l /= w;
@@ -127,38 +196,28 @@ namespace easy3d {
 
     //-----------------------------------------------------------------------------
 
-    void SurfaceMeshSmoothing::implicit_smoothing(float timestep,
-                                                  bool use_uniform_laplace,
-                                                  bool rescale) {
-        if (!mesh_->n_vertices())
-            return;
-
-        // compute edge weights if they don't exist or if the mesh changed
-        auto eweight = mesh_->get_edge_property<float>("e:cotan");
-        if (!eweight || how_many_edge_weights_ != mesh_->n_edges())
-            compute_edge_weights(use_uniform_laplace);
-        eweight = mesh_->get_edge_property<float>("e:cotan");
+    void SurfaceMeshSmoothing::build_implicit_system(float timestep, bool use_uniform_laplace) {
+        clear_cache();
 
-        // compute vertex weights
+        // the weights are always recomputed: the Laplacian (or the geometry) may have changed
+        compute_edge_weights(use_uniform_laplace);
         compute_vertex_weights(use_uniform_laplace);
 
-        // store center and area
-        vec3 center_before;
-        float area_before;
-        if (rescale) {
-            center_before = geom::centroid(mesh_);
-            area_before = geom::surface_area(mesh_);
-        }
-
         // properties
-        auto points = mesh_->get_vertex_property<vec3>("v:point");
-        auto vweight = mesh_->get_vertex_property<float>("v:area");
+        const auto &eweight = edge_weights_;
+        const auto &vweight = vertex_weights_;
         auto idx = mesh_->add_vertex_property<int>("v:idx", -1);
 
+        std::unique_ptr<ImplicitSystem> system(new ImplicitSystem);
+        system->timestep = timestep;
+        system->use_uniform_laplace = use_uniform_laplace;
+        system->connectivity = internal::connectivity_revision(mesh_);
+        system->geometry = internal::geometry_revision(mesh_);
+
         // collect free (non-boundary) vertices in array free_vertices[]
         // assign indices such that idx[ free_vertices[i] ] == i
         unsigned i = 0;
-        std::vector<SurfaceMesh::Vertex> free_vertices;
+        auto &free_vertices = system->free_vertices;
         free_vertices.reserve(mesh_->n_vertices());
         for (auto v : mesh_->vertices()) {
             if (!mesh_->is_border(v)) {
@@ -167,16 +226,13 @@ namespace easy3d {
             }
         }
         const unsigned int n = free_vertices.size();
-
-        // A*X = B
-        SparseMatrix A(n, n);
-        Eigen::MatrixXd B(n, 3);
+        system->inv_vweights.resize(n);
 
         // nonzero elements of A as triplets: (row, column, value)
         std::vector<Triplet> triplets;
+        triplets.reserve(7 * n);
 
-        // setup matrix A and rhs B
-        dvec3 b;
+        // setup matrix A (and record how fixed boundary vertices contribute to the rhs B)
         double ww;
         SurfaceMesh::Vertex v, vv;
         SurfaceMesh::Edge e;
@@ -184,38 +240,84 @@ namespace easy3d {
             v = free_vertices[i];
 
             // rhs row
-            b = static_cast<dvec3>(points[v]) / vweight[v];
+            system->inv_vweights[i] = 1.0 / vweight[v.idx()];
 
             // lhs row
             ww = 0.0;
             for (auto h : mesh_->halfedges(v)) {
                 vv = mesh_->target(h);
                 e = mesh_->edge(h);
-                ww += eweight[e];
+                ww += eweight[e.idx()];
 
                 // fixed boundary vertex -> right hand side
                 if (mesh_->is_border(vv)) {
-                    b -= -timestep * eweight[e] * static_cast<dvec3>(points[vv]);
+                    system->border_terms.push_back({i, vv, timestep * eweight[e.idx()]});
                 }
                     // free interior vertex -> matrix
                 else {
-                    triplets.emplace_back(i, idx[vv], -timestep * eweight[e]);
+                    triplets.emplace_back(i, idx[vv], -timestep * eweight[e.idx()]);
                 }
-
-                B.row(i) = (Eigen::Vector3d) b;
             }
 
             // center vertex -> matrix
-            triplets.emplace_back(i, i, 1.0 / vweight[v] + timestep * ww);
+            triplets.emplace_back(i, i, 1.0 / vweight[v.idx()] + timestep * ww);
         }
 
         // build sparse matrix from triplets
+        SparseMatrix A(n, n);
         A.setFromTriplets(triplets.begin(), triplets.end());
 
-        // solve A*X = B
-        Eigen::SimplicialLDLT<SparseMatrix> solver(A);
-        Eigen::MatrixXd X = solver.solve(B);
-        if (solver.info() != Eigen::Success) {
+        // factorize A (symbolic + numeric)
+        system->solver.compute(A);
+        if (system->solver.info() != Eigen::Success)
+            std::cerr << "SurfaceMeshSmoothing: Could not factorize linear system\n";
+
+        implicit_system_ = std::move(system);
+
+        // clean-up
+        mesh_->remove_vertex_property(idx);
+    }
+
+    //-----------------------------------------------------------------------------
+
+    void SurfaceMeshSmoothing::implicit_smoothing(float timestep,
+                                                  bool use_uniform_laplace,
+                                                  bool rescale) {
+        if (!mesh_->n_vertices())
+            return;
+
+        // (re)build the system if it doesn't exist or if the mesh/parameters changed
+        if (!implicit_system_ || !implicit_system_->is_valid(mesh_, timestep, use_uniform_laplace))
+            build_implicit_system(timestep, use_uniform_laplace);
+        if (implicit_system_->solver.info() != Eigen::Success)
+            return;
+
+        // store center and area
+        vec3 center_before;
+        float area_before;
+        if (rescale) {
+            center_before = geom::centroid(mesh_);
+            area_before = geom::surface_area(mesh_);
+        }
+
+        auto points = mesh_->get_vertex_property<vec3>("v:point");
+
+        // setup rhs B of A*X = B from the current positions
+        const auto &free_vertices = implicit_system_->free_vertices;
+        const unsigned int n = free_vertices.size();
+        Eigen::MatrixXd B(n, 3);
+        for (unsigned int i = 0; i < n; ++i) {
+            const vec3 &p = points[free_vertices[i]];
+            B.row(i) = Eigen::Vector3d(p.x, p.y, p.z) * implicit_system_->inv_vweights[i];
+        }
+        for (const auto &term : implicit_system_->border_terms) {
+            const vec3 &p = points[term.vertex];
+            B.row(term.row) += Eigen::Vector3d(p.x, p.y, p.z) * term.weight;
+        }
+
+        // solve A*X = B (back-substitution only)
+        Eigen::MatrixXd X = implicit_system_->solver.solve(B);
+        if (implicit_system_->solver.info() != Eigen::Success) {
             std::cerr << "SurfaceMeshSmoothing: Could not solve linear system\n";
         } else {
             // copy solution
@@ -239,8 +341,8 @@ namespace easy3d {
                 mesh_->position(v) += trans;
         }
 
-        // clean-up
-        mesh_->remove_vertex_property(idx);
+        // the new positions are the result of this smoother, so the cached system remains valid for them
+        implicit_system_->geometry = internal::geometry_revision(mesh_);
     }
 
 } // namespace easy3d
@@ -12,6 +12,9 @@
 #ifndef EASY3D_ALGO_SURFACE_MESH_SMOOTHING_H
 #define EASY3D_ALGO_SURFACE_MESH_SMOOTHING_H
 
+#include <memory>
+#include <vector>
+
 #include <easy3d/core/surface_mesh.h>
 
 namespace easy3d {
@@ -22,6 +25,17 @@ namespace easy3d {
      * See the following papers for more details:
      *  - Mathieu Desbrun et al. Implicit fairing of irregular meshes using diffusion and curvature flow. SIGGRAPH, 1999.
      *  - Misha Kazhdan et al. Can mean‐curvature flow be modified to be non‐singular? CGF, 2012.
+     *
+     * The linear system of implicit smoothing (including the Laplace weights it is built from and its factorization)
+     * is cached. Calling implicit_smoothing() again with the same timestep and Laplacian only requires a
+     * back-substitution, as long as neither the connectivity nor the vertex positions of the mesh have been changed
+     * by anything else than this smoother (both are fingerprinted when the system is built and after each smoothing
+     * step). The weights are thus those of the geometry at the time the system was built (i.e., the Laplacian is
+     * frozen), which is the common choice for interactive smoothing. Call clear_cache() to force the weights to be
+     * recomputed from the current geometry.
+     *
+     * The Laplace weights are stored in the smoother (not in the mesh), so a smoother can be destroyed even after its
+     * mesh has been deleted.
      */
     class SurfaceMeshSmoothing {
     public:
@@ -31,6 +45,10 @@ namespace easy3d {
         // destructor
         ~SurfaceMeshSmoothing();
 
+        // a smoother is bound to its mesh and its cached system, so it can not be copied
+        SurfaceMeshSmoothing(const SurfaceMeshSmoothing &) = delete;
+        SurfaceMeshSmoothing &operator=(const SurfaceMeshSmoothing &) = delete;
+
         //! \brief Perform \p iters iterations of explicit Laplacian smoothing.
         //! Decide whether to use uniform Laplacian or cotan Laplacian (default: cotan).
         void explicit_smoothing(unsigned int iters = 10,
@@ -39,10 +57,16 @@ namespace easy3d {
         //! \brief Perform implicit Laplacian smoothing with \p timestep.
         //! Decide whether to use uniform Laplacian or cotan Laplacian (default: cotan).
         //! Decide whether to re-center and re-scale model after smoothing (default: true).
+        //! \note The factorized system is reused by subsequent calls unless the connectivity or the geometry of the
+        //!     mesh has been modified elsewhere, or the \p timestep or the choice of Laplacian changes.
         void implicit_smoothing(float timestep = 0.001,
                                 bool use_uniform_laplace = false,
                                 bool rescale = true);
 
+        //! \brief Discard the cached system of implicit smoothing.
+        //! The next call to implicit_smoothing() will recompute the Laplace weights and re-factorize the system.
+        void clear_cache();
+
         //! \brief Initialize edge and vertex weights.
         void initialize(bool use_uniform_laplace = false) {
             compute_edge_weights(use_uniform_laplace);
@@ -56,14 +80,22 @@ namespace easy3d {
         //! Initialize cotan/uniform Laplace weights.
         void compute_vertex_weights(bool use_uniform_laplace);
 
+        //! Build and factorize the linear system of implicit smoothing.
+        void build_implicit_system(float timestep, bool use_uniform_laplace);
+
     private:
         //! the mesh
         SurfaceMesh *mesh_;
 
-        // remember for how many vertices/edges we computed weights
-        // recompute if numbers change (i.e. mesh has changed)
-        unsigned int how_many_edge_weights_;
-        unsigned int how_many_vertex_weights_;
+        //! the Laplace weights: per edge (cotan or uniform) and per vertex (inverse Voronoi area or valence)
+        std::vector<float> edge_weights_;
+        std::vector<float> vertex_weights_;
+        //! the Laplacian the edge weights were computed for
+        bool edge_weights_uniform_;
+
+        //! the cached (factorized) system of implicit smoothing
+        class ImplicitSystem;
+        std::unique_ptr<ImplicitSystem> implicit_system_;
     };
 
 } // namespace easy3d
@@ -0,0 +1,252 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo/surface_mesh_winding_number.h>
+#include <easy3d/core/surface_mesh.h>
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace easy3d {
+
+
+    namespace details {
+
+        // The signed solid angle of triangle (a, b, c) seen from the origin, using the formula in
+        //      A. Van Oosterom and J. Strackee. The Solid Angle of a Plane Triangle.
+        //      IEEE Transactions on Biomedical Engineering, BME-30(2):125-126, 1983.
+        inline double solid_angle(const dvec3 &a, const dvec3 &b, const dvec3 &c) {
+            const double la = length(a), lb = length(b), lc = length(c);
+            const double numerator = dot(a, cross(b, c));
+            const double denominator = la * lb * lc + dot(a, b) * lc + dot(b, c) * la + dot(c, a) * lb;
+            return 2.0 * std::atan2(numerator, denominator);
+        }
+
+        // the index of the monomial r_i r_j r_k in x^3, y^3, z^3, x^2 y, x^2 z, x y^2, y^2 z, x z^2, y z^2, x y z
+        inline int cubic_monomial(int i, int j, int k) {
+            int count[3] = {0, 0, 0};
+            ++count[i];
+            ++count[j];
+            ++count[k];
+            for (int a = 0; a < 3; ++a) {
+                if (count[a] == 3)
+                    return a;
+            }
+            if (count[0] == 2) return count[1] == 1 ? 3 : 4;
+            if (count[1] == 2) return count[0] == 1 ? 5 : 6;
+            if (count[2] == 2) return count[0] == 1 ? 7 : 8;
+            return 9;
+        }
+
+    }
+
+
+    SurfaceMeshWindingNumber::SurfaceMeshWindingNumber(const SurfaceMesh *mesh, float accuracy)
+            : beta_(accuracy)
+    {
+        // the faces as triangle fans
+        for (auto f : mesh->faces()) {
+            const auto h0 = mesh->halfedge(f);
+            const vec3 &p0 = mesh->position(mesh->source(h0));
+            for (auto h = mesh->next(h0); mesh->target(h) != mesh->source(h0); h = mesh->next(h)) {
+                points_.push_back(p0);
+                points_.push_back(mesh->position(mesh->source(h)));
+                points_.push_back(mesh->position(mesh->target(h)));
+            }
+        }
+
+        const int num = static_cast<int>(points_.size() / 3);
+        if (num == 0)
+            return;
+
+        std::vector<vec3> centroids(num);
+        std::vector<int> order(num);
+        for (int i = 0; i < num; ++i) {
+            centroids[i] = (points_[3 * i] + points_[3 * i + 1] + points_[3 * i + 2]) / 3.0f;
+            order[i] = i;
+        }
+
+        nodes_.push_back(Node());
+        build(0, 0, num, order, centroids);
+
+        // store the triangles in the order of the leaves
+        std::vector<vec3> points(points_.size());
+        for (int i = 0; i < num; ++i) {
+            for (int k = 0; k < 3; ++k)
+                points[3 * i + k] = points_[3 * order[i] + k];
+        }
+        points_.swap(points);
+    }
+
+
+    void SurfaceMeshWindingNumber::build(int slot, int begin, int end, std::vector<int> &order,
+                                         const std::vector<vec3> &centroids)
+    {
+        Node node;
+        node.begin = begin;
+        node.end = end;
+        node.left = -1;
+
+        // the area-weighted center and the first-order term
+        double total_area = 0.0;
+        node.center = dvec3(0, 0, 0);
+        node.area = dvec3(0, 0, 0);
+        vec3 cmin = centroids[order[begin]], cmax = cmin;
+        for (int i = begin; i < end; ++i) {
+            const int t = order[i];
+            const dvec3 a(points_[3 * t]), b(points_[3 * t + 1]), c(points_[3 * t + 2]);
+            const dvec3 n = cross(b - a, c - a) * 0.5;  // area-weighted normal
+            const double area = length(n);
+            total_area += area;
+            node.center += dvec3(centroids[t]) * area;
+            node.area += n;
+            for (int k = 0; k < 3; ++k) {
+                cmin[k] = std::min(cmin[k], centroids[t][k]);
+                cmax[k] = std::max(cmax[k], centroids[t][k]);
+            }
+        }
+        if (total_area > 0.0)
+            node.center /= total_area;
+        else
+            node.center = dvec3((cmin + cmax) * 0.5f);
+
+        // the second- and third-order terms, and the radius
+        node.moment = dmat3(0.0);
+        dmat3 third[3] = {dmat3(0.0), dmat3(0.0), dmat3(0.0)};   // T_ijk = third[k](i, j)
+        node.radius = 0.0;
+        for (int i = begin; i < end; ++i) {
+            const int t = order[i];
+            const dvec3 a(points_[3 * t]), b(points_[3 * t + 1]), c(points_[3 * t + 2]);
+            const dvec3 n = cross(b - a, c - a) * 0.5;
+            const dvec3 d = dvec3(centroids[t]) - node.center;
+            // the second moment of the triangle w.r.t. the center (divided by its area):
+            //      (va * va^T + vb * vb^T + vc * vc^T + s * s^T) / 12, with s = va + vb + vc
+            const dvec3 va = a - node.center, vb = b - node.center, vc = c - node.center, sum = va + vb + vc;
+            dmat3 second(0.0);
+            for (int r = 0; r < 3; ++r) {
+                for (int s = 0; s < 3; ++s) {
+                    node.moment(r, s) += n[r] * d[s];
+                    second(r, s) = (va[r] * va[s] + vb[r] * vb[s] + vc[r] * vc[s] + sum[r] * sum[s]) / 12.0;
+                }
+            }
+            for (int k = 0; k < 3; ++k)
+                third[k] += second * n[k];
+            node.radius = std::max(node.radius, std::max(distance(a, node.center),
+                                                         std::max(distance(b, node.center), distance(c, node.center))));
+        }
+        for (double &c : node.cubic)
+            c = 0.0;
+        node.linear = dvec3(0, 0, 0);
+        for (int k = 0; k < 3; ++k) {
+            for (int i = 0; i < 3; ++i) {
+                node.linear[i] += 2.0 * third[k](k, i);
+                node.linear[k] += third[k](i, i);
+                for (int j = 0; j < 3; ++j)
+                    node.cubic[details::cubic_monomial(i, j, k)] += third[k](i, j);
+            }
+        }
+
+        if (end - begin > 8) {
+            // split at the median along the longest axis of the centroids
+            const vec3 ext = cmax - cmin;
+            const int axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+            const int mid = (begin + end) / 2;
+            std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                             [&centroids, axis](int a, int b) -> bool {
+                                 return centroids[a][axis] < centroids[b][axis];
+                             });
+            // the two children are stored contiguously
+            node.left = static_cast<int>(nodes_.size());
+            nodes_.push_back(Node());
+            nodes_.push_back(Node());
+            build(node.left, begin, mid, order, centroids);
+            build(node.left + 1, mid, end, order, centroids);
+        }
+        nodes_[slot] = node;
+    }
+
+
+    double SurfaceMeshWindingNumber::winding_number(const vec3 &p) const {
+        if (nodes_.empty())
+            return 0.0;
+
+        const dvec3 q(p);
+        const double beta2 = beta_ * beta_;
+        double sum = 0.0;
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node &node = nodes_[stack[--top]];
+            const dvec3 r = node.center - q;
+            const double d2 = dot(r, r);
+            if (d2 > beta2 * node.radius * node.radius) {
+                // far away: the expansion of the solid angle around the center
+                const double d = std::sqrt(d2);
+                const double d3 = d2 * d;
+                const auto &m = node.moment;
+                double rmr = 0.0;
+                for (int i = 0; i < 3; ++i) {
+                    for (int j = 0; j < 3; ++j)
+                        rmr += r[i] * m(i, j) * r[j];
+                }
+                sum += dot(r, node.area) / d3 + (m(0, 0) + m(1, 1) + m(2, 2)) / d3 - 3.0 * rmr / (d3 * d2);
+                // the third-order term: 0.5 * sum_ijk T_ijk * d^2(r_k / |r|^3) / (dr_i dr_j)
+                const double x = r.x, y = r.y, z = r.z;
+                const double *c = node.cubic;
+                const double rrr = x * x * (c[0] * x + c[3] * y + c[4] * z) + y * y * (c[1] * y + c[5] * x + c[6] * z) +
+                                   z * z * (c[2] * z + c[7] * x + c[8] * y) + c[9] * x * y * z;
+                sum += 0.5 * (15.0 * rrr / (d3 * d2 * d2) - 3.0 * dot(node.linear, r) / (d3 * d2));
+            } else if (node.left < 0) {
+                for (int i = node.begin; i < node.end; ++i) {
+                    sum += details::solid_angle(dvec3(points_[3 * i]) - q, dvec3(points_[3 * i + 1]) - q,
+                                                dvec3(points_[3 * i + 2]) - q);
+                }
+            } else {
+                stack[top++] = node.left;
+                stack[top++] = node.left + 1;
+            }
+        }
+        return sum / (4.0 * M_PI);
+    }
+
+
+    std::vector<float> SurfaceMeshWindingNumber::winding_numbers(const std::vector<vec3> &points) const {
+        const int num = static_cast<int>(points.size());
+        std::vector<float> values(num);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < num; ++i)
+            values[i] = static_cast<float>(winding_number(points[i]));
+        return values;
+    }
+
+
+    bool SurfaceMeshWindingNumber::is_inside(const vec3 &p) const {
+        return std::abs(winding_number(p)) > 0.5;
+    }
+
+}
@@ -0,0 +1,107 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_SURFACE_MESH_WINDING_NUMBER_H
+#define EASY3D_ALGO_SURFACE_MESH_WINDING_NUMBER_H
+
+
+#include <vector>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    class SurfaceMesh;
+
+    /**
+     * \brief Fast generalized winding numbers (i.e., inside/outside queries) of a surface mesh.
+     * \class SurfaceMeshWindingNumber easy3d/algo/surface_mesh_winding_number.h
+     * \details The generalized winding number of a point is the sum of the signed solid angles of the faces seen from
+     *      the point (divided by 4 pi). It is 1 inside and 0 outside a closed and consistently oriented mesh, and it
+     *      varies smoothly for meshes with holes, non-manifold parts, or self-intersections. So thresholding it at
+     *      0.5 gives a robust inside/outside test.
+     *      The faces are organized in a bounding volume hierarchy, and the contribution of a node far away from the
+     *      query point is approximated by a third-order expansion of the solid angle, as described in
+     *          Gavin Barill, Neil Dickson, Ryan Schmidt, David I.W. Levin, and Alec Jacobson.
+     *          Fast Winding Numbers for Soups and Clouds. ACM Transactions on Graphics, 37(4), 2018.
+     *      Non-triangular faces are treated as triangle fans.
+     *
+     * Example usage:
+     *  \code
+     *      const SurfaceMeshWindingNumber wn(mesh);
+     *      const std::vector<float> values = wn.winding_numbers(points);   // in parallel
+     *      if (wn.is_inside(p)) { ... }
+     *  \endcode
+     */
+    class SurfaceMeshWindingNumber {
+    public:
+        /**
+         * \brief Builds the hierarchy for a surface mesh.
+         * @param mesh The surface mesh. It is not used after the construction.
+         * @param accuracy A node is approximated if the distance from the query point to its center is larger than
+         *      \p accuracy times its radius. Larger values are more accurate but slower. Default: 2, for which the
+         *      error is below 0.01.
+         */
+        explicit SurfaceMeshWindingNumber(const SurfaceMesh *mesh, float accuracy = 2.0f);
+
+        /// \brief Returns the generalized winding number at a point.
+        double winding_number(const vec3 &p) const;
+
+        /// \brief Returns the generalized winding numbers at a set of points (computed in parallel).
+        std::vector<float> winding_numbers(const std::vector<vec3> &points) const;
+
+        /// \brief Returns whether a point is inside the mesh, i.e., the absolute value of its generalized winding
+        ///     number is larger than 0.5.
+        bool is_inside(const vec3 &p) const;
+
+    private:
+        struct Node {
+            int left;           // the first child (the second one is left + 1), or -1 for a leaf
+            int begin, end;     // the range of the triangles
+            dvec3 center;       // the area-weighted center of the triangles
+            double radius;      // the radius of the ball around the center containing the triangles
+            dvec3 area;         // the sum of the area-weighted normals (the first-order term)
+            dmat3 moment;       // the sum of area * normal * (centroid - center)^T (the second-order term)
+            // the third-order term, from the tensor T_ijk = sum of normal[k] * (the second moment of area w.r.t. the
+            // center)(i, j): the coefficients of the cubic polynomial sum_ijk T_ijk r_i r_j r_k (x^3, y^3, z^3, x^2 y,
+            // x^2 z, x y^2, y^2 z, x z^2, y z^2, x y z), and the vector v_j = sum_k (2 * T_kjk + T_kkj)
+            double cubic[10];
+            dvec3 linear;
+        };
+
+        // builds the subtree of the triangles in [begin, end) of 'order' into nodes_[slot]
+        void build(int slot, int begin, int end, std::vector<int> &order, const std::vector<vec3> &centroids);
+
+    private:
+        std::vector<vec3> points_;  // the three corners of each triangle (in the order of the leaves)
+        std::vector<Node> nodes_;
+        double beta_;
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_ALGO_SURFACE_MESH_WINDING_NUMBER_H
@@ -0,0 +1,169 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/algo_ext/box_intersection.h>
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+
+namespace easy3d {
+
+
+    void box_self_intersection(const std::vector<Box3> &boxes, std::vector<std::pair<int, int> > &pairs) {
+        pairs.clear();
+
+        std::vector<int> valid;
+        valid.reserve(boxes.size());
+        Box3 total;
+        for (std::size_t i = 0; i < boxes.size(); ++i) {
+            if (boxes[i].is_valid()) {
+                valid.push_back(static_cast<int>(i));
+                total.grow(boxes[i]);
+            }
+        }
+        if (valid.size() < 2)
+            return;
+
+        // the sweep axis: the boxes overlap the least (relative to the extent of all boxes) along this axis
+        unsigned int axis = 0;
+        double best = std::numeric_limits<double>::max();
+        double mean_range[3];
+        for (unsigned int a = 0; a < 3; ++a) {
+            double sum = 0.0;
+            for (auto id : valid)
+                sum += boxes[id].range(a);
+            mean_range[a] = sum / static_cast<double>(valid.size());
+            const double ratio = sum / std::max(static_cast<double>(total.range(a)), 1e-30);
+            if (ratio < best) {
+                best = ratio;
+                axis = a;
+            }
+        }
+
+        // The other two axes are partitioned into a uniform grid. Each box is added to all the grid cells it
+        // overlaps, and the boxes in each cell are swept along the sweep axis (the cells are processed in
+        // parallel). A pair is reported only in the cell containing the min corner of the overlap of the two boxes
+        // (in the grid plane), so each pair is reported exactly once.
+        const unsigned int ay = (axis + 1) % 3;
+        const unsigned int az = (axis + 2) % 3;
+        const int max_res = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(valid.size()) / 8.0)));
+        int res[2];
+        float cell_size[2];
+        const unsigned int grid_axes[2] = {ay, az};
+        for (int k = 0; k < 2; ++k) {
+            const unsigned int a = grid_axes[k];
+            const double r = total.range(a);
+            res[k] = (mean_range[a] > 0.0) ? static_cast<int>(std::min(r / (2.0 * mean_range[a]), double(max_res)))
+                                            : max_res;
+            res[k] = std::max(res[k], 1);
+            cell_size[k] = static_cast<float>(r / res[k]);
+        }
+        auto cell_coord = [&](float v, int k) -> int {
+            if (cell_size[k] <= 0.0f)
+                return 0;
+            const int c = static_cast<int>((v - total.min_coord(grid_axes[k])) / cell_size[k]);
+            return std::min(std::max(c, 0), res[k] - 1);
+        };
+
+        std::sort(valid.begin(), valid.end(), [&boxes, axis](int a, int b) -> bool {
+            const float ma = boxes[a].min_coord(axis);
+            const float mb = boxes[b].min_coord(axis);
+            return ma < mb || (ma == mb && a < b);
+        });
+
+        // the boxes of each cell (in the sorted order), stored contiguously in the CRS format
+        const int num_cells = res[0] * res[1];
+        std::vector<int> cell_ptr(num_cells + 1, 0);
+        for (auto id : valid) {
+            const Box3 &b = boxes[id];
+            const int y0 = cell_coord(b.min_coord(ay), 0), y1 = cell_coord(b.max_coord(ay), 0);
+            const int z0 = cell_coord(b.min_coord(az), 1), z1 = cell_coord(b.max_coord(az), 1);
+            for (int y = y0; y <= y1; ++y) {
+                for (int z = z0; z <= z1; ++z)
+                    ++cell_ptr[y * res[1] + z + 1];
+            }
+        }
+        for (int c = 0; c < num_cells; ++c)
+            cell_ptr[c + 1] += cell_ptr[c];
+        std::vector<int> cell_boxes(cell_ptr[num_cells]);
+        std::vector<int> fill(cell_ptr.begin(), cell_ptr.end() - 1);
+        for (auto id : valid) {
+            const Box3 &b = boxes[id];
+            const int y0 = cell_coord(b.min_coord(ay), 0), y1 = cell_coord(b.max_coord(ay), 0);
+            const int z0 = cell_coord(b.min_coord(az), 1), z1 = cell_coord(b.max_coord(az), 1);
+            for (int y = y0; y <= y1; ++y) {
+                for (int z = z0; z <= z1; ++z)
+                    cell_boxes[fill[y * res[1] + z]++] = id;
+            }
+        }
+        std::vector<int>().swap(fill);
+
+        std::vector<std::vector<std::pair<int, int> > > cell_pairs(num_cells);
+
+#pragma omp parallel for schedule(dynamic)
+        for (int c = 0; c < num_cells; ++c) {
+            const int begin = cell_ptr[c];
+            const int end = cell_ptr[c + 1];
+            if (end - begin < 2)
+                continue;
+            const int cy = c / res[1];
+            const int cz = c % res[1];
+            auto &result = cell_pairs[c];
+            for (int i = begin; i < end; ++i) {
+                const Box3 &bi = boxes[cell_boxes[i]];
+                const float max_i = bi.max_coord(axis);
+                for (int j = i + 1; j < end; ++j) {
+                    const Box3 &bj = boxes[cell_boxes[j]];
+                    if (bj.min_coord(axis) > max_i)
+                        break;
+                    if (bj.min_coord(ay) > bi.max_coord(ay) || bi.min_coord(ay) > bj.max_coord(ay) ||
+                        bj.min_coord(az) > bi.max_coord(az) || bi.min_coord(az) > bj.max_coord(az))
+                        continue;
+                    // report the pair only in the cell containing the min corner of the overlap
+                    if (cell_coord(std::max(bi.min_coord(ay), bj.min_coord(ay)), 0) != cy ||
+                        cell_coord(std::max(bi.min_coord(az), bj.min_coord(az)), 1) != cz)
+                        continue;
+                    const int a = cell_boxes[i];
+                    const int b = cell_boxes[j];
+                    result.emplace_back(std::min(a, b), std::max(a, b));
+                }
+            }
+        }
+
+        std::size_t count = 0;
+        for (const auto &result : cell_pairs)
+            count += result.size();
+        pairs.reserve(count);
+        for (auto &result : cell_pairs) {
+            pairs.insert(pairs.end(), result.begin(), result.end());
+            std::vector<std::pair<int, int> >().swap(result);
+        }
+        std::sort(pairs.begin(), pairs.end());
+    }
+
+} // namespace easy3d
@@ -0,0 +1,50 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_ALGO_EXT_BOX_INTERSECTION_H
+#define EASY3D_ALGO_EXT_BOX_INTERSECTION_H
+
+#include <vector>
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Finds all pairs of intersecting axis-aligned boxes, i.e., the broad phase of all-pairs intersection
+     *      tests (e.g., between the faces of a mesh).
+     * \details The boxes are closed (i.e., touching boxes intersect) and invalid boxes are ignored. The boxes are
+     *      distributed into a uniform grid over two axes, and the boxes in each grid cell are swept (in parallel)
+     *      along the axis on which they overlap the least.
+     * @param boxes The boxes.
+     * @param pairs Returns the indices (i, j) of the intersecting boxes, with i < j and sorted in ascending order.
+     *      So the result does not depend on the number of threads.
+     */
+    void box_self_intersection(const std::vector<Box3> &boxes, std::vector<std::pair<int, int> > &pairs);
+
+} // namespace easy3d
+
+#endif  // EASY3D_ALGO_EXT_BOX_INTERSECTION_H
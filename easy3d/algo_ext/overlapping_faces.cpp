@@ -25,6 +25,7 @@
  ********************************************************************/
 
 #include <easy3d/algo_ext/overlapping_faces.h>
+#include <easy3d/algo_ext/box_intersection.h>
 
 #include <set>
 #include <unordered_map>
@@ -64,7 +65,7 @@ namespace easy3d {
     }
 
 
-    OverlappingFaces::OverlapType OverlappingFaces::do_overlap(const Triangle &A, const Triangle &B, double sqr_eps) {
+    OverlappingFaces::OverlapType OverlappingFaces::do_overlap(const Triangle &A, const Triangle &B, double sqr_eps) const {
         // Number of combinatorially shared vertices
         int num_comb_shared_vertices = 0;
 
@@ -159,27 +160,39 @@ namespace easy3d {
 
         triangle_faces_ = mesh_to_cgal_triangle_list(mesh);
 
-        // bounding boxes of the triangles
-        std::vector<Box> boxes;
-        for (TrianglesIterator it = triangle_faces_.begin(); it != triangle_faces_.end(); ++it) {
-            if (!it->triangle.is_degenerate())
-                boxes.push_back(Box(it->triangle.bbox(), it));
+        // bounding boxes of the (non-degenerate) triangles
+        const int num = static_cast<int>(triangle_faces_.size());
+        std::vector<Box3> boxes(num);
+        for (int i = 0; i < num; ++i) {
+            const Triangle_3 &t = triangle_faces_[i].triangle;
+            if (!t.is_degenerate()) {
+                for (int j = 0; j < 3; ++j) {
+                    const Point_3 &p = t.vertex(j); // converted from float, so exact
+                    boxes[i].grow(vec3(float(p.x()), float(p.y()), float(p.z())));
+                }
+            }
         }
-        std::vector< std::pair<TrianglesIterator, TrianglesIterator> > intersecting_boxes;
-        auto cb = [&intersecting_boxes](const Box &a, const Box &b) {
-            intersecting_boxes.push_back({ a.handle(), b.handle() });
-        };
-        CGAL::box_self_intersection_d(boxes.begin(), boxes.end(), cb);
-
-        double sqr_eps = dist_threshold * dist_threshold;
-        for (const auto& b : intersecting_boxes) {
-            const Triangle& ta = *b.first;
-            const Triangle& tb = *b.second;
-
-            auto type = do_overlap(ta, tb, sqr_eps);
-            if (type == OT_SAME)
+
+        // broad phase: pairs of triangles with intersecting bounding boxes
+        std::vector<std::pair<int, int> > intersecting_boxes;
+        box_self_intersection(boxes, intersecting_boxes);
+
+        // narrow phase (in parallel)
+        const double sqr_eps = dist_threshold * dist_threshold;
+        const int num_pairs = static_cast<int>(intersecting_boxes.size());
+        std::vector<OverlapType> types(num_pairs);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < num_pairs; ++i) {
+            const auto &b = intersecting_boxes[i];
+            types[i] = do_overlap(triangle_faces_[b.first], triangle_faces_[b.second], sqr_eps);
+        }
+
+        for (int i = 0; i < num_pairs; ++i) {
+            const Triangle& ta = triangle_faces_[intersecting_boxes[i].first];
+            const Triangle& tb = triangle_faces_[intersecting_boxes[i].second];
+            if (types[i] == OT_SAME)
                 duplicate_faces.emplace_back(std::make_pair(ta.face, tb.face));
-            else if (type == OT_FOLDING)
+            else if (types[i] == OT_FOLDING)
                 folding_faces.emplace_back(std::make_pair(ta.face, tb.face));
         }
     }
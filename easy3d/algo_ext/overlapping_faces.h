@@ -35,7 +35,6 @@
 
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/intersections.h>	// Triangle triangle intersection
-#include <CGAL/box_intersection_d.h>
 
 #include <easy3d/core/surface_mesh.h>
 
@@ -100,17 +99,15 @@ namespace easy3d {
             std::vector<SurfaceMesh::Vertex> vertices;
         };
 
-        // Axis-align boxes for all-pairs self-intersection detection
         typedef std::vector<Triangle>				Triangles;
-        typedef typename Triangles::iterator		TrianglesIterator;
-        typedef CGAL::Box_intersection_d::Box_with_handle_d<double, 3, TrianglesIterator>	Box;
 
     private:
         Triangles mesh_to_cgal_triangle_list(SurfaceMesh* esh);
 
         // test if two triangles duplicate
         enum OverlapType {OT_NONE, OT_SAME, OT_FOLDING};
-        OverlapType do_overlap(const Triangle& A, const Triangle& B, double sqr_eps);
+        // it does not change any state, so it can be called in parallel
+        OverlapType do_overlap(const Triangle& A, const Triangle& B, double sqr_eps) const;
 
         Triangles triangle_faces_;
     };
@@ -9,12 +9,14 @@
  ********************************************************************/
 
 #include <easy3d/algo_ext/self_intersection.h>
+#include <easy3d/algo_ext/box_intersection.h>
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/surface_mesh_builder.h>
 #include <easy3d/util/logging.h>
 #include <easy3d/algo_ext/surfacer.h>
 
 #include <queue>
+#include <cmath>
 
 #define REMESH_INTERSECTIONS_TIMING
 
@@ -27,8 +29,50 @@
 namespace easy3d {
 
 
+    namespace details {
+
+        // The sign of the orientation of d w.r.t. the plane (a, b, c), evaluated in double precision. Returns 0 if
+        // the sign cannot be certified, using the static error bound of the orient3d predicate from
+        //      J. R. Shewchuk. Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates.
+        //      Discrete & Computational Geometry, 18(3):305-363, 1997.
+        // The float inputs are exactly representable in double precision, so the bound applies.
+        inline int orient_3d_filtered(const vec3 &a, const vec3 &b, const vec3 &c, const vec3 &d) {
+            const double adx = double(a.x) - d.x, ady = double(a.y) - d.y, adz = double(a.z) - d.z;
+            const double bdx = double(b.x) - d.x, bdy = double(b.y) - d.y, bdz = double(b.z) - d.z;
+            const double cdx = double(c.x) - d.x, cdy = double(c.y) - d.y, cdz = double(c.z) - d.z;
+
+            const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+            const double cdxady = cdx * ady, adxcdy = adx * cdy;
+            const double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+            const double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+            const double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz)
+                                     + (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz)
+                                     + (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz);
+            const double err_bound = 7.7715611723761027e-16 * permanent;
+            if (det > err_bound)
+                return 1;
+            if (det < -err_bound)
+                return -1;
+            return 0;
+        }
+
+        // true if the points p[i] (i in [0, n)) are certainly strictly on the same side of the plane of triangle t
+        inline bool strictly_one_side(const vec3 *t, const vec3 *const *p, int n) {
+            const int s = orient_3d_filtered(t[0], t[1], t[2], *p[0]);
+            if (s == 0)
+                return false;
+            for (int i = 1; i < n; ++i) {
+                if (orient_3d_filtered(t[0], t[1], t[2], *p[i]) != s)
+                    return false;
+            }
+            return true;
+        }
+    }
+
+
     SelfIntersection::SelfIntersection()
-            : mesh_(nullptr), construct_intersection_(false) {}
+            : mesh_(nullptr), construct_intersection_(false), filter_enabled_(true) {}
 
 
     SelfIntersection::~SelfIntersection() {
@@ -55,21 +99,36 @@ namespace easy3d {
 
         mesh_to_cgal_triangle_list(input_mesh);
 
-        // bounding boxes of the triangles
-        std::vector<Box> boxes;
-        for (TrianglesIterator it = triangle_faces_.begin(); it != triangle_faces_.end(); ++it) {
-            if (!it->triangle.is_degenerate())
-                boxes.push_back(Box(it->triangle.bbox(), it));
+        // bounding boxes of the (non-degenerate) triangles
+        const int num = static_cast<int>(triangle_faces_.size());
+        std::vector<Box3> boxes(num);
+        for (int i = 0; i < num; ++i) {
+            const Triangle &t = triangle_faces_[i];
+            if (!t.triangle.is_degenerate()) {
+                for (const auto &p : t.points)
+                    boxes[i].grow(p);
+            }
+        }
+
+        // broad phase: pairs of triangles with intersecting bounding boxes
+        std::vector<std::pair<int, int> > intersecting_boxes;
+        box_self_intersection(boxes, intersecting_boxes);
+
+        // narrow phase: the floating-point filter rejects most of the candidate pairs (in parallel), and only the
+        // remaining ones are tested using exact arithmetic (sequentially, as the results are accumulated).
+        const int num_pairs = static_cast<int>(intersecting_boxes.size());
+        std::vector<unsigned char> candidate(num_pairs);
+#pragma omp parallel for schedule(dynamic, 1024)
+        for (int i = 0; i < num_pairs; ++i) {
+            const auto &b = intersecting_boxes[i];
+            candidate[i] = !filter_enabled_ || may_intersect(triangle_faces_[b.first], triangle_faces_[b.second]);
         }
-        std::vector<std::pair<TrianglesIterator, TrianglesIterator> > intersecting_boxes;
-        auto cb = [&intersecting_boxes](const Box &a, const Box &b) {
-            intersecting_boxes.push_back({a.handle(), b.handle()});
-        };
-        CGAL::box_self_intersection_d(boxes.begin(), boxes.end(), cb);
 
-        for (const auto &b : intersecting_boxes) {
-            const Triangle &ta = *b.first;
-            const Triangle &tb = *b.second;
+        for (int i = 0; i < num_pairs; ++i) {
+            if (!candidate[i])
+                continue;
+            const Triangle &ta = triangle_faces_[intersecting_boxes[i].first];
+            const Triangle &tb = triangle_faces_[intersecting_boxes[i].second];
             if (do_intersect(ta, tb)) {
                 auto fa = original_face[ta.index];
                 auto fb = original_face[tb.index];
@@ -332,6 +391,48 @@ namespace easy3d {
     }
 
 
+    bool SelfIntersection::may_intersect(const Triangle &A, const Triangle &B) const {
+        // The shared vertices are classified in the same way as in do_intersect(). A geometrically shared vertex
+        // (i.e., squared distance < FLT_MIN) can only be confirmed exactly, so such pairs are always escalated.
+        int num_comb_shared_vertices = 0;
+        int sa[3] = {0, 0, 0}, sb[3] = {0, 0, 0};   // shared flags
+        for (unsigned short ea = 0; ea < 3; ++ea) {
+            for (unsigned short eb = 0; eb < 3; ++eb) {
+                if (A.vertices[ea] == B.vertices[eb]) {
+                    ++num_comb_shared_vertices;
+                    sa[ea] = sb[eb] = 1;
+                } else if (distance2(dvec3(A.points[ea]), dvec3(B.points[eb])) < 2.0 * FLT_MIN)
+                    return true;
+            }
+        }
+
+        switch (num_comb_shared_vertices) {
+            case 0: {   // separated by the supporting plane of either triangle
+                const vec3 *pa[3] = {&A.points[0], &A.points[1], &A.points[2]};
+                const vec3 *pb[3] = {&B.points[0], &B.points[1], &B.points[2]};
+                return !details::strictly_one_side(A.points, pb, 3) && !details::strictly_one_side(B.points, pa, 3);
+            }
+            case 1: {   // the edges opposite to the shared vertex are both separated from the other triangle
+                const vec3 *pa[2], *pb[2];
+                for (int i = 0, ia = 0, ib = 0; i < 3; ++i) {
+                    if (!sa[i]) pa[ia++] = &A.points[i];
+                    if (!sb[i]) pb[ib++] = &B.points[i];
+                }
+                return !(details::strictly_one_side(B.points, pa, 2) && details::strictly_one_side(A.points, pb, 2));
+            }
+            case 2: {   // not coplanar
+                const vec3 *pb[1] = {nullptr};
+                for (int i = 0; i < 3; ++i) {
+                    if (!sb[i]) pb[0] = &B.points[i];
+                }
+                return !details::strictly_one_side(A.points, pb, 1);
+            }
+            default:    // duplicate faces are counted by do_intersect()
+                return true;
+        }
+    }
+
+
     void SelfIntersection::mesh_to_cgal_triangle_list(SurfaceMesh *input_mesh) {
         if (mesh_)
             delete mesh_;
@@ -362,6 +463,8 @@ namespace easy3d {
                 original_face[triangle_faces_.size()] = to_input_face[f];
                 t.index = f.idx();
                 t.vertices = vertices;
+                for (int i = 0; i < 3; ++i)
+                    t.points[i] = prop[vertices[i]];
                 triangle_faces_.push_back(t);
             } else {
                 LOG_N_TIMES(3, WARNING) << "only triangular meshes can be processed. " << COUNTER;
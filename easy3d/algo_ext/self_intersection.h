@@ -19,7 +19,6 @@
 
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/intersections.h>    // for triangle-triangle intersection
-#include <CGAL/box_intersection_d.h>
 #include <CGAL/Constrained_Delaunay_triangulation_2.h>
 #include <CGAL/Constrained_triangulation_plus_2.h>
 
@@ -69,6 +68,13 @@ namespace easy3d {
          */
         bool remesh(SurfaceMesh *mesh, bool stitch);
 
+        /**
+         * \brief Enables (default) or disables the floating-point filter that rejects most of the candidate face pairs
+         *      before the exact intersection tests. The result does not change, so disabling the filter is only
+         *      useful to validate it.
+         */
+        void set_filter_enabled(bool enabled) { filter_enabled_ = enabled; }
+
     private:
 
         typedef CGAL::Exact_predicates_exact_constructions_kernel Kernel;
@@ -104,12 +110,10 @@ namespace easy3d {
             SurfaceMesh::Face face;
             int index;    // face index
             std::vector<SurfaceMesh::Vertex> vertices;
+            vec3 points[3]; // the (exact) input coordinates, for the floating-point filters
         };
 
-        // Axis-align boxes for all-pairs self-intersection detection
         typedef std::vector<Triangle> Triangles;
-        typedef typename Triangles::iterator TrianglesIterator;
-        typedef CGAL::Box_intersection_d::Box_with_handle_d<double, 3, TrianglesIterator> Box;
 
     private:
 
@@ -118,6 +122,10 @@ namespace easy3d {
         // test if two triangles intersect
         bool do_intersect(const Triangle &A, const Triangle &B);
 
+        // Floating-point filter of do_intersect(). Returns false only if A and B are certainly not intersecting
+        // (and are not duplicates). Only the input coordinates are used, so it is thread safe.
+        bool may_intersect(const Triangle &A, const Triangle &B) const;
+
         // Given a list of objects (e.g., resulting from intersecting a triangle
         // with many other triangles), construct a constrained Delaunay
         // triangulation on a given plane (P), by inserting constraints for each
@@ -203,6 +211,8 @@ namespace easy3d {
 
         bool construct_intersection_;
 
+        bool filter_enabled_;
+
         Triangles triangle_faces_;
 
         // index in 'triangle_faces_' (degenerate faces removed) -> original face
@@ -29,6 +29,9 @@
 #include <easy3d/util/logging.h>
 #include <easy3d/core/surface_mesh_builder.h>
 
+#include <numeric>
+#include <unordered_map>
+
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 
 #include <CGAL/Surface_mesh.h>
@@ -38,7 +41,6 @@
 #include <CGAL/Polygon_mesh_processing/polygon_soup_to_polygon_mesh.h>
 #include <CGAL/Polygon_mesh_processing/orientation.h>
 #include <CGAL/Polygon_mesh_processing/clip.h>
-#include <CGAL/Polygon_mesh_slicer.h>
 
 
 typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
@@ -235,6 +237,149 @@ namespace easy3d {
             mesh.clear();
             CGAL::Polygon_mesh_processing::polygon_soup_to_polygon_mesh(points, polygons, mesh);
         }
+
+
+        // Slices a triangle mesh by a set of parallel planes {p | dot(dir, p) = levels[i]}.
+        // A vertex exactly on a plane is treated as above the plane (i.e., a symbolic perturbation), so each face
+        // intersected by a plane contributes exactly one segment, which starts at the edge crossed downwards and ends
+        // at the edge crossed upwards (w.r.t. dir). Faces on the plane do not contribute.
+        // Each face is assigned once to all the planes intersecting it (using a binary search in the sorted levels),
+        // and then the planes are processed in parallel: the segments are linked into polylines using a hash map on
+        // the IDs of the edges.
+        void slice(SurfaceMesh *mesh, const dvec3 &dir, const std::vector<double> &levels,
+                   std::vector<std::vector<Surfacer::Polyline> > &result) {
+            const int num_levels = static_cast<int>(levels.size());
+            result.assign(num_levels, std::vector<Surfacer::Polyline>());
+            if (num_levels == 0)
+                return;
+
+            const std::vector<vec3> &points = mesh->points();
+            const int num_vertices = static_cast<int>(points.size());
+            std::vector<double> height(num_vertices);
+#pragma omp parallel for
+            for (int i = 0; i < num_vertices; ++i)
+                height[i] = dot(dir, dvec3(points[i]));
+
+            std::vector<int> order(num_levels);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&levels](int a, int b) -> bool {
+                return levels[a] < levels[b];
+            });
+            std::vector<double> sorted_levels(num_levels);
+            for (int i = 0; i < num_levels; ++i)
+                sorted_levels[i] = levels[order[i]];
+
+            // a face is intersected by a plane at level t if min_height < t <= max_height, i.e., the planes in
+            // [first, last) of the sorted levels
+            const int num_faces = static_cast<int>(mesh->faces_size());     // including the deleted ones
+            std::vector<int> first(num_faces, 0), last(num_faces, 0);
+#pragma omp parallel for
+            for (int i = 0; i < num_faces; ++i) {
+                const SurfaceMesh::Face f(i);
+                if (mesh->is_deleted(f))
+                    continue;
+                double min_height = std::numeric_limits<double>::max();
+                double max_height = -std::numeric_limits<double>::max();
+                for (auto v : mesh->vertices(f)) {
+                    min_height = std::min(min_height, height[v.idx()]);
+                    max_height = std::max(max_height, height[v.idx()]);
+                }
+                first[i] = static_cast<int>(
+                        std::upper_bound(sorted_levels.begin(), sorted_levels.end(), min_height) - sorted_levels.begin());
+                last[i] = static_cast<int>(
+                        std::upper_bound(sorted_levels.begin(), sorted_levels.end(), max_height) - sorted_levels.begin());
+            }
+
+            // the faces intersected by each plane, stored contiguously in the CRS format
+            std::vector<int> layer_ptr(num_levels + 1, 0);
+            for (int i = 0; i < num_faces; ++i) {
+                for (int l = first[i]; l < last[i]; ++l)
+                    ++layer_ptr[l + 1];
+            }
+            for (int l = 0; l < num_levels; ++l)
+                layer_ptr[l + 1] += layer_ptr[l];
+            std::vector<int> layer_faces(layer_ptr[num_levels]);
+            std::vector<int> fill(layer_ptr.begin(), layer_ptr.end() - 1);
+            for (int i = 0; i < num_faces; ++i) {
+                for (int l = first[i]; l < last[i]; ++l)
+                    layer_faces[fill[l]++] = i;
+            }
+
+#pragma omp parallel for schedule(dynamic)
+            for (int l = 0; l < num_levels; ++l) {
+                const double t = sorted_levels[l];
+                const int begin = layer_ptr[l];
+                const int end = layer_ptr[l + 1];
+
+                // the segments (start edge, end edge)
+                std::vector<std::pair<int, int> > segments;
+                segments.reserve(end - begin);
+                for (int i = begin; i < end; ++i) {
+                    int start_edge = -1, end_edge = -1;
+                    for (auto h : mesh->halfedges(SurfaceMesh::Face(layer_faces[i]))) {
+                        const bool from_above = height[mesh->source(h).idx()] >= t;
+                        const bool to_above = height[mesh->target(h).idx()] >= t;
+                        if (from_above && !to_above)
+                            start_edge = mesh->edge(h).idx();
+                        else if (!from_above && to_above)
+                            end_edge = mesh->edge(h).idx();
+                    }
+                    if (start_edge != -1 && end_edge != -1)
+                        segments.emplace_back(start_edge, end_edge);
+                }
+                const int num_segments = static_cast<int>(segments.size());
+
+                // the segment starting at each edge (unique for a manifold mesh)
+                std::unordered_map<int, int> starting_at(num_segments * 2);
+                for (int s = 0; s < num_segments; ++s)
+                    starting_at[segments[s].first] = s;
+                std::vector<bool> has_previous(num_segments, false);
+                for (int s = 0; s < num_segments; ++s) {
+                    auto pos = starting_at.find(segments[s].second);
+                    if (pos != starting_at.end())
+                        has_previous[pos->second] = true;
+                }
+
+                auto crossing = [&](int e) -> vec3 {
+                    const SurfaceMesh::Edge edge(e);
+                    const auto v0 = mesh->vertex(edge, 0);
+                    const auto v1 = mesh->vertex(edge, 1);
+                    const double h0 = height[v0.idx()];
+                    const double h1 = height[v1.idx()];
+                    const dvec3 p0(points[v0.idx()]);
+                    const dvec3 p1(points[v1.idx()]);
+                    return vec3(p0 + (p1 - p0) * ((t - h0) / (h1 - h0)));
+                };
+
+                auto &polylines = result[order[l]];
+                std::vector<bool> visited(num_segments, false);
+                auto trace = [&](int s) -> void {
+                    Surfacer::Polyline polyline(1, crossing(segments[s].first));
+                    while (true) {
+                        visited[s] = true;
+                        const vec3 p = crossing(segments[s].second);
+                        if (p != polyline.back()) // skip the zero-length pieces (caused by vertices on the plane)
+                            polyline.push_back(p);
+                        auto pos = starting_at.find(segments[s].second);
+                        if (pos == starting_at.end() || visited[pos->second])
+                            break;
+                        s = pos->second;
+                    }
+                    if (polyline.size() > 1)
+                        polylines.push_back(polyline);
+                };
+
+                // the open polylines first, and then the closed ones (whose first and last points are identical)
+                for (int s = 0; s < num_segments; ++s) {
+                    if (!has_previous[s])
+                        trace(s);
+                }
+                for (int s = 0; s < num_segments; ++s) {
+                    if (!visited[s])
+                        trace(s);
+                }
+            }
+        }
     }
 
 
@@ -442,39 +587,55 @@ namespace easy3d {
             return result;
         }
 
-        typedef std::vector<K::Point_3> CGALPolyline;
-
-        auto to_easy3d = [](std::vector<CGALPolyline>& input) -> std::vector<Surfacer::Polyline> {
-            std::vector<Surfacer::Polyline> polylines(input.size());
-            for (std::size_t i = 0; i < input.size(); ++i) {
-                const CGALPolyline &pl = input[i];
-                polylines[i].resize(pl.size());
-                for (std::size_t j = 0; j < pl.size(); ++j) {
-                    const auto &p = pl[j];
-                    polylines[i][j] = vec3(
-                            CGAL::to_double(p.x()),
-                            CGAL::to_double(p.y()),
-                            CGAL::to_double(p.z())
-                    );
+        const std::size_t num = input_planes.size();
+        result.resize(num);
+
+        // the planes sharing the same normal direction are sliced together
+        std::vector<bool> processed(num, false);
+        for (std::size_t i = 0; i < num; ++i) {
+            if (processed[i])
+                continue;
+            const dvec3 normal(input_planes[i].a(), input_planes[i].b(), input_planes[i].c());
+            if (length(normal) == 0.0) {
+                LOG(WARNING) << "plane " << i << " is degenerate (zero normal vector)";
+                processed[i] = true;
+                continue;
+            }
+            const dvec3 dir = normalize(normal);
+
+            std::vector<std::size_t> members;
+            std::vector<double> levels;
+            std::vector<bool> reversed;
+            for (std::size_t j = i; j < num; ++j) {
+                if (processed[j])
+                    continue;
+                const dvec3 n(input_planes[j].a(), input_planes[j].b(), input_planes[j].c());
+                const double len = length(n);
+                if (len == 0.0)
+                    continue;
+                const double d = input_planes[j].d();
+                if (distance2(n / len, dir) < 1e-12) {
+                    members.push_back(j);
+                    levels.push_back(-d / len);
+                    reversed.push_back(false);
+                    processed[j] = true;
+                } else if (distance2(n / len, -dir) < 1e-12) {
+                    members.push_back(j);
+                    levels.push_back(d / len);
+                    reversed.push_back(true);   // the polylines are oriented w.r.t. the normal of the plane
+                    processed[j] = true;
                 }
             }
-            return polylines;
-        };
 
-        CGALMesh mesh;
-        details::to_cgal(input_mesh, mesh);
-        // Slicer constructor from the mesh
-        CGAL::Polygon_mesh_slicer<CGALMesh , K> slicer(mesh);
-
-        std::vector< std::vector<CGALPolyline> > CGALResult(input_planes.size());
-        for (std::size_t i=0; i<input_planes.size(); ++i) {
-            const auto &input_plane = input_planes[i];
-            Plane_3 plane(input_plane.a(), input_plane.b(), input_plane.c(), input_plane.d());
-
-            std::vector<CGALPolyline> lines;
-            slicer(plane, std::back_inserter(lines));
-
-            result.push_back(to_easy3d(lines));
+            std::vector< std::vector<Surfacer::Polyline> > polylines;
+            details::slice(input_mesh, dir, levels, polylines);
+            for (std::size_t k = 0; k < members.size(); ++k) {
+                if (reversed[k]) {
+                    for (auto &polyline : polylines[k])
+                        std::reverse(polyline.begin(), polyline.end());
+                }
+                result[members[k]].swap(polylines[k]);
+            }
         }
 
         return result;
@@ -282,6 +282,12 @@ namespace easy3d {
          *         counterclockwise.
          * \note An edge shared by two faces included in plane will not be reported. For example, if plane passes
          *       though one face of a cube, only one closed polyline will be reported (the boundary of the face).
+         *       A vertex exactly on a plane is treated as being on the positive side of the plane, and the first and
+         *       last points of a closed polyline are identical.
+         * \details The planes sharing the same normal direction are processed together: each face is assigned once
+         *       to all the planes intersecting it, and then the planes are sliced in parallel. So slicing a mesh
+         *       by many parallel planes (e.g., layers for 3D printing) costs much less than slicing by each plane
+         *       individually.
          * \see slice(SurfaceMesh *mesh, const Plane3 &plane).
          */
         static std::vector< std::vector<Polyline> > slice(SurfaceMesh *mesh, const std::vector<Plane3> &planes);
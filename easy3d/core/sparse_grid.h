@@ -0,0 +1,180 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_CORE_SPARSE_GRID_H
+#define EASY3D_CORE_SPARSE_GRID_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <easy3d/core/types.h>
+
+
+namespace easy3d {
+
+    /**
+     * \brief A sparse regular grid storing a value at each grid point (i.e., voxel).
+     * \class SparseGrid easy3d/core/sparse_grid.h
+     * \details The grid points are grouped into blocks of block_size^3 points, and only the blocks that have been
+     *      added are stored (contiguously, in the order they were added). The value of any other grid point is the
+     *      background value. Grid point (i, j, k) is located at origin + (i, j, k) * voxel_size, and the indices
+     *      can be negative.
+     *      Adding blocks is not thread-safe, but the values of existing blocks can be modified in parallel (e.g.,
+     *      one block per thread).
+     *
+     * Example usage:
+     *  \code
+     *      SparseGrid<float> grid(origin, 0.01f, 1.0f);
+     *      grid.set_value(i, j, k, 0.5f);
+     *      for (std::size_t b = 0; b < grid.num_blocks(); ++b) {
+     *          const auto& block = grid.block(b);
+     *          int i, j, k;
+     *          for (int v = 0; v < SparseGrid<float>::block_volume; ++v) {
+     *              block.grid_point(v, i, j, k);
+     *              ... block.values[v] is the value at grid point (i, j, k)
+     *          }
+     *      }
+     *  \endcode
+     */
+    template<typename T>
+    class SparseGrid {
+    public:
+        /// The number of grid points along each side of a block.
+        static const int block_size = 8;
+        /// The number of grid points in a block.
+        static const int block_volume = block_size * block_size * block_size;
+
+        /// \brief A block of block_size^3 grid points.
+        struct Block {
+            int x, y, z;            ///< The coordinates of the block (its first grid point is (x, y, z) * block_size).
+            std::vector<T> values;  ///< The values, indexed by (i + block_size * (j + block_size * k)) (local indices).
+
+            /// \brief Returns the (global) indices of the v-th grid point of this block.
+            void grid_point(int v, int &i, int &j, int &k) const {
+                i = x * block_size + v % block_size;
+                j = y * block_size + (v / block_size) % block_size;
+                k = z * block_size + v / (block_size * block_size);
+            }
+        };
+
+    public:
+        /**
+         * \brief Constructs an empty grid.
+         * @param origin The position of grid point (0, 0, 0).
+         * @param voxel_size The distance between two adjacent grid points.
+         * @param background The value of the grid points that are not stored.
+         */
+        explicit SparseGrid(const vec3 &origin = vec3(0, 0, 0), float voxel_size = 1.0f, const T &background = T())
+                : origin_(origin), voxel_size_(voxel_size), background_(background) {}
+
+        /// \brief The position of grid point (0, 0, 0).
+        const vec3 &origin() const { return origin_; }
+        /// \brief The distance between two adjacent grid points.
+        float voxel_size() const { return voxel_size_; }
+        /// \brief The value of the grid points that are not stored.
+        const T &background() const { return background_; }
+
+        /// \brief Returns the position of grid point (i, j, k).
+        vec3 position(int i, int j, int k) const {
+            return origin_ + vec3(static_cast<float>(i), static_cast<float>(j), static_cast<float>(k)) * voxel_size_;
+        }
+
+        /// \brief Returns the number of blocks.
+        std::size_t num_blocks() const { return blocks_.size(); }
+        /// \brief Returns the idx-th block.
+        const Block &block(std::size_t idx) const { return blocks_[idx]; }
+        /// \brief Returns the idx-th block.
+        Block &block(std::size_t idx) { return blocks_[idx]; }
+
+        /// \brief Returns the index of the block with coordinates (bx, by, bz), or -1 if it doesn't exist.
+        int find_block(int bx, int by, int bz) const {
+            auto pos = index_.find(key(bx, by, bz));
+            return pos == index_.end() ? -1 : pos->second;
+        }
+
+        /// \brief Adds the block with coordinates (bx, by, bz) (filled with the background value) if it doesn't exist.
+        /// \return The index of the block.
+        int add_block(int bx, int by, int bz) {
+            auto result = index_.emplace(key(bx, by, bz), static_cast<int>(blocks_.size()));
+            if (result.second) {
+                blocks_.emplace_back();
+                Block &b = blocks_.back();
+                b.x = bx;
+                b.y = by;
+                b.z = bz;
+                b.values.assign(block_volume, background_);
+            }
+            return result.first->second;
+        }
+
+        /// \brief Returns the value at grid point (i, j, k) (the background value if it is not stored).
+        const T &value(int i, int j, int k) const {
+            const int idx = find_block(block_coordinate(i), block_coordinate(j), block_coordinate(k));
+            if (idx < 0)
+                return background_;
+            return blocks_[idx].values[local_index(i, j, k)];
+        }
+
+        /// \brief Sets the value at grid point (i, j, k). The block containing it is added if it doesn't exist.
+        void set_value(int i, int j, int k, const T &value) {
+            const int idx = add_block(block_coordinate(i), block_coordinate(j), block_coordinate(k));
+            blocks_[idx].values[local_index(i, j, k)] = value;
+        }
+
+        /// \brief Returns the coordinate of the block containing the grid point with index i (along an axis).
+        static int block_coordinate(int i) {
+            return i >= 0 ? i / block_size : -((-i + block_size - 1) / block_size);
+        }
+
+        /// \brief Returns the index of grid point (i, j, k) within its block.
+        static int local_index(int i, int j, int k) {
+            const int li = i - block_coordinate(i) * block_size;
+            const int lj = j - block_coordinate(j) * block_size;
+            const int lk = k - block_coordinate(k) * block_size;
+            return li + block_size * (lj + block_size * lk);
+        }
+
+    private:
+        // the block coordinates are stored in 21 bits each
+        static uint64_t key(int bx, int by, int bz) {
+            const uint64_t offset = 1u << 20, mask = 0x1fffff;
+            return (((static_cast<uint64_t>(bx) + offset) & mask) << 42) |
+                   (((static_cast<uint64_t>(by) + offset) & mask) << 21) |
+                   ((static_cast<uint64_t>(bz) + offset) & mask);
+        }
+
+    private:
+        vec3 origin_;
+        float voxel_size_;
+        T background_;
+        std::vector<Block> blocks_;
+        std::unordered_map<uint64_t, int> index_;
+    };
+
+} // namespace easy3d
+
+#endif  // EASY3D_CORE_SPARSE_GRID_H
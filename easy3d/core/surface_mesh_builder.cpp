@@ -225,6 +225,202 @@ namespace easy3d {
     }
 
 
+    bool SurfaceMeshBuilder::build(std::vector<vec3> &points, const std::vector<int> &indices,
+                                   const std::vector<int> &offsets, std::vector<Halfedge> *corners) {
+        mesh_->clear();
+
+        const int nv = static_cast<int>(points.size());
+        const int nf = offsets.empty() ? 0 : static_cast<int>(offsets.size()) - 1;
+        const int nc = static_cast<int>(indices.size());
+        if (corners)
+            corners->assign(nf, Halfedge());
+
+        // the corner following corner c in polygon f
+        auto next_corner = [&offsets](int f, int c) -> int { return c + 1 < offsets[f + 1] ? c + 1 : offsets[f]; };
+
+        // Step 1: check if the connectivity can be created in bulk, i.e., all polygons are valid, each directed edge
+        //         occurs at most once, and each edge is shared by at most two polygons.
+
+        bool bulk = (nf > 0 && offsets.front() == 0 && offsets.back() == nc);
+        for (int f = 0; f < nf && bulk; ++f) {
+            if (offsets[f + 1] - offsets[f] < 3) {
+                bulk = false;
+                break;
+            }
+            for (int c = offsets[f]; c < offsets[f + 1] && bulk; ++c) {
+                if (indices[c] < 0 || indices[c] >= nv)
+                    bulk = false;
+                for (int d = offsets[f]; d < c && bulk; ++d) {
+                    if (indices[d] == indices[c])
+                        bulk = false;
+                }
+            }
+        }
+
+        // the corners (i.e., the outgoing halfedges) of each vertex, and the opposite corner of each corner
+        std::vector<int> out_offsets, opposite;
+        if (bulk) {
+            out_offsets.assign(nv + 1, 0);
+            for (int c = 0; c < nc; ++c)
+                ++out_offsets[indices[c] + 1];
+            for (int v = 0; v < nv; ++v)
+                out_offsets[v + 1] += out_offsets[v];
+
+            std::vector<int> out_corners(nc), out_targets(nc);
+            std::vector<int> pos(out_offsets.begin(), out_offsets.end() - 1);
+            for (int f = 0; f < nf; ++f) {
+                for (int c = offsets[f]; c < offsets[f + 1]; ++c) {
+                    const int p = pos[indices[c]]++;
+                    out_corners[p] = c;
+                    out_targets[p] = indices[next_corner(f, c)];
+                }
+            }
+            std::vector<int>().swap(pos);
+
+            opposite.assign(nc, -1);
+            for (int v = 0; v < nv && bulk; ++v) {
+                for (int p = out_offsets[v]; p < out_offsets[v + 1] && bulk; ++p) {
+                    const int u = out_targets[p];
+                    // the same directed edge must not appear twice
+                    for (int q = out_offsets[v]; q < p; ++q) {
+                        if (out_targets[q] == u)
+                            bulk = false;
+                    }
+                    // at most one opposite
+                    for (int q = out_offsets[u]; q < out_offsets[u + 1] && bulk; ++q) {
+                        if (out_targets[q] == v) {
+                            if (opposite[out_corners[p]] != -1)
+                                bulk = false;
+                            opposite[out_corners[p]] = out_corners[q];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Step 2: create the connectivity
+
+        if (bulk) {
+            // Each corner is assigned its halfedge (in place). A corner and its opposite share an edge.
+            std::vector<int> &halfedge = opposite;
+            int ne = 0;
+            for (int c = 0; c < nc; ++c) {
+                const int o = opposite[c];
+                if (o == -1 || o > c)
+                    halfedge[c] = 2 * (ne++);
+                else // the opposite corner has been visited, and it has been assigned its halfedge
+                    halfedge[c] = halfedge[o] ^ 1;
+            }
+
+            mesh_->resize(nv, ne, nf);
+            points.swap(mesh_->points());
+
+            for (int f = 0; f < nf; ++f) {
+                const Face face(f);
+                for (int c = offsets[f]; c < offsets[f + 1]; ++c) {
+                    const int n = next_corner(f, c);
+                    const Halfedge h(halfedge[c]);
+                    mesh_->set_target(h, Vertex(indices[n]));
+                    mesh_->set_face(h, face);
+                    mesh_->set_next(h, Halfedge(halfedge[n]));
+                    mesh_->set_out_halfedge(Vertex(indices[c]), h);
+                }
+                // the halfedge of the face points to the first vertex of the polygon
+                mesh_->set_halfedge(face, Halfedge(halfedge[offsets[f + 1] - 1]));
+            }
+
+            // the boundary halfedges: a boundary vertex must have exactly one outgoing boundary halfedge
+            std::vector<Halfedge> boundary_out(nv);
+            for (int f = 0; f < nf && bulk; ++f) {
+                for (int c = offsets[f]; c < offsets[f + 1]; ++c) {
+                    const Halfedge h(halfedge[c] ^ 1);
+                    if (!mesh_->face(h).is_valid()) {
+                        mesh_->set_target(h, Vertex(indices[c]));
+                        const int source = indices[next_corner(f, c)];
+                        if (boundary_out[source].is_valid()) {
+                            bulk = false;
+                            break;
+                        }
+                        boundary_out[source] = h;
+                    }
+                }
+            }
+            for (int v = 0; v < nv && bulk; ++v) {
+                const Halfedge h = boundary_out[v];
+                if (h.is_valid()) {
+                    mesh_->set_next(h, boundary_out[mesh_->target(h).idx()]);
+                    mesh_->set_out_halfedge(Vertex(v), h);
+                }
+            }
+
+            // all the halfedges around a vertex must form a single fan (i.e., the vertex is manifold)
+            for (int v = 0; v < nv && bulk; ++v) {
+                const int num = out_offsets[v + 1] - out_offsets[v] + (boundary_out[v].is_valid() ? 1 : 0);
+                if (num == 0)
+                    continue;
+                const Halfedge start = mesh_->out_halfedge(Vertex(v));
+                Halfedge h = start;
+                int count = 0;
+                do {
+                    h = mesh_->opposite(mesh_->prev(h));
+                    ++count;
+                } while (h != start && count <= num);
+                if (count != num)
+                    bulk = false;
+            }
+
+            if (!bulk) { // undo
+                points.swap(mesh_->points());
+                mesh_->clear();
+            }
+        }
+
+        if (bulk) {
+            if (corners) {
+                for (int f = 0; f < nf; ++f)
+                    (*corners)[f] = mesh_->halfedge(Face(f));
+            }
+
+            // same as end_surface(): remove isolated vertices
+            std::size_t num_isolated_vertices(0);
+            for (int v = 0; v < nv; ++v) {
+                if (out_offsets[v + 1] == out_offsets[v]) {
+                    mesh_->delete_vertex(Vertex(v));
+                    ++num_isolated_vertices;
+                }
+            }
+            if (num_isolated_vertices > 0) {
+                mesh_->collect_garbage();
+                LOG(WARNING) << "mesh has topological issues:\n   - " << num_isolated_vertices
+                             << " isolated vertices (removed)";
+            }
+            mesh_->vertex_property<bool>("v:locked");
+            std::vector<vec3>().swap(points);
+            return true;
+        }
+
+        // Step 3 (not an oriented 2-manifold): add the polygons one by one
+
+        begin_surface();
+        for (const auto &p : points)
+            add_vertex(p);
+        std::vector<vec3>().swap(points);
+
+        std::vector<Vertex> vertices;
+        for (int f = 0; f < nf; ++f) {
+            vertices.clear();
+            for (int c = offsets[f]; c < offsets[f + 1]; ++c)
+                vertices.emplace_back(indices[c]);
+            const Face face = add_face(vertices);
+            // the halfedges are not renumbered by end_surface() (only the isolated vertices are removed)
+            if (corners && face.is_valid())
+                (*corners)[f] = mesh_->halfedge(face);
+        }
+        end_surface();
+        return false;
+    }
+
+
     SurfaceMesh::Vertex SurfaceMeshBuilder::add_vertex(const vec3 &p) {
         DLOG_IF(!original_vertex_, ERROR) << "you must call begin_surface() before the constructing a surface mesh";
         Vertex v = mesh_->add_vertex(p);
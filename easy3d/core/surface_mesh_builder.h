@@ -110,6 +110,28 @@ namespace easy3d {
          */
         void end_surface(bool log_issues = true);
 
+        /**
+         * @brief Builds the mesh from a set of polygons at once, i.e., without calling begin_surface(), add_vertex(),
+         *        add_face(), and end_surface().
+         * @details If all the polygons are valid and they form an oriented 2-manifold surface, the connectivity is
+         *        created in bulk: the opposite halfedges are matched using a table of the outgoing halfedges of each
+         *        vertex (instead of being searched and linked face by face), which is much faster and needs much less
+         *        memory for large models. Otherwise, the polygons are added one by one using add_face(), which
+         *        resolves the non-manifoldness as usual.
+         * @param points The coordinates of the vertices. They are moved into the mesh (i.e., \p points will be empty).
+         * @param indices The vertex indices of all the polygons (concatenated).
+         * @param offsets The position of each polygon in \p indices, followed by the size of \p indices, i.e., the
+         *        i-th polygon consists of the vertices indices[offsets[i]], ..., indices[offsets[i + 1] - 1].
+         * @param corners If not null, returns for each polygon the halfedge (of the created face) pointing to the
+         *        first vertex of the polygon, or an invalid halfedge if the polygon was ignored. Following next()
+         *        visits the remaining vertices in order, so per-corner attributes can be assigned to the halfedges
+         *        without relying on the vertices, which may be copied (to resolve non-manifoldness) or renumbered
+         *        (isolated vertices are removed).
+         * @return \c true if the connectivity was created in bulk, and \c false if the polygons were added one by one.
+         */
+        bool build(std::vector<vec3> &points, const std::vector<int> &indices, const std::vector<int> &offsets,
+                   std::vector<Halfedge> *corners = nullptr);
+
         // -------------------------------------------------------------------------------------------------------------
 
         /**
@@ -0,0 +1,379 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/chunked_file.h>
+
+#include <cstdlib>
+
+#include <3rd_party/stb/stb_image.h>    // for stbi_zlib_decode_malloc_guesssize()
+
+// The deflate compressor of stb_image_write (its implementation is compiled in image_io.cpp), not declared in the
+// public part of stb_image_write.h.
+extern "C" unsigned char *stbi_zlib_compress(unsigned char *data, int data_len, int *out_len, int quality);
+
+
+namespace easy3d {
+
+    namespace io {
+
+        namespace details {
+
+            const char magic[4] = {'E', '3', 'D', 'C'};
+            const uint32_t version = 1;
+            const uint32_t byte_order_mark = 0x01020304;
+
+            std::vector<uint32_t> crc32_table() {
+                std::vector<uint32_t> table(256);
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k)
+                        c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                    table[i] = c;
+                }
+                return table;
+            }
+
+            uint32_t crc32(const char *data, std::size_t size) {
+                static const std::vector<uint32_t> table = crc32_table(); // thread-safe initialization
+                uint32_t crc = 0xFFFFFFFFu;
+                for (std::size_t i = 0; i < size; ++i)
+                    crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+                return crc ^ 0xFFFFFFFFu;
+            }
+
+            template<typename T>
+            inline void write(std::ostream &output, const T &value) {
+                output.write(reinterpret_cast<const char *>(&value), sizeof(T));
+            }
+
+            inline void write(std::ostream &output, const std::string &str) {
+                write(output, static_cast<uint32_t>(str.size()));
+                output.write(str.data(), static_cast<std::streamsize>(str.size()));
+            }
+
+            template<typename T>
+            inline bool read(std::istream &input, T &value) {
+                return !input.read(reinterpret_cast<char *>(&value), sizeof(T)).fail();
+            }
+
+            inline bool read(std::istream &input, std::string &str) {
+                uint32_t size = 0;
+                if (!read(input, size) || size > (1u << 20))
+                    return false;
+                str.resize(size);
+                return !input.read(&str[0], size).fail();
+            }
+
+            // Encodes a chunk: the stored bytes are compressed if this makes them smaller.
+            void encode_chunk(const std::string &raw, std::string &stored, uint32_t &checksum, uint8_t &compressed) {
+                checksum = crc32(raw.data(), raw.size());
+                int size = 0;
+                unsigned char *data = raw.empty() ? nullptr : stbi_zlib_compress(
+                        reinterpret_cast<unsigned char *>(const_cast<char *>(raw.data())),
+                        static_cast<int>(raw.size()), &size, 5);
+                if (data && static_cast<std::size_t>(size) < raw.size()) {
+                    stored.assign(reinterpret_cast<const char *>(data), size);
+                    compressed = 1;
+                } else {
+                    stored = raw;
+                    compressed = 0;
+                }
+                free(data);
+            }
+
+            // Decodes a chunk into raw bytes and verifies its checksum.
+            bool decode_chunk(const std::string &stored, uint8_t compressed, uint64_t raw_size, uint32_t checksum,
+                              std::string &raw) {
+                if (compressed) {
+                    int size = 0;
+                    char *data = stbi_zlib_decode_malloc_guesssize(stored.data(), static_cast<int>(stored.size()),
+                                                                   static_cast<int>(raw_size), &size);
+                    if (!data)
+                        return false;
+                    raw.assign(data, size);
+                    free(data);
+                } else
+                    raw = stored;
+                return raw.size() == raw_size && crc32(raw.data(), raw.size()) == checksum;
+            }
+
+            // number of chunks processed (in parallel) at a time
+            const int chunks_per_batch = 16;
+
+        } // namespace details
+
+
+        ChunkedFileWriter::ChunkedFileWriter(const std::string &file_name, const std::string &model_type)
+                : output_(file_name.c_str(), std::fstream::binary), offset_(0), ok_(false) {
+            if (output_.fail()) {
+                LOG(ERROR) << "could not open file: " << file_name;
+                return;
+            }
+            output_.write(details::magic, 4);
+            details::write(output_, details::version);
+            details::write(output_, details::byte_order_mark);
+            details::write(output_, model_type);
+            offset_ = static_cast<uint64_t>(output_.tellp());
+            ok_ = output_.good();
+        }
+
+
+        ChunkedFileWriter::~ChunkedFileWriter() {
+            if (output_.is_open())
+                output_.close();
+        }
+
+
+        bool ChunkedFileWriter::write_column(const std::string &name, const std::string &type, std::size_t value_size,
+                                             std::size_t num_values, std::size_t values_per_chunk,
+                                             const Encoder &encode) {
+            if (!ok_)
+                return false;
+
+            Column column;
+            column.name = name;
+            column.type = type;
+            column.value_size = value_size;
+            column.num_values = num_values;
+            column.values_per_chunk = values_per_chunk;
+
+            const std::size_t num_chunks = (num_values + values_per_chunk - 1) / values_per_chunk;
+            std::vector<std::string> raw(details::chunks_per_batch), stored(details::chunks_per_batch);
+            for (std::size_t batch = 0; batch < num_chunks; batch += details::chunks_per_batch) {
+                const int count = static_cast<int>(std::min<std::size_t>(details::chunks_per_batch, num_chunks - batch));
+                std::vector<Chunk> chunks(count);
+#pragma omp parallel for schedule(dynamic)
+                for (int c = 0; c < count; ++c) {
+                    const std::size_t first = (batch + c) * values_per_chunk;
+                    encode(first, std::min(first + values_per_chunk, num_values), raw[c]);
+                    chunks[c].raw_size = raw[c].size();
+                    details::encode_chunk(raw[c], stored[c], chunks[c].checksum, chunks[c].compressed);
+                    chunks[c].stored_size = stored[c].size();
+                }
+                for (int c = 0; c < count; ++c) {
+                    chunks[c].offset = offset_;
+                    output_.write(stored[c].data(), static_cast<std::streamsize>(stored[c].size()));
+                    offset_ += stored[c].size();
+                    column.chunks.push_back(chunks[c]);
+                }
+                if (output_.fail()) {
+                    LOG(ERROR) << "failed writing column '" << name << "'";
+                    ok_ = false;
+                    return false;
+                }
+            }
+
+            columns_.push_back(column);
+            return true;
+        }
+
+
+        bool ChunkedFileWriter::finish() {
+            if (!ok_)
+                return false;
+
+            // the table of contents
+            const uint64_t toc_offset = offset_;
+            details::write(output_, static_cast<uint32_t>(sizes_.size()));
+            for (const auto &size : sizes_) {
+                details::write(output_, size.first);
+                details::write(output_, size.second);
+            }
+            details::write(output_, static_cast<uint32_t>(columns_.size()));
+            for (const auto &column : columns_) {
+                details::write(output_, column.name);
+                details::write(output_, column.type);
+                details::write(output_, column.value_size);
+                details::write(output_, column.num_values);
+                details::write(output_, column.values_per_chunk);
+                details::write(output_, static_cast<uint32_t>(column.chunks.size()));
+                for (const auto &chunk : column.chunks) {
+                    details::write(output_, chunk.offset);
+                    details::write(output_, chunk.stored_size);
+                    details::write(output_, chunk.raw_size);
+                    details::write(output_, chunk.checksum);
+                    details::write(output_, chunk.compressed);
+                }
+            }
+
+            // the trailer
+            details::write(output_, toc_offset);
+            output_.write(details::magic, 4);
+
+            output_.close();
+            ok_ = !output_.fail();
+            return ok_;
+        }
+
+
+        ChunkedFileReader::ChunkedFileReader(const std::string &file_name)
+                : file_name_(file_name), input_(file_name.c_str(), std::fstream::binary), ok_(false) {
+            if (input_.fail()) {
+                LOG(ERROR) << "could not open file: " << file_name;
+                return;
+            }
+
+            char magic[4];
+            uint32_t version = 0, bom = 0;
+            if (!input_.read(magic, 4) || std::memcmp(magic, details::magic, 4) != 0 ||
+                !details::read(input_, version) || !details::read(input_, bom) ||
+                !details::read(input_, model_type_)) {
+                LOG(ERROR) << "not an e3d file: " << file_name;
+                return;
+            }
+            if (version != details::version || bom != details::byte_order_mark) {
+                LOG(ERROR) << "unsupported e3d file (version " << version << " or byte order): " << file_name;
+                return;
+            }
+
+            // the trailer
+            uint64_t toc_offset = 0;
+            input_.seekg(-static_cast<std::streamoff>(sizeof(uint64_t) + 4), std::ios::end);
+            if (!details::read(input_, toc_offset) || !input_.read(magic, 4) ||
+                std::memcmp(magic, details::magic, 4) != 0) {
+                LOG(ERROR) << "incomplete e3d file (no table of contents): " << file_name;
+                return;
+            }
+
+            // the table of contents
+            input_.seekg(static_cast<std::streamoff>(toc_offset), std::ios::beg);
+            uint32_t num_sizes = 0, num_columns = 0;
+            bool success = details::read(input_, num_sizes);
+            for (uint32_t i = 0; success && i < num_sizes; ++i) {
+                std::pair<std::string, uint64_t> size;
+                success = details::read(input_, size.first) && details::read(input_, size.second);
+                sizes_.push_back(size);
+            }
+            success = success && details::read(input_, num_columns);
+            for (uint32_t i = 0; success && i < num_columns; ++i) {
+                Column column;
+                uint32_t num_chunks = 0;
+                success = details::read(input_, column.name) && details::read(input_, column.type) &&
+                          details::read(input_, column.value_size) && details::read(input_, column.num_values) &&
+                          details::read(input_, column.values_per_chunk) && details::read(input_, num_chunks);
+                for (uint32_t j = 0; success && j < num_chunks; ++j) {
+                    ChunkedFileWriter::Chunk chunk;
+                    success = details::read(input_, chunk.offset) && details::read(input_, chunk.stored_size) &&
+                              details::read(input_, chunk.raw_size) && details::read(input_, chunk.checksum) &&
+                              details::read(input_, chunk.compressed);
+                    column.chunks.push_back(chunk);
+                }
+                columns_.push_back(column);
+            }
+            if (!success) {
+                LOG(ERROR) << "corrupted table of contents in file: " << file_name;
+                return;
+            }
+            ok_ = true;
+        }
+
+
+        std::size_t ChunkedFileReader::size(const std::string &element) const {
+            for (const auto &size : sizes_) {
+                if (size.first == element)
+                    return static_cast<std::size_t>(size.second);
+            }
+            return 0;
+        }
+
+
+        std::vector<std::string> ChunkedFileReader::columns() const {
+            std::vector<std::string> names;
+            for (const auto &column : columns_)
+                names.push_back(column.name);
+            return names;
+        }
+
+
+        std::string ChunkedFileReader::column_type(const std::string &name) const {
+            for (const auto &column : columns_) {
+                if (column.name == name)
+                    return column.type;
+            }
+            return "";
+        }
+
+
+        const ChunkedFileReader::Column *
+        ChunkedFileReader::find(const std::string &name, const std::string &type, std::size_t value_size) const {
+            for (const auto &column : columns_) {
+                if (column.name == name) {
+                    if (column.type != type || column.value_size != value_size) {
+                        LOG(ERROR) << "column '" << name << "' has type '" << column.type << "' (size "
+                                   << column.value_size << "), but '" << type << "' (size " << value_size
+                                   << ") is requested";
+                        return nullptr;
+                    }
+                    return &column;
+                }
+            }
+            LOG(ERROR) << "column '" << name << "' does not exist in file: " << file_name_;
+            return nullptr;
+        }
+
+
+        bool ChunkedFileReader::read_column(const Column &column, const Decoder &decode) {
+            if (!ok_)
+                return false;
+
+            const std::size_t num_chunks = column.chunks.size();
+            std::vector<std::string> stored(details::chunks_per_batch), raw(details::chunks_per_batch);
+            for (std::size_t batch = 0; batch < num_chunks; batch += details::chunks_per_batch) {
+                const int count = static_cast<int>(std::min<std::size_t>(details::chunks_per_batch, num_chunks - batch));
+                // the chunks are read sequentially and decoded in parallel
+                for (int c = 0; c < count; ++c) {
+                    const auto &chunk = column.chunks[batch + c];
+                    stored[c].resize(chunk.stored_size);
+                    input_.seekg(static_cast<std::streamoff>(chunk.offset), std::ios::beg);
+                    if (!input_.read(&stored[c][0], static_cast<std::streamsize>(chunk.stored_size))) {
+                        LOG(ERROR) << "failed reading column '" << column.name << "' (unexpected end of file)";
+                        ok_ = false;
+                        return false;
+                    }
+                }
+
+                int num_failed = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:num_failed)
+                for (int c = 0; c < count; ++c) {
+                    const auto &chunk = column.chunks[batch + c];
+                    const std::size_t first = (batch + c) * column.values_per_chunk;
+                    const std::size_t last = std::min<std::size_t>(first + column.values_per_chunk, column.num_values);
+                    if (!details::decode_chunk(stored[c], chunk.compressed, chunk.raw_size, chunk.checksum, raw[c]) ||
+                        !decode(first, last, raw[c].data(), raw[c].size()))
+                        ++num_failed;
+                }
+                if (num_failed > 0) {
+                    LOG(ERROR) << "failed reading column '" << column.name << "' (" << num_failed
+                               << " corrupted chunks)";
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    } // namespace io
+
+} // namespace easy3d
@@ -0,0 +1,452 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_FILEIO_CHUNKED_FILE_H
+#define EASY3D_FILEIO_CHUNKED_FILE_H
+
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <functional>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include <easy3d/core/types.h>
+#include <easy3d/fileio/translator.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        /**
+         * \brief Writer of the chunked, columnar native format of Easy3D (file extension '*.e3d').
+         * \class ChunkedFileWriter easy3d/fileio/chunked_file.h
+         * \details The file stores a set of named columns (typically one per property array of a model). Each column
+         *      is split into chunks that are compressed (deflate) and checksummed (CRC-32) independently. A table of
+         *      contents is stored at the end of the file, so a reader can locate any column without parsing the
+         *      others. The chunks of a column are encoded in parallel.
+         *
+         *      File layout: "E3DC", version, byte-order mark, model type | chunks ... | table of contents |
+         *      offset of the table of contents, "E3DC".
+         * \see ChunkedFileReader
+         */
+        class ChunkedFileWriter {
+        public:
+            /// Creates file \p file_name to store a model of type \p model_type (e.g., "SurfaceMesh").
+            ChunkedFileWriter(const std::string &file_name, const std::string &model_type);
+            ~ChunkedFileWriter();
+
+            /// Returns whether the file was successfully created (and no error has occurred).
+            bool is_ok() const { return ok_; }
+
+            /// Records the number of instances of an element (e.g., "vertex", "face").
+            void set_size(const std::string &element, std::size_t num) { sizes_.emplace_back(element, num); }
+
+            /// Writes a column of plain values (i.e., values that can be copied bytewise, e.g., float, vec3).
+            /// \param type A name identifying the value type, verified by the reader.
+            template<typename T>
+            bool write_column(const std::string &name, const std::string &type, const std::vector<T> &values) {
+                const std::size_t per_chunk = std::max<std::size_t>(1, chunk_bytes / sizeof(T));
+                return write_column(name, type, sizeof(T), values.size(), per_chunk,
+                                    [&values](std::size_t first, std::size_t last, std::string &bytes) {
+                                        bytes.assign(reinterpret_cast<const char *>(values.data() + first),
+                                                     (last - first) * sizeof(T));
+                                    });
+            }
+
+            /// Writes a column of values of variable size, serialized by their member function
+            /// 'void write(std::ostream&) const', e.g., the connectivity of a PolyMesh.
+            template<typename T>
+            bool write_serialized_column(const std::string &name, const std::string &type,
+                                         const std::vector<T> &values) {
+                return write_column(name, type, 0, values.size(), serialized_chunk_size,
+                                    [&values](std::size_t first, std::size_t last, std::string &bytes) {
+                                        std::ostringstream output(std::ios::binary);
+                                        for (std::size_t i = first; i < last; ++i)
+                                            values[i].write(output);
+                                        bytes = output.str();
+                                    });
+            }
+
+            /// Writes the table of contents and closes the file. Returns whether the entire file was written.
+            bool finish();
+
+        public:
+            typedef std::function<void(std::size_t first, std::size_t last, std::string &bytes)> Encoder;
+
+            /// Writes a column of \p num_values values, \p values_per_chunk values per chunk. The bytes of each
+            /// chunk are given by \p encode, which may be called concurrently for different chunks.
+            bool write_column(const std::string &name, const std::string &type, std::size_t value_size,
+                              std::size_t num_values, std::size_t values_per_chunk, const Encoder &encode);
+
+            static const std::size_t chunk_bytes = 1 << 22;         // uncompressed size of a chunk of plain values
+            static const std::size_t serialized_chunk_size = 1 << 16; // number of serialized values per chunk
+
+        private:
+            struct Chunk {
+                uint64_t offset;        // position in the file
+                uint64_t stored_size;   // size in the file
+                uint64_t raw_size;      // uncompressed size
+                uint32_t checksum;      // CRC-32 of the uncompressed bytes
+                uint8_t compressed;     // 0: stored as is; 1: deflate
+            };
+
+            struct Column {
+                std::string name;
+                std::string type;
+                uint64_t value_size;    // 0 for values of variable size
+                uint64_t num_values;
+                uint64_t values_per_chunk;
+                std::vector<Chunk> chunks;
+            };
+
+            std::ofstream output_;
+            uint64_t offset_;
+            bool ok_;
+            std::vector<Column> columns_;
+            std::vector<std::pair<std::string, uint64_t> > sizes_;
+
+            friend class ChunkedFileReader;
+        };
+
+
+        /**
+         * \brief Reader of the chunked, columnar native format of Easy3D (file extension '*.e3d').
+         * \class ChunkedFileReader easy3d/fileio/chunked_file.h
+         * \details Only the table of contents is read when opening the file. Each column can then be read on demand
+         *      (and the others are skipped). The chunks of a column are decompressed and verified in parallel.
+         * \see ChunkedFileWriter
+         */
+        class ChunkedFileReader {
+        public:
+            /// Opens file \p file_name and reads its table of contents.
+            explicit ChunkedFileReader(const std::string &file_name);
+
+            /// Returns whether the file was successfully opened (and no error has occurred).
+            bool is_ok() const { return ok_; }
+
+            /// The type of the model stored in the file, e.g., "SurfaceMesh".
+            const std::string &model_type() const { return model_type_; }
+
+            /// The number of instances of an element (e.g., "vertex", "face") recorded in the file (0 if unknown).
+            std::size_t size(const std::string &element) const;
+
+            /// The names of all the columns stored in the file.
+            std::vector<std::string> columns() const;
+
+            /// The type name of column \p name (empty if the column does not exist).
+            std::string column_type(const std::string &name) const;
+
+            /// Reads a column of plain values. \p values is resized to the number of values of the column.
+            template<typename T>
+            bool read_column(const std::string &name, const std::string &type, std::vector<T> &values) {
+                const auto column = find(name, type, sizeof(T));
+                if (!column)
+                    return false;
+                values.resize(column->num_values);
+                return read_column(*column, [&values](std::size_t first, std::size_t last, const char *bytes,
+                                                      std::size_t size) -> bool {
+                    if (size != (last - first) * sizeof(T))
+                        return false;
+                    std::memcpy(reinterpret_cast<char *>(values.data() + first), bytes, size);
+                    return true;
+                });
+            }
+
+            /// Reads a column of values of variable size, deserialized by their member function
+            /// 'void read(std::istream&)'. \p values is resized to the number of values of the column.
+            template<typename T>
+            bool read_serialized_column(const std::string &name, const std::string &type, std::vector<T> &values) {
+                const auto column = find(name, type, 0);
+                if (!column)
+                    return false;
+                values.resize(column->num_values);
+                return read_column(*column, [&values](std::size_t first, std::size_t last, const char *bytes,
+                                                      std::size_t size) -> bool {
+                    std::istringstream input(std::string(bytes, size), std::ios::binary);
+                    for (std::size_t i = first; i < last; ++i)
+                        values[i].read(input);
+                    return !input.fail();
+                });
+            }
+
+        public:
+            typedef ChunkedFileWriter::Column Column;
+            typedef std::function<bool(std::size_t first, std::size_t last, const char *bytes,
+                                       std::size_t size)> Decoder;
+
+            /// Reads a column. For each chunk, \p decode receives the range of values and the uncompressed bytes of
+            /// the chunk. It may be called concurrently for different chunks.
+            bool read_column(const Column &column, const Decoder &decode);
+
+        private:
+            const Column *find(const std::string &name, const std::string &type, std::size_t value_size) const;
+
+        private:
+            std::string file_name_;
+            std::ifstream input_;
+            bool ok_;
+            std::string model_type_;
+            std::vector<Column> columns_;
+            std::vector<std::pair<std::string, uint64_t> > sizes_;
+        };
+
+
+        namespace details {
+
+            /// The names identifying the value types of columns.
+            template<typename T> struct ColumnType { static const char *name() { return nullptr; } };
+            template<> struct ColumnType<bool> { static const char *name() { return "bool"; } };
+            template<> struct ColumnType<char> { static const char *name() { return "int8"; } };
+            template<> struct ColumnType<unsigned char> { static const char *name() { return "uint8"; } };
+            template<> struct ColumnType<int> { static const char *name() { return "int32"; } };
+            template<> struct ColumnType<unsigned int> { static const char *name() { return "uint32"; } };
+            template<> struct ColumnType<float> { static const char *name() { return "float32"; } };
+            template<> struct ColumnType<double> { static const char *name() { return "float64"; } };
+            template<> struct ColumnType<vec2> { static const char *name() { return "vec2"; } };
+            template<> struct ColumnType<vec3> { static const char *name() { return "vec3"; } };
+            template<> struct ColumnType<vec4> { static const char *name() { return "vec4"; } };
+            template<> struct ColumnType<dvec2> { static const char *name() { return "dvec2"; } };
+            template<> struct ColumnType<dvec3> { static const char *name() { return "dvec3"; } };
+            template<> struct ColumnType<dvec4> { static const char *name() { return "dvec4"; } };
+            template<> struct ColumnType<ivec2> { static const char *name() { return "ivec2"; } };
+            template<> struct ColumnType<ivec3> { static const char *name() { return "ivec3"; } };
+            template<> struct ColumnType<ivec4> { static const char *name() { return "ivec4"; } };
+            template<> struct ColumnType<mat3> { static const char *name() { return "mat3"; } };
+            template<> struct ColumnType<mat4> { static const char *name() { return "mat4"; } };
+
+            // std::vector<bool> does not store its values contiguously
+            inline bool write_values(ChunkedFileWriter &writer, const std::string &name, const std::vector<bool> &values) {
+                const std::vector<unsigned char> bytes(values.begin(), values.end());
+                return writer.write_column(name, ColumnType<bool>::name(), bytes);
+            }
+
+            template<typename T>
+            inline bool write_values(ChunkedFileWriter &writer, const std::string &name, const std::vector<T> &values) {
+                return writer.write_column(name, ColumnType<T>::name(), values);
+            }
+
+            inline bool read_values(ChunkedFileReader &reader, const std::string &name, std::vector<bool> &values) {
+                std::vector<unsigned char> bytes;
+                if (!reader.read_column(name, ColumnType<bool>::name(), bytes))
+                    return false;
+                values.assign(bytes.begin(), bytes.end());
+                return true;
+            }
+
+            template<typename T>
+            inline bool read_values(ChunkedFileReader &reader, const std::string &name, std::vector<T> &values) {
+                return reader.read_column(name, ColumnType<T>::name(), values);
+            }
+
+
+            // Type dispatch over the supported value types (the typeid of a property is only known at runtime).
+            template<typename... Types>
+            struct PropertyColumns;
+
+            template<>
+            struct PropertyColumns<> {
+                template<typename Access>
+                static bool write(ChunkedFileWriter &, const std::string &, const Access &, const std::string &) {
+                    return false;
+                }
+
+                template<typename Access>
+                static bool read(ChunkedFileReader &, const std::string &, Access &, const std::string &,
+                                 std::size_t) {
+                    return false;
+                }
+            };
+
+            template<typename T, typename... Others>
+            struct PropertyColumns<T, Others...> {
+                template<typename Access>
+                static bool write(ChunkedFileWriter &writer, const std::string &column, const Access &access,
+                                  const std::string &name) {
+                    if (access.type(name) != typeid(T))
+                        return PropertyColumns<Others...>::write(writer, column, access, name);
+                    return write_values(writer, column, access.template get<T>(name));
+                }
+
+                template<typename Access>
+                static bool read(ChunkedFileReader &reader, const std::string &column, Access &access,
+                                 const std::string &name, std::size_t num) {
+                    if (reader.column_type(column) != ColumnType<T>::name())
+                        return PropertyColumns<Others...>::read(reader, column, access, name, num);
+                    std::vector<T> values;
+                    if (!read_values(reader, column, values) || values.size() != num)
+                        return false;
+                    access.template add<T>(name).swap(values);
+                    return true;
+                }
+            };
+
+            typedef PropertyColumns<bool, char, unsigned char, int, unsigned int, float, double, vec2, vec3, vec4,
+                    dvec2, dvec3, dvec4, ivec2, ivec3, ivec4, mat3, mat4> SupportedColumns;
+
+
+            /**
+             * Writes all the properties of an element (except the ones in \p skip), each as a column named
+             * "element/property". The \p Access type provides the properties of the element, e.g.,
+             *  \code
+             *      struct VertexAccess {
+             *          const SurfaceMesh* mesh;
+             *          std::vector<std::string> names() const { return mesh->vertex_properties(); }
+             *          const std::type_info& type(const std::string& name) const {
+             *              return mesh->get_vertex_property_type(name);
+             *          }
+             *          template <typename T> const std::vector<T>& get(const std::string& name) const {
+             *              return mesh->get_vertex_property<T>(name).vector();
+             *          }
+             *      };
+             *  \endcode
+             * Properties of unsupported types are skipped (with a warning).
+             */
+            template<typename Access>
+            inline bool write_properties(ChunkedFileWriter &writer, const std::string &element, const Access &access,
+                                         const std::vector<std::string> &skip) {
+                for (const auto &name : access.names()) {
+                    if (std::find(skip.begin(), skip.end(), name) != skip.end())
+                        continue;
+                    if (!SupportedColumns::write(writer, element + "/" + name, access, name)) {
+                        if (!writer.is_ok())
+                            return false;
+                        LOG(WARNING) << "property '" << name << "' (defined on " << element
+                                     << ") not saved: type not supported by the e3d format";
+                    }
+                }
+                return writer.is_ok();
+            }
+
+
+            /**
+             * Reads the properties of an element (except the ones in \p skip) stored as columns "element/property".
+             * If \p selected is not null, only the properties in \p selected are read. Besides the member functions
+             * described in write_properties(), the \p Access type also provides
+             *  \code
+             *      template <typename T> std::vector<T>& add(const std::string& name) {
+             *          return mesh->vertex_property<T>(name).vector();
+             *      }
+             *  \endcode
+             */
+            template<typename Access>
+            inline bool read_properties(ChunkedFileReader &reader, const std::string &element, Access &access,
+                                        const std::vector<std::string> &skip,
+                                        const std::vector<std::string> *selected) {
+                const std::string prefix = element + "/";
+                const std::size_t num = reader.size(element);
+                for (const auto &column : reader.columns()) {
+                    if (column.compare(0, prefix.size(), prefix) != 0)
+                        continue;
+                    const std::string name = column.substr(prefix.size());
+                    if (std::find(skip.begin(), skip.end(), name) != skip.end())
+                        continue;
+                    if (selected && std::find(selected->begin(), selected->end(), name) == selected->end())
+                        continue;
+                    if (!SupportedColumns::read(reader, column, access, name, num)) {
+                        LOG(ERROR) << "failed reading property '" << name << "' (defined on " << element << ")";
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+
+            /// Writes the translation of a model (i.e., its model property "translation", if any) as the column
+            /// "model/translation". The vertex coordinates are saved as they are (i.e., relative to the translation).
+            template<typename Model>
+            inline bool write_translation(ChunkedFileWriter &writer, const Model *model) {
+                auto trans = model->template get_model_property<dvec3>("translation");
+                if (!trans)
+                    return writer.is_ok();
+                writer.set_size("model", 1);
+                return write_values(writer, "model/translation", std::vector<dvec3>(1, trans[0]));
+            }
+
+
+            /// Applies the translation stored in the file (if any) and the Translator to the vertex coordinates
+            /// \p points of a loaded model, in the same way as the other readers:
+            ///  - DISABLED: the points are restored to their original (i.e., not translated) coordinates;
+            ///  - TRANSLATE_USE_FIRST_POINT: the points are translated w.r.t. the (original) first point;
+            ///  - TRANSLATE_USE_LAST_KNOWN_OFFSET: the points are translated w.r.t. the last known translation.
+            /// The offsets are computed in double precision, so no precision is lost if the translations are equal.
+            template<typename Model>
+            inline bool read_translation(ChunkedFileReader &reader, Model *model, std::vector<vec3> &points) {
+                dvec3 stored(0, 0, 0);
+                if (!reader.column_type("model/translation").empty()) {
+                    std::vector<dvec3> values;
+                    if (!read_values(reader, "model/translation", values) || values.size() != 1) {
+                        LOG(ERROR) << "failed reading the translation of the model";
+                        return false;
+                    }
+                    stored = values[0];
+                }
+
+                const auto status = Translator::instance()->status();
+                if (status == Translator::DISABLED || points.empty()) {
+                    if (stored != dvec3(0, 0, 0)) {
+                        for (auto &p : points)
+                            p = vec3(static_cast<float>(p.x + stored.x), static_cast<float>(p.y + stored.y),
+                                     static_cast<float>(p.z + stored.z));
+                    }
+                    return true;
+                }
+
+                dvec3 origin;
+                if (status == Translator::TRANSLATE_USE_FIRST_POINT) {
+                    origin = dvec3(points[0].x + stored.x, points[0].y + stored.y, points[0].z + stored.z);
+                    Translator::instance()->set_translation(origin);
+                } else
+                    origin = Translator::instance()->translation();
+
+                const dvec3 shift = stored - origin;
+                for (auto &p : points)
+                    p = vec3(static_cast<float>(p.x + shift.x), static_cast<float>(p.y + shift.y),
+                             static_cast<float>(p.z + shift.z));
+
+                auto trans = model->template add_model_property<dvec3>("translation", dvec3(0, 0, 0));
+                trans[0] = origin;
+                if (status == Translator::TRANSLATE_USE_FIRST_POINT)
+                    LOG(INFO) << "model translated w.r.t. the first vertex (" << origin
+                              << "), stored as ModelProperty<dvec3>(\"translation\")";
+                else
+                    LOG(INFO) << "model translated w.r.t. last known reference point (" << origin
+                              << "), stored as ModelProperty<dvec3>(\"translation\")";
+                return true;
+            }
+
+        } // namespace details
+
+    } // namespace io
+
+} // namespace easy3d
+
+#endif  // EASY3D_FILEIO_CHUNKED_FILE_H
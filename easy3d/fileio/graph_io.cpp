@@ -50,12 +50,14 @@ namespace easy3d {
         const std::string& ext = file_system::extension(file_name, true);
         if (ext == "ply")
             success = io::load_ply(file_name, graph);
+        else if (ext == "e3d")
+            success = io::load_e3d(file_name, graph);
         else if (ext.empty()){
             LOG(ERROR) << "unknown file format: no extension" << ext;
             success = false;
         }
         else {
-            LOG(ERROR) << "unknown file format: " << ext << ". Only PLY format is supported for Graph" << ext;
+            LOG(ERROR) << "unknown file format: " << ext << ". Only PLY and E3D formats are supported for Graph";
             return nullptr;
         }
 
@@ -97,8 +99,10 @@ namespace easy3d {
             }
             success = io::save_ply(final_name, graph, true);
         }
+        else if (ext == "e3d")
+            success = io::save_e3d(final_name, graph);
 		else {
-            LOG(ERROR) << "unknown file format: " << ext << ". Only PLY format is supported for Graph";
+            LOG(ERROR) << "unknown file format: " << ext << ". Only PLY and E3D formats are supported for Graph";
 			success = false;
 		}
 
@@ -29,13 +29,14 @@
 
 
 #include <string>
+#include <vector>
 
 
 namespace easy3d {
 
     class Graph;
 
-    /// \brief Implementation of file input/output operations for Graph (Currently only PLY format is supported).
+    /// \brief Implementation of file input/output operations for Graph (PLY and E3D formats are supported).
     /// \class GraphIO easy3d/fileio/graph_io.h
     class GraphIO
 	{
@@ -43,13 +44,13 @@ namespace easy3d {
         /**
          * \brief Reads a graph from file \p file_name.
          * \return The pointer of the graph (nullptr if failed).
-         * \details File extension determines file format (currently only PLY format is supported).
+         * \details File extension determines file format (ply, e3d).
          */
         static Graph* load(const std::string& file_name);
 
         /**
          * \brief Saves \p graph to file \p file_name.
-         * \details File extension determines file format (currently only PLY format is supported).
+         * \details File extension determines file format (ply, e3d).
          * \return The status of the operation
          *      \arg true if succeeded
          *      \arg false if failed
@@ -77,6 +78,14 @@ namespace easy3d {
          */
         bool save_ply(const std::string& file_name, const Graph* graph, bool binary = true);
 
+        /// Reads a graph from an \p E3D format file, the chunked columnar native format of Easy3D.
+        bool load_e3d(const std::string& file_name, Graph* graph);
+        /// Reads the connectivity, the vertex coordinates, and only the listed \p properties of a graph from an
+        /// \p E3D format file. Chunks of other properties are not even read from disk.
+        bool load_e3d(const std::string& file_name, Graph* graph, const std::vector<std::string>& properties);
+        /// Saves a graph to an \p E3D format file, the chunked columnar native format of Easy3D.
+        bool save_e3d(const std::string& file_name, const Graph* graph);
+
     } // namespace io
 
 
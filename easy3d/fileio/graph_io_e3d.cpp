@@ -0,0 +1,167 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/graph_io.h>
+#include <easy3d/fileio/chunked_file.h>
+#include <easy3d/core/graph.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        namespace details {
+
+            // Access to the properties of an element of a graph (see write_properties() and read_properties())
+            template<typename G>
+            struct GraphVertices {
+                G *graph;
+                std::vector<std::string> names() const { return graph->vertex_properties(); }
+                const std::type_info &type(const std::string &name) const { return graph->get_vertex_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return graph->template get_vertex_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return graph->template vertex_property<T>(name).vector();
+                }
+            };
+
+            template<typename G>
+            struct GraphEdges {
+                G *graph;
+                std::vector<std::string> names() const { return graph->edge_properties(); }
+                const std::type_info &type(const std::string &name) const { return graph->get_edge_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return graph->template get_edge_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return graph->template edge_property<T>(name).vector();
+                }
+            };
+
+
+            bool load_e3d(const std::string &file_name, Graph *graph, const std::vector<std::string> *selected) {
+                if (!graph) {
+                    LOG(ERROR) << "null graph pointer";
+                    return false;
+                }
+
+                ChunkedFileReader reader(file_name);
+                if (!reader.is_ok())
+                    return false;
+                if (reader.model_type() != "Graph") {
+                    LOG(ERROR) << "file stores a " << reader.model_type() << " (a Graph is expected): " << file_name;
+                    return false;
+                }
+
+                graph->clear();
+                graph->resize(reader.size("vertex"), reader.size("edge"));
+
+                // the connectivity (always loaded). Only the edge connectivity is stored, from which the vertex
+                // connectivity is recovered (in the same order as Graph::add_edge()).
+                auto &econn = graph->edge_property<Graph::EdgeConnectivity>("e:connectivity").vector();
+                if (!reader.read_column("edge/e:connectivity", "Graph::EdgeConnectivity", econn) ||
+                    econn.size() != graph->n_edges()) {
+                    graph->clear();
+                    return false;
+                }
+                auto &vconn = graph->vertex_property<Graph::VertexConnectivity>("v:connectivity").vector();
+                for (std::size_t i = 0; i < econn.size(); ++i) {
+                    const Graph::Edge e(static_cast<int>(i));
+                    vconn[econn[i].source_.idx()].edges_.push_back(e);
+                    vconn[econn[i].target_.idx()].edges_.push_back(e);
+                }
+
+                // the other properties (the vertex coordinates are always loaded)
+                std::vector<std::string> vertex_selected;
+                if (selected) {
+                    vertex_selected = *selected;
+                    vertex_selected.push_back("v:point");
+                }
+                const std::vector<std::string> skip = {"v:connectivity", "e:connectivity", "v:deleted", "e:deleted"};
+                GraphVertices<Graph> vertices{graph};
+                GraphEdges<Graph> edges{graph};
+                if (!read_properties(reader, "vertex", vertices, skip, selected ? &vertex_selected : nullptr) ||
+                    !read_properties(reader, "edge", edges, skip, selected)) {
+                    graph->clear();
+                    return false;
+                }
+
+                // the vertex coordinates are stored relative to the translation (if any)
+                auto &points = graph->vertex_property<vec3>("v:point").vector();
+                if (!read_translation(reader, graph, points)) {
+                    graph->clear();
+                    return false;
+                }
+
+                return graph->n_vertices() > 0;
+            }
+
+        } // namespace details
+
+
+        bool load_e3d(const std::string &file_name, Graph *graph) {
+            return details::load_e3d(file_name, graph, nullptr);
+        }
+
+
+        bool load_e3d(const std::string &file_name, Graph *graph, const std::vector<std::string> &properties) {
+            return details::load_e3d(file_name, graph, &properties);
+        }
+
+
+        bool save_e3d(const std::string &file_name, const Graph *graph) {
+            if (!graph) {
+                LOG(ERROR) << "null graph pointer";
+                return false;
+            }
+
+            // the deleted elements are not stored
+            Graph copy;
+            if (graph->has_garbage()) {
+                copy = *graph;
+                copy.collect_garbage();
+                graph = &copy;
+            }
+
+            ChunkedFileWriter writer(file_name, "Graph");
+            writer.set_size("vertex", graph->n_vertices());
+            writer.set_size("edge", graph->n_edges());
+
+            writer.write_column("edge/e:connectivity", "Graph::EdgeConnectivity",
+                                graph->get_edge_property<Graph::EdgeConnectivity>("e:connectivity").vector());
+
+            const std::vector<std::string> skip = {"v:connectivity", "e:connectivity", "v:deleted", "e:deleted"};
+            details::write_properties(writer, "vertex", details::GraphVertices<const Graph>{graph}, skip);
+            details::write_properties(writer, "edge", details::GraphEdges<const Graph>{graph}, skip);
+
+            details::write_translation(writer, graph);
+            return writer.finish();
+        }
+
+    }
+
+}
@@ -122,9 +122,11 @@ namespace easy3d {
                         IntProperty vertex_1_indices, vertex_2_indices;
                         if (details::extract_named_property(e.int_properties, vertex_1_indices, "vertex1") &&
                             details::extract_named_property(e.int_properties, vertex_2_indices, "vertex2")) {
-                            edge_vertex_indices.resize(vertex_1_indices.size());
-                            for (std::size_t i = 0; i < edge_vertex_indices.size(); ++i)
-                                edge_vertex_indices[i] = {vertex_1_indices[i], vertex_2_indices[i]};
+                            edge_vertex_indices.resize(vertex_1_indices.size(), 2);
+                            for (std::size_t i = 0; i < vertex_1_indices.size(); ++i) {
+                                edge_vertex_indices.values[2 * i] = vertex_1_indices[i];
+                                edge_vertex_indices.values[2 * i + 1] = vertex_2_indices[i];
+                            }
                             continue;
                         }
                         else {
@@ -164,8 +166,9 @@ namespace easy3d {
                           << "), stored as ModelProperty<dvec3>(\"translation\")";
             }
 
-            for (auto e : edge_vertex_indices) {
-                if (e.size() == 2)
+            for (std::size_t i = 0; i < edge_vertex_indices.size(); ++i) {
+                const int* e = edge_vertex_indices.list(i);
+                if (edge_vertex_indices.length(i) == 2)
                     graph->add_edge(Graph::Vertex(e[0]), Graph::Vertex(e[1]));
                 else {
                     LOG(ERROR) << "The size of edge property \'vertex_indices\' is not 2";
@@ -224,6 +227,19 @@ namespace easy3d {
 				}
 			}
 
+			template <typename T>
+            inline void collect_vertex_properties(const Graph* graph, std::vector< GenericListProperty<T> >& properties) {
+                const auto& all_properties = graph->vertex_properties();
+				for (auto name : all_properties) {
+                    auto prop = graph->get_vertex_property< std::vector<T> >(name);
+					if (prop) {
+						if (name.substr(0, 2) == "v:")
+							name = name.substr(2, name.length() - 1);
+						properties.emplace_back(GenericListProperty<T>(name, prop.vector()));
+					}
+				}
+			}
+
 			template <typename T>
             inline void collect_edge_properties(const Graph* graph, std::vector< GenericProperty<T> >& properties) {
                 const auto& all_properties = graph->edge_properties();
@@ -237,6 +253,19 @@ namespace easy3d {
 				}
 			}
 
+			template <typename T>
+            inline void collect_edge_properties(const Graph* graph, std::vector< GenericListProperty<T> >& properties) {
+                const auto& all_properties = graph->edge_properties();
+				for (auto name : all_properties) {
+                    auto prop = graph->get_edge_property< std::vector<T> >(name);
+					if (prop) {
+						if (name.substr(0, 2) == "e:")
+							name = name.substr(2, name.length() - 1);
+						properties.emplace_back(GenericListProperty<T>(name, prop.vector()));
+					}
+				}
+			}
+
 
 		} // namespace details
 
@@ -49,8 +49,9 @@ namespace easy3d {
     {
         data.clear();
 
-        // flag is non-zero to flip data vertically (so the first pixel in the output array is the bottom left)
-        stbi_set_flip_vertically_on_load(flip_vertically);
+        // flag is non-zero to flip data vertically (so the first pixel in the output array is the bottom left).
+        // It is set per thread, since images can be loaded concurrently (e.g., by TextureDecoder).
+        stbi_set_flip_vertically_on_load_thread(flip_vertically);
 
         unsigned char* pixels = stbi_load(file_name.c_str(), &width, &height, &channels, requested_channels);
         if (pixels) {
@@ -28,6 +28,10 @@
 #include <easy3d/util/logging.h>
 
 #include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <memory>
+#include <algorithm>
 #include <unordered_map>
 
 
@@ -95,6 +99,97 @@ namespace easy3d {
         }
 
 
+        namespace details {
+
+            // Serializes the instances [first, last) of an element into a buffer, in the binary layout declared by
+            // PlyWriter::write() (native byte order).
+            class BinaryEncoder {
+            public:
+                explicit BinaryEncoder(std::vector<char> &buffer) : buffer_(buffer) {}
+
+                template<typename T>
+                inline void put(T value) {
+                    const std::size_t pos = buffer_.size();
+                    buffer_.resize(pos + sizeof(T));
+                    std::memcpy(buffer_.data() + pos, &value, sizeof(T));
+                }
+
+                template<typename T>
+                inline void put_list(const GenericListProperty<T> &prop, std::size_t j) {
+                    const std::size_t length = prop.length(j);
+                    put(static_cast<uint32_t>(length));  // length type is PLY_UINT32
+                    const std::size_t pos = buffer_.size();
+                    buffer_.resize(pos + length * sizeof(T));
+                    if (length > 0)
+                        std::memcpy(buffer_.data() + pos, prop.list(j), length * sizeof(T));
+                }
+
+                void encode(const Element &element, std::size_t first, std::size_t last) {
+                    for (std::size_t j = first; j < last; ++j) {
+                        for (const auto &prop : element.int_list_properties)
+                            put_list<int>(prop, j);
+                        for (const auto &prop : element.float_list_properties)
+                            put_list<float>(prop, j);
+                        for (const auto &prop : element.vec3_properties) {
+                            const vec3 &v = prop[j];
+                            if (prop.name == "color") {
+                                put(static_cast<unsigned char>(v.x * 255));
+                                put(static_cast<unsigned char>(v.y * 255));
+                                put(static_cast<unsigned char>(v.z * 255));
+                            } else {
+                                put(v.x);
+                                put(v.y);
+                                put(v.z);
+                            }
+                        }
+                        for (const auto &prop : element.vec2_properties) {
+                            put(prop[j].x);
+                            put(prop[j].y);
+                        }
+                        for (const auto &prop : element.float_properties)
+                            put(prop[j]);
+                        for (const auto &prop : element.int_properties)
+                            put(static_cast<int32_t>(prop[j]));
+                    }
+                }
+
+            private:
+                std::vector<char> &buffer_;
+            };
+
+
+            // Writes the body of a binary PLY file. The instances of each element are split into chunks that are
+            // encoded in parallel into separate buffers, which are then appended to the file in order. The number
+            // of chunks encoded at a time is bounded, so is the memory.
+            bool write_binary_body(FILE *file, const std::vector<Element> &elements) {
+                const std::size_t chunk_size = 1 << 16;   // instances per chunk
+                const int chunks_per_batch = 64;
+                std::vector<std::vector<char> > buffers(chunks_per_batch);
+
+                for (const auto &element : elements) {
+                    const std::size_t num = element.num_instances;
+                    const std::size_t num_chunks = (num + chunk_size - 1) / chunk_size;
+                    for (std::size_t batch = 0; batch < num_chunks; batch += chunks_per_batch) {
+                        const int count = static_cast<int>(std::min<std::size_t>(chunks_per_batch, num_chunks - batch));
+#pragma omp parallel for schedule(dynamic)
+                        for (int c = 0; c < count; ++c) {
+                            const std::size_t first = (batch + c) * chunk_size;
+                            buffers[c].clear();
+                            BinaryEncoder encoder(buffers[c]);
+                            encoder.encode(element, first, std::min(first + chunk_size, num));
+                        }
+                        for (int c = 0; c < count; ++c) {
+                            if (fwrite(buffers[c].data(), 1, buffers[c].size(), file) != buffers[c].size())
+                                return false;
+                        }
+                    }
+                }
+                return true;
+            }
+
+        } // namespace details
+
+
         bool PlyWriter::write(
                 const std::string &file_name,
                 const std::vector<Element> &elements,
@@ -109,7 +204,15 @@ namespace easy3d {
             } else
                 mode = PLY_ASCII;
 
-            p_ply ply = ply_create(file_name.c_str(), mode, nullptr, 0, nullptr);
+            // In binary mode, the header is written by rply and the body by details::write_binary_body().
+            std::unique_ptr<FILE, int (*)(FILE *)> file(nullptr, fclose);
+            p_ply ply = nullptr;
+            if (binary) {
+                file.reset(fopen(file_name.c_str(), "wb"));
+                if (file)
+                    ply = ply_create_to_file(file.get(), mode, nullptr, 0, nullptr);
+            } else
+                ply = ply_create(file_name.c_str(), mode, nullptr, 0, nullptr);
             if (!ply) {
                 LOG(ERROR) << "failed to create ply file: " << file_name;
                 return false;
@@ -262,8 +365,24 @@ namespace easy3d {
             }
 
             // write output header
-            if (!ply_write_header(ply))
+            if (!ply_write_header(ply)) {
+                ply_close(ply);
                 return false;
+            }
+
+            if (binary) {
+                if (!details::write_binary_body(file.get(), elements)) {
+                    LOG(ERROR) << "failed to write to the ply file: " << file_name;
+                    ply_close(ply);
+                    return false;
+                }
+                ply_close(ply);
+                if (fclose(file.release()) != 0) {
+                    LOG(ERROR) << "failed to close the ply file: " << file_name;
+                    return false;
+                }
+                return true;
+            }
 
             for (std::size_t i = 0; i < elements.size(); ++i) {
                 const std::size_t num = elements[i].num_instances;
@@ -271,17 +390,19 @@ namespace easy3d {
                 for (std::size_t j = 0; j < num; ++j) {
                     const std::vector<IntListProperty> &int_list_properties = elements[i].int_list_properties;
                     for (std::size_t k = 0; k < int_list_properties.size(); ++k) {
-                        const std::vector<int> &values = int_list_properties[k][j];
-                        ply_write(ply, static_cast<double>(values.size()));
-                        for (std::size_t m = 0; m < values.size(); ++m)
+                        const std::size_t length = int_list_properties[k].length(j);
+                        const int *values = int_list_properties[k].list(j);
+                        ply_write(ply, static_cast<double>(length));
+                        for (std::size_t m = 0; m < length; ++m)
                             ply_write(ply, values[m]);
                     }
 
                     const std::vector<FloatListProperty> &float_list_properties = elements[i].float_list_properties;
                     for (std::size_t k = 0; k < float_list_properties.size(); ++k) {
-                        const std::vector<float> &values = float_list_properties[k][j];
-                        ply_write(ply, static_cast<double>(values.size()));
-                        for (std::size_t m = 0; m < values.size(); ++m)
+                        const std::size_t length = float_list_properties[k].length(j);
+                        const float *values = float_list_properties[k].list(j);
+                        ply_write(ply, static_cast<double>(length));
+                        for (std::size_t m = 0; m < length; ++m)
                             ply_write(ply, static_cast<double>(values[m]));
                     }
 
@@ -336,6 +457,408 @@ namespace easy3d {
         }
 
 
+        namespace details {
+
+            // The fast path for binary PLY files with a fixed layout, i.e., each element instance has the same size
+            // in bytes (no list properties, or list properties of constant length, e.g., the faces of a triangle
+            // mesh). The body is read in large blocks and each property is decoded as a column directly into the
+            // final property of the element, bypassing the per-value callbacks of rply and the intermediate
+            // representation as double values.
+            class FixedLayoutBinaryReader {
+            public:
+                // Returns true if the file was successfully read. Returns false if the file is not a binary file
+                // with a fixed layout (or it could not be read), in which case the generic reader should be used.
+                bool read(const std::string &file_name, std::vector<Element> &elements) {
+                    FILE *file = fopen(file_name.c_str(), "rb");
+                    if (!file)
+                        return false;
+                    const bool success = read_header(file) && read_body(file, elements);
+                    fclose(file);
+                    return success;
+                }
+
+            private:
+                struct Property {
+                    std::string name;
+                    bool is_list;
+                    e_ply_type type;        // value type (of the list entries, if it is a list)
+                    e_ply_type length_type; // for lists only
+                };
+
+                struct HeaderElement {
+                    std::string name;
+                    std::size_t num_instances;
+                    std::vector<Property> properties;
+                };
+
+                // where the values of a property go
+                struct Target {
+                    enum Kind { VEC3, VEC2, FLOAT, INT, FLOAT_LIST, INT_LIST };
+                    Kind kind;
+                    std::size_t index;      // index of the property in the element's container
+                    std::size_t component;  // for VEC3 and VEC2 only
+                    float scale;            // e.g., colors stored as integers in [0, 255] are scaled to [0, 1]
+                };
+
+                static bool parse_type(const std::string &str, e_ply_type &type) {
+                    static const char *const names[] = {
+                            "int8", "uint8", "int16", "uint16", "int32", "uint32", "float32", "float64",
+                            "char", "uchar", "short", "ushort", "int", "uint", "float", "double"
+                    };
+                    for (int i = 0; i < 16; ++i) {
+                        if (str == names[i]) {
+                            type = static_cast<e_ply_type>(i);
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                static std::size_t type_size(e_ply_type type) {
+                    switch (type) {
+                        case PLY_INT8: case PLY_UINT8: case PLY_CHAR: case PLY_UCHAR: return 1;
+                        case PLY_INT16: case PLY_UINT16: case PLY_SHORT: case PLY_USHORT: return 2;
+                        case PLY_INT32: case PLY_UINT32: case PLY_INT: case PLY_UINT: case PLY_FLOAT32: case PLY_FLOAT:
+                            return 4;
+                        default: return 8; // PLY_FLOAT64, PLY_DOUBLE
+                    }
+                }
+
+                static bool is_float_type(e_ply_type type) {
+                    return type == PLY_FLOAT || type == PLY_DOUBLE || type == PLY_FLOAT32 || type == PLY_FLOAT64;
+                }
+
+                template<typename T>
+                static inline T swap_bytes(T value) {
+                    char *bytes = reinterpret_cast<char *>(&value);
+                    std::reverse(bytes, bytes + sizeof(T));
+                    return value;
+                }
+
+                // Decodes a column of 'num' values starting at 'src' with a distance of 'src_stride' bytes. The
+                // loop has no dependencies, allowing the compiler to vectorize it (including the byte swaps).
+                template<typename In, typename Out>
+                static void decode(const char *src, std::size_t src_stride, std::size_t num, bool swap,
+                                   Out *dst, std::size_t dst_stride) {
+                    if (swap) {
+                        for (std::size_t i = 0; i < num; ++i) {
+                            In value;
+                            std::memcpy(&value, src + i * src_stride, sizeof(In));
+                            dst[i * dst_stride] = static_cast<Out>(swap_bytes(value));
+                        }
+                    } else {
+                        for (std::size_t i = 0; i < num; ++i) {
+                            In value;
+                            std::memcpy(&value, src + i * src_stride, sizeof(In));
+                            dst[i * dst_stride] = static_cast<Out>(value);
+                        }
+                    }
+                }
+
+                template<typename Out>
+                static void decode(e_ply_type type, const char *src, std::size_t src_stride, std::size_t num,
+                                   bool swap, Out *dst, std::size_t dst_stride) {
+                    switch (type) {
+                        case PLY_INT8: case PLY_CHAR:
+                            decode<int8_t>(src, src_stride, num, swap, dst, dst_stride); break;
+                        case PLY_UINT8: case PLY_UCHAR:
+                            decode<uint8_t>(src, src_stride, num, swap, dst, dst_stride); break;
+                        case PLY_INT16: case PLY_SHORT:
+                            decode<int16_t>(src, src_stride, num, swap, dst, dst_stride); break;
+                        case PLY_UINT16: case PLY_USHORT:
+                            decode<uint16_t>(src, src_stride, num, swap, dst, dst_stride); break;
+                        case PLY_INT32: case PLY_INT:
+                            decode<int32_t>(src, src_stride, num, swap, dst, dst_stride); break;
+                        case PLY_UINT32: case PLY_UINT:
+                            decode<uint32_t>(src, src_stride, num, swap, dst, dst_stride); break;
+                        case PLY_FLOAT32: case PLY_FLOAT:
+                            decode<float>(src, src_stride, num, swap, dst, dst_stride); break;
+                        default:
+                            decode<double>(src, src_stride, num, swap, dst, dst_stride); break;
+                    }
+                }
+
+                bool read_header(FILE *file) {
+                    char line[1024];
+                    if (!fgets(line, sizeof(line), file) || std::string(line).substr(0, 3) != "ply")
+                        return false;
+                    while (fgets(line, sizeof(line), file)) {
+                        std::istringstream in(line);
+                        std::string keyword;
+                        in >> keyword;
+                        if (keyword == "format") {
+                            std::string format;
+                            in >> format;
+                            if (format == "binary_little_endian")
+                                swap_ = PlyWriter::is_big_endian();
+                            else if (format == "binary_big_endian")
+                                swap_ = !PlyWriter::is_big_endian();
+                            else
+                                return false; // ASCII
+                        } else if (keyword == "element") {
+                            HeaderElement element;
+                            if (!(in >> element.name >> element.num_instances))
+                                return false;
+                            elements_.push_back(element);
+                        } else if (keyword == "property") {
+                            if (elements_.empty())
+                                return false;
+                            Property prop;
+                            std::string type;
+                            in >> type;
+                            prop.is_list = (type == "list");
+                            if (prop.is_list) {
+                                std::string length_type;
+                                in >> length_type >> type;
+                                if (!parse_type(length_type, prop.length_type))
+                                    return false;
+                            }
+                            if (!parse_type(type, prop.type) || !(in >> prop.name))
+                                return false;
+                            elements_.back().properties.push_back(prop);
+                        } else if (keyword == "end_header")
+                            return true;
+                        // "comment" and "obj_info" are ignored
+                    }
+                    return false;
+                }
+
+                // Decides where each property of an element goes. This follows the same conventions as
+                // PlyReader::collect_elements(), e.g., "x", "y", and "z" are combined into the vec3 property "point".
+                static std::vector<Target> make_targets(const HeaderElement &header, Element &element) {
+                    const auto &props = header.properties;
+                    auto find = [&](const std::string &name, bool is_float) -> int {
+                        for (std::size_t i = 0; i < props.size(); ++i) {
+                            if (!props[i].is_list && props[i].name == name && is_float_type(props[i].type) == is_float)
+                                return static_cast<int>(i);
+                        }
+                        return -1;
+                    };
+
+                    std::vector<Target> targets(props.size(), Target{Target::FLOAT, 0, 0, 1.0f});
+                    std::vector<bool> assigned(props.size(), false);
+                    auto assign_vector = [&](const std::vector<std::string> &names, bool is_float,
+                                             const std::string &vector_name, float scale) -> bool {
+                        std::vector<int> ids;
+                        for (const auto &name : names) {
+                            const int id = find(name, is_float);
+                            if (id < 0 || assigned[id])
+                                return false;
+                            ids.push_back(id);
+                        }
+                        const bool is_vec3 = (names.size() == 3);
+                        const std::size_t index = is_vec3 ? element.vec3_properties.size() : element.vec2_properties.size();
+                        if (is_vec3)
+                            element.vec3_properties.emplace_back(Vec3Property(vector_name));
+                        else
+                            element.vec2_properties.emplace_back(Vec2Property(vector_name));
+                        for (std::size_t k = 0; k < ids.size(); ++k) {
+                            targets[ids[k]] = Target{is_vec3 ? Target::VEC3 : Target::VEC2, index, k, scale};
+                            assigned[ids[k]] = true;
+                        }
+                        return true;
+                    };
+
+                    if (!assign_vector({"x", "y", "z"}, true, "point", 1.0f))
+                        assign_vector({"X", "Y", "Z"}, true, "point", 1.0f);
+                    assign_vector({"texcoord_x", "texcoord_y"}, true, "texcoord", 1.0f);
+                    assign_vector({"nx", "ny", "nz"}, true, "normal", 1.0f);
+                    if (!assign_vector({"r", "g", "b"}, true, "color", 1.0f) &&
+                        !assign_vector({"red", "green", "blue"}, false, "color", 1.0f / 255.0f))
+                        assign_vector({"diffuse_red", "diffuse_green", "diffuse_blue"}, false, "color", 1.0f / 255.0f);
+
+                    // the remaining properties (the alpha channel is handled after all others, as in the generic reader)
+                    int alpha = find("a", true);
+                    bool alpha_is_int = false;
+                    if (alpha < 0) {
+                        alpha = find("alpha", false);
+                        alpha_is_int = (alpha >= 0);
+                    }
+                    for (std::size_t i = 0; i < props.size(); ++i) {
+                        if (assigned[i] || static_cast<int>(i) == alpha)
+                            continue;
+                        const auto &prop = props[i];
+                        if (prop.is_list) {
+                            if (is_float_type(prop.type)) {
+                                targets[i] = Target{Target::FLOAT_LIST, element.float_list_properties.size(), 0, 1.0f};
+                                element.float_list_properties.emplace_back(FloatListProperty(prop.name));
+                            } else {
+                                targets[i] = Target{Target::INT_LIST, element.int_list_properties.size(), 0, 1.0f};
+                                element.int_list_properties.emplace_back(IntListProperty(prop.name));
+                            }
+                        } else if (is_float_type(prop.type)) {
+                            targets[i] = Target{Target::FLOAT, element.float_properties.size(), 0, 1.0f};
+                            element.float_properties.emplace_back(FloatProperty(prop.name));
+                        } else {
+                            targets[i] = Target{Target::INT, element.int_properties.size(), 0, 1.0f};
+                            element.int_properties.emplace_back(IntProperty(prop.name));
+                        }
+                    }
+                    if (alpha >= 0) {
+                        targets[alpha] = Target{Target::FLOAT, element.float_properties.size(), 0,
+                                                alpha_is_int ? 1.0f / 255.0f : 1.0f};
+                        element.float_properties.emplace_back(FloatProperty("alpha"));
+                    }
+                    return targets;
+                }
+
+                bool read_body(FILE *file, std::vector<Element> &elements) {
+                    std::vector<Element> result;
+                    std::vector<char> first_instance, buffer;
+                    for (std::size_t e = 0; e < elements_.size(); ++e) {
+                        const HeaderElement &header = elements_[e];
+                        const auto &props = header.properties;
+                        if (header.num_instances == 0) { // kept (with empty properties), as the generic reader does
+                            Element element(header.name, 0);
+                            make_targets(header, element);
+                            result.push_back(std::move(element));
+                            continue;
+                        }
+
+                        // determine the layout from the first instance (it must be the same for all instances)
+                        std::size_t stride = 0;
+                        std::vector<std::size_t> offset(props.size()), list_length(props.size(), 1);
+                        first_instance.clear();
+                        for (std::size_t i = 0; i < props.size(); ++i) {
+                            offset[i] = stride;
+                            std::size_t size = type_size(props[i].is_list ? props[i].length_type : props[i].type);
+                            if (props[i].is_list) {
+                                first_instance.resize(stride + size);
+                                if (fread(first_instance.data() + stride, 1, size, file) != size)
+                                    return false;
+                                double num = 0;
+                                decode(props[i].length_type, first_instance.data() + stride, size, 1, swap_, &num, 1);
+                                if (num < 0)
+                                    return false;
+                                list_length[i] = static_cast<std::size_t>(num);
+                                stride += size;
+                                size = list_length[i] * type_size(props[i].type);
+                            }
+                            first_instance.resize(stride + size);
+                            if (size > 0 && fread(first_instance.data() + stride, 1, size, file) != size)
+                                return false;
+                            stride += size;
+                        }
+                        if (stride == 0)
+                            return false;
+
+                        Element element(header.name, header.num_instances);
+                        const std::vector<Target> targets = make_targets(header, element);
+                        for (auto &prop : element.vec3_properties) prop.resize(header.num_instances);
+                        for (auto &prop : element.vec2_properties) prop.resize(header.num_instances);
+                        for (auto &prop : element.float_properties) prop.resize(header.num_instances);
+                        for (auto &prop : element.int_properties) prop.resize(header.num_instances);
+                        for (std::size_t i = 0; i < props.size(); ++i) {
+                            if (targets[i].kind == Target::INT_LIST)
+                                element.int_list_properties[targets[i].index].resize(header.num_instances, list_length[i]);
+                            else if (targets[i].kind == Target::FLOAT_LIST)
+                                element.float_list_properties[targets[i].index].resize(header.num_instances, list_length[i]);
+                        }
+
+                        // read the instances in blocks and decode each property as a column
+                        const std::size_t block_size = std::max<std::size_t>(1, (std::size_t(1) << 26) / stride);
+                        std::vector<std::size_t> lengths;
+                        for (std::size_t first = 0; first < header.num_instances; first += block_size) {
+                            const std::size_t num = std::min(block_size, header.num_instances - first);
+                            buffer.resize(num * stride);
+                            std::size_t pending = buffer.size();
+                            char *dst = buffer.data();
+                            if (first == 0) { // the first instance has already been read
+                                std::memcpy(dst, first_instance.data(), stride);
+                                dst += stride;
+                                pending -= stride;
+                            }
+                            // a short read means variable-size lists (or a truncated file): use the generic reader
+                            if (pending > 0 && fread(dst, 1, pending, file) != pending)
+                                return false;
+                            for (std::size_t i = 0; i < props.size(); ++i) {
+                                const char *src = buffer.data() + offset[i];
+                                const Target &t = targets[i];
+                                if (props[i].is_list) {
+                                    // all lists must have the same length, otherwise the layout is not fixed
+                                    lengths.resize(num);
+                                    decode(props[i].length_type, src, stride, num, swap_, lengths.data(), 1);
+                                    for (auto len : lengths) {
+                                        if (len != list_length[i])
+                                            return false;
+                                    }
+                                    // the k-th values of all lists are decoded as a column, straight into the flat
+                                    // value array
+                                    src += type_size(props[i].length_type);
+                                    const std::size_t value_size = type_size(props[i].type);
+                                    const std::size_t len = list_length[i];
+                                    for (std::size_t k = 0; k < len; ++k) {
+                                        if (t.kind == Target::INT_LIST) {
+                                            auto &values = element.int_list_properties[t.index].values;
+                                            decode(props[i].type, src + k * value_size, stride, num, swap_,
+                                                   values.data() + first * len + k, len);
+                                        } else {
+                                            auto &values = element.float_list_properties[t.index].values;
+                                            decode(props[i].type, src + k * value_size, stride, num, swap_,
+                                                   values.data() + first * len + k, len);
+                                        }
+                                    }
+                                } else {
+                                    switch (t.kind) {
+                                        case Target::VEC3:
+                                            decode(props[i].type, src, stride, num, swap_,
+                                                   element.vec3_properties[t.index][first].data() + t.component, 3);
+                                            break;
+                                        case Target::VEC2:
+                                            decode(props[i].type, src, stride, num, swap_,
+                                                   element.vec2_properties[t.index][first].data() + t.component, 2);
+                                            break;
+                                        case Target::FLOAT:
+                                            decode(props[i].type, src, stride, num, swap_,
+                                                   element.float_properties[t.index].data() + first, 1);
+                                            break;
+                                        default:
+                                            decode(props[i].type, src, stride, num, swap_,
+                                                   element.int_properties[t.index].data() + first, 1);
+                                            break;
+                                    }
+                                }
+                            }
+                        }
+
+                        // scale the colors (and alpha values) stored as integers in [0, 255]
+                        for (const auto &t : targets) {
+                            if (t.scale == 1.0f)
+                                continue;
+                            if (t.kind == Target::VEC3) {
+                                for (auto &v : element.vec3_properties[t.index])
+                                    v[t.component] *= t.scale;
+                            } else if (t.kind == Target::FLOAT) {
+                                for (auto &v : element.float_properties[t.index])
+                                    v *= t.scale;
+                            }
+                        }
+
+                        for (const auto &prop : element.vec3_properties) {
+                            if (prop.name == "normal" && !prop.empty()) { // check if the normals are normalized
+                                const float len = length(prop[0]);
+                                LOG_IF(std::abs(1.0 - len) > epsilon<float>(), WARNING)
+                                                << "normals (defined on element '" << element.name
+                                                << "') not normalized (length of the first normal vector is " << len
+                                                << ")";
+                            }
+                        }
+
+                        result.push_back(std::move(element));
+                    }
+
+                    elements.swap(result);
+                    return true;
+                }
+
+            private:
+                std::vector<HeaderElement> elements_;
+                bool swap_ = false;
+            };
+
+        } // namespace details
+
+
         PlyReader::~PlyReader() {
             for (auto prop : list_properties_)
                 delete prop;
@@ -345,6 +868,12 @@ namespace easy3d {
 
 
         bool PlyReader::read(const std::string &file_name, std::vector<Element> &elements) {
+            // the fast path for binary files with a fixed layout (the vast majority of binary PLY files)
+            details::FixedLayoutBinaryReader fast_reader;
+            if (fast_reader.read(file_name, elements))
+                return std::any_of(elements.begin(), elements.end(),
+                                   [](const Element &e) { return e.num_instances > 0; });
+
             p_ply ply = ply_open(file_name.c_str(), nullptr, 0, nullptr);
             if (!ply) {
                 LOG(ERROR) << "failed to open ply file: " << file_name;
@@ -399,8 +928,8 @@ namespace easy3d {
                 long num_instances = 0;
                 const char *element_name = nullptr;
                 ply_get_element_info(element, &element_name, &num_instances);
-                if (num_instances <= 0)
-                    continue;
+                // an element without instances is still collected (with empty properties), but no callbacks are set
+                // for it (ply_set_read_cb() returns the number of instances, i.e., 0 would be taken as a failure)
 
 //                if (strcmp(element_name, VERTEX) && strcmp(element_name, FACE) && strcmp(element_name, EDGE)) {
 //                    LOG(ERROR) << "unknown element: " << element_name << " (ignored)";
@@ -428,7 +957,8 @@ namespace easy3d {
                         prop->orig_value_type = value_type;
                         prop->resize(num_instances);
                         list_properties_.push_back(prop);
-                        if (!ply_set_read_cb(ply, element_name, property_name, callback_list_property, prop, 0)) {
+                        if (num_instances > 0 &&
+                            !ply_set_read_cb(ply, element_name, property_name, callback_list_property, prop, 0)) {
                             LOG(ERROR) << "failed to set callback for list property '" << property_name
                                        << "' for element '" << element_name << "'";
                             return false;
@@ -438,7 +968,8 @@ namespace easy3d {
                         prop->orig_value_type = type;
                         prop->resize(num_instances);
                         value_properties_.push_back(prop);
-                        if (!ply_set_read_cb(ply, element_name, property_name, callback_value_property, prop, 0)) {
+                        if (num_instances > 0 &&
+                            !ply_set_read_cb(ply, element_name, property_name, callback_value_property, prop, 0)) {
                             LOG(ERROR) << "failed to set callback for property '" << property_name << "' for element '"
                                        << element_name << "'";
                             return false;
@@ -465,7 +996,9 @@ namespace easy3d {
             for (auto prop : value_properties_) delete prop;
             value_properties_.clear();
 
-            return (elements.size() > 0 && elements[0].num_instances > 0);
+            // empty elements are kept, so they may come first
+            return std::any_of(elements.begin(), elements.end(),
+                               [](const Element &e) { return e.num_instances > 0; });
         }
 
 
@@ -514,15 +1047,19 @@ namespace easy3d {
 
             template<typename VT_Input, typename VT_Output>
             inline void convert(const GenericProperty<std::vector<VT_Input> > &input,
-                                GenericProperty<std::vector<VT_Output> > &output) {
-                output.resize(input.size());
+                                GenericListProperty<VT_Output> &output) {
                 output.name = input.name;
-                for (std::size_t i = 0; i < input.size(); ++i) {
-                    const auto &v_in = input[i];
-                    auto &v_out = output[i];
-                    v_out.resize(v_in.size());
-                    for (std::size_t j = 0; j < v_in.size(); ++j)
-                        v_out[j] = static_cast<VT_Output>(v_in[j]);
+                std::size_t num_values = 0;
+                for (const auto &v_in : input)
+                    num_values += v_in.size();
+                output.values.clear();
+                output.values.reserve(num_values);
+                output.offsets.assign(1, 0);
+                output.offsets.reserve(input.size() + 1);
+                for (const auto &v_in : input) {
+                    for (auto v : v_in)
+                        output.values.push_back(static_cast<VT_Output>(v));
+                    output.offsets.push_back(output.values.size());
                 }
             }
 
@@ -51,12 +51,70 @@ namespace easy3d {
             std::string name;
         };
 
+        /// \brief Generic list property, i.e., a list of values for each instance.
+        /// \class GenericListProperty easy3d/fileio/ply_reader_writer.h
+        /// \details The lists are stored in two flat arrays (instead of a vector per instance): the values of
+        ///     instance \c i are values[offsets[i]], ..., values[offsets[i + 1] - 1].
+        /// \tparam VT The value type, e.g., int, float
+        template <typename VT>
+        class GenericListProperty {
+        public:
+            GenericListProperty(const std::string &prop_name = "",
+                                const std::vector< std::vector<VT> > &lists = std::vector< std::vector<VT> >())
+                    : name(prop_name), offsets(1, 0) {
+                reserve(lists.size());
+                for (const auto &list : lists)
+                    push_back(list);
+            }
+
+            /// \brief The number of instances (i.e., lists).
+            std::size_t size() const { return offsets.size() - 1; }
+            /// \brief Returns whether there is no instance.
+            bool empty() const { return offsets.size() == 1; }
+            /// \brief Reserves memory for \p n instances.
+            void reserve(std::size_t n) { offsets.reserve(n + 1); }
+            /// \brief Resizes to \p n instances, each having a list of \p length values.
+            void resize(std::size_t n, std::size_t length) {
+                values.resize(n * length);
+                offsets.resize(n + 1);
+                for (std::size_t i = 0; i <= n; ++i)
+                    offsets[i] = i * length;
+            }
+
+            /// \brief The number of values of instance \p i.
+            std::size_t length(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+            /// \brief The first value of instance \p i.
+            const VT *list(std::size_t i) const { return values.data() + offsets[i]; }
+            /// \brief A copy of the list of instance \p i.
+            std::vector<VT> operator[](std::size_t i) const {
+                return std::vector<VT>(values.begin() + offsets[i], values.begin() + offsets[i + 1]);
+            }
+
+            /// \brief Appends an instance.
+            void push_back(const std::vector<VT> &list) {
+                values.insert(values.end(), list.begin(), list.end());
+                offsets.push_back(values.size());
+            }
+
+            /// \brief Converts to a vector per instance (e.g., to be stored as a property of a model).
+            operator std::vector< std::vector<VT> >() const {
+                std::vector< std::vector<VT> > lists(size());
+                for (std::size_t i = 0; i < lists.size(); ++i)
+                    lists[i].assign(values.begin() + offsets[i], values.begin() + offsets[i + 1]);
+                return lists;
+            }
+
+            std::string name;
+            std::vector<VT> values;             // the values of all instances, one list after another
+            std::vector<std::size_t> offsets;   // the start of each list (and the end of the last one)
+        };
+
 		typedef GenericProperty<vec3>                   Vec3Property;
         typedef GenericProperty<vec2>                   Vec2Property;
 		typedef GenericProperty<float>                  FloatProperty;
 		typedef GenericProperty<int>                    IntProperty;
-		typedef GenericProperty< std::vector<float> >	FloatListProperty;
-		typedef GenericProperty< std::vector<int> >     IntListProperty;
+		typedef GenericListProperty<float>	            FloatListProperty;
+		typedef GenericListProperty<int>                IntListProperty;
 
         /// \brief Model element (e.g., faces, vertices, edges) with optional properties
         /// \class Element easy3d/fileio/ply_reader_writer.h
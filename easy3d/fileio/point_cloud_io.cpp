@@ -62,6 +62,8 @@ namespace easy3d {
             success = io::PointCloudIO_vg::load_vg(file_name, cloud);
         else if (ext == "bvg")
             success = io::PointCloudIO_vg::load_bvg(file_name, cloud);
+        else if (ext == "e3d")
+            success = io::load_e3d(file_name, cloud);
 
         else if (ext.empty()){
             LOG(ERROR) << "unknown file format: no extension";
@@ -89,50 +91,80 @@ namespace easy3d {
 	}
 
 
-	bool PointCloudIO::save(const std::string& file_name, const PointCloud* cloud) {
-		if (!cloud) {
-			LOG(ERROR) << "Point cloud is null";
-			return false;
-		}
+	namespace details {
 
-        StopWatch w;
-        bool success = false;
+        // saves all the points (if vertices is null) or only the given vertices
+        bool save(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices) {
+            if (!cloud) {
+                LOG(ERROR) << "Point cloud is null";
+                return false;
+            }
 
-        std::string final_name = file_name;
-        const std::string& ext = file_system::extension(file_name, true);
-        if (ext == "ply" || ext.empty()) {
-            if (ext.empty()) {
-                LOG(ERROR) << "No extension specified. Default to ply";
-                final_name = final_name + ".ply";
+            if (vertices) {
+                const int num = static_cast<int>(cloud->vertices_size());
+                for (auto id : *vertices) {
+                    if (id < 0 || id >= num || cloud->is_deleted(PointCloud::Vertex(id))) {
+                        LOG(ERROR) << "invalid vertex index: " << id << " (out of range or deleted)";
+                        return false;
+                    }
+                }
             }
-            success = io::save_ply(final_name, cloud, true);
-        }
-		else if (ext == "bin")
-            success = io::save_bin(final_name, cloud);
-		else if (ext == "xyz")
-            success = io::save_xyz(final_name, cloud);
-		else if (ext == "bxyz")
-            success = io::save_bxyz(final_name, cloud);
-		else if (ext == "las" || ext == "laz")
-            success = io::save_las(final_name, cloud);
-        else if (ext == "vg")
-            success = io::PointCloudIO_vg::save_vg(file_name, cloud);
-        else if (ext == "bvg")
-            success = io::PointCloudIO_vg::save_bvg(file_name, cloud);
-		else {
-			LOG(ERROR) << "unknown file format: " << ext;
-            success = false;
-		}
 
-        if (success) {
-            LOG(INFO) << "save model done. " << w.time_string();
-            return true;
-        }
-        else {
-            LOG(INFO) << "save model failed";
-            return false;
+            StopWatch w;
+            bool success = false;
+
+            std::string final_name = file_name;
+            const std::string& ext = file_system::extension(file_name, true);
+            if (ext == "ply" || ext.empty()) {
+                if (ext.empty()) {
+                    LOG(ERROR) << "No extension specified. Default to ply";
+                    final_name = final_name + ".ply";
+                }
+                success = io::save_ply(final_name, cloud, true, vertices);
+            }
+            else if (ext == "bin")
+                success = io::save_bin(final_name, cloud, vertices);
+            else if (ext == "xyz")
+                success = io::save_xyz(final_name, cloud, vertices);
+            else if (ext == "bxyz")
+                success = io::save_bxyz(final_name, cloud, vertices);
+            else if (ext == "las" || ext == "laz")
+                success = io::save_las(final_name, cloud, vertices);
+            else if (vertices && (ext == "vg" || ext == "bvg" || ext == "e3d")) {
+                LOG(ERROR) << "saving a subset of the points is not supported for format: " << ext;
+                success = false;
+            }
+            else if (ext == "vg")
+                success = io::PointCloudIO_vg::save_vg(file_name, cloud);
+            else if (ext == "bvg")
+                success = io::PointCloudIO_vg::save_bvg(file_name, cloud);
+            else if (ext == "e3d")
+                success = io::save_e3d(file_name, cloud);
+            else {
+                LOG(ERROR) << "unknown file format: " << ext;
+                success = false;
+            }
+
+            if (success) {
+                LOG(INFO) << "save model done. " << w.time_string();
+                return true;
+            }
+            else {
+                LOG(INFO) << "save model failed";
+                return false;
+            }
         }
 
+    } // namespace details
+
+
+	bool PointCloudIO::save(const std::string& file_name, const PointCloud* cloud) {
+        return details::save(file_name, cloud, nullptr);
 	}
 
+
+    bool PointCloudIO::save(const std::string& file_name, const PointCloud* cloud, const std::vector<int>& vertices) {
+        return details::save(file_name, cloud, &vertices);
+    }
+
 } // namespace easy3d
@@ -45,7 +45,7 @@ namespace easy3d {
 	public:
         /**
          * \brief Reads a point cloud from file \p file_name.
-         * \details File extension determines file format (bin, xyz/bxyz, ply, las/laz, vg/bvg)
+         * \details File extension determines file format (bin, xyz/bxyz, ply, las/laz, vg/bvg, e3d)
          * and type (i.e. binary or ASCII).
          * \return The pointer of the point cloud (nullptr if failed).
          */
@@ -53,7 +53,7 @@ namespace easy3d {
 
         /**
          * \brief Saves a point_cloud to a file.
-         * \details File extension determines file format (bin, xyz/bxyz, ply, las/laz, vg/bvg) and type (i.e. binary
+         * \details File extension determines file format (bin, xyz/bxyz, ply, las/laz, vg/bvg, e3d) and type (i.e. binary
          * or ASCII).
          * \param file_name The file name.
          * \param cloud The point cloud.
@@ -62,6 +62,19 @@ namespace easy3d {
          *      \arg false if failed
          */
 		static bool	save(const std::string& file_name, const PointCloud* cloud);
+
+        /**
+         * \brief Saves a subset of the points of a point cloud to a file, without creating a new point cloud.
+         * \details File extension determines file format (bin, xyz/bxyz, ply, las/laz) and type (i.e. binary or
+         * ASCII). The selected points and their properties are written in the given order.
+         * \param file_name The file name.
+         * \param cloud The point cloud.
+         * \param vertices The indices of the vertices to be saved. They must be valid and not deleted.
+         * \return The status of the operation
+         *      \arg true if succeeded
+         *      \arg false if failed
+         */
+        static bool	save(const std::string& file_name, const PointCloud* cloud, const std::vector<int>& vertices);
 	};
 
 
@@ -74,29 +87,42 @@ namespace easy3d {
         /// \brief Saves a point cloud to a \c bin format file.
         /// \details A typical \c bin format file contains three blocks storing points, colors (optional),
         /// and normals (optional).
-		bool save_bin(const std::string& file_name, const PointCloud* cloud);
+        /// If \p vertices is provided, only these vertices are saved.
+		bool save_bin(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices = nullptr);
+
+        /// \brief Reads point cloud from an \c e3d format file, the chunked columnar native format of Easy3D.
+        bool load_e3d(const std::string& file_name, PointCloud* cloud);
+        /// \brief Reads the points and only the listed \p properties (e.g., "v:normal") of a point cloud from an
+        /// \c e3d format file. Chunks of other properties are not even read from disk.
+        bool load_e3d(const std::string& file_name, PointCloud* cloud, const std::vector<std::string>& properties);
+        /// \brief Saves a point cloud to an \c e3d format file, the chunked columnar native format of Easy3D.
+        bool save_e3d(const std::string& file_name, const PointCloud* cloud);
 
         /// \brief Reads point cloud from an \c xyz format file.
         /// \details Each line of an \c xyz file contains three floating point numbers representing the \p x, \p y, and
         /// \p z coordinates of a point.
 		bool load_xyz(const std::string& file_name, PointCloud* cloud);
-		bool save_xyz(const std::string& file_name, const PointCloud* cloud);
+        /// \brief Saves a point cloud to an \c xyz format file. If \p vertices is provided, only these vertices are saved.
+		bool save_xyz(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices = nullptr);
         /// \brief Reads point cloud from a binary \c xyz format file.
 		bool load_bxyz(const std::string& file_name, PointCloud* cloud);
-        /// \brief Saves a point cloud to a binary \c xyz format file.
-		bool save_bxyz(const std::string& file_name, const PointCloud* cloud);
+        /// \brief Saves a point cloud to a binary \c xyz format file. If \p vertices is provided, only these vertices
+        /// are saved.
+		bool save_bxyz(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices = nullptr);
 
         /// \brief Reads point cloud from a \c ply format file.
 		bool load_ply(const std::string& file_name, PointCloud* cloud);
-        /// \brief Saves a point cloud to a \c ply format file.
-		bool save_ply(const std::string& file_name, const PointCloud* cloud, bool binary = true);
+        /// \brief Saves a point cloud to a \c ply format file. If \p vertices is provided, only these vertices are saved.
+		bool save_ply(const std::string& file_name, const PointCloud* cloud, bool binary = true,
+                      const std::vector<int>* vertices = nullptr);
 
         /// \brief Reads point cloud from an \c las/laz format file.
         ///     Internally the method uses the LASlib of martin.isenburg@rapidlasso.com. See http://rapidlasso.com
         bool load_las(const std::string &file_name, PointCloud *cloud);
         /// \brief Saves a point cloud to an \c LAS/LAS format file.
         /// \details Internally it uses the LASlib of martin.isenburg@rapidlasso.com. See http://rapidlasso.com
-		bool save_las(const std::string& file_name, const PointCloud* cloud);
+        ///     If \p vertices is provided, only these vertices are saved.
+		bool save_las(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices = nullptr);
 	};
 
 
@@ -25,8 +25,10 @@
  ********************************************************************/
 
 #include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/point_cloud_io_details.h>
 
 #include <fstream>
+#include <algorithm>
 
 #include <easy3d/fileio/translator.h>
 #include <easy3d/core/point_cloud.h>
@@ -37,6 +39,52 @@ namespace easy3d {
 
 	namespace io {
 
+        namespace details {
+
+            bool write_values(std::ostream &output, const std::vector<vec3> &values, const std::vector<int> *vertices,
+                              const dvec3 *origin) {
+                const std::size_t num = vertices ? vertices->size() : values.size();
+                if (!vertices && !origin) {
+                    output.write((const char *) values.data(), num * sizeof(vec3));
+                    return !output.fail();
+                }
+
+                const std::size_t chunk_size = 1 << 16;
+                std::vector<vec3> buffer;
+                buffer.reserve(std::min(chunk_size, num));
+                for (std::size_t first = 0; first < num; first += chunk_size) {
+                    const std::size_t last = std::min(first + chunk_size, num);
+                    buffer.clear();
+                    for (std::size_t i = first; i < last; ++i) {
+                        const vec3 &v = values[vertices ? (*vertices)[i] : i];
+                        if (origin)
+                            buffer.emplace_back(static_cast<float>(v.x + origin->x),
+                                                static_cast<float>(v.y + origin->y),
+                                                static_cast<float>(v.z + origin->z));
+                        else
+                            buffer.push_back(v);
+                    }
+                    output.write((const char *) buffer.data(), buffer.size() * sizeof(vec3));
+                    if (output.fail())
+                        return false;
+                }
+                return true;
+            }
+
+
+            const std::vector<int> *select_vertices(const PointCloud *cloud, const std::vector<int> *vertices,
+                                                    std::vector<int> &storage) {
+                if (vertices || !cloud->has_garbage())
+                    return vertices;
+                storage.clear();
+                storage.reserve(cloud->n_vertices());
+                for (auto v : cloud->vertices())
+                    storage.push_back(v.idx());
+                return &storage;
+            }
+
+        } // namespace details
+
 
 		// three blocks storing points, colors (optional), and normals (optional)
 		bool load_bin(const std::string& file_name, PointCloud* cloud) {
@@ -110,7 +158,7 @@ namespace easy3d {
 		}
 
 
-		bool save_bin(const std::string& file_name, const PointCloud* cloud) {
+		bool save_bin(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices) {
 			// open file
 			std::ofstream output(file_name.c_str(), std::fstream::binary);
 			if (output.fail()) {
@@ -118,30 +166,22 @@ namespace easy3d {
 				return false;
 			}
 
-            int num = cloud->n_vertices();
+            std::vector<int> live;
+            vertices = details::select_vertices(cloud, vertices, live);
+            int num = vertices ? static_cast<int>(vertices->size()) : static_cast<int>(cloud->n_vertices());
 
 			// write the points block
 			auto points = cloud->get_vertex_property<vec3>("v:point");
             output.write((char*)&num, sizeof(int));
 
             auto trans = cloud->get_model_property<dvec3>("translation");
-            if (trans) { // has translation
-                const dvec3& origin = trans[0];
-                for (auto v : cloud->vertices()) {
-                    const vec3& p = points[v];
-                    for (unsigned short i=0; i<3; ++i) {
-                        float value = static_cast<float>(p[i] + origin[i]);
-                        output.write((char *)&value, sizeof(float));
-                    }
-                }
-            }
-            else
-			    output.write((char*)points.data(), num * sizeof(vec3));
+            const dvec3 origin = trans ? trans[0] : dvec3(0, 0, 0);
+            bool success = details::write_values(output, points.vector(), vertices, trans ? &origin : nullptr);
 
 			auto colors = cloud->get_vertex_property<vec3>("v:color");
 			if (colors) {
                 output.write((char*)&num, sizeof(int));
-				output.write((char*)colors.data(), num * sizeof(vec3));
+                success = success && details::write_values(output, colors.vector(), vertices, nullptr);
 			}
             else {
                 int num_colors = 0;
@@ -151,13 +191,17 @@ namespace easy3d {
 			auto normals = cloud->get_vertex_property<vec3>("v:normal");
 			if (normals) {
                 output.write((char*)&num, sizeof(int));
-				output.write((char*)normals.data(), num * sizeof(vec3));
+                success = success && details::write_values(output, normals.vector(), vertices, nullptr);
 			}
             else {
                 int num_normals = 0;
                 output.write((char*)&num_normals, sizeof(int));
             }
 
+            if (!success || output.fail()) {
+                LOG(ERROR) << "failed writing file: " << file_name;
+                return false;
+            }
 			return true;
 		}
 
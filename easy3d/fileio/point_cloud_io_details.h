@@ -0,0 +1,65 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_FILEIO_POINT_CLOUD_IO_DETAILS_H
+#define EASY3D_FILEIO_POINT_CLOUD_IO_DETAILS_H
+
+#include <vector>
+#include <ostream>
+
+#include <easy3d/core/types.h>
+
+
+// Internal helpers shared by the point cloud writers (defined in point_cloud_io_bin.cpp). Not part of the API.
+
+// \cond
+namespace easy3d {
+
+    class PointCloud;
+
+    namespace io {
+
+        namespace details {
+
+            // Writes the (translated) values of the given vertices (or of all vertices if the list is null) into a
+            // binary stream. The values are gathered into chunks, so no copy of the entire point cloud is made.
+            bool write_values(std::ostream &output, const std::vector<vec3> &values, const std::vector<int> *vertices,
+                              const dvec3 *origin);
+
+            // The vertices to be saved: the given ones, or all the (non-deleted) vertices if the point cloud has
+            // garbage (in which case their indices are stored in 'storage'). Returns null if all the values in the
+            // property arrays are to be saved.
+            const std::vector<int> *select_vertices(const PointCloud *cloud, const std::vector<int> *vertices,
+                                                    std::vector<int> &storage);
+
+        } // namespace details
+
+    } // namespace io
+
+} // namespace easy3d
+// \endcond
+
+#endif  // EASY3D_FILEIO_POINT_CLOUD_IO_DETAILS_H
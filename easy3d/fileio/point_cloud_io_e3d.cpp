@@ -0,0 +1,130 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/chunked_file.h>
+#include <easy3d/core/point_cloud.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        namespace details {
+
+            // Access to the vertex properties of a point cloud (see write_properties() and read_properties())
+            template<typename Cloud>
+            struct PointCloudVertices {
+                Cloud *cloud;
+                std::vector<std::string> names() const { return cloud->vertex_properties(); }
+                const std::type_info &type(const std::string &name) const { return cloud->get_vertex_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return cloud->template get_vertex_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return cloud->template vertex_property<T>(name).vector();
+                }
+            };
+
+
+            bool load_e3d(const std::string &file_name, PointCloud *cloud, const std::vector<std::string> *selected) {
+                if (!cloud) {
+                    LOG(ERROR) << "null point cloud pointer";
+                    return false;
+                }
+
+                ChunkedFileReader reader(file_name);
+                if (!reader.is_ok())
+                    return false;
+                if (reader.model_type() != "PointCloud") {
+                    LOG(ERROR) << "file stores a " << reader.model_type() << " (a PointCloud is expected): "
+                               << file_name;
+                    return false;
+                }
+
+                cloud->clear();
+                cloud->resize(reader.size("vertex"));
+
+                // the point coordinates are always loaded
+                std::vector<std::string> vertex_selected;
+                if (selected) {
+                    vertex_selected = *selected;
+                    vertex_selected.push_back("v:point");
+                }
+                PointCloudVertices<PointCloud> vertices{cloud};
+                if (!read_properties(reader, "vertex", vertices, {"v:deleted"}, selected ? &vertex_selected : nullptr)) {
+                    cloud->clear();
+                    return false;
+                }
+
+                // the vertex coordinates are stored relative to the translation (if any)
+                auto &points = cloud->vertex_property<vec3>("v:point").vector();
+                if (!read_translation(reader, cloud, points)) {
+                    cloud->clear();
+                    return false;
+                }
+
+                return cloud->n_vertices() > 0;
+            }
+
+        } // namespace details
+
+
+        bool load_e3d(const std::string &file_name, PointCloud *cloud) {
+            return details::load_e3d(file_name, cloud, nullptr);
+        }
+
+
+        bool load_e3d(const std::string &file_name, PointCloud *cloud, const std::vector<std::string> &properties) {
+            return details::load_e3d(file_name, cloud, &properties);
+        }
+
+
+        bool save_e3d(const std::string &file_name, const PointCloud *cloud) {
+            if (!cloud) {
+                LOG(ERROR) << "null point cloud pointer";
+                return false;
+            }
+
+            // the deleted points are not stored
+            PointCloud copy;
+            if (cloud->has_garbage()) {
+                copy = *cloud;
+                copy.collect_garbage();
+                cloud = &copy;
+            }
+
+            ChunkedFileWriter writer(file_name, "PointCloud");
+            writer.set_size("vertex", cloud->n_vertices());
+            details::write_properties(writer, "vertex", details::PointCloudVertices<const PointCloud>{cloud},
+                                      {"v:deleted"});
+            details::write_translation(writer, cloud);
+            return writer.finish();
+        }
+
+    }
+
+}
@@ -25,6 +25,7 @@
  ********************************************************************/
 
 #include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/point_cloud_io_details.h>
 
 #include <algorithm>
 #include <climits>  // for USHRT_MAX
@@ -142,11 +143,13 @@ namespace easy3d {
         }
 
 
-        bool save_las(const std::string &file_name, const PointCloud *cloud) {
+        bool save_las(const std::string &file_name, const PointCloud *cloud, const std::vector<int> *vertices) {
             if (!cloud) {
                 LOG(ERROR) << "null input point cloud pointer";
                 return false;
             }
+            std::vector<int> live;
+            vertices = details::select_vertices(cloud, vertices, live);
 
             auto normals = cloud->get_vertex_property<vec3>("v:normal");
             if (normals)
@@ -162,10 +165,17 @@ namespace easy3d {
             }
 
             auto points = cloud->get_vertex_property<vec3>("v:point");
-            const Box3 &box = cloud->bounding_box();
+            Box3 box;
+            if (vertices) {
+                for (auto id : *vertices)
+                    box.grow(points.vector()[id]);
+            }
+            else
+                box = cloud->bounding_box();
             const vec3 center = box.center();
             auto trans = cloud->get_model_property<dvec3>("translation");
-            LOG(INFO) << "saving " << cloud->n_vertices() << " points...";
+            const std::size_t num = vertices ? vertices->size() : cloud->n_vertices();
+            LOG(INFO) << "saving " << num << " points...";
 
             // init header
             // to set a 'accurate enough' scale factor, I follow the suggestion here:
@@ -220,7 +230,8 @@ namespace easy3d {
 
             // write points
             if (colors) {
-                for (auto v : cloud->vertices()) {
+                for (std::size_t i = 0; i < num; ++i) {
+                    const PointCloud::Vertex v(vertices ? (*vertices)[i] : static_cast<int>(i));
                     const vec3 &p = points[v];
                     laspoint.coordinates[0] = p[0] + x0;
                     laspoint.coordinates[1] = p[1] + y0;
@@ -244,9 +255,9 @@ namespace easy3d {
                 }
             } else {
                 // if the model doesn't have color, I store the height values as the intensity
-                const Box3 &box = cloud->bounding_box();
                 const float ht = box.range(2);
-                for (auto v : cloud->vertices()) {
+                for (std::size_t i = 0; i < num; ++i) {
+                    const PointCloud::Vertex v(vertices ? (*vertices)[i] : static_cast<int>(i));
                     const vec3 &p = points[v];
                     laspoint.coordinates[0] = p[0] + x0;
                     laspoint.coordinates[1] = p[1] + y0;
@@ -270,10 +281,11 @@ namespace easy3d {
 
             // close the writer
             I64 total_bytes = laswriter->close();
-            LOG(INFO) << total_bytes << " bytes for " << laswriter->npoints << " points";
+            const I64 num_written = laswriter->npoints;
+            LOG(INFO) << total_bytes << " bytes for " << num_written << " points";
             delete laswriter;
 
-            return laswriter->npoints > 0;
+            return num_written > 0;
         }
 
     }
@@ -25,6 +25,7 @@
  ********************************************************************/
 
 #include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/point_cloud_io_details.h>
 #include <easy3d/fileio/translator.h>
 #include <easy3d/fileio/ply_reader_writer.h>
 #include <easy3d/core/point_cloud.h>
@@ -122,36 +123,70 @@ namespace easy3d {
 
 		namespace details {
 
+			// If vertices is provided, only the values of these vertices are collected.
 			template <typename T>
-			inline void collect_properties(const PointCloud* cloud, std::vector< GenericProperty<T> >& properties) {
+			inline void collect_properties(const PointCloud* cloud, std::vector< GenericProperty<T> >& properties,
+                                           const std::vector<int>* vertices) {
 				const auto& all_properties = cloud->vertex_properties();
 				for (auto name : all_properties) {
 					auto prop = cloud->get_vertex_property<T>(name);
 					if (prop) {
 						if (name.substr(0, 2) == "v:")
 							name = name.substr(2, name.length() - 1);
-						properties.emplace_back(GenericProperty<T>(name, prop.vector()));
+                        if (vertices) {
+                            properties.emplace_back(GenericProperty<T>(name));
+                            auto& values = properties.back();
+                            values.reserve(vertices->size());
+                            for (auto id : *vertices)
+                                values.push_back(prop.vector()[id]);
+                        }
+                        else
+                            properties.emplace_back(GenericProperty<T>(name, prop.vector()));
 					}
 				}
 			}
 
+			template <typename T>
+			inline void collect_properties(const PointCloud* cloud, std::vector< GenericListProperty<T> >& properties,
+                                           const std::vector<int>* vertices) {
+				const auto& all_properties = cloud->vertex_properties();
+				for (auto name : all_properties) {
+					auto prop = cloud->get_vertex_property< std::vector<T> >(name);
+					if (prop) {
+						if (name.substr(0, 2) == "v:")
+							name = name.substr(2, name.length() - 1);
+                        if (vertices) {
+                            properties.emplace_back(GenericListProperty<T>(name));
+                            auto& values = properties.back();
+                            values.reserve(vertices->size());
+                            for (auto id : *vertices)
+                                values.push_back(prop.vector()[id]);
+                        }
+                        else
+                            properties.emplace_back(GenericListProperty<T>(name, prop.vector()));
+					}
+				}
+			}
 		} // namespace details
 
-		bool save_ply(const std::string& file_name, const PointCloud* cloud, bool binary/* = true*/) {
-			if (!cloud || cloud->n_vertices() == 0) {
+		bool save_ply(const std::string& file_name, const PointCloud* cloud, bool binary/* = true*/,
+                      const std::vector<int>* vertices/* = nullptr*/) {
+			if (!cloud || cloud->n_vertices() == 0 || (vertices && vertices->empty())) {
 				LOG(ERROR) << "empty point cloud data";
 				return false;
 			}
+            std::vector<int> live;
+            vertices = details::select_vertices(cloud, vertices, live);
 
-			std::size_t num = cloud->n_vertices();
+			std::size_t num = vertices ? vertices->size() : cloud->n_vertices();
 			Element element_vertex("vertex", num);
 
-			details::collect_properties(cloud, element_vertex.vec3_properties);
-            details::collect_properties(cloud, element_vertex.vec2_properties);
-			details::collect_properties(cloud, element_vertex.float_properties);
-			details::collect_properties(cloud, element_vertex.int_properties);
-			details::collect_properties(cloud, element_vertex.int_list_properties);
-			details::collect_properties(cloud, element_vertex.float_list_properties);
+			details::collect_properties(cloud, element_vertex.vec3_properties, vertices);
+            details::collect_properties(cloud, element_vertex.vec2_properties, vertices);
+			details::collect_properties(cloud, element_vertex.float_properties, vertices);
+			details::collect_properties(cloud, element_vertex.int_properties, vertices);
+			details::collect_properties(cloud, element_vertex.int_list_properties, vertices);
+			details::collect_properties(cloud, element_vertex.float_list_properties, vertices);
 
             auto trans = cloud->get_model_property<dvec3>("translation");
             if (trans) { // has translation
@@ -168,7 +203,7 @@ namespace easy3d {
             }
 
 			std::vector<Element> elements;
-            elements.emplace_back(element_vertex);
+            elements.emplace_back(std::move(element_vertex));
 
             binary = binary && (file_name.find("ascii") == std::string::npos);
             LOG_IF(!binary, WARNING) << "you're writing an ASCII ply file. Use binary format for better performance";
@@ -27,7 +27,11 @@
 #include <easy3d/fileio/point_cloud_io_ptx.h>
 
 #include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 #include <fstream>
+#include <sstream>
 
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/util/file_system.h>
@@ -200,6 +204,332 @@ namespace easy3d {
 			}
 		}
 
+
+		namespace details {
+
+			// reads the header of a scan. Returns false if the header is incomplete (or there are no more scans).
+			bool read_ptx_header(LineInputStream& in, PointCloudIO_ptx::Scan& scan) {
+				// skip empty lines between scans
+				do {
+					in.get_line();
+					if (in.eof() && in.current_line().empty())
+						return false;
+				} while (in.current_line().find_first_not_of(" \t\r") == std::string::npos);
+
+				in >> scan.num_columns;
+				in.get_line();
+				in >> scan.num_rows;
+				if (in.fail() || scan.num_columns == 0 || scan.num_rows == 0) {
+					LOG(ERROR) << "failed reading the grid size of the scan";
+					return false;
+				}
+
+				vec3 v3[4];
+				for (auto& v : v3) {
+					in.get_line();
+					in >> v;
+					if (in.fail()) {
+						LOG(ERROR) << "failed reading sensor transformation matrix";
+						return false;
+					}
+				}
+				scan.scanner_position = v3[0];
+				scan.sensor_transform = mat4(vec4(v3[1], 0), vec4(v3[2], 0), vec4(v3[3], 0), vec4(v3[0], 1));
+
+				vec4 v4[4];
+				for (auto& v : v4) {
+					in.get_line();
+					in >> v;
+					if (in.fail()) {
+						LOG(ERROR) << "failed reading point cloud transformation matrix";
+						return false;
+					}
+				}
+				scan.cloud_transform = mat4(v4[0], v4[1], v4[2], v4[3]);	// transposed in the file
+				return true;
+			}
+
+
+			// Skips the next 'num' lines of the file. If 'bbox' is not null, the points on these lines are parsed
+			// (without being stored) and the non-missing ones (transformed by 'transform') are added to the box.
+			bool skip_ptx_points(std::ifstream& input, std::size_t num, const mat4& transform, Box3* bbox) {
+				std::vector<char> buffer(1024 * 1024);
+				std::string carry;	// a line across two blocks (only needed for parsing)
+				std::streamoff pos = input.tellg();
+
+				auto parse = [&](const char* line) -> void {
+					char* end = nullptr;
+					vec3 p;
+					for (int i = 0; i < 3; ++i) {
+						p[i] = std::strtof(line, &end);
+						line = end;
+					}
+					if (p.x != 0.0f || p.y != 0.0f || p.z != 0.0f)
+						bbox->grow(transform * p);
+				};
+
+				while (num > 0) {
+					input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+					const std::size_t count = static_cast<std::size_t>(input.gcount());
+					if (count == 0)
+						break;
+					const char* p = buffer.data();
+					const char* end = p + count;
+					while (num > 0 && p < end) {
+						const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+						if (!nl) {
+							if (bbox)
+								carry.append(p, end);
+							p = end;
+							break;
+						}
+						if (bbox) {
+							if (carry.empty())
+								parse(p);
+							else {
+								carry.append(p, nl);
+								parse(carry.c_str());
+								carry.clear();
+							}
+						}
+						--num;
+						p = nl + 1;
+					}
+					pos += p - buffer.data();
+				}
+
+				// the last line of the file may not end with a line break
+				if (num == 1 && input.eof()) {
+					if (bbox && !carry.empty())
+						parse(carry.c_str());
+					num = 0;
+				}
+
+				input.clear();
+				input.seekg(pos);
+				return num == 0;
+			}
+
+
+			// a line holding a single non-negative integer (e.g., the first two lines of a header)
+			bool is_ptx_grid_size(const std::string& line) {
+				const std::size_t first = line.find_first_not_of(" \t\r");
+				if (first == std::string::npos)
+					return false;
+				const std::size_t last = line.find_last_not_of(" \t\r");
+				for (std::size_t i = first; i <= last; ++i) {
+					if (line[i] < '0' || line[i] > '9')
+						return false;
+				}
+				return true;
+			}
+
+
+			// Returns the position of the header of the next scan (or the size of the file if there is none) if all the
+			// 'num' point lines of a scan starting at 'offset' have the length of the first one ('line_length', with
+			// the line break), e.g., if the numbers were written with a fixed number of decimals. The position is then
+			// computed, and checked on a few lines spread over the scan and on the header following the points (after
+			// blank lines if any). Returns -1 if the lines have different lengths.
+			std::streamoff find_ptx_header_after_regular_lines(std::ifstream& input, std::streamoff offset, std::size_t num,
+															   std::streamoff line_length, std::streamoff file_size) {
+				if (num == 0 || line_length <= 0)
+					return -1;
+				const std::streamoff end = offset + static_cast<std::streamoff>(num) * line_length;
+				if (end > file_size + 1)	// the last line of the file may not end with a line break
+					return -1;
+
+				const std::size_t num_probes = 16;
+				std::string line;
+				for (std::size_t k = 1; k <= num_probes; ++k) {
+					const std::size_t i = (num - 1) * k / num_probes;	// the last line is always checked
+					input.clear();
+					input.seekg(offset + static_cast<std::streamoff>(i) * line_length - 1);
+					if (input.get() != '\n' || !std::getline(input, line) ||
+						static_cast<std::streamoff>(line.size()) + 1 != line_length)
+						return -1;
+				}
+				if (end >= file_size)
+					return file_size;
+
+				input.clear();
+				input.seekg(end);
+				while (true) {
+					const std::streamoff pos = input.tellg();
+					if (!std::getline(input, line))
+						return file_size;	// only blank lines follow
+					if (line.find_first_not_of(" \t\r") == std::string::npos)
+						continue;
+					if (is_ptx_grid_size(line) && std::getline(input, line) && is_ptx_grid_size(line))
+						return pos;
+					return -1;
+				}
+			}
+
+
+			// Finds the header of the next scan, which starts with two lines each holding a single integer (a point
+			// line has at least four numbers), searching from the line following position 'from'. The position of
+			// the header is returned, or -1 if the end of the file is reached first.
+			std::streamoff find_ptx_header(std::ifstream& input, std::streamoff from) {
+				input.clear();
+				input.seekg(from);
+				std::string line;
+				std::getline(input, line);	// the rest of the line containing 'from'
+				std::streamoff candidate = -1;
+				while (true) {
+					const std::streamoff pos = input.tellg();
+					if (!std::getline(input, line))
+						break;
+					if (!is_ptx_grid_size(line))
+						candidate = -1;
+					else if (candidate < 0)
+						candidate = pos;
+					else
+						return candidate;
+				}
+				input.clear();
+				return -1;
+			}
+
+		}
+
+
+		bool PointCloudIO_ptx::read_scans(bool compute_bounding_boxes) {
+			scans_.clear();
+
+			std::ifstream input(file_name_.c_str(), std::ios::binary);
+			if (input.fail()) {
+				LOG(ERROR) << "could not open file: " << file_name_;
+				return false;
+			}
+			input.seekg(0, std::ios::end);
+			const std::streamoff file_size = input.tellg();
+			input.seekg(0, std::ios::beg);
+
+			while (true) {
+				Scan scan;
+				{
+					LineInputStream in(input);
+					if (!details::read_ptx_header(in, scan))
+						break;
+				}
+				scan.offset = input.tellg();
+
+				// the first point tells if the scan has colors
+				std::string line;
+				std::getline(input, line);
+				const std::streamoff line_length = input.tellg() - scan.offset;	// negative at the end of the file
+				std::istringstream first(line);
+				float x, y, z, intensity, r, g, b;
+				first >> x >> y >> z >> intensity;
+				if (first.fail()) {
+					LOG(ERROR) << "failed reading the first point of scan #" << scans_.size();
+					break;
+				}
+				first >> r >> g >> b;
+				scan.has_colors = !first.fail();
+
+				const std::size_t num = static_cast<std::size_t>(scan.num_columns) * scan.num_rows;
+				if (compute_bounding_boxes) {
+					input.clear();
+					input.seekg(scan.offset);
+					if (!details::skip_ptx_points(input, num, scan.cloud_transform, &scan.bbox)) {
+						LOG(ERROR) << "scan #" << scans_.size() << " is incomplete (" << num << " points expected)";
+						break;
+					}
+					scans_.push_back(scan);
+					continue;
+				}
+
+				// If all the point lines have the same length, the next header is right after the points. Otherwise,
+				// the point count only gives a lower bound of the size of the scan: each line has at least four (or
+				// seven) single-character numbers separated by spaces. The points within this bound are skipped, and
+				// the next header is searched from there.
+				std::streamoff next = details::find_ptx_header_after_regular_lines(input, scan.offset, num, line_length,
+																				   file_size);
+				if (next < 0) {
+					const std::streamoff min_line_length = scan.has_colors ? 14 : 8;
+					const std::streamoff min_end = scan.offset + static_cast<std::streamoff>(num) * min_line_length;
+					if (min_end > file_size + 1) {
+						LOG(ERROR) << "scan #" << scans_.size() << " is incomplete (" << num << " points expected)";
+						break;
+					}
+					next = details::find_ptx_header(input, std::min(min_end, file_size) - 1);
+				}
+				scans_.push_back(scan);
+				if (next < 0 || next >= file_size)
+					break;
+				input.clear();
+				input.seekg(next);
+			}
+
+			LOG(INFO) << scans_.size() << " scans found in file " << file_system::simple_name(file_name_);
+			return !scans_.empty();
+		}
+
+
+		PointCloud* PointCloudIO_ptx::load_scan(std::size_t index) {
+			if (index >= scans_.size()) {
+				LOG(ERROR) << "scan #" << index << " does not exist (" << scans_.size() << " scans in total)";
+				return nullptr;
+			}
+			Scan& scan = scans_[index];
+
+			std::ifstream input(file_name_.c_str(), std::ios::binary);
+			if (input.fail()) {
+				LOG(ERROR) << "could not open file: " << file_name_;
+				return nullptr;
+			}
+			input.seekg(scan.offset);
+
+			PointCloud* cloud = new PointCloud;
+			cloud->set_name(file_system::name_less_extension(file_name_) + "-#" + std::to_string(index));
+			cloud->add_model_property<ivec2>("grid_size", ivec2(0, 0))[0] = ivec2(static_cast<int>(scan.num_rows), static_cast<int>(scan.num_columns));
+			cloud->add_model_property<mat4>("sensor_transform", mat4::identity())[0] = scan.sensor_transform;
+			auto grid = cloud->add_vertex_property<ivec2>("v:grid");
+			auto intensities = cloud->add_vertex_property<float>("v:intensity");
+			PointCloud::VertexProperty<vec3> colors;
+			if (scan.has_colors)
+				colors = cloud->add_vertex_property<vec3>("v:color");
+
+			const unsigned int num = scan.num_columns * scan.num_rows;
+			Box3 bbox;
+			LineInputStream in(input);
+			ProgressLogger progress(num, true, false);
+			for (unsigned int i = 0; i < num; ++i) {
+				if (progress.is_canceled()) {
+					LOG(WARNING) << "loading point cloud file cancelled";
+					delete cloud;
+					return nullptr;
+				}
+				progress.notify(i);
+
+				vec3 p, c;
+				float intensity = 0.0f;
+				in.get_line();
+				in >> p >> intensity;
+				if (scan.has_colors)
+					in >> c;
+				if (in.fail()) {
+					LOG(ERROR) << "failed reading the " << i << "_th point of scan #" << index;
+					delete cloud;
+					return nullptr;
+				}
+
+				if (p.x == 0.0f && p.y == 0.0f && p.z == 0.0f) // missing point
+					continue;
+
+				auto v = cloud->add_vertex(scan.cloud_transform * p);
+				grid[v] = ivec2(static_cast<int>(i % scan.num_rows), static_cast<int>(i / scan.num_rows)); // column by column
+				intensities[v] = intensity;
+				if (colors)
+					colors[v] = c / 255.0f;
+				bbox.grow(cloud->position(v));
+			}
+
+			scan.bbox = bbox;
+			return cloud;
+		}
+
 	} // namespace io
 
 } // namespace easy3d
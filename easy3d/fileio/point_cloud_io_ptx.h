@@ -28,6 +28,10 @@
 #define EASY3D_FILEIO_POINT_CLOUD_IO_PTX_H
 
 #include <string>
+#include <vector>
+#include <iosfwd>
+
+#include <easy3d/core/types.h>
 
 namespace easy3d {
 
@@ -120,6 +124,20 @@ namespace easy3d {
 		 *			addModel(model);
 		 *		}
 		 *		\endcode
+		 *
+		 *  Scans can also be loaded lazily (and in any order). The headers of all scans are read first (the points
+		 *  are skipped without being parsed), and then only the requested scans are loaded. Such a scan keeps its grid
+		 *  structure: missing points are excluded, and the row and column of each point are stored in the vertex
+		 *  property "v:grid".
+		 *      \code
+		 *		PointCloudIO_ptx serializer(file_name);
+		 *		if (serializer.read_scans()) {
+		 *			for (std::size_t i = 0; i < serializer.num_scans(); ++i) {
+		 *				if (is_visible(serializer.scan(i).scanner_position))
+		 *					addModel(serializer.load_scan(i));
+		 *			}
+		 *		}
+		 *		\endcode
 		 */
 
 		class PointCloudIO_ptx
@@ -131,12 +149,47 @@ namespace easy3d {
 			/// \brief Reads a single point cloud from the file.
 			PointCloud* load_next();
 
+			/// \brief The header information of a scan.
+			struct Scan {
+				unsigned int num_columns;
+				unsigned int num_rows;
+				vec3 scanner_position;	///< the registered position of the scanner
+				mat4 sensor_transform;	///< the registered axes and position of the scanner
+				mat4 cloud_transform;	///< applied to the points to get the registered coordinates
+				bool has_colors;
+				/// The bounding box of the (non-missing) registered points. It is valid only if it was computed
+				/// by read_scans() or after the scan has been loaded by load_scan().
+				Box3 bbox;
+				std::streamoff offset;	///< the position of the first point in the file
+			};
+
+			/// \brief Reads the headers of all the scans in the file. The point lines are skipped without being
+			///		read: the grid size of a scan gives a lower bound of its size in the file, past which the next
+			///		header is searched. If \p compute_bounding_boxes is true, the points are parsed (but not stored)
+			///		to compute the bounding box of each scan.
+			/// \return false if the file could not be read or has no valid scans.
+			bool read_scans(bool compute_bounding_boxes = false);
+
+			/// \brief The number of scans (available after read_scans()).
+			std::size_t num_scans() const { return scans_.size(); }
+			/// \brief The header information of the \p index-th scan (available after read_scans()).
+			const Scan& scan(std::size_t index) const { return scans_[index]; }
+
+			/// \brief Reads the \p index-th scan, keeping its grid structure. Missing points (i.e., with coordinates
+			///		"0 0 0") are excluded. The point cloud has the vertex properties "v:grid" (ivec2, the row and
+			///		column of each point), "v:intensity", and "v:color" (if available), and the model properties
+			///		"grid_size" (ivec2, the number of rows and columns) and "sensor_transform" (mat4).
+			/// \pre read_scans() has been called.
+			PointCloud* load_scan(std::size_t index);
+
 		private:
 			std::ifstream*		input_;
 			LineInputStream*	in_;
 
 			std::string			file_name_;
 			int					cloud_index_;
+
+			std::vector<Scan>	scans_;
 		};
 
 	} // namespace io
@@ -25,8 +25,13 @@
  ********************************************************************/
 
 #include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/point_cloud_io_details.h>
 
 #include <fstream>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
 
 #include <easy3d/fileio/translator.h>
 #include <easy3d/core/point_cloud.h>
@@ -40,6 +45,86 @@ namespace easy3d {
     // \cond
 	namespace io {
 
+        namespace details {
+
+            // Writes a number to \p out using (at most) \p digits significant digits and returns the number of
+            // characters written. Numbers with moderate magnitudes are converted using a scaled integer, which is
+            // much faster than the stream operator or printf; the other ones are handed over to snprintf.
+            // The buffer must be able to hold at least 32 characters.
+            int format_number(double value, int digits, char *out) {
+                static const double pow10[] = {
+                        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                };
+
+                if (value == 0.0) {
+                    out[0] = '0';
+                    return 1;
+                }
+
+                const double a = std::fabs(value);
+                if (!(a >= 1e-5 && a < 1e15) || digits > 15)
+                    return std::snprintf(out, 32, "%.*g", digits, value);
+
+                // the exponent of the leading digit. log10() may be off by one, which is corrected below.
+                int exp = static_cast<int>(std::floor(std::log10(a)));
+                unsigned long long mantissa = 0;
+                for (int attempt = 0; attempt < 2; ++attempt) {
+                    const int shift = digits - 1 - exp;   // in [-14, 20)
+                    if (shift < 0)
+                        mantissa = static_cast<unsigned long long>(a / pow10[-shift] + 0.5);
+                    else if (exp < 0)
+                        mantissa = static_cast<unsigned long long>(a * pow10[shift] + 0.5);
+                    else {  // the integer and fractional parts are scaled separately to not lose precision
+                        const double integer = std::floor(a);
+                        mantissa = static_cast<unsigned long long>(integer) *
+                                   static_cast<unsigned long long>(pow10[shift]) +
+                                   static_cast<unsigned long long>((a - integer) * pow10[shift] + 0.5);
+                    }
+                    if (mantissa >= static_cast<unsigned long long>(pow10[digits]))
+                        ++exp;
+                    else if (mantissa < static_cast<unsigned long long>(pow10[digits - 1]))
+                        --exp;
+                    else
+                        break;
+                }
+                if (mantissa >= static_cast<unsigned long long>(pow10[digits])) // rounded up to the next power of 10
+                    mantissa /= 10;
+
+                char digit_str[20];
+                for (int i = digits - 1; i >= 0; --i) {
+                    digit_str[i] = static_cast<char>('0' + mantissa % 10);
+                    mantissa /= 10;
+                }
+                int num_digits = digits;    // the significant digits without the trailing zeros
+                while (num_digits > 1 && digit_str[num_digits - 1] == '0')
+                    --num_digits;
+
+                char *p = out;
+                if (value < 0)
+                    *p++ = '-';
+                if (exp >= 0) {
+                    for (int i = 0; i <= exp; ++i)
+                        *p++ = i < num_digits ? digit_str[i] : '0';
+                    if (num_digits > exp + 1) {
+                        *p++ = '.';
+                        for (int i = exp + 1; i < num_digits; ++i)
+                            *p++ = digit_str[i];
+                    }
+                } else {
+                    *p++ = '0';
+                    *p++ = '.';
+                    for (int i = 0; i < -exp - 1; ++i)
+                        *p++ = '0';
+                    std::memcpy(p, digit_str, num_digits);
+                    p += num_digits;
+                }
+                return static_cast<int>(p - out);
+            }
+
+        } // namespace details
+
+
 		bool load_xyz(const std::string& file_name, PointCloud* cloud) {
 			std::ifstream input(file_name.c_str());
 			if (input.fail()) {
@@ -102,40 +187,61 @@ namespace easy3d {
 		}
 
 
-		bool save_xyz(const std::string& file_name, const PointCloud* cloud) {
-			std::ofstream output(file_name.c_str());
+		bool save_xyz(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices) {
+			std::ofstream output(file_name.c_str(), std::fstream::binary);
 			if (output.fail()) {
                 LOG(ERROR) << "could not open file: " << file_name;
 				return false;
 			}
-			output.precision(16);
+
+            std::vector<int> live;
+            vertices = details::select_vertices(cloud, vertices, live);
 
 			auto points = cloud->get_vertex_property<vec3>("v:point");
             auto trans = cloud->get_model_property<dvec3>("translation");
-
-            ProgressLogger progress(cloud->n_vertices(), true, false);
-            if (trans) { // has translation
-                const dvec3 &origin = trans[0];
-                for (auto v: cloud->vertices()) {
-                    if (progress.is_canceled()) {
-                        LOG(WARNING) << "saving point cloud file cancelled";
-                        return false;
-                    }
-                    output << points[v].x + origin.x << " "
-                           << points[v].y + origin.y << " "
-                           << points[v].z + origin.z << std::endl;
-                    progress.next();
+            const dvec3 origin = trans ? trans[0] : dvec3(0, 0, 0);
+            // 9 significant digits are sufficient to restore a float exactly. With a translation, the coordinates
+            // are doubles and more digits are needed.
+            const int digits = trans ? 15 : 9;
+
+            // The points are split into chunks that are formatted in parallel into separate buffers, which are then
+            // appended to the file in order. The number of chunks formatted at a time is bounded, so is the memory.
+            const std::size_t num = vertices ? vertices->size() : cloud->n_vertices();
+            const std::size_t chunk_size = 1 << 16;   // points per chunk
+            const int chunks_per_batch = 16;
+            std::vector<std::vector<char> > buffers(chunks_per_batch);
+
+            ProgressLogger progress(num, true, false);
+            const std::size_t num_chunks = (num + chunk_size - 1) / chunk_size;
+            for (std::size_t batch = 0; batch < num_chunks; batch += chunks_per_batch) {
+                if (progress.is_canceled()) {
+                    LOG(WARNING) << "saving point cloud file cancelled";
+                    return false;
                 }
-            }
-            else {
-                for (auto v: cloud->vertices()) {
-                    if (progress.is_canceled()) {
-                        LOG(WARNING) << "saving point cloud file cancelled";
-                        return false;
+                const int count = static_cast<int>(std::min<std::size_t>(chunks_per_batch, num_chunks - batch));
+#pragma omp parallel for schedule(dynamic)
+                for (int c = 0; c < count; ++c) {
+                    const std::size_t first = (batch + c) * chunk_size;
+                    const std::size_t last = std::min(first + chunk_size, num);
+                    auto &buffer = buffers[c];
+                    buffer.resize((last - first) * 3 * 32);
+                    char *out = buffer.data();
+                    for (std::size_t i = first; i < last; ++i) {
+                        const vec3 &p = points.vector()[vertices ? (*vertices)[i] : i];
+                        for (int k = 0; k < 3; ++k) {
+                            out += details::format_number(trans ? p[k] + origin[k] : p[k], digits, out);
+                            *out++ = (k < 2 ? ' ' : '\n');
+                        }
                     }
-                    output << points[v] << std::endl;
-                    progress.next();
+                    buffer.resize(out - buffer.data());
+                }
+                for (int c = 0; c < count; ++c)
+                    output.write(buffers[c].data(), buffers[c].size());
+                if (output.fail()) {
+                    LOG(ERROR) << "failed writing file: " << file_name;
+                    return false;
                 }
+                progress.notify(std::min((batch + count) * chunk_size, num));
             }
 
 			return true;
@@ -211,7 +317,7 @@ namespace easy3d {
 		}
 
 
-		bool save_bxyz(const std::string& file_name, const PointCloud* cloud) {
+		bool save_bxyz(const std::string& file_name, const PointCloud* cloud, const std::vector<int>* vertices) {
 			// open file
 			std::ofstream output(file_name.c_str(), std::fstream::binary);
 			if (output.fail()) {
@@ -225,21 +331,16 @@ namespace easy3d {
 				return false;
 			}
 
-			auto points = cloud->get_vertex_property<vec3>("v:point");
+            std::vector<int> live;
+            vertices = details::select_vertices(cloud, vertices, live);
 
             auto trans = cloud->get_model_property<dvec3>("translation");
-            if (trans) { // has translation
-                const dvec3& origin = trans[0];
-                for (auto v : cloud->vertices()) {
-                    const vec3& p = points[v];
-                    for (unsigned short i=0; i<3; ++i) {
-                        float value = static_cast<float>(p[i] + origin[i]);
-                        output.write((char *)&value, sizeof(float));
-                    }
-                }
+            const dvec3 origin = trans ? trans[0] : dvec3(0, 0, 0);
+            auto points = cloud->get_vertex_property<vec3>("v:point");
+            if (!details::write_values(output, points.vector(), vertices, trans ? &origin : nullptr)) {
+                LOG(ERROR) << "failed writing file: " << file_name;
+                return false;
             }
-            else
-                output.write((char*)points.data(), cloud->n_vertices() * sizeof(vec3));
 			return true;
 		}
 
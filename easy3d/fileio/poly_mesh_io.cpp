@@ -53,6 +53,8 @@ namespace easy3d {
             success = io::load_pm(file_name, mesh);
         else if (ext == "mesh")
             success = io::load_mesh(file_name, mesh);
+        else if (ext == "e3d")
+            success = io::load_e3d(file_name, mesh);
         else if (ext.empty()){
             LOG(ERROR) << "unknown file format: no extension" << ext;
             success = false;
@@ -111,6 +113,8 @@ namespace easy3d {
             success = io::save_pm(final_name, mesh);
         else if (ext == "mesh")
             success = io::save_mesh(file_name, mesh);
+        else if (ext == "e3d")
+            success = io::save_e3d(final_name, mesh);
         else {
             LOG(ERROR) << "unknown file format: " << ext;
             success = false;
@@ -29,6 +29,7 @@
 
 
 #include <string>
+#include <vector>
 
 
 namespace easy3d {
@@ -46,7 +47,7 @@ namespace easy3d {
 
         /**
          * \brief Reads a polyhedral mesh from a file.
-         * \details File extension determines file format (now only '*.plm' format is supported).
+         * \details File extension determines file format (plm, pm, mesh, e3d).
          * \param file_name The file name.
          * \return The pointer of the polyhedral mesh (nullptr if failed).
          */
@@ -54,7 +55,7 @@ namespace easy3d {
 
         /**
          * \brief Saves a polyhedral mesh to a file.
-         * \details File extension determines file format (now only '*.plm' format is supported).
+         * \details File extension determines file format (plm, pm, mesh, e3d).
          * \param file_name The file name.
          * \param mesh The Polytope mesh.
          * \return The status of the operation
@@ -82,6 +83,14 @@ namespace easy3d {
         /// Saves a polyhedral mesh to a \p MESH format file. This ASCII format is supported by Tetgen and Medit.
         bool save_mesh(const std::string& file_name, const PolyMesh* mesh);
 
+        /// Reads a polyhedral mesh from an \p E3D format file, the chunked columnar native format of Easy3D.
+        bool load_e3d(const std::string& file_name, PolyMesh* mesh);
+        /// Reads the connectivity, the vertex coordinates, and only the listed \p properties of a polyhedral mesh
+        /// from an \p E3D format file. Chunks of other properties are not even read from disk.
+        bool load_e3d(const std::string& file_name, PolyMesh* mesh, const std::vector<std::string>& properties);
+        /// Saves a polyhedral mesh to an \p E3D format file, the chunked columnar native format of Easy3D.
+        bool save_e3d(const std::string& file_name, const PolyMesh* mesh);
+
     } // namespace io
 
 } // namespace easy3d
@@ -0,0 +1,219 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/poly_mesh_io.h>
+#include <easy3d/fileio/chunked_file.h>
+#include <easy3d/core/poly_mesh.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        namespace details {
+
+            // Access to the properties of an element of a polyhedral mesh (see write_properties() and read_properties())
+            template<typename Mesh>
+            struct PolyMeshVertices {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->vertex_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_vertex_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_vertex_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template vertex_property<T>(name).vector();
+                }
+            };
+
+            template<typename Mesh>
+            struct PolyMeshEdges {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->edge_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_edge_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_edge_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template edge_property<T>(name).vector();
+                }
+            };
+
+            template<typename Mesh>
+            struct PolyMeshHalfFaces {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->halfface_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_halfface_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_halfface_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template halfface_property<T>(name).vector();
+                }
+            };
+
+            template<typename Mesh>
+            struct PolyMeshFaces {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->face_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_face_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_face_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template face_property<T>(name).vector();
+                }
+            };
+
+            template<typename Mesh>
+            struct PolyMeshCells {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->cell_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_cell_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_cell_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template cell_property<T>(name).vector();
+                }
+            };
+
+
+            bool load_e3d(const std::string &file_name, PolyMesh *mesh, const std::vector<std::string> *selected) {
+                if (!mesh) {
+                    LOG(ERROR) << "null mesh pointer";
+                    return false;
+                }
+
+                ChunkedFileReader reader(file_name);
+                if (!reader.is_ok())
+                    return false;
+                if (reader.model_type() != "PolyMesh") {
+                    LOG(ERROR) << "file stores a " << reader.model_type() << " (a PolyMesh is expected): " << file_name;
+                    return false;
+                }
+
+                mesh->clear();
+                mesh->resize(reader.size("vertex"), reader.size("edge"), reader.size("face"), reader.size("cell"));
+
+                // the connectivity (always loaded)
+                auto &vconn = mesh->vertex_property<PolyMesh::VertexConnectivity>("v:connectivity").vector();
+                auto &econn = mesh->edge_property<PolyMesh::EdgeConnectivity>("e:connectivity").vector();
+                auto &hconn = mesh->halfface_property<PolyMesh::HalfFaceConnectivity>("h:connectivity").vector();
+                auto &cconn = mesh->cell_property<PolyMesh::CellConnectivity>("c:connectivity").vector();
+                if (!reader.read_serialized_column("vertex/v:connectivity", "PolyMesh::VertexConnectivity", vconn) ||
+                    !reader.read_serialized_column("edge/e:connectivity", "PolyMesh::EdgeConnectivity", econn) ||
+                    !reader.read_serialized_column("halfface/h:connectivity", "PolyMesh::HalfFaceConnectivity", hconn) ||
+                    !reader.read_serialized_column("cell/c:connectivity", "PolyMesh::CellConnectivity", cconn) ||
+                    vconn.size() != mesh->n_vertices() || econn.size() != mesh->n_edges() ||
+                    hconn.size() != mesh->n_halffaces() || cconn.size() != mesh->n_cells()) {
+                    mesh->clear();
+                    return false;
+                }
+
+                // the other properties (the vertex coordinates are always loaded)
+                std::vector<std::string> vertex_selected;
+                if (selected) {
+                    vertex_selected = *selected;
+                    vertex_selected.push_back("v:point");
+                }
+                const std::vector<std::string> skip = {"v:connectivity", "e:connectivity", "h:connectivity",
+                                                       "c:connectivity"};
+                PolyMeshVertices<PolyMesh> vertices{mesh};
+                PolyMeshEdges<PolyMesh> edges{mesh};
+                PolyMeshHalfFaces<PolyMesh> halffaces{mesh};
+                PolyMeshFaces<PolyMesh> faces{mesh};
+                PolyMeshCells<PolyMesh> cells{mesh};
+                if (!read_properties(reader, "vertex", vertices, skip, selected ? &vertex_selected : nullptr) ||
+                    !read_properties(reader, "edge", edges, skip, selected) ||
+                    !read_properties(reader, "halfface", halffaces, skip, selected) ||
+                    !read_properties(reader, "face", faces, skip, selected) ||
+                    !read_properties(reader, "cell", cells, skip, selected)) {
+                    mesh->clear();
+                    return false;
+                }
+
+                // the vertex coordinates are stored relative to the translation (if any)
+                auto &points = mesh->vertex_property<vec3>("v:point").vector();
+                if (!read_translation(reader, mesh, points)) {
+                    mesh->clear();
+                    return false;
+                }
+
+                return (mesh->n_vertices() > 0 && mesh->n_faces() > 0 && mesh->n_cells() > 0);
+            }
+
+        } // namespace details
+
+
+        bool load_e3d(const std::string &file_name, PolyMesh *mesh) {
+            return details::load_e3d(file_name, mesh, nullptr);
+        }
+
+
+        bool load_e3d(const std::string &file_name, PolyMesh *mesh, const std::vector<std::string> &properties) {
+            return details::load_e3d(file_name, mesh, &properties);
+        }
+
+
+        bool save_e3d(const std::string &file_name, const PolyMesh *mesh) {
+            if (!mesh) {
+                LOG(ERROR) << "null mesh pointer";
+                return false;
+            }
+
+            ChunkedFileWriter writer(file_name, "PolyMesh");
+            writer.set_size("vertex", mesh->n_vertices());
+            writer.set_size("edge", mesh->n_edges());
+            writer.set_size("halfface", mesh->n_halffaces());
+            writer.set_size("face", mesh->n_faces());
+            writer.set_size("cell", mesh->n_cells());
+
+            // the connectivity is of variable size
+            writer.write_serialized_column("vertex/v:connectivity", "PolyMesh::VertexConnectivity",
+                                           mesh->get_vertex_property<PolyMesh::VertexConnectivity>("v:connectivity").vector());
+            writer.write_serialized_column("edge/e:connectivity", "PolyMesh::EdgeConnectivity",
+                                           mesh->get_edge_property<PolyMesh::EdgeConnectivity>("e:connectivity").vector());
+            writer.write_serialized_column("halfface/h:connectivity", "PolyMesh::HalfFaceConnectivity",
+                                           mesh->get_halfface_property<PolyMesh::HalfFaceConnectivity>("h:connectivity").vector());
+            writer.write_serialized_column("cell/c:connectivity", "PolyMesh::CellConnectivity",
+                                           mesh->get_cell_property<PolyMesh::CellConnectivity>("c:connectivity").vector());
+
+            const std::vector<std::string> skip = {"v:connectivity", "e:connectivity", "h:connectivity",
+                                                   "c:connectivity"};
+            details::write_properties(writer, "vertex", details::PolyMeshVertices<const PolyMesh>{mesh}, skip);
+            details::write_properties(writer, "edge", details::PolyMeshEdges<const PolyMesh>{mesh}, skip);
+            details::write_properties(writer, "halfface", details::PolyMeshHalfFaces<const PolyMesh>{mesh}, skip);
+            details::write_properties(writer, "face", details::PolyMeshFaces<const PolyMesh>{mesh}, skip);
+            details::write_properties(writer, "cell", details::PolyMeshCells<const PolyMesh>{mesh}, skip);
+
+            details::write_translation(writer, mesh);
+            return writer.finish();
+        }
+
+    }
+
+}
@@ -0,0 +1,188 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/scene_loader.h>
+
+#include <algorithm>
+
+#include <easy3d/core/point_cloud.h>
+#include <easy3d/core/surface_mesh.h>
+#include <easy3d/core/graph.h>
+#include <easy3d/core/poly_mesh.h>
+#include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/graph_io.h>
+#include <easy3d/fileio/surface_mesh_io.h>
+#include <easy3d/fileio/poly_mesh_io.h>
+#include <easy3d/fileio/ply_reader_writer.h>
+#include <easy3d/fileio/chunked_file.h>
+#include <easy3d/fileio/point_cloud_io_ptx.h>
+#include <easy3d/fileio/translator.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+
+    SceneLoader::SceneLoader(unsigned int num_threads)
+            : num_threads_(num_threads)
+            , num_parsing_(0)
+            , stop_(false)
+    {
+        if (num_threads_ == 0)
+            num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+
+    SceneLoader::~SceneLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            if (!files_.empty())
+                LOG(WARNING) << files_.size() << " files not loaded (loading cancelled)";
+            files_.clear();
+        }
+        condition_.notify_all();
+        for (auto& t : threads_)
+            t.join();
+
+        for (auto model : models_)
+            delete model;
+    }
+
+
+    std::vector<Model*> SceneLoader::load(const std::string& file_name) {
+        std::vector<Model*> models;
+
+        const std::string& ext = file_system::extension(file_name, true);
+        bool is_ply_mesh = false;
+        if (ext == "ply")
+            is_ply_mesh = (io::PlyReader::num_instances(file_name, "face") > 0);
+        std::string e3d_type;   // the *.e3d format can store any type of models
+        if (ext == "e3d")
+            e3d_type = io::ChunkedFileReader(file_name).model_type();
+
+        Model* model = nullptr;
+        if ((ext == "ply" && is_ply_mesh) || ext == "obj" || ext == "off" || ext == "stl" || ext == "sm" || ext == "geojson" || ext == "trilist" || e3d_type == "SurfaceMesh") { // mesh
+            model = SurfaceMeshIO::load(file_name);
+        } else if ((ext == "ply" && io::PlyReader::num_instances(file_name, "edge") > 0) || e3d_type == "Graph") {
+            model = GraphIO::load(file_name);
+        } else if (ext == "plm" || ext == "pm" || ext == "mesh" || e3d_type == "PolyMesh") {
+            model = PolyMeshIO::load(file_name);
+        }
+        else { // point cloud
+            if (ext == "ptx") {
+                io::PointCloudIO_ptx serializer(file_name);
+                PointCloud* cloud = nullptr;
+                while ((cloud = serializer.load_next()))
+                    models.push_back(cloud);
+                return models;
+            } else
+                model = PointCloudIO::load(file_name);
+        }
+
+        if (model) {
+            model->set_name(file_name);
+            models.push_back(model);
+        }
+        return models;
+    }
+
+
+    void SceneLoader::add(const std::vector<std::string>& file_names) {
+        if (file_names.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            files_.insert(files_.end(), file_names.begin(), file_names.end());
+        }
+        condition_.notify_all();
+
+        // the workers are created on demand
+        while (threads_.size() < num_threads_)
+            threads_.emplace_back(&SceneLoader::worker, this);
+    }
+
+
+    std::vector<Model*> SceneLoader::take(std::size_t max_num_points) {
+        std::vector<Model*> result;
+        std::size_t num_points = 0;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        while (!models_.empty()) {
+            Model* model = models_.front();
+            num_points += model->points().size();
+            if (!result.empty() && num_points > max_num_points)
+                break;
+            result.push_back(model);
+            models_.pop_front();
+        }
+        return result;
+    }
+
+
+    bool SceneLoader::is_idle() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return files_.empty() && num_parsing_ == 0 && models_.empty();
+    }
+
+
+    void SceneLoader::worker() {
+        while (true) {
+            // When translation is enabled, the files must be parsed in the order they were added. Acquiring the
+            // order lock before taking a file guarantees this.
+            std::unique_lock<std::mutex> order_lock(order_mutex_, std::defer_lock);
+            if (Translator::instance()->status() != Translator::DISABLED)
+                order_lock.lock();
+
+            std::string file_name;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this]() { return stop_ || !files_.empty(); });
+                if (stop_)
+                    return;
+                file_name = files_.front();
+                files_.pop_front();
+                ++num_parsing_;
+            }
+
+            const std::vector<Model*>& models = load(file_name);
+            if (models.empty())
+                LOG(WARNING) << "failed loading file: " << file_name;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                models_.insert(models_.end(), models.begin(), models.end());
+                --num_parsing_;
+            }
+
+            if (callback_)
+                callback_();
+        }
+    }
+
+} // namespace easy3d
@@ -0,0 +1,122 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_FILEIO_SCENE_LOADER_H
+#define EASY3D_FILEIO_SCENE_LOADER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+namespace easy3d {
+
+    class Model;
+
+    /**
+     * \brief Loads models from files in the background using a pool of worker threads.
+     * \class SceneLoader easy3d/fileio/scene_loader.h
+     * \details Parsing files and building the models do not involve OpenGL, so the files are parsed concurrently
+     *      by the worker threads. The loaded models are collected in a queue, from which the rendering thread takes
+     *      them (e.g., a limited number of points per frame) to create the drawables and upload the data to the GPU.
+     *      This way, a scene consisting of hundreds of files can be loaded while the UI keeps responding.
+     *      If translation in file IO is enabled (see Translator), the files are still parsed in the background but
+     *      one after another, because the translation applied to a model depends on the previously loaded ones.
+     *
+     *      Example usage:
+     *      \code
+     *          SceneLoader loader;
+     *          loader.set_callback(func);   // e.g., a function waking up the rendering thread
+     *          loader.add(file_names);
+     *          ...
+     *          // in the rendering thread, e.g., before drawing each frame
+     *          for (auto model : loader.take(4000000))
+     *              viewer->add_model(model);
+     *      \endcode
+     */
+    class SceneLoader {
+    public:
+        /// \param num_threads The number of worker threads. Use 0 for the number of hardware threads.
+        explicit SceneLoader(unsigned int num_threads = 0);
+        /// Discards the files not parsed yet, waits for the files being parsed, and deletes the models not taken.
+        ~SceneLoader();
+
+        /**
+         * \brief Loads the models stored in a file (in the calling thread).
+         * \details The type of the models (i.e., SurfaceMesh, PointCloud, Graph, or PolyMesh) is determined by the
+         *      file extension and, for PLY and E3D files, by the content of the file. A PTX file may contain multiple
+         *      point clouds. The name of each model is set to the file name (or the name of the scan for PTX files).
+         * \return The loaded models (empty if failed).
+         */
+        static std::vector<Model*> load(const std::string& file_name);
+
+        /// Queues files to be loaded in the background. The function returns immediately.
+        void add(const std::vector<std::string>& file_names);
+
+        /**
+         * \brief Sets a function to be called each time a file has been parsed, e.g., to wake up the rendering thread.
+         * \attention The function is called from the worker threads. It must be set before adding files.
+         */
+        void set_callback(const std::function<void()>& func) { callback_ = func; }
+
+        /**
+         * \brief Takes (in the order they have been loaded) the models that are ready.
+         * \details To limit the time spent on creating drawables and uploading data per frame, the models are taken
+         *      until their total number of points exceeds \p max_num_points. At least one model is taken if any.
+         *      The caller is in charge of the memory management of the taken models.
+         */
+        std::vector<Model*> take(std::size_t max_num_points);
+
+        /// Returns \c true if there are no files to be parsed and no loaded models to be taken.
+        bool is_idle() const;
+
+    private:
+        void worker();
+
+    private:
+        unsigned int num_threads_;
+        std::vector<std::thread> threads_;
+
+        std::deque<std::string> files_;  // files to be parsed
+        std::deque<Model*> models_;      // the loaded models (not taken yet)
+        std::size_t num_parsing_;        // number of files being parsed
+        bool stop_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable condition_;
+        std::mutex order_mutex_;         // serializes parsing when translation is enabled
+
+        std::function<void()> callback_;
+    };
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_FILEIO_SCENE_LOADER_H
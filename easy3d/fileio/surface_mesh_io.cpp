@@ -51,6 +51,8 @@ namespace easy3d {
             success = io::load_ply(file_name, mesh);
         else if (ext == "sm")
             success = io::load_sm(file_name, mesh);
+        else if (ext == "e3d")
+            success = io::load_e3d(file_name, mesh);
         else if (ext == "obj")
             success = io::load_obj(file_name, mesh);
         else if (ext == "off")
@@ -108,6 +110,8 @@ namespace easy3d {
             success = io::save_ply(final_name, mesh, true);
         } else if (ext == "sm")
             success = io::save_sm(final_name, mesh);
+        else if (ext == "e3d")
+            success = io::save_e3d(final_name, mesh);
         else if (ext == "obj")
             success = io::save_obj(final_name, mesh);
         else if (ext == "off")
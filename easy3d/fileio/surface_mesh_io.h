@@ -29,6 +29,7 @@
 
 
 #include <string>
+#include <vector>
 
 
 namespace easy3d {
@@ -46,7 +47,7 @@ namespace easy3d {
 
         /**
          * \brief Reads a surface mesh from a file.
-         * \details File extension determines file format (ply, obj, off, stl, poly) and type (i.e. binary or ASCII).
+         * \details File extension determines file format (ply, obj, off, stl, poly, e3d) and type (i.e. binary or ASCII).
          * \param file_name The file name.
          * \return The pointer of the surface mesh (nullptr if failed).
          */
@@ -54,7 +55,7 @@ namespace easy3d {
 
         /**
          * \brief Saves a surface mesh to a file.
-         * \details File extension determines file format (ply, obj, off, stl, poly) and type (i.e. binary or ASCII).
+         * \details File extension determines file format (ply, obj, off, stl, poly, e3d) and type (i.e. binary or ASCII).
          * \param file_name The file name.
          * \param mesh The surface mesh.
          * \return The status of the operation
@@ -71,6 +72,14 @@ namespace easy3d {
         /// Saves a surface mesh to a \p SM format file.
         bool save_sm(const std::string& file_name, const SurfaceMesh* mesh);
 
+        /// Reads a surface mesh from an \p E3D format file, the chunked columnar native format of Easy3D.
+        bool load_e3d(const std::string& file_name, SurfaceMesh* mesh);
+        /// Reads the connectivity, the vertex coordinates, and only the listed \p properties (e.g., "v:normal")
+        /// of a surface mesh from an \p E3D format file. Chunks of other properties are not even read from disk.
+        bool load_e3d(const std::string& file_name, SurfaceMesh* mesh, const std::vector<std::string>& properties);
+        /// Saves a surface mesh to an \p E3D format file, the chunked columnar native format of Easy3D.
+        bool save_e3d(const std::string& file_name, const SurfaceMesh* mesh);
+
         /// Reads a surface mesh from a \p PLY format file.
         bool load_ply(const std::string& file_name, SurfaceMesh* mesh);
         /// Saves a surface mesh to a \p PLY format file.
@@ -86,8 +95,11 @@ namespace easy3d {
         /// Saves a surface mesh to a \p OBJ format file.
 		bool save_obj(const std::string& file_name, const SurfaceMesh* mesh);
 
-        /// Reads a surface mesh from a \p STL format file.
-		bool load_stl(const std::string& file_name, SurfaceMesh* mesh);
+        /// Reads a surface mesh from a \p STL format file (ASCII or binary). Coincident vertices of the triangles are
+        /// welded. If \p cell_size is positive, the coordinates are quantized to a grid of this cell size and vertices
+        /// falling into the same cell are welded (so vertices closer than \p cell_size may stay apart if they are in
+        /// neighboring cells); otherwise only vertices with exactly the same coordinates are welded.
+		bool load_stl(const std::string& file_name, SurfaceMesh* mesh, float cell_size = 0.0f);
         /// Saves a surface mesh to a \p STL format file.
 		bool save_stl(const std::string& file_name, const SurfaceMesh* mesh);
 
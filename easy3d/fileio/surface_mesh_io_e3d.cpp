@@ -0,0 +1,206 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/fileio/surface_mesh_io.h>
+#include <easy3d/fileio/chunked_file.h>
+#include <easy3d/core/surface_mesh.h>
+
+
+namespace easy3d {
+
+    namespace io {
+
+        namespace details {
+
+            // Access to the properties of an element of a surface mesh (see write_properties() and read_properties())
+            template<typename Mesh>
+            struct SurfaceMeshVertices {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->vertex_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_vertex_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_vertex_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template vertex_property<T>(name).vector();
+                }
+            };
+
+            template<typename Mesh>
+            struct SurfaceMeshHalfedges {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->halfedge_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_halfedge_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_halfedge_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template halfedge_property<T>(name).vector();
+                }
+            };
+
+            template<typename Mesh>
+            struct SurfaceMeshEdges {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->edge_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_edge_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_edge_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template edge_property<T>(name).vector();
+                }
+            };
+
+            template<typename Mesh>
+            struct SurfaceMeshFaces {
+                Mesh *mesh;
+                std::vector<std::string> names() const { return mesh->face_properties(); }
+                const std::type_info &type(const std::string &name) const { return mesh->get_face_property_type(name); }
+                template<typename T> const std::vector<T> &get(const std::string &name) const {
+                    return mesh->template get_face_property<T>(name).vector();
+                }
+                template<typename T> std::vector<T> &add(const std::string &name) {
+                    return mesh->template face_property<T>(name).vector();
+                }
+            };
+
+
+            bool load_e3d(const std::string &file_name, SurfaceMesh *mesh, const std::vector<std::string> *selected) {
+                if (!mesh) {
+                    LOG(ERROR) << "null mesh pointer";
+                    return false;
+                }
+
+                ChunkedFileReader reader(file_name);
+                if (!reader.is_ok())
+                    return false;
+                if (reader.model_type() != "SurfaceMesh") {
+                    LOG(ERROR) << "file stores a " << reader.model_type() << " (a SurfaceMesh is expected): "
+                               << file_name;
+                    return false;
+                }
+
+                mesh->clear();
+                mesh->resize(reader.size("vertex"), reader.size("edge"), reader.size("face"));
+
+                // the connectivity (always loaded)
+                auto &vconn = mesh->vertex_property<SurfaceMesh::VertexConnectivity>("v:connectivity").vector();
+                auto &hconn = mesh->halfedge_property<SurfaceMesh::HalfedgeConnectivity>("h:connectivity").vector();
+                auto &fconn = mesh->face_property<SurfaceMesh::FaceConnectivity>("f:connectivity").vector();
+                if (!reader.read_column("vertex/v:connectivity", "SurfaceMesh::VertexConnectivity", vconn) ||
+                    !reader.read_column("halfedge/h:connectivity", "SurfaceMesh::HalfedgeConnectivity", hconn) ||
+                    !reader.read_column("face/f:connectivity", "SurfaceMesh::FaceConnectivity", fconn) ||
+                    vconn.size() != mesh->n_vertices() || hconn.size() != mesh->n_halfedges() ||
+                    fconn.size() != mesh->n_faces()) {
+                    mesh->clear();
+                    return false;
+                }
+
+                // the other properties (the vertex coordinates are always loaded)
+                std::vector<std::string> vertex_selected;
+                if (selected) {
+                    vertex_selected = *selected;
+                    vertex_selected.push_back("v:point");
+                }
+                const std::vector<std::string> skip = {"v:connectivity", "h:connectivity", "f:connectivity",
+                                                       "v:deleted", "e:deleted", "f:deleted"};
+                SurfaceMeshVertices<SurfaceMesh> vertices{mesh};
+                SurfaceMeshHalfedges<SurfaceMesh> halfedges{mesh};
+                SurfaceMeshEdges<SurfaceMesh> edges{mesh};
+                SurfaceMeshFaces<SurfaceMesh> faces{mesh};
+                if (!read_properties(reader, "vertex", vertices, skip, selected ? &vertex_selected : nullptr) ||
+                    !read_properties(reader, "halfedge", halfedges, skip, selected) ||
+                    !read_properties(reader, "edge", edges, skip, selected) ||
+                    !read_properties(reader, "face", faces, skip, selected)) {
+                    mesh->clear();
+                    return false;
+                }
+
+                // the vertex coordinates are stored relative to the translation (if any)
+                auto &points = mesh->vertex_property<vec3>("v:point").vector();
+                if (!read_translation(reader, mesh, points)) {
+                    mesh->clear();
+                    return false;
+                }
+
+                return mesh->n_faces() > 0;
+            }
+
+        } // namespace details
+
+
+        bool load_e3d(const std::string &file_name, SurfaceMesh *mesh) {
+            return details::load_e3d(file_name, mesh, nullptr);
+        }
+
+
+        bool load_e3d(const std::string &file_name, SurfaceMesh *mesh, const std::vector<std::string> &properties) {
+            return details::load_e3d(file_name, mesh, &properties);
+        }
+
+
+        bool save_e3d(const std::string &file_name, const SurfaceMesh *mesh) {
+            if (!mesh) {
+                LOG(ERROR) << "null mesh pointer";
+                return false;
+            }
+
+            // the deleted elements are not stored
+            SurfaceMesh copy;
+            if (mesh->has_garbage()) {
+                copy = *mesh;
+                copy.collect_garbage();
+                mesh = &copy;
+            }
+
+            ChunkedFileWriter writer(file_name, "SurfaceMesh");
+            writer.set_size("vertex", mesh->n_vertices());
+            writer.set_size("halfedge", mesh->n_halfedges());
+            writer.set_size("edge", mesh->n_edges());
+            writer.set_size("face", mesh->n_faces());
+
+            writer.write_column("vertex/v:connectivity", "SurfaceMesh::VertexConnectivity",
+                                mesh->get_vertex_property<SurfaceMesh::VertexConnectivity>("v:connectivity").vector());
+            writer.write_column("halfedge/h:connectivity", "SurfaceMesh::HalfedgeConnectivity",
+                                mesh->get_halfedge_property<SurfaceMesh::HalfedgeConnectivity>("h:connectivity").vector());
+            writer.write_column("face/f:connectivity", "SurfaceMesh::FaceConnectivity",
+                                mesh->get_face_property<SurfaceMesh::FaceConnectivity>("f:connectivity").vector());
+
+            const std::vector<std::string> skip = {"v:connectivity", "h:connectivity", "f:connectivity",
+                                                   "v:deleted", "e:deleted", "f:deleted"};
+            details::write_properties(writer, "vertex", details::SurfaceMeshVertices<const SurfaceMesh>{mesh}, skip);
+            details::write_properties(writer, "halfedge", details::SurfaceMeshHalfedges<const SurfaceMesh>{mesh}, skip);
+            details::write_properties(writer, "edge", details::SurfaceMeshEdges<const SurfaceMesh>{mesh}, skip);
+            details::write_properties(writer, "face", details::SurfaceMeshFaces<const SurfaceMesh>{mesh}, skip);
+
+            details::write_translation(writer, mesh);
+            return writer.finish();
+        }
+
+    }
+
+}
@@ -28,6 +28,9 @@
 
 #include <fstream>
 #include <unordered_map>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 
 #include <easy3d/fileio/translator.h>
 #include <easy3d/core/surface_mesh.h>
@@ -36,15 +39,536 @@
 #include <easy3d/util/logging.h>
 
 
-#define USE_FAST_OBJ
+// The streaming reader (default) parses the file block by block and builds the mesh in bulk, so its peak memory is
+// close to the size of the resulting mesh. The other readers are kept for reference.
+#define USE_STREAMING_OBJ
 
 
-#ifdef USE_FAST_OBJ
-
+// The implementation of fast_obj is also used by other modules (e.g., Tutorial_308_TexturedMesh).
 #define FAST_OBJ_IMPLEMENTATION
 #include <3rd_party/fastobj/fast_obj.h>
 
 
+#ifdef USE_STREAMING_OBJ
+
+namespace easy3d {
+
+    namespace io {
+
+        namespace details {
+
+            inline bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+            inline const char *skip_space(const char *p, const char *end) {
+                while (p < end && is_space(*p)) ++p;
+                return p;
+            }
+
+            // returns the start of the next line
+            inline const char *next_line(const char *p, const char *end) {
+                if (p >= end)
+                    return end;
+                p = static_cast<const char *>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+                return p ? p + 1 : end;
+            }
+
+            // returns the rest of the line (trimmed)
+            inline std::string rest_of_line(const char *p, const char *end) {
+                p = skip_space(p, end);
+                const char *q = p;
+                while (q < end && *q != '\n') ++q;
+                while (q > p && is_space(*(q - 1))) --q;
+                return std::string(p, q);
+            }
+
+            inline bool starts_with(const char *p, const char *end, const char *keyword) {
+                const std::size_t n = std::strlen(keyword);
+                return end - p > static_cast<std::ptrdiff_t>(n) && std::strncmp(p, keyword, n) == 0 && is_space(p[n]);
+            }
+
+            // Parses a (signed) integer. Returns the position after the number (or p if there is no number).
+            inline const char *parse_int(const char *p, const char *end, int &value) {
+                const char *q = p;
+                bool negative = false;
+                if (q < end && (*q == '-' || *q == '+')) {
+                    negative = (*q == '-');
+                    ++q;
+                }
+                if (q >= end || *q < '0' || *q > '9')
+                    return p;
+                long long v = 0;
+                while (q < end && *q >= '0' && *q <= '9')
+                    v = v * 10 + (*q++ - '0');
+                value = static_cast<int>(negative ? -v : v);
+                return q;
+            }
+
+            // Parses a floating point number (e.g., -1.25e-3). Returns the position after the number (or p if there
+            // is no number). Unlike strtod(), it does not depend on the locale.
+            inline const char *parse_double(const char *p, const char *end, double &value) {
+                static const double powers[] = {
+                        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                };
+
+                const char *q = p;
+                bool negative = false;
+                if (q < end && (*q == '-' || *q == '+')) {
+                    negative = (*q == '-');
+                    ++q;
+                }
+
+                unsigned long long mantissa = 0;
+                int num_digits = 0, exponent = 0;
+                const char *digits = q;
+                for (; q < end && *q >= '0' && *q <= '9'; ++q) {
+                    if (num_digits < 19) {
+                        mantissa = mantissa * 10 + (*q - '0');
+                        if (mantissa) ++num_digits;
+                    } else
+                        ++exponent;
+                }
+                if (q < end && *q == '.') {
+                    for (++q; q < end && *q >= '0' && *q <= '9'; ++q) {
+                        if (num_digits < 19) {
+                            mantissa = mantissa * 10 + (*q - '0');
+                            if (mantissa) ++num_digits;
+                            --exponent;
+                        }
+                    }
+                }
+                if (q == digits || (q == digits + 1 && *digits == '.'))
+                    return p;
+
+                if (q < end && (*q == 'e' || *q == 'E')) {
+                    int e = 0;
+                    const char *r = parse_int(q + 1, end, e);
+                    if (r != q + 1) {
+                        exponent += e;
+                        q = r;
+                    }
+                }
+
+                double v = static_cast<double>(mantissa);
+                if (exponent < 0)
+                    v = (exponent >= -22) ? v / powers[-exponent] : v * std::pow(10.0, exponent);
+                else if (exponent > 0)
+                    v = (exponent <= 22) ? v * powers[exponent] : v * std::pow(10.0, exponent);
+                value = negative ? -v : v;
+                return q;
+            }
+
+
+            // The data parsed from a range of lines.
+            struct ObjSegment {
+                std::vector<double> positions;  // x, y, z of each 'v'
+                std::vector<vec2> texcoords;    // each 'vt'
+                std::vector<int> face_sizes;    // the number of corners of each 'f'
+                std::vector<int> corner_positions;
+                std::vector<int> corner_texcoords;  // -1 for corners without a texture coordinate
+                // Relative (i.e., negative) indices are stored w.r.t. the beginning of this segment, and the
+                // corners having them are recorded here. They are corrected when the segments are merged.
+                std::vector<std::size_t> relative_positions;
+                std::vector<std::size_t> relative_texcoords;
+                bool has_corner_texcoords = false;
+                // the 'usemtl' statements (before which face) and the 'mtllib' statements
+                std::vector<std::pair<std::size_t, std::string> > materials;
+                std::vector<std::string> material_libs;
+            };
+
+
+            void parse_segment(const char *p, const char *end, ObjSegment &seg) {
+                while (p < end) {
+                    const char *line = skip_space(p, end);
+                    p = next_line(line, end);
+                    if (line >= end)
+                        break;
+
+                    if (line[0] == 'v' && line + 1 < end && is_space(line[1])) {
+                        double xyz[3] = {0, 0, 0};
+                        const char *q = line + 1;
+                        for (auto &c : xyz)
+                            q = parse_double(skip_space(q, end), end, c);
+                        seg.positions.insert(seg.positions.end(), xyz, xyz + 3);
+                    } else if (line[0] == 'v' && line + 2 < end && line[1] == 't' && is_space(line[2])) {
+                        double uv[2] = {0, 0};
+                        const char *q = line + 2;
+                        for (auto &c : uv)
+                            q = parse_double(skip_space(q, end), end, c);
+                        seg.texcoords.emplace_back(static_cast<float>(uv[0]), static_cast<float>(uv[1]));
+                    } else if (line[0] == 'f' && line + 1 < end && is_space(line[1])) {
+                        const int num_positions = static_cast<int>(seg.positions.size() / 3);
+                        const int num_texcoords = static_cast<int>(seg.texcoords.size());
+                        int size = 0;
+                        const char *q = line + 1;
+                        while (true) {
+                            q = skip_space(q, end);
+                            int vi = 0;
+                            const char *r = parse_int(q, end, vi);
+                            if (r == q || vi == 0)
+                                break;
+                            q = r;
+                            int ti = 0, ni = 0;
+                            if (q < end && *q == '/') {
+                                q = parse_int(q + 1, end, ti);
+                                if (q < end && *q == '/')
+                                    q = parse_int(q + 1, end, ni);
+                            }
+
+                            if (vi < 0) {
+                                seg.relative_positions.push_back(seg.corner_positions.size());
+                                seg.corner_positions.push_back(num_positions + vi);
+                            } else
+                                seg.corner_positions.push_back(vi - 1);
+
+                            if (ti < 0) {
+                                seg.relative_texcoords.push_back(seg.corner_texcoords.size());
+                                seg.corner_texcoords.push_back(num_texcoords + ti);
+                            } else
+                                seg.corner_texcoords.push_back(ti - 1);
+                            seg.has_corner_texcoords |= (ti != 0);
+                            ++size;
+
+                            // skip anything else of this corner
+                            while (q < end && !is_space(*q) && *q != '\n') ++q;
+                        }
+                        if (size > 0)
+                            seg.face_sizes.push_back(size);
+                    } else if (starts_with(line, end, "usemtl"))
+                        seg.materials.emplace_back(seg.face_sizes.size(), rest_of_line(line + 6, end));
+                    else if (starts_with(line, end, "mtllib"))
+                        seg.material_libs.push_back(rest_of_line(line + 6, end));
+                    // 'vn', 'vp', 'g', 'o', 's', 'l', 'p', and comments are ignored
+                }
+            }
+
+
+            // The data accumulated from all the segments.
+            struct ObjData {
+                std::vector<vec3> points;
+                std::vector<vec2> texcoords;
+                std::vector<int> indices;               // the position index of each corner
+                std::vector<int> offsets{0};            // the first corner of each face
+                std::vector<int> corner_texcoords;      // allocated only if there are texture coordinates
+                bool has_corner_texcoords = false;
+                std::vector<int> face_materials;        // allocated only if 'usemtl' is used
+                bool has_face_materials = false;
+                std::vector<std::string> material_names;
+                std::unordered_map<std::string, int> material_ids;
+                std::vector<std::string> material_libs;
+                int current_material = -1;
+                dvec3 origin = dvec3(0, 0, 0);
+            };
+
+
+            void merge_segment(ObjSegment &seg, ObjData &data) {
+                const int position_base = static_cast<int>(data.points.size());
+                const int texcoord_base = static_cast<int>(data.texcoords.size());
+                const std::size_t corner_base = data.indices.size();
+                const std::size_t face_base = data.offsets.size() - 1;
+
+                if (!seg.positions.empty() && Translator::instance()->status() == Translator::TRANSLATE_USE_FIRST_POINT &&
+                    data.points.empty()) {
+                    data.origin = dvec3(seg.positions.data());
+                    Translator::instance()->set_translation(data.origin);
+                }
+                const dvec3 &o = data.origin;
+                for (std::size_t i = 0; i < seg.positions.size(); i += 3) {
+                    const double *v = seg.positions.data() + i;
+                    data.points.emplace_back(static_cast<float>(v[0] - o.x), static_cast<float>(v[1] - o.y),
+                                             static_cast<float>(v[2] - o.z));
+                }
+                std::vector<double>().swap(seg.positions);
+                data.texcoords.insert(data.texcoords.end(), seg.texcoords.begin(), seg.texcoords.end());
+
+                for (auto c : seg.relative_positions)
+                    seg.corner_positions[c] += position_base;
+                data.indices.insert(data.indices.end(), seg.corner_positions.begin(), seg.corner_positions.end());
+
+                if (seg.has_corner_texcoords && !data.has_corner_texcoords) {
+                    data.corner_texcoords.assign(corner_base, -1);
+                    data.has_corner_texcoords = true;
+                }
+                if (data.has_corner_texcoords) {
+                    for (auto c : seg.relative_texcoords)
+                        seg.corner_texcoords[c] += texcoord_base;
+                    data.corner_texcoords.insert(data.corner_texcoords.end(), seg.corner_texcoords.begin(),
+                                                 seg.corner_texcoords.end());
+                }
+
+                // faces and their materials
+                std::size_t next_material = 0;
+                for (std::size_t f = 0; f <= seg.face_sizes.size(); ++f) {
+                    for (; next_material < seg.materials.size() && seg.materials[next_material].first == f; ++next_material) {
+                        const std::string &name = seg.materials[next_material].second;
+                        auto pos = data.material_ids.find(name);
+                        if (pos == data.material_ids.end()) {
+                            pos = data.material_ids.emplace(name, static_cast<int>(data.material_names.size())).first;
+                            data.material_names.push_back(name);
+                        }
+                        data.current_material = pos->second;
+                        if (!data.has_face_materials) {
+                            data.face_materials.assign(face_base + f, -1);
+                            data.has_face_materials = true;
+                        }
+                    }
+                    if (f == seg.face_sizes.size())
+                        break;
+                    data.offsets.push_back(data.offsets.back() + seg.face_sizes[f]);
+                    if (data.has_face_materials)
+                        data.face_materials.push_back(data.current_material);
+                }
+
+                data.material_libs.insert(data.material_libs.end(), seg.material_libs.begin(), seg.material_libs.end());
+                seg = ObjSegment();
+            }
+
+
+            // A material defined in an MTL file. Easy3D uses only the diffuse color.
+            struct ObjMaterial {
+                vec3 diffuse = vec3(1.0f, 1.0f, 1.0f);
+            };
+
+
+            void load_mtl(const std::string &file_name, std::unordered_map<std::string, ObjMaterial> &materials) {
+                std::ifstream input(file_name.c_str());
+                if (input.fail()) {
+                    LOG(WARNING) << "could not open material file: " << file_name;
+                    return;
+                }
+
+                static const std::vector<std::pair<std::string, std::string> > textures = {
+                        {"map_Ka", "ambient"}, {"map_Kd", "diffuse"}, {"map_Ks", "specular"},
+                        {"map_Ke", "emission"}, {"map_Kt", "transmittance"}, {"map_Ns", "shininess"},
+                        {"map_Ni", "index of refraction"}, {"map_d", "dissolve (alpha)"}, {"map_bump", "bump"},
+                        {"bump", "bump"}
+                };
+
+                ObjMaterial *current = nullptr;
+                std::string line;
+                while (std::getline(input, line)) {
+                    const char *p = skip_space(line.data(), line.data() + line.size());
+                    const char *end = line.data() + line.size();
+                    if (starts_with(p, end, "newmtl"))
+                        current = &materials[rest_of_line(p + 6, end)];
+                    else if (current && starts_with(p, end, "Kd")) {
+                        const char *q = p + 2;
+                        for (int i = 0; i < 3; ++i) {
+                            double c = 0.0;
+                            q = parse_double(skip_space(q, end), end, c);
+                            current->diffuse[i] = static_cast<float>(c);
+                        }
+                    } else {
+                        for (const auto &tex : textures) {
+                            if (starts_with(p, end, tex.first.c_str())) {
+                                const std::string &name = rest_of_line(p + tex.first.size(), end);
+                                LOG_IF(!name.empty(), WARNING) << tex.second << " texture ignored: " << name;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+        } // namespace details
+
+
+        bool load_obj(const std::string &file_name, SurfaceMesh *mesh) {
+            if (!mesh) {
+                LOG(ERROR) << "null mesh pointer";
+                return false;
+            }
+
+            std::ifstream input(file_name.c_str(), std::ios::binary);
+            if (input.fail()) {
+                LOG(ERROR) << "could not open file: " << file_name;
+                return false;
+            }
+
+            // ------------------------ parse the file block by block ------------------------
+
+            // Each block (ending at a line break) is split into segments of lines that are parsed in parallel, and
+            // then the segments are merged in order.
+            static const std::size_t block_size = 32 * 1024 * 1024;
+            static const std::size_t segment_size = 1024 * 1024;
+
+            details::ObjData data;
+            if (Translator::instance()->status() == Translator::TRANSLATE_USE_LAST_KNOWN_OFFSET)
+                data.origin = Translator::instance()->translation();
+
+            input.seekg(0, std::ios::end);
+            const std::size_t file_size = static_cast<std::size_t>(input.tellg());
+            input.seekg(0, std::ios::beg);
+            std::vector<char> buffer(std::min(block_size, file_size + 1));
+            std::size_t carry = 0;    // the incomplete last line of the previous block
+            while (true) {
+                input.read(buffer.data() + carry, static_cast<std::streamsize>(buffer.size() - carry));
+                const std::size_t size = carry + static_cast<std::size_t>(input.gcount());
+                const bool eof = !input;
+                if (size == 0)
+                    break;
+
+                // the block ends after the last line break (or at the end of the file)
+                std::size_t block_end = size;
+                if (!eof) {
+                    while (block_end > 0 && buffer[block_end - 1] != '\n')
+                        --block_end;
+                    if (block_end == 0) { // a single line longer than the buffer
+                        buffer.resize(buffer.size() * 2);
+                        carry = size;
+                        continue;
+                    }
+                }
+
+                // split the block into segments at line breaks
+                std::vector<const char *> bounds(1, buffer.data());
+                const char *block = buffer.data();
+                while (static_cast<std::size_t>(bounds.back() - block) + segment_size < block_end) {
+                    const char *p = bounds.back() + segment_size;
+                    bounds.push_back(details::next_line(p, block + block_end));
+                }
+                bounds.push_back(block + block_end);
+
+                std::vector<details::ObjSegment> segments(bounds.size() - 1);
+#pragma omp parallel for schedule(dynamic)
+                for (int i = 0; i < static_cast<int>(segments.size()); ++i)
+                    details::parse_segment(bounds[i], bounds[i + 1], segments[i]);
+
+                for (auto &seg : segments)
+                    details::merge_segment(seg, data);
+
+                if (eof)
+                    break;
+                carry = size - block_end;
+                std::memmove(buffer.data(), buffer.data() + block_end, carry);
+            }
+            std::vector<char>().swap(buffer);
+
+            // ------------------------ check the faces ------------------------
+
+            // Consecutive duplicate vertices are removed, and faces with less than three vertices or out-of-range
+            // vertices are ignored. Faces with other duplicate vertices are left to the builder.
+            const int num_points = static_cast<int>(data.points.size());
+            const int num_texcoords = static_cast<int>(data.texcoords.size());
+            const bool has_texcoords = data.has_corner_texcoords && num_texcoords > 0;
+            std::size_t num_less_three = 0, num_out_of_range = 0;
+            const bool has_materials = data.has_face_materials;
+            int num_faces = 0, corner = 0;
+            for (std::size_t f = 0; f + 1 < data.offsets.size(); ++f) {
+                const int begin = data.offsets[f], end = data.offsets[f + 1];
+                const int first = corner;
+                bool out_of_range = false;
+                for (int c = begin; c < end; ++c) {
+                    const int v = data.indices[c];
+                    if (v < 0 || v >= num_points)
+                        out_of_range = true;
+                    if (corner > first && data.indices[corner - 1] == v)
+                        continue;
+                    data.indices[corner] = v;
+                    if (has_texcoords)
+                        data.corner_texcoords[corner] = data.corner_texcoords[c];
+                    ++corner;
+                }
+                if (corner - first > 1 && data.indices[corner - 1] == data.indices[first])
+                    --corner;
+
+                if (out_of_range || corner - first < 3) {
+                    if (out_of_range) {
+                        LOG_N_TIMES(3, ERROR) << "face has out-of-range vertices (face ignored). " << COUNTER;
+                        ++num_out_of_range;
+                    } else {
+                        LOG_N_TIMES(3, ERROR) << "face has less than 3 vertices (face ignored). " << COUNTER;
+                        ++num_less_three;
+                    }
+                    corner = first;
+                    continue;
+                }
+                data.offsets[num_faces + 1] = corner;
+                if (has_materials)
+                    data.face_materials[num_faces] = data.face_materials[f];
+                ++num_faces;
+            }
+            data.indices.resize(corner);
+            data.offsets.resize(num_faces + 1);
+            if (has_texcoords)
+                data.corner_texcoords.resize(corner);
+            if (has_materials)
+                data.face_materials.resize(num_faces);
+            LOG_IF(num_less_three + num_out_of_range > 0, WARNING) << num_less_three + num_out_of_range
+                    << " faces ignored (" << num_less_three << " with less than 3 vertices, "
+                    << num_out_of_range << " with out-of-range vertices)";
+
+            // ------------------------ build the mesh ------------------------
+
+            // the halfedge pointing to the first corner of each face (the vertices may be copied or renumbered)
+            std::vector<SurfaceMesh::Halfedge> corners;
+            SurfaceMeshBuilder builder(mesh);
+            builder.build(data.points, data.indices, data.offsets, &corners);
+            std::vector<int>().swap(data.indices);
+
+            if (Translator::instance()->status() != Translator::DISABLED) {
+                auto trans = mesh->add_model_property<dvec3>("translation", dvec3(0, 0, 0));
+                trans[0] = data.origin;
+                if (Translator::instance()->status() == Translator::TRANSLATE_USE_FIRST_POINT)
+                    LOG(INFO) << "model translated w.r.t. the first vertex (" << data.origin
+                              << "), stored as ModelProperty<dvec3>(\"translation\")";
+                else
+                    LOG(INFO) << "model translated w.r.t. last known reference point (" << data.origin
+                              << "), stored as ModelProperty<dvec3>(\"translation\")";
+            }
+
+            // texture coordinates (for the halfedges pointing to the corners)
+            if (has_texcoords) {
+                auto prop_texcoords = mesh->add_halfedge_property<vec2>("h:texcoord");
+#pragma omp parallel for
+                for (int f = 0; f < num_faces; ++f) {
+                    SurfaceMesh::Halfedge h = corners[f];
+                    if (!h.is_valid())
+                        continue;
+                    const int begin = data.offsets[f], end = data.offsets[f + 1];
+                    bool complete = true;
+                    for (int c = begin; c < end; ++c) {
+                        const int t = data.corner_texcoords[c];
+                        complete &= (t >= 0 && t < num_texcoords);
+                    }
+                    if (!complete)
+                        continue;
+                    for (int c = begin; c < end; ++c, h = mesh->next(h))
+                        prop_texcoords[h] = data.texcoords[data.corner_texcoords[c]];
+                }
+            }
+
+            // face colors from the materials (currently Easy3D uses only the diffuse color)
+            if (has_materials) {
+                std::unordered_map<std::string, details::ObjMaterial> materials;
+                const std::string dir = file_system::parent_directory(file_name);
+                for (const auto &lib : data.material_libs)
+                    details::load_mtl(dir + "/" + lib, materials);
+
+                std::vector<vec3> colors(data.material_names.size(), details::ObjMaterial().diffuse);
+                for (std::size_t i = 0; i < colors.size(); ++i) {
+                    auto pos = materials.find(data.material_names[i]);
+                    if (pos != materials.end())
+                        colors[i] = pos->second.diffuse;
+                }
+
+                auto prop_face_color = mesh->add_face_property<vec3>("f:color");
+                for (int f = 0; f < num_faces; ++f) {
+                    const int m = data.face_materials[f];
+                    if (corners[f].is_valid())
+                        prop_face_color[mesh->face(corners[f])] = (m >= 0) ? colors[m] : details::ObjMaterial().diffuse;
+                }
+            }
+
+            return mesh->n_faces() > 0;
+        }
+    }
+}
+
+
+#elif defined(USE_FAST_OBJ)
+
+
 namespace easy3d {
 
     namespace io {
@@ -200,17 +200,18 @@ namespace easy3d {
                 return SurfaceMesh::Halfedge();
             };
 
+            std::vector<SurfaceMesh::Vertex> vts;
             for (std::size_t i=0; i<face_vertex_indices.size(); ++i) {
-                const auto& indices = face_vertex_indices[i];
-				std::vector<SurfaceMesh::Vertex> vts;
-				for (auto id : indices)
-                    vts.emplace_back(SurfaceMesh::Vertex(id));
+                const int* indices = face_vertex_indices.list(i);
+                vts.resize(face_vertex_indices.length(i));
+                for (std::size_t j = 0; j < vts.size(); ++j)
+                    vts[j] = SurfaceMesh::Vertex(indices[j]);
                 auto face = builder.add_face(vts);
 
                 // now let's add the texcoords (defined on halfedges)
                 if (face.is_valid() && prop_texcoords) {
-                    const auto& face_texcoords = face_halfedge_texcoords[i];
-                    if (face_texcoords.size() == vts.size() * 2) { // 2 coordinates per vertex
+                    const float* face_texcoords = face_halfedge_texcoords.list(i);
+                    if (face_halfedge_texcoords.length(i) == vts.size() * 2) { // 2 coordinates per vertex
                         auto begin = find_face_halfedge(mesh, face, builder.face_vertices()[0]);
                         auto cur = begin;
                         unsigned int texcord_idx = 0;
@@ -307,6 +308,19 @@ namespace easy3d {
 				}
 			}
 
+			template <typename T>
+			inline void collect_vertex_properties(const SurfaceMesh* mesh, std::vector< GenericListProperty<T> >& properties) {
+				const auto& all_properties = mesh->vertex_properties();
+				for (auto name : all_properties) {
+					auto prop = mesh->get_vertex_property< std::vector<T> >(name);
+					if (prop) {
+						if (name.substr(0, 2) == "v:")
+							name = name.substr(2, name.length() - 1);
+						properties.emplace_back(GenericListProperty<T>(name, prop.vector()));
+					}
+				}
+			}
+
 			template <typename T>
 			inline void collect_face_properties(const SurfaceMesh* mesh, std::vector< GenericProperty<T> >& properties) {
 				const auto& all_properties = mesh->face_properties();
@@ -320,6 +334,19 @@ namespace easy3d {
 				}
 			}
 
+			template <typename T>
+			inline void collect_face_properties(const SurfaceMesh* mesh, std::vector< GenericListProperty<T> >& properties) {
+				const auto& all_properties = mesh->face_properties();
+				for (auto name : all_properties) {
+					auto prop = mesh->get_face_property< std::vector<T> >(name);
+					if (prop) {
+						if (name.substr(0, 2) == "f:")
+							name = name.substr(2, name.length() - 1);
+						properties.emplace_back(GenericListProperty<T>(name, prop.vector()));
+					}
+				}
+			}
+
 
 			template <typename T>
 			inline void collect_edge_properties(const SurfaceMesh* mesh, std::vector< GenericProperty<T> >& properties) {
@@ -334,6 +361,19 @@ namespace easy3d {
 				}
 			}
 
+			template <typename T>
+			inline void collect_edge_properties(const SurfaceMesh* mesh, std::vector< GenericListProperty<T> >& properties) {
+				const auto& all_properties = mesh->edge_properties();
+				for (auto name : all_properties) {
+					auto prop = mesh->get_edge_property< std::vector<T> >(name);
+					if (prop) {
+						if (name.substr(0, 2) == "e:")
+							name = name.substr(2, name.length() - 1);
+						properties.emplace_back(GenericListProperty<T>(name, prop.vector()));
+					}
+				}
+			}
+
 
 		} // namespace details
 
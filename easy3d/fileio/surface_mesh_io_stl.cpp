@@ -28,9 +28,12 @@
 
 #include <cstdio>
 #include <cstring>
-#include <map>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+#include <limits>
+#include <algorithm>
 #include <fstream>
-#include <cfloat>
 
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/surface_mesh_builder.h>
@@ -56,35 +59,118 @@ namespace easy3d {
 		//-----------------------------------------------------------------------------
 
 
-		// helper class for STL reader
-		class CmpVec
-		{
-		public:
-
-			CmpVec(float _eps = FLT_MIN) : eps_(_eps) {}
-
-			bool operator()(const vec3& v0, const vec3& v1) const
-			{
-				if (fabs(v0[0] - v1[0]) <= eps_)
-				{
-					if (fabs(v0[1] - v1[1]) <= eps_)
-					{
-						return (v0[2] < v1[2] - eps_);
-					}
-					else return (v0[1] < v1[1] - eps_);
-				}
-				else return (v0[0] < v1[0] - eps_);
-			}
-
-		private:
-			float eps_;
-		};
-
+        namespace details {
+
+            // The welding key of a point: its grid cell (if cell_size > 0) or the bit pattern of its coordinates.
+            struct WeldKey {
+                WeldKey(const vec3 &p, float cell_size) {
+                    for (int i = 0; i < 3; ++i) {
+                        if (cell_size > 0.0f)
+                            c[i] = static_cast<int64_t>(std::floor(static_cast<double>(p[i]) / cell_size));
+                        else {
+                            const float v = (p[i] == 0.0f) ? 0.0f : p[i]; // -0 and +0 are the same point
+                            uint32_t bits;
+                            std::memcpy(&bits, &v, sizeof(bits));
+                            c[i] = bits;
+                        }
+                    }
+                }
+
+                bool operator==(const WeldKey &other) const {
+                    return c[0] == other.c[0] && c[1] == other.c[1] && c[2] == other.c[2];
+                }
+
+                std::size_t hash() const {
+                    uint64_t h = static_cast<uint64_t>(c[0]) * 0x9e3779b97f4a7c15ull;
+                    h = (h ^ (h >> 31) ^ static_cast<uint64_t>(c[1])) * 0xc2b2ae3d27d4eb4full;
+                    h = (h ^ (h >> 31) ^ static_cast<uint64_t>(c[2])) * 0x165667b19e3779f9ull;
+                    return static_cast<std::size_t>(h ^ (h >> 32));
+                }
+
+                int64_t c[3];
+            };
+
+
+            // Welds the corners of the triangles (three consecutive points each) into vertices, and builds the mesh.
+            // The corners are inserted in parallel into an open-addressing hash table whose slots keep the smallest
+            // corner index of each key, so the result (the vertices are ordered by their first occurrence) does not
+            // depend on the number of threads.
+            void weld_and_build(std::vector<vec3> &corners, float cell_size, SurfaceMesh *mesh) {
+                const int num_corners = static_cast<int>(corners.size());
+
+                std::size_t table_size = 1;
+                while (table_size < static_cast<std::size_t>(num_corners) + num_corners / 2)
+                    table_size <<= 1;
+                const std::size_t mask = table_size - 1;
+                std::vector<std::atomic<int> > table(table_size); // stores (corner index + 1), 0 for empty slots
+
+                // the slot of each corner (and then its representative corner)
+                std::vector<int> indices(num_corners);
+#pragma omp parallel for
+                for (int i = 0; i < num_corners; ++i) {
+                    const WeldKey key(corners[i], cell_size);
+                    std::size_t slot = key.hash() & mask;
+                    while (true) {
+                        int current = table[slot].load();
+                        if (current == 0 && table[slot].compare_exchange_strong(current, i + 1))
+                            break;
+                        // 'current' was updated if the slot has been taken by another thread
+                        if (current != 0 && WeldKey(corners[current - 1], cell_size) == key) {
+                            while (i + 1 < current && !table[slot].compare_exchange_weak(current, i + 1)) {}
+                            break;
+                        }
+                        if (current != 0)
+                            slot = (slot + 1) & mask;
+                    }
+                    indices[i] = static_cast<int>(slot);
+                }
+
+#pragma omp parallel for
+                for (int i = 0; i < num_corners; ++i)
+                    indices[i] = table[indices[i]].load() - 1;
+                std::vector<std::atomic<int> >().swap(table);
+
+                // number the vertices in the order of their first occurrence (representatives precede their copies)
+                int num_vertices = 0;
+                for (int i = 0; i < num_corners; ++i) {
+                    if (indices[i] == i) {
+                        corners[num_vertices] = corners[i];
+                        indices[i] = num_vertices++;
+                    } else
+                        indices[i] = indices[indices[i]];
+                }
+                corners.resize(num_vertices);
+                corners.shrink_to_fit();
+
+                // ignore degenerate triangles
+                std::size_t num_degenerate = 0;
+                int num_kept = 0;
+                for (int t = 0; t < num_corners / 3; ++t) {
+                    const int a = indices[3 * t], b = indices[3 * t + 1], c = indices[3 * t + 2];
+                    if (a == b || a == c || b == c) {
+                        ++num_degenerate;
+                        continue;
+                    }
+                    indices[3 * num_kept] = a;
+                    indices[3 * num_kept + 1] = b;
+                    indices[3 * num_kept + 2] = c;
+                    ++num_kept;
+                }
+                indices.resize(3 * num_kept);
+                LOG_IF(num_degenerate > 0, WARNING) << num_degenerate << " degenerate triangles ignored";
+
+                std::vector<int> offsets(num_kept + 1);
+                for (int t = 0; t <= num_kept; ++t)
+                    offsets[t] = 3 * t;
+
+                SurfaceMeshBuilder builder(mesh);
+                builder.build(corners, indices, offsets);
+            }
 
-		//-----------------------------------------------------------------------------
+        } // namespace details
 
 
-		bool load_stl(const std::string& file_name, SurfaceMesh* mesh)
+		bool load_stl(const std::string& file_name, SurfaceMesh* mesh, float cell_size)
 		{
 			if (!mesh) {
                 LOG(ERROR) << "null mesh pointer";
@@ -94,21 +180,14 @@ namespace easy3d {
 			char                            line[100], *c;
 			unsigned int                    i, nT;
 			vec3                           p;
-			SurfaceMesh::Vertex               v;
-			std::vector<SurfaceMesh::Vertex>  vertices(3);
 			size_t n_items(0);
 
-			CmpVec comp(FLT_MIN);
-			std::map<vec3, SurfaceMesh::Vertex, CmpVec>            vMap(comp);
-			std::map<vec3, SurfaceMesh::Vertex, CmpVec>::iterator  vMapIt;
-
+			// the corners of all the triangles, which will be welded into vertices
+			std::vector<vec3> corners;
 
 			// clear mesh
 			mesh->clear();
 
-            SurfaceMeshBuilder builder(mesh);
-            builder.begin_surface();
-
 			// open file (in ASCII mode)
 			FILE* in = fopen(file_name.c_str(), "r");
             if (!in) {
@@ -116,12 +195,19 @@ namespace easy3d {
                 return false;
             }
 
-
-			// ASCII or binary STL?
+			// ASCII or binary STL? Some binary files also start with "solid", so the file size is checked as well.
 			c = fgets(line, 6, in);
 			assert(c != nullptr);
-			const bool binary = ((strncmp(line, "SOLID", 5) != 0) &&
+			bool binary = ((strncmp(line, "SOLID", 5) != 0) &&
 				(strncmp(line, "solid", 5) != 0));
+			if (!binary) {
+                // the file size is queried with a stream, because ftell() returns a 32-bit long on Windows
+                std::ifstream stream(file_name.c_str(), std::ios::binary | std::ios::ate);
+                const std::streamoff file_size = stream ? static_cast<std::streamoff>(stream.tellg()) : 0;
+                if (file_size >= 84 && fseek(in, 80, SEEK_SET) == 0 && fread(&nT, 4, 1, in) == 1)
+                    binary = (file_size == 84 + 50 * static_cast<std::streamoff>(nT));
+                fseek(in, 5, SEEK_SET);
+            }
 
 
 			// parse binary STL
@@ -138,43 +224,31 @@ namespace easy3d {
 
 				// read number of triangles
 				read(in, nT);
-
-				// read triangles
-				while (nT)
-				{
-					// skip triangle normal
-					n_items = fread(line, 1, 12, in);
-					assert(n_items > 0);
-					// triangle's vertices
-					for (i = 0; i < 3; ++i)
-					{
-						read(in, p);
-
-						// has vector been referenced before?
-						if ((vMapIt = vMap.find(p)) == vMap.end())
-						{
-							// No : add vertex and remember idx/vector mapping
-							v = builder.add_vertex(p);
-							vertices[i] = v;
-							vMap[p] = v;
-						}
-						else
-						{
-							// Yes : get index from map
-							vertices[i] = vMapIt->second;
-						}
-					}
-
-					// Add face only if it is not degenerated
-					if ((vertices[0] != vertices[1]) &&
-						(vertices[0] != vertices[2]) &&
-						(vertices[1] != vertices[2]))
-						builder.add_face(vertices);
-
-					n_items = fread(line, 1, 2, in);
-					assert(n_items > 0);
-					--nT;
-				}
+				if (nT > static_cast<unsigned int>(std::numeric_limits<int>::max() / 5)) { // the slots of the hash table are int
+                    LOG(ERROR) << "too many triangles: " << nT;
+                    fclose(in);
+                    return false;
+                }
+
+                // The triangles are fixed-size records (normal, three vertices, attribute byte count). They are read
+                // in blocks and the vertices of each block are decoded in parallel.
+                static const unsigned int record_size = 50;
+                static const unsigned int block_triangles = 1 << 20;
+                std::vector<char> buffer(static_cast<std::size_t>(std::min(nT, block_triangles)) * record_size);
+                corners.resize(static_cast<std::size_t>(nT) * 3);
+                for (unsigned int first = 0; first < nT; first += block_triangles) {
+                    const unsigned int num = std::min(block_triangles, nT - first);
+                    const std::size_t num_read = fread(buffer.data(), record_size, num, in);
+                    if (num_read != num) {
+                        LOG(WARNING) << "file is truncated: " << first + num_read << " out of " << nT << " triangles read";
+                        corners.resize(static_cast<std::size_t>(first + num_read) * 3);
+                        nT = static_cast<unsigned int>(first + num_read);
+                    }
+                    vec3* dest = corners.data() + static_cast<std::size_t>(first) * 3;
+#pragma omp parallel for
+                    for (int t = 0; t < static_cast<int>(num_read); ++t)
+                        std::memcpy(dest + 3 * t, buffer.data() + static_cast<std::size_t>(t) * record_size + 12, 36);
+                }
 			}
 
 
@@ -203,34 +277,15 @@ namespace easy3d {
 
 							// read x, y, z
 							sscanf(c + 6, "%f %f %f", &p[0], &p[1], &p[2]);
-
-							// has vector been referenced before?
-							if ((vMapIt = vMap.find(p)) == vMap.end())
-							{
-								// No : add vertex and remember idx/vector mapping
-								v = builder.add_vertex(p);
-								vertices[i] = v;
-								vMap[p] = v;
-							}
-							else
-							{
-								// Yes : get index from map
-								vertices[i] = vMapIt->second;
-							}
+							corners.push_back(p);
 						}
-
-						// Add face only if it is not degenerated
-						if ((vertices[0] != vertices[1]) &&
-							(vertices[0] != vertices[2]) &&
-							(vertices[1] != vertices[2]))
-							builder.add_face(vertices);
 					}
 				}
 			}
 
 			fclose(in);
 
-            builder.end_surface();
+            details::weld_and_build(corners, cell_size, mesh);
 			return mesh->n_faces() > 0;
 		}
 
@@ -34,6 +34,34 @@
 
 namespace easy3d {
 
+    namespace internal {
+        // the OpenGL formats of image data with 'comp' components (per pixel)
+        bool gl_pixel_format(int comp, GLenum &internal_format, GLenum &format) {
+            switch (comp) {
+                case 4:
+                    internal_format = GL_RGBA8;
+                    format = GL_RGBA;
+                    return true;
+                case 3:
+                    internal_format = GL_RGB8;
+                    format = GL_RGB;
+                    return true;
+                case 2:
+                    internal_format = GL_RG8;
+                    format = GL_RG;
+                    return true;
+                case 1:
+                    internal_format = GL_R8;
+                    format = GL_RED;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+    }
+    using namespace internal;
+
+
     Texture::Texture()
             : id_(0), name_(""), wrap_mode_(CLAMP_TO_EDGE), filter_mode_(LINEAR) {
         sizes_[0] = 0;
@@ -118,27 +146,9 @@ namespace easy3d {
         }
 
         GLenum internal_format, format;
-        switch (comp) {
-            case 4:
-                internal_format = GL_RGBA8;
-                format = GL_RGBA;
-                break;
-            case 3:
-                internal_format = GL_RGB8;
-                format = GL_RGB;
-                break;
-            case 2:
-                internal_format = GL_RG8;
-                format = GL_RG;
-                break;
-            case 1:
-                internal_format = GL_R8;
-                format = GL_RED;
-                break;
-            default: {
-                LOG(ERROR) << "invalid format";
-                return nullptr;
-            }
+        if (!gl_pixel_format(comp, internal_format, format)) {
+            LOG(ERROR) << "invalid format";
+            return nullptr;
         }
 
         glBindTexture(GL_TEXTURE_2D, tex);
@@ -181,6 +191,44 @@ namespace easy3d {
     }
 
 
+    bool Texture::upload_level(const std::vector<unsigned char> &data, int width, int height, int comp, int level,
+                               int num_levels, bool compressed) {
+        GLenum internal_format, format;
+        if (id_ == 0 || !gl_pixel_format(comp, internal_format, format) || (compressed && comp != 3 && comp != 4)) {
+            LOG(ERROR) << "invalid texture or format";
+            return false;
+        }
+
+        glBindTexture(GL_TEXTURE_2D, id_);
+        easy3d_debug_log_gl_error;
+
+        int align;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &align);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        if (compressed) {   // BC1 (i.e., S3TC DXT1) for RGB, and BC3 (i.e., S3TC DXT5) for RGBA
+            glCompressedTexImage2D(GL_TEXTURE_2D, level,
+                                   comp == 4 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+                                   width, height, 0, static_cast<GLsizei>(data.size()), data.data());
+        } else
+            glTexImage2D(GL_TEXTURE_2D, level, internal_format, width, height, 0, format, GL_UNSIGNED_BYTE, data.data());
+        easy3d_debug_log_gl_error;
+        // only the levels that have been uploaded (i.e., [level, num_levels - 1]) are used for sampling
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+        easy3d_debug_log_gl_error;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, num_levels - 1);
+        easy3d_debug_log_gl_error;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                        filter_mode_ == LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST);
+        easy3d_debug_log_gl_error;
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        easy3d_debug_log_gl_error;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, align);
+        return true;
+    }
+
+
     void Texture::bind(int unit) {
         glActiveTexture(GL_TEXTURE0 + unit);
         glBindTexture(GL_TEXTURE_2D, id_);
@@ -101,6 +101,12 @@ namespace easy3d {
         /** The creation of a texture is only allowed by using the create() function */
         Texture();
 
+        // Uploads a mip level (of an image having 'num_levels' levels) and makes it the finest level used for
+        // sampling. Used for progressive uploading, i.e., from the coarsest level to the finest one. If 'compressed'
+        // is true, the data is in BC1 (for RGB) or BC3 (for RGBA) format.
+        bool upload_level(const std::vector<unsigned char> &data, int width, int height, int comp, int level,
+                          int num_levels, bool compressed = false);
+
         //copying disabled
         Texture(const Texture &);
 
@@ -0,0 +1,664 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <easy3d/renderer/texture_decoder.h>
+
+#include <algorithm>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+
+#include <easy3d/fileio/image_io.h>
+#include <easy3d/util/file_system.h>
+#include <easy3d/util/logging.h>
+
+
+namespace easy3d {
+
+
+    std::size_t TextureDecoder::Image::size_in_bytes() const {
+        std::size_t size = 0;
+        for (const auto& level : levels)
+            size += level.size();
+        return size;
+    }
+
+
+    TextureDecoder::TextureDecoder(unsigned int num_threads, std::size_t capacity)
+            : num_threads_(num_threads)
+            , capacity_(capacity)
+            , cache_directory_capacity_(std::size_t(2) << 30)
+            , compression_(false)
+            , cache_size_(0)
+            , stop_(false)
+    {
+        if (num_threads_ == 0)
+            num_threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+
+    TextureDecoder::~TextureDecoder() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            files_.clear();
+        }
+        condition_.notify_all();
+        decoded_.notify_all();
+        for (auto& t : threads_)
+            t.join();
+    }
+
+
+    std::shared_ptr<TextureDecoder::Image> TextureDecoder::decode(const std::string& file_name) {
+        if (!file_system::is_file(file_name)) {
+            LOG(ERROR) << "file does not exist: " << file_name;
+            return nullptr;
+        }
+
+        std::shared_ptr<Image> image = std::make_shared<Image>();
+        image->levels.resize(1);
+        int width = 0, height = 0;
+        // flip the image vertically, so the first pixel in the output array is the bottom left
+        if (!ImageIO::load(file_name, image->levels[0], width, height, image->channels, 0, true) || image->levels[0].empty())
+            return nullptr;
+
+        image->widths.assign(1, width);
+        image->heights.assign(1, height);
+        generate_mipmaps(*image);
+        return image;
+    }
+
+
+    namespace details {
+
+        // reads the 4x4 block of pixels at (bx, by), repeating the last row/column for blocks crossing the border
+        void fetch_block(const std::vector<unsigned char>& src, int w, int h, int c, int bx, int by,
+                         unsigned char block[16][4]) {
+            for (int j = 0; j < 4; ++j) {
+                const int y = std::min(by * 4 + j, h - 1);
+                for (int i = 0; i < 4; ++i) {
+                    const int x = std::min(bx * 4 + i, w - 1);
+                    const unsigned char* p = src.data() + (static_cast<std::size_t>(y) * w + x) * c;
+                    for (int k = 0; k < 4; ++k)
+                        block[j * 4 + i][k] = (k < c) ? p[k] : 255;
+                }
+            }
+        }
+
+        inline unsigned short to_rgb565(const int rgb[3]) {
+            return static_cast<unsigned short>(((rgb[0] * 31 + 127) / 255) << 11 | ((rgb[1] * 63 + 127) / 255) << 5 |
+                                               ((rgb[2] * 31 + 127) / 255));
+        }
+
+        inline void from_rgb565(unsigned short v, int rgb[3]) {
+            const int r = (v >> 11) & 31, g = (v >> 5) & 63, b = v & 31;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+
+        // Encodes the colors of a block into 8 bytes of BC1 (the four-color mode). The end points are the two
+        // corners of the (slightly inset) bounding box of the colors on the diagonal that follows the correlation of
+        // the channels.
+        void encode_bc1_block(const unsigned char block[16][4], unsigned char* out) {
+            int lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+            for (int i = 0; i < 16; ++i) {
+                for (int k = 0; k < 3; ++k) {
+                    lo[k] = std::min(lo[k], static_cast<int>(block[i][k]));
+                    hi[k] = std::max(hi[k], static_cast<int>(block[i][k]));
+                }
+            }
+            for (int k = 0; k < 3; ++k) {
+                const int inset = (hi[k] - lo[k]) / 16;
+                lo[k] += inset;
+                hi[k] -= inset;
+            }
+
+            // the channel with the largest range is the reference. The range of another channel is flipped if it
+            // is negatively correlated with the reference.
+            int ref = 0;
+            for (int k = 1; k < 3; ++k) {
+                if (hi[k] - lo[k] > hi[ref] - lo[ref])
+                    ref = k;
+            }
+            int center[3];
+            for (int k = 0; k < 3; ++k)
+                center[k] = (lo[k] + hi[k]) / 2;
+            for (int k = 0; k < 3; ++k) {
+                if (k == ref)
+                    continue;
+                int covariance = 0;
+                for (int i = 0; i < 16; ++i)
+                    covariance += (block[i][ref] - center[ref]) * (block[i][k] - center[k]);
+                if (covariance < 0)
+                    std::swap(lo[k], hi[k]);
+            }
+
+            unsigned short c0 = to_rgb565(hi), c1 = to_rgb565(lo);
+            if (c0 < c1)
+                std::swap(c0, c1);
+
+            unsigned int indices = 0;
+            if (c0 != c1) {
+                int palette[4][3];
+                from_rgb565(c0, palette[0]);
+                from_rgb565(c1, palette[1]);
+                for (int k = 0; k < 3; ++k) {
+                    palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+                    palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+                }
+                for (int i = 0; i < 16; ++i) {
+                    int best = 0, best_dist = std::numeric_limits<int>::max();
+                    for (int p = 0; p < 4; ++p) {
+                        int dist = 0;
+                        for (int k = 0; k < 3; ++k) {
+                            const int d = static_cast<int>(block[i][k]) - palette[p][k];
+                            dist += d * d;
+                        }
+                        if (dist < best_dist) {
+                            best_dist = dist;
+                            best = p;
+                        }
+                    }
+                    indices |= static_cast<unsigned int>(best) << (2 * i);
+                }
+            }
+
+            out[0] = static_cast<unsigned char>(c0 & 0xff);
+            out[1] = static_cast<unsigned char>(c0 >> 8);
+            out[2] = static_cast<unsigned char>(c1 & 0xff);
+            out[3] = static_cast<unsigned char>(c1 >> 8);
+            for (int i = 0; i < 4; ++i)
+                out[4 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xff);
+        }
+
+        // Encodes the alpha values of a block into the 8-byte alpha part of BC3 (the eight-alpha mode).
+        void encode_bc3_alpha(const unsigned char block[16][4], unsigned char* out) {
+            int lo = 255, hi = 0;
+            for (int i = 0; i < 16; ++i) {
+                lo = std::min(lo, static_cast<int>(block[i][3]));
+                hi = std::max(hi, static_cast<int>(block[i][3]));
+            }
+
+            unsigned long long indices = 0;
+            if (hi > lo) {
+                int palette[8];
+                palette[0] = hi;
+                palette[1] = lo;
+                for (int p = 1; p < 7; ++p)
+                    palette[p + 1] = ((7 - p) * hi + p * lo) / 7;
+                for (int i = 0; i < 16; ++i) {
+                    int best = 0, best_dist = std::numeric_limits<int>::max();
+                    for (int p = 0; p < 8; ++p) {
+                        const int dist = std::abs(static_cast<int>(block[i][3]) - palette[p]);
+                        if (dist < best_dist) {
+                            best_dist = dist;
+                            best = p;
+                        }
+                    }
+                    indices |= static_cast<unsigned long long>(best) << (3 * i);
+                }
+            }
+
+            out[0] = static_cast<unsigned char>(hi);
+            out[1] = static_cast<unsigned char>(lo);
+            for (int i = 0; i < 6; ++i)
+                out[2 + i] = static_cast<unsigned char>((indices >> (8 * i)) & 0xff);
+        }
+
+
+        // The cache file of an image file: a header (magic, version, the full path and the time stamp of the
+        // image file), followed by the description and the data of each level.
+        const char cache_magic[8] = {'E', '3', 'D', 'T', 'E', 'X', '0', '1'};
+
+        std::string cache_file_name(const std::string& cache_directory, const std::string& file_name, bool compress) {
+            std::ostringstream name;
+            name << std::hex << std::hash<std::string>()(file_name);
+            return cache_directory + "/" + name.str() + (compress ? "-bc" : "") + ".tex";
+        }
+
+        template<typename T> void write_value(std::ostream& out, const T& v) {
+            out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+
+        template<typename T> bool read_value(std::istream& in, T& v) {
+            in.read(reinterpret_cast<char*>(&v), sizeof(T));
+            return !in.fail();
+        }
+
+        bool write_cache(const std::string& cache_file, const std::string& file_name, int64_t time_stamp,
+                         const TextureDecoder::Image& image) {
+            // write into a temporary file first, such that an incomplete cache file is never read. The name is unique
+            // to the writer, as other threads or processes may be writing the same cache file.
+            std::ostringstream suffix;
+            suffix << std::hex << (std::random_device()() ^ std::hash<std::thread::id>()(std::this_thread::get_id()));
+            const std::string temp_file = cache_file + "." + suffix.str() + ".tmp";
+            {
+                std::ofstream out(temp_file.c_str(), std::ios::binary);
+                if (out.fail())
+                    return false;
+                out.write(cache_magic, sizeof(cache_magic));
+                write_value(out, static_cast<uint32_t>(file_name.size()));
+                out.write(file_name.data(), static_cast<std::streamsize>(file_name.size()));
+                write_value(out, time_stamp);
+                write_value(out, static_cast<int32_t>(image.channels));
+                write_value(out, static_cast<int32_t>(image.compressed));
+                write_value(out, static_cast<int32_t>(image.levels.size()));
+                for (std::size_t i = 0; i < image.levels.size(); ++i) {
+                    write_value(out, static_cast<int32_t>(image.widths[i]));
+                    write_value(out, static_cast<int32_t>(image.heights[i]));
+                    write_value(out, static_cast<uint64_t>(image.levels[i].size()));
+                    out.write(reinterpret_cast<const char*>(image.levels[i].data()),
+                              static_cast<std::streamsize>(image.levels[i].size()));
+                }
+                if (out.fail()) {
+                    out.close();
+                    std::remove(temp_file.c_str());
+                    return false;
+                }
+            }
+            std::remove(cache_file.c_str());
+            if (std::rename(temp_file.c_str(), cache_file.c_str()) != 0) {
+                std::remove(temp_file.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        std::shared_ptr<TextureDecoder::Image> read_cache(const std::string& cache_file, const std::string& file_name,
+                                                          int64_t time_stamp) {
+            std::ifstream in(cache_file.c_str(), std::ios::binary);
+            if (in.fail())
+                return nullptr;
+
+            char magic[sizeof(cache_magic)];
+            in.read(magic, sizeof(magic));
+            uint32_t length = 0;
+            if (in.fail() || std::memcmp(magic, cache_magic, sizeof(magic)) != 0 || !read_value(in, length) ||
+                length != file_name.size())
+                return nullptr;
+            std::string name(length, '\0');
+            in.read(&name[0], length);
+            int64_t stamp = 0;
+            if (in.fail() || name != file_name || !read_value(in, stamp) || stamp != time_stamp)
+                return nullptr;  // a different image file, or the image file has been modified
+
+            std::shared_ptr<TextureDecoder::Image> image = std::make_shared<TextureDecoder::Image>();
+            int32_t channels = 0, compressed = 0, num_levels = 0;
+            if (!read_value(in, channels) || !read_value(in, compressed) || !read_value(in, num_levels) ||
+                num_levels <= 0 || num_levels > 32)
+                return nullptr;
+            image->channels = channels;
+            image->compressed = (compressed != 0);
+            image->levels.resize(num_levels);
+            for (int i = 0; i < num_levels; ++i) {
+                int32_t w = 0, h = 0;
+                uint64_t size = 0;
+                if (!read_value(in, w) || !read_value(in, h) || !read_value(in, size) || w <= 0 || h <= 0)
+                    return nullptr;
+                const uint64_t expected = image->compressed ?
+                        static_cast<uint64_t>((w + 3) / 4) * ((h + 3) / 4) * (channels == 4 ? 16 : 8) :
+                        static_cast<uint64_t>(w) * h * channels;
+                if (size != expected)
+                    return nullptr;
+                image->widths.push_back(w);
+                image->heights.push_back(h);
+                image->levels[i].resize(static_cast<std::size_t>(size));
+                in.read(reinterpret_cast<char*>(image->levels[i].data()), static_cast<std::streamsize>(size));
+                if (in.fail())
+                    return nullptr;
+            }
+            return image;
+        }
+
+    }
+
+
+    std::shared_ptr<TextureDecoder::Image> TextureDecoder::decode(const std::string& file_name,
+                                                                  const std::string& cache_directory, bool compress,
+                                                                  std::size_t cache_capacity) {
+        if (cache_directory.empty()) {
+            std::shared_ptr<Image> image = decode(file_name);
+            if (image && compress)
+                TextureDecoder::compress(*image);
+            return image;
+        }
+
+        if (!file_system::is_file(file_name)) {
+            LOG(ERROR) << "file does not exist: " << file_name;
+            return nullptr;
+        }
+
+        if (!file_system::is_directory(cache_directory))
+            file_system::create_directory(cache_directory);
+        const std::string cache_file = details::cache_file_name(cache_directory, file_name, compress);
+        const int64_t time_stamp = static_cast<int64_t>(file_system::time_stamp(file_name));
+        std::shared_ptr<Image> image = details::read_cache(cache_file, file_name, time_stamp);
+        if (image)
+            return image;
+
+        image = decode(file_name);
+        if (!image)
+            return nullptr;
+        if (compress)
+            TextureDecoder::compress(*image);
+        if (details::write_cache(cache_file, file_name, time_stamp, *image))
+            shrink_cache_directory(cache_directory, cache_capacity);
+        else
+            LOG(WARNING) << "failed writing texture cache file: " << cache_file;
+        return image;
+    }
+
+
+    void TextureDecoder::shrink_cache_directory(const std::string& cache_directory, std::size_t capacity) {
+        struct CacheFile {
+            std::string name;
+            time_t time;
+            std::size_t size;
+        };
+        std::vector<std::string> names;
+        file_system::get_files(cache_directory, names, false);
+        std::vector<CacheFile> files;
+        std::size_t total = 0;
+        for (const auto& name : names) {
+            if (file_system::extension(name) != "tex")
+                continue;   // not a cache file (e.g., a temporary one being written)
+            const std::string file = cache_directory + "/" + name;
+            const std::size_t size = static_cast<std::size_t>(file_system::file_size(file));
+            files.push_back({file, file_system::time_stamp(file), size});
+            total += size;
+        }
+        if (total <= capacity)
+            return;
+
+        // the oldest first
+        std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.time < b.time; });
+        for (std::size_t i = 0; i < files.size() && total > capacity; ++i) {
+            if (file_system::delete_file(files[i].name))
+                total -= files[i].size;
+        }
+    }
+
+
+    bool TextureDecoder::compress(Image& image) {
+        if (image.compressed || (image.channels != 3 && image.channels != 4))
+            return false;
+
+        const int block_size = (image.channels == 4) ? 16 : 8;
+        for (std::size_t i = 0; i < image.levels.size(); ++i) {
+            const int w = image.widths[i], h = image.heights[i];
+            const int nbx = (w + 3) / 4, nby = (h + 3) / 4;
+            const std::vector<unsigned char>& src = image.levels[i];
+            std::vector<unsigned char> dst(static_cast<std::size_t>(nbx) * nby * block_size);
+
+            // images are compressed by the worker threads, so each level is compressed sequentially
+            for (int by = 0; by < nby; ++by) {
+                unsigned char block[16][4];
+                for (int bx = 0; bx < nbx; ++bx) {
+                    details::fetch_block(src, w, h, image.channels, bx, by, block);
+                    unsigned char* out = dst.data() + (static_cast<std::size_t>(by) * nbx + bx) * block_size;
+                    if (image.channels == 4) {
+                        details::encode_bc3_alpha(block, out);
+                        out += 8;
+                    }
+                    details::encode_bc1_block(block, out);
+                }
+            }
+            image.levels[i].swap(dst);
+        }
+        image.compressed = true;
+        return true;
+    }
+
+
+    void TextureDecoder::set_cache_directory(const std::string& dir, std::size_t capacity) {
+        std::string directory = dir;
+        if (!dir.empty() && !file_system::is_directory(dir) && !file_system::create_directory(dir)) {
+            LOG(WARNING) << "failed creating texture cache directory: " << dir << " (disk cache disabled)";
+            directory.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_directory_ = directory;
+        cache_directory_capacity_ = capacity;
+    }
+
+
+    void TextureDecoder::set_compression(bool b) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        compression_ = b;
+    }
+
+
+    void TextureDecoder::generate_mipmaps(Image& image) {
+        if (image.compressed) {
+            LOG(ERROR) << "cannot generate mip levels for a compressed image";
+            return;
+        }
+        image.levels.resize(1);
+        image.widths.resize(1);
+        image.heights.resize(1);
+
+        const int c = image.channels;
+        while (image.widths.back() > 1 || image.heights.back() > 1) {
+            const int w = image.widths.back(), h = image.heights.back();
+            const int nw = std::max(1, w / 2), nh = std::max(1, h / 2);
+            const std::vector<unsigned char>& src = image.levels.back();
+            std::vector<unsigned char> dst(static_cast<std::size_t>(nw) * nh * c);
+
+            // each pixel of the new level averages a block of 2x2 pixels (3 for the last row/column of odd sizes)
+            for (int y = 0; y < nh; ++y) {
+                const int y0 = std::min(2 * y, h - 1);
+                const int y1 = (y == nh - 1) ? h - 1 : std::min(2 * y + 1, h - 1);
+                for (int x = 0; x < nw; ++x) {
+                    const int x0 = std::min(2 * x, w - 1);
+                    const int x1 = (x == nw - 1) ? w - 1 : std::min(2 * x + 1, w - 1);
+                    for (int k = 0; k < c; ++k) {
+                        unsigned int sum = 0, count = 0;
+                        for (int j = y0; j <= y1; ++j) {
+                            for (int i = x0; i <= x1; ++i) {
+                                sum += src[(static_cast<std::size_t>(j) * w + i) * c + k];
+                                ++count;
+                            }
+                        }
+                        dst[(static_cast<std::size_t>(y) * nw + x) * c + k] = static_cast<unsigned char>((sum + count / 2) / count);
+                    }
+                }
+            }
+
+            image.levels.push_back(std::move(dst));
+            image.widths.push_back(nw);
+            image.heights.push_back(nh);
+        }
+    }
+
+
+    void TextureDecoder::request(const std::string& file_name, bool pin) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto pos = entries_.find(file_name);
+            if (pos != entries_.end() && pos->second.status != NONE) {
+                Entry& entry = pos->second;
+                if (pin && !entry.pinned) {
+                    entry.pinned = true;
+                    if (entry.status == READY)
+                        lru_.erase(entry.lru_pos);
+                }
+                return;
+            }
+            Entry& entry = entries_[file_name];
+            entry.status = PENDING;
+            entry.pinned = pin;
+            files_.push_back(file_name);
+        }
+        condition_.notify_one();
+
+        // the workers are created on demand
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threads_.size() < num_threads_ && threads_.size() < files_.size() + 1)
+            threads_.emplace_back(&TextureDecoder::worker, this);
+    }
+
+
+    void TextureDecoder::unpin(const std::string& file_name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto pos = entries_.find(file_name);
+        if (pos == entries_.end() || !pos->second.pinned)
+            return;
+        Entry& entry = pos->second;
+        entry.pinned = false;
+        if (entry.status == READY) {
+            lru_.push_front(file_name);
+            entry.lru_pos = lru_.begin();
+            shrink_cache();
+        }
+    }
+
+
+    void TextureDecoder::set_callback(const std::function<void()>& func) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback_ = func;
+    }
+
+
+    TextureDecoder::Status TextureDecoder::status(const std::string& file_name) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto pos = entries_.find(file_name);
+        return pos == entries_.end() ? NONE : pos->second.status;
+    }
+
+
+    std::shared_ptr<const TextureDecoder::Image> TextureDecoder::get(const std::string& file_name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto pos = entries_.find(file_name);
+        if (pos == entries_.end() || pos->second.status != READY)
+            return nullptr;
+        if (!pos->second.pinned)
+            lru_.splice(lru_.begin(), lru_, pos->second.lru_pos);
+        return pos->second.image;
+    }
+
+
+    std::shared_ptr<const TextureDecoder::Image> TextureDecoder::wait(const std::string& file_name) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        decoded_.wait(lock, [&]() {
+            auto pos = entries_.find(file_name);
+            return stop_ || pos == entries_.end() || pos->second.status != PENDING;
+        });
+        auto pos = entries_.find(file_name);
+        if (pos == entries_.end() || pos->second.status != READY)
+            return nullptr;
+        if (!pos->second.pinned)
+            lru_.splice(lru_.begin(), lru_, pos->second.lru_pos);
+        return pos->second.image;
+    }
+
+
+    void TextureDecoder::evict(const std::string& file_name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto pos = entries_.find(file_name);
+        if (pos == entries_.end() || pos->second.status == PENDING)
+            return;
+        if (pos->second.status == READY) {
+            cache_size_ -= pos->second.image->size_in_bytes();
+            if (!pos->second.pinned)
+                lru_.erase(pos->second.lru_pos);
+        }
+        entries_.erase(pos);
+    }
+
+
+    std::size_t TextureDecoder::cache_size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache_size_;
+    }
+
+
+    void TextureDecoder::shrink_cache() {
+        // the most recently decoded image (at the front) is always kept
+        while (cache_size_ > capacity_ && lru_.size() > 1) {
+            auto pos = entries_.find(lru_.back());
+            cache_size_ -= pos->second.image->size_in_bytes();
+            entries_.erase(pos);
+            lru_.pop_back();
+        }
+    }
+
+
+    void TextureDecoder::worker() {
+        while (true) {
+            std::string file_name;
+            // a copy of the settings, which may be changed while the image is being decoded
+            std::string cache_directory;
+            std::size_t cache_capacity;
+            bool compress;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this]() { return stop_ || !files_.empty(); });
+                if (stop_)
+                    return;
+                file_name = files_.front();
+                files_.pop_front();
+                cache_directory = cache_directory_;
+                cache_capacity = cache_directory_capacity_;
+                compress = compression_;
+            }
+
+            std::shared_ptr<const Image> image = decode(file_name, cache_directory, compress, cache_capacity);
+            if (!image)
+                LOG(WARNING) << "failed decoding image file: " << file_name;
+
+            std::function<void()> callback;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Entry& entry = entries_[file_name];
+                if (image) {
+                    entry.status = READY;
+                    entry.image = image;
+                    cache_size_ += image->size_in_bytes();
+                    if (!entry.pinned) {
+                        lru_.push_front(file_name);
+                        entry.lru_pos = lru_.begin();
+                    }
+                    shrink_cache();
+                } else
+                    entry.status = FAILED;
+                callback = callback_;   // a copy, so it can be called without locking the mutex
+            }
+            decoded_.notify_all();
+
+            if (callback)
+                callback();
+        }
+    }
+
+} // namespace easy3d
@@ -0,0 +1,216 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#ifndef EASY3D_RENDERER_TEXTURE_DECODER_H
+#define EASY3D_RENDERER_TEXTURE_DECODER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+namespace easy3d {
+
+    /**
+     * \brief Decodes image files into mipmap pyramids in background threads, and keeps the results in a cache of
+     *      bounded size.
+     * \class TextureDecoder easy3d/renderer/texture_decoder.h
+     * \details Decoding an image and generating its mip levels do not involve OpenGL, so they are done by a pool of
+     *      worker threads. The rendering thread polls the decoded images (see get()) and uploads them to the GPU.
+     *      When the total size of the cached images exceeds the capacity, the least recently used images are
+     *      evicted from the cache (images still referenced by the callers stay valid). Images requested with
+     *      \p pin set to true (e.g., images that are waiting to be uploaded) are never evicted this way, until they
+     *      are unpinned or explicitly evicted.
+     *
+     *      The decoded mip levels can also be cached on disk (see set_cache_directory()), such that reopening the
+     *      same images skips decoding entirely. A cache file is identified by the full path of the image file and
+     *      is valid as long as the image file is not modified. The total size of the cache files is bounded (the
+     *      oldest files are deleted first). Optionally (see set_compression()), RGB and RGBA
+     *      images are block-compressed (into BC1 and BC3, i.e., S3TC DXT1 and DXT5, respectively), which reduces
+     *      the GPU memory by a factor of 6 and 4, respectively.
+     *
+     *      Example usage:
+     *      \code
+     *          TextureDecoder decoder;
+     *          decoder.request(file_name, true);
+     *          ...
+     *          // in the rendering thread, e.g., before drawing each frame
+     *          std::shared_ptr<const TextureDecoder::Image> image = decoder.get(file_name);
+     *          if (image) {
+     *              ... upload the levels, from image->levels.back() to image->levels.front() ...
+     *              decoder.evict(file_name);
+     *          }
+     *      \endcode
+     */
+    class TextureDecoder {
+    public:
+        /// A decoded image and its mip levels.
+        struct Image {
+            int channels;
+            /// The width and height of each level. Level 0 is the original image, and each following level halves the
+            /// size of the previous one (at least 1 pixel) until a 1x1 level.
+            std::vector<int> widths;
+            std::vector<int> heights;
+            /// The pixels of each level. The first pixel is the bottom-left one.
+            std::vector< std::vector<unsigned char> > levels;
+            /// If true, each level is stored as 4x4 blocks in BC1 (for 3 channels) or BC3 (for 4 channels) format.
+            bool compressed = false;
+
+            /// The memory (in bytes) of all the levels.
+            std::size_t size_in_bytes() const;
+        };
+
+        /// The status of an image file.
+        enum Status { NONE, PENDING, READY, FAILED };
+
+        /// \param num_threads The number of worker threads. Use 0 for the number of hardware threads.
+        /// \param capacity The maximum memory (in bytes) of the cached images.
+        explicit TextureDecoder(unsigned int num_threads = 0, std::size_t capacity = std::size_t(1) << 30);
+        /// Discards the pending requests and waits for the images being decoded.
+        ~TextureDecoder();
+
+        /**
+         * \brief Decodes an image file and generates its mip levels (in the calling thread).
+         * \return The decoded image, or nullptr if the file could not be read.
+         */
+        static std::shared_ptr<Image> decode(const std::string& file_name);
+
+        /**
+         * \brief Decodes an image file (in the calling thread) using the disk cache.
+         * \details If a valid cache file of the image exists in \p cache_directory, the levels are read from it.
+         *      Otherwise, the image is decoded (and compressed if \p compress is true), and the result is written
+         *      into the cache, which is then shrunk to \p cache_capacity (see shrink_cache_directory()).
+         * \return The decoded image, or nullptr if the file could not be read.
+         */
+        static std::shared_ptr<Image> decode(const std::string& file_name, const std::string& cache_directory,
+                                             bool compress, std::size_t cache_capacity = std::size_t(2) << 30);
+
+        /**
+         * \brief Deletes the oldest (i.e., least recently written) cache files in \p cache_directory until the total
+         *      size of the cache files is within \p capacity (in bytes).
+         */
+        static void shrink_cache_directory(const std::string& cache_directory, std::size_t capacity);
+
+        /**
+         * \brief Generates the mip levels of an image that has only level 0, using a 2x2 box filter (the last
+         *      row/column of a level with an odd size is merged into the previous one).
+         */
+        static void generate_mipmaps(Image& image);
+
+        /**
+         * \brief Compresses all the levels of an RGB (into BC1) or RGBA (into BC3) image. Images with other numbers
+         *      of channels are not compressed.
+         * \return true if the image has been compressed.
+         */
+        static bool compress(Image& image);
+
+        /// Sets the directory for caching the decoded images on disk (created if it does not exist), and the maximum
+        /// total size (in bytes) of the cache files. An empty string (default) disables the disk cache. It takes
+        /// effect for the images decoded after this call.
+        void set_cache_directory(const std::string& dir, std::size_t capacity = std::size_t(2) << 30);
+        /// Enables/Disables the compression of the decoded images. Default: disabled. It takes effect for the images
+        /// decoded after this call.
+        void set_compression(bool b);
+
+        /**
+         * \brief Queues an image file to be decoded in the background, unless it is already cached or pending.
+         * \param pin If true, the decoded image is not evicted when the cache exceeds its capacity, until it is
+         *      unpinned (see unpin()) or evicted (see evict()). This guarantees that an image is still available when
+         *      the caller gets to consume it.
+         */
+        void request(const std::string& file_name, bool pin = false);
+
+        /// Unpins an image (see request()), such that it can be evicted when the cache exceeds its capacity.
+        void unpin(const std::string& file_name);
+
+        /// Returns the status of an image file.
+        Status status(const std::string& file_name) const;
+
+        /// Returns the decoded image if it is ready (nullptr otherwise), and marks it as recently used.
+        std::shared_ptr<const Image> get(const std::string& file_name);
+
+        /// Waits until an image file is decoded, and returns the image (nullptr if decoding failed or the file
+        /// has not been requested).
+        std::shared_ptr<const Image> wait(const std::string& file_name);
+
+        /// Removes an image from the cache (e.g., after it has been uploaded and won't be requested again).
+        void evict(const std::string& file_name);
+
+        /// The memory (in bytes) of the cached images.
+        std::size_t cache_size() const;
+
+        /**
+         * \brief Sets a function to be called each time an image has been decoded, e.g., to wake up the rendering
+         *      thread. It takes effect for the images decoded after this call.
+         * \attention The function is called from the worker threads.
+         */
+        void set_callback(const std::function<void()>& func);
+
+    private:
+        void worker();
+        // evicts the least recently used (unpinned) images until the cache fits in its capacity. The mutex must be
+        // locked.
+        void shrink_cache();
+
+    private:
+        struct Entry {
+            Status status;
+            std::shared_ptr<const Image> image;
+            bool pinned = false;                        // pinned images are not in the LRU list
+            std::list<std::string>::iterator lru_pos;   // valid only if ready and not pinned
+        };
+
+        unsigned int num_threads_;
+        std::size_t capacity_;
+        std::string cache_directory_;       // the disk cache settings are protected by the mutex
+        std::size_t cache_directory_capacity_;
+        bool compression_;
+        std::vector<std::thread> threads_;
+
+        std::deque<std::string> files_;     // files to be decoded
+        std::unordered_map<std::string, Entry> entries_;
+        std::list<std::string> lru_;        // ready (unpinned) images, the most recently used first
+        std::size_t cache_size_;
+        bool stop_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable condition_;     // for the workers
+        std::condition_variable decoded_;       // for wait()
+
+        std::function<void()> callback_;    // protected by the mutex
+    };
+
+} // namespace easy3d
+
+
+#endif  // EASY3D_RENDERER_TEXTURE_DECODER_H
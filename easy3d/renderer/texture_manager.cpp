@@ -25,6 +25,8 @@
  ********************************************************************/
 
 #include <easy3d/renderer/texture_manager.h>
+#include <easy3d/renderer/texture_decoder.h>
+#include <easy3d/renderer/opengl.h>
 #include <easy3d/fileio/image_io.h>
 #include <easy3d/core/random.h>
 #include <easy3d/util/logging.h>
@@ -36,6 +38,12 @@ namespace easy3d {
 
     std::unordered_map<std::string, Texture *>    TextureManager::textures_;
     std::unordered_map<std::string, bool>        TextureManager::attempt_load_texture_; // avoid multiple attempt
+    TextureDecoder*                              TextureManager::decoder_ = nullptr;
+    std::string                                  TextureManager::cache_directory_;
+    std::size_t                                  TextureManager::cache_capacity_ = std::size_t(2) << 30;
+    bool                                         TextureManager::compression_ = false;
+    std::vector<TextureManager::PendingTexture>  TextureManager::pending_;
+    std::function<void()>                        TextureManager::callback_;
 
 
     Texture* TextureManager::request(const std::string &image_file, Texture::WrapMode wrap, Texture::FilterMode filter) {
@@ -135,7 +143,125 @@ namespace easy3d {
         }
     }
 
+    Texture* TextureManager::request_async(const std::string &image_file, Texture::WrapMode wrap, Texture::FilterMode filter) {
+        std::unordered_map<std::string, Texture *>::iterator pos = textures_.find(image_file);
+        if (pos != textures_.end()) // texture already exists
+            return pos->second;
+
+        if (!file_system::is_file(image_file)) {
+            LOG(ERROR) << "file does not exist: " << image_file;
+            return nullptr;
+        }
+
+        // a 1x1 (light gray) placeholder until the image is decoded
+        Texture *texture = Texture::create(std::vector<unsigned char>(4, 200), 1, 1, 4, wrap, filter);
+        if (!texture) {
+            LOG(ERROR) << "failed creating texture for image file: " << image_file;
+            return nullptr;
+        }
+        texture->name_ = image_file;
+        textures_[image_file] = texture;
+
+        if (!decoder_) {
+            decoder_ = new TextureDecoder;
+            decoder_->set_callback(callback_);
+            decoder_->set_cache_directory(cache_directory_, cache_capacity_);
+            decoder_->set_compression(compression_);
+        }
+        // pinned: the decoded image stays in the cache until upload_pending() has uploaded it
+        decoder_->request(image_file, true);
+        pending_.push_back({texture, -1});
+        return texture;
+    }
+
+
+    bool TextureManager::upload_pending(std::size_t max_bytes) {
+        if (pending_.empty())
+            return false;
+
+        std::size_t uploaded = 0;
+        bool more = false;
+        for (std::size_t i = 0; i < pending_.size();) {
+            PendingTexture &p = pending_[i];
+            const std::string &file = p.texture->name();
+            if (decoder_->status(file) == TextureDecoder::FAILED) {
+                LOG(ERROR) << "failed creating texture from image file: " << file;
+                decoder_->evict(file);
+                pending_.erase(pending_.begin() + i);
+                continue;
+            }
+
+            std::shared_ptr<const TextureDecoder::Image> image = decoder_->get(file);
+            if (!image) {
+                ++i;
+                continue;
+            }
+
+            if (p.next_level < 0) {
+                p.next_level = static_cast<int>(image->levels.size()) - 1;
+                p.texture->sizes_[0] = image->widths[0];
+                p.texture->sizes_[1] = image->heights[0];
+                p.texture->sizes_[2] = image->channels;
+            }
+
+            // the coarsest levels first
+            while (p.next_level >= 0 && (uploaded == 0 || uploaded + image->levels[p.next_level].size() <= max_bytes)) {
+                const int level = p.next_level;
+                p.texture->upload_level(image->levels[level], image->widths[level], image->heights[level],
+                                        image->channels, level, static_cast<int>(image->levels.size()),
+                                        image->compressed);
+                uploaded += image->levels[level].size();
+                --p.next_level;
+            }
+
+            if (p.next_level < 0) { // completed: the decoded image is not needed anymore
+                LOG(INFO) << "a texture (id " << p.texture->id() << ") generated from image \'"
+                          << file_system::simple_name(file) << "\'";
+                decoder_->evict(file);
+                pending_.erase(pending_.begin() + i);
+            } else {
+                more = true;
+                break;  // the budget has been used up
+            }
+        }
+        return more;
+    }
+
+
+    void TextureManager::set_cache_directory(const std::string &dir, bool compression, std::size_t capacity) {
+        cache_directory_ = dir;
+        cache_capacity_ = capacity;
+        compression_ = compression;
+        if (compression_ && !GLEW_EXT_texture_compression_s3tc) {
+            LOG(WARNING) << "S3TC texture compression is not supported (compression disabled)";
+            compression_ = false;
+        }
+
+        // the images that haven't been decoded yet will use the new settings
+        if (decoder_) {
+            decoder_->set_cache_directory(cache_directory_, cache_capacity_);
+            decoder_->set_compression(compression_);
+        }
+    }
+
+
+    void TextureManager::set_callback(const std::function<void()> &func) {
+        callback_ = func;
+        if (decoder_)
+            decoder_->set_callback(func);
+    }
+
+
     void TextureManager::release(const Texture* texture) {
+        for (std::size_t i = 0; i < pending_.size(); ++i) {
+            if (pending_[i].texture == texture) {
+                // the decoded image is not needed anymore (if still being decoded, it can be evicted later)
+                decoder_->unpin(texture->name());
+                decoder_->evict(texture->name());
+                pending_.erase(pending_.begin() + i);
+                break;
+            }
+        }
         for (auto p : textures_) {
             if (p.second == texture) {
                 textures_.erase(texture->name());
@@ -148,6 +274,14 @@ namespace easy3d {
 
 
     void TextureManager::terminate() {
+        delete decoder_;   // waits for the images being decoded
+        decoder_ = nullptr;
+        pending_.clear();
+        callback_ = nullptr;
+        cache_directory_.clear();
+        cache_capacity_ = std::size_t(2) << 30;
+        compression_ = false;
+
         for (auto p : textures_)
             delete p.second;
         textures_.clear();
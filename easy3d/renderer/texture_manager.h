@@ -29,7 +29,9 @@
 
 
 #include <string>
+#include <vector>
 #include <unordered_map>
+#include <functional>
 
 #include <easy3d/renderer/texture.h>
 
@@ -37,6 +39,7 @@
 namespace easy3d {
 
     class Texture;
+    class TextureDecoder;
 
     /**
      * \brief Management of OpenGL textures.
@@ -98,6 +101,53 @@ namespace easy3d {
                                 Texture::WrapMode wrap = Texture::CLAMP_TO_EDGE,
                                 Texture::FilterMode filter = Texture::LINEAR);
 
+        /**
+         * @brief Request a texture from the image file, without waiting for the image to be decoded.
+         * @details The image is decoded (and its mip levels are generated) in a background thread. The returned
+         *          texture is a 1x1 placeholder until the decoded levels are uploaded by upload_pending(), from the
+         *          coarsest level to the finest one. Like request(), the texture has a unique identifier of its
+         *          full-path file name, and no new texture will be generated if it is requested again.
+         * @param image_file The full path to the image file.
+         * @param wrap The wrap mode.
+         * @param filter The filter mode.
+         * @return The texture (a placeholder until its image has been decoded).
+         */
+        static Texture *request_async(const std::string &image_file,
+                                      Texture::WrapMode wrap = Texture::CLAMP_TO_EDGE,
+                                      Texture::FilterMode filter = Texture::LINEAR);
+
+        /**
+         * @brief Uploads the decoded mip levels of the textures requested by request_async(). It must be called from
+         *        the rendering thread (with the OpenGL context current), e.g., before drawing each frame.
+         * @param max_bytes The maximum amount of data to upload in this call (at least one level is uploaded if
+         *        there is any), such that the rendering thread keeps responding.
+         * @return true if there are still decoded levels to be uploaded (i.e., the caller should call this function
+         *         again in the next frame).
+         */
+        static bool upload_pending(std::size_t max_bytes = 64 * 1024 * 1024);
+
+        /**
+         * @brief Sets the directory for caching the decoded (and optionally compressed) mip levels of the images
+         *        requested by request_async(). Reopening the same images then skips decoding entirely. The cache of an
+         *        image becomes invalid when the image file is modified. An empty string (default) disables the cache.
+         * @param dir The cache directory (created if it does not exist).
+         * @param compression If true, RGB and RGBA images are block-compressed (BC1 and BC3, respectively), which
+         *        reduces the GPU memory by a factor of 6 and 4, respectively. It is ignored if the OpenGL
+         *        implementation does not support S3TC.
+         * @param capacity The maximum total size (in bytes) of the cache files. The oldest files are deleted first.
+         * @note The settings take effect for the images decoded after this call. They are reset by terminate().
+         * @attention It must be called with the OpenGL context current.
+         */
+        static void set_cache_directory(const std::string &dir, bool compression = false,
+                                        std::size_t capacity = std::size_t(2) << 30);
+
+        /**
+         * @brief Sets a function to be called each time an image requested by request_async() has been decoded,
+         *        e.g., to wake up the rendering thread. It takes effect for the images decoded after this call.
+         * @attention The function is called from the decoding threads.
+         */
+        static void set_callback(const std::function<void()> &func);
+
         /**
          * Release a texture (deallocate its memory).
          * @param texture The texture to be released.
@@ -112,6 +162,18 @@ namespace easy3d {
         // as find forces construction/copy/destruction of a std::sting copy of the const char*.
         static std::unordered_map<std::string, Texture *> textures_;
         static std::unordered_map<std::string, bool> attempt_load_texture_; // avoid multiple attempt
+
+        // asynchronous loading
+        struct PendingTexture {
+            Texture *texture;
+            int next_level;     // the next level to be uploaded (-1 if the image hasn't been decoded)
+        };
+        static TextureDecoder *decoder_;
+        static std::string cache_directory_;
+        static std::size_t cache_capacity_;
+        static bool compression_;
+        static std::vector<PendingTexture> pending_;
+        static std::function<void()> callback_;
     };
 
 
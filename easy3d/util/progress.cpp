@@ -13,6 +13,8 @@
 
 #include <cassert>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 
 namespace easy3d {
@@ -26,7 +28,10 @@ namespace easy3d {
 
             virtual void notify(std::size_t percent, bool update_viewer);
 
-            void set_client(ProgressClient *c) { client_ = c; }
+            void set_client(ProgressClient *c) {
+                client_ = c;
+                client_thread_ = std::this_thread::get_id();
+            }
 
             void push();
             void pop();
@@ -40,9 +45,14 @@ namespace easy3d {
 
             virtual ~Progress() {}
 
+            // The progress is reported only by the thread that created the client (usually the GUI thread), so
+            // tasks running on worker threads (e.g., loading files in the background) never touch the GUI.
+            bool is_client_thread() const { return std::this_thread::get_id() == client_thread_; }
+
             ProgressClient *client_;
+            std::thread::id client_thread_;
             int level_;
-            bool canceled_;
+            std::atomic<bool> canceled_;
         };
 
         Progress* Progress::instance() {
@@ -51,6 +61,8 @@ namespace easy3d {
         }
 
         void Progress::push() {
+            if (!is_client_thread())
+                return;
             level_++;
             if (level_ == 1) {
                 clear_canceled();
@@ -58,12 +70,14 @@ namespace easy3d {
         }
 
         void Progress::pop() {
+            if (!is_client_thread())
+                return;
             assert(level_ > 0);
             level_--;
         }
 
         void Progress::notify(std::size_t percent, bool update_viewer) {
-            if (client_ != nullptr && level_ < 2)
+            if (client_ != nullptr && level_ < 2 && is_client_thread())
                 client_->notify(percent, update_viewer);
         }
     }
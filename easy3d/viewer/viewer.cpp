@@ -65,8 +65,7 @@
 #include <easy3d/fileio/graph_io.h>
 #include <easy3d/fileio/surface_mesh_io.h>
 #include <easy3d/fileio/poly_mesh_io.h>
-#include <easy3d/fileio/ply_reader_writer.h>
-#include <easy3d/fileio/point_cloud_io_ptx.h>
+#include <easy3d/fileio/scene_loader.h>
 #include <easy3d/util/dialogs.h>
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/logging.h>
@@ -121,6 +120,7 @@ namespace easy3d {
         , drawable_axes_(nullptr)
         , show_camera_path_(false)
         , model_idx_(-1)
+        , scene_loader_(nullptr)
     {
         // Avoid locale-related number parsing issues.
         setlocale(LC_NUMERIC, "C");
@@ -149,6 +149,9 @@ namespace easy3d {
         kfi_ = new KeyFrameInterpolator(camera_->frame());
         easy3d::connect(&kfi_->interpolation_stopped, this, &Viewer::update);
 
+        // textures requested by TextureManager::request_async() are uploaded when drawing the next frame
+        TextureManager::set_callback([this]() { update(); });
+
         sprintf(gpu_time_, "fps: ?? (?? ms/frame)");
 
         /* Poll for events once before starting a potentially lengthy loading process.*/
@@ -535,6 +538,10 @@ namespace easy3d {
         if (!window_)
             return;
 
+        // stop loading before the scene is destroyed
+        delete scene_loader_;
+        scene_loader_ = nullptr;
+
         delete camera_;
         delete kfi_;
         delete drawable_axes_;
@@ -979,6 +986,11 @@ namespace easy3d {
 
 
     bool Viewer::drop_event(const std::vector<std::string> &filenames) {
+        if (filenames.size() > 1) {
+            add_models(filenames);
+            return true;
+        }
+
         int count = 0;
         for (auto &name : filenames) {
             if (add_model(name))
@@ -1053,6 +1065,10 @@ namespace easy3d {
                     }
                 }
 
+                add_loaded_models();
+                if (TextureManager::upload_pending())
+                    update();   // continue uploading in the next frame
+
                 pre_draw();
                 draw();
                 post_draw();
@@ -1194,37 +1210,12 @@ namespace easy3d {
             }
         }
 
-        const std::string &ext = file_system::extension(file_name, true);
-        bool is_ply_mesh = false;
-        if (ext == "ply")
-            is_ply_mesh = (io::PlyReader::num_instances(file_name, "face") > 0);
-
         Model *model = nullptr;
-        if ((ext == "ply" && is_ply_mesh) || ext == "obj" || ext == "off" || ext == "stl" || ext == "sm" || ext == "geojson" || ext == "trilist") { // mesh
-            model = SurfaceMeshIO::load(file_name);
-        } else if (ext == "ply" && io::PlyReader::num_instances(file_name, "edge") > 0) {
-            model = GraphIO::load(file_name);
-        } else if (ext == "plm" || ext == "pm" || ext == "mesh") {
-            model = PolyMeshIO::load(file_name);
-        }
-        else { // point cloud
-            if (ext == "ptx") {
-                io::PointCloudIO_ptx serializer(file_name);
-                PointCloud *cloud = nullptr;
-                while ((cloud = serializer.load_next())) {
-                    model = add_model(cloud, create_default_drawables);
-                    update();
-                }
-                return model;   // returns the last cloud in the file.
-            } else
-                model = PointCloudIO::load(file_name);
-        }
-
-        if (model) {
-            model->set_name(file_name);
-            add_model(model, create_default_drawables);
+        for (auto m : SceneLoader::load(file_name)) {
+            model = add_model(m, create_default_drawables);
+            update();
         }
-        return model;
+        return model;   // returns the last model if the file contains multiple models (e.g., PTX).
     }
 
 
@@ -1257,6 +1248,56 @@ namespace easy3d {
     }
 
 
+    void Viewer::add_models(const std::vector<std::string> &file_names) {
+        std::vector<std::string> names;
+        for (const auto &file_path : file_names) {
+            const std::string file_name = file_system::convert_to_native_style(file_path);
+            bool exists = false;
+            for (auto m : models_) {
+                if (m->name() == file_name) {
+                    LOG(WARNING) << "model has already been added to the viewer: " << file_name;
+                    exists = true;
+                    break;
+                }
+            }
+            if (!exists)
+                names.push_back(file_name);
+        }
+        if (names.empty())
+            return;
+
+        if (!scene_loader_) {
+            scene_loader_ = new SceneLoader;
+            scene_loader_->set_callback([this]() { update(); });
+        }
+        LOG(INFO) << "loading " << names.size() << " files in the background...";
+        scene_loader_->add(names);
+    }
+
+
+    void Viewer::add_loaded_models() {
+        if (!scene_loader_)
+            return;
+
+        // Drawables are created and the data is uploaded to the GPU (when drawing) only for a limited number of
+        // points per frame, such that the viewer keeps responding.
+        static const std::size_t max_num_points_per_frame = 4000000;
+        const std::vector<Model *> &models = scene_loader_->take(max_num_points_per_frame);
+        if (models.empty())
+            return;
+
+        for (auto model : models)
+            add_model(model, true);
+
+        if (scene_loader_->is_idle()) {
+            LOG(INFO) << "all files loaded (" << models_.size() << " models in the scene)";
+            fit_screen();
+        }
+        else
+            update();   // continue with the next batch in the next frame
+    }
+
+
     bool Viewer::delete_model(Model *model) {
         if (!model) {
             LOG(WARNING) << "model is NULL.";
@@ -1361,9 +1402,14 @@ namespace easy3d {
                 "Point Cloud (*.bin *.ply *.xyz *.bxyz *.las *.laz *.vg *.bvg *.ptx)", "*.bin *.ply *.xyz *.bxyz *.las *.laz *.vg *.bvg *.ptx",
                 "Polyhedral Mesh (*.plm *.pm *.mesh)", "*.plm *.pm *.mesh",
                 "Graph (*.ply)", "*.ply",
+                "Easy3D native format (*.e3d)", "*.e3d",
                 "All Files (*.*)", "*"
         };
         const std::vector<std::string> &file_names = dialog::open(title, default_path, filters, true);
+        if (file_names.size() > 1) {
+            add_models(file_names);
+            return true;
+        }
 
         int count = 0;
         for (const auto &file_name : file_names) {
@@ -1393,6 +1439,7 @@ namespace easy3d {
                 "*.bin *.ply *.xyz *.bxyz *.las *.laz *.vg *.bvg",
                 "Polyhedral Mesh (*.plm *.pm *.mesh)", "*.plm *.pm *.mesh",
                 "Graph (*.ply)", "*.ply",
+                "Easy3D native format (*.e3d)", "*.e3d",
                 "All Files (*.*)", "*"
         };
 
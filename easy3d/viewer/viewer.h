@@ -44,6 +44,7 @@ namespace easy3d {
     class TrianglesDrawable;
     class TextRenderer;
     class KeyFrameInterpolator;
+    class SceneLoader;
 
     /**
      * @brief The built-in Easy3D Viewer.
@@ -227,6 +228,18 @@ namespace easy3d {
          */
         virtual Model* add_model(Model* model, bool create_default_drawables = true);
 
+        /**
+         * @brief Add models from files to the viewer in the background. On success, the viewer will be in charge
+         *        of the memory management of the models.
+         * @details The files are parsed concurrently by worker threads (see SceneLoader). The loaded models are
+         *          added to the viewer (with the default drawables) in the rendering thread, a limited amount per
+         *          frame, so the viewer keeps responding while loading a large scene (e.g., hundreds of tiles).
+         *          The camera is adjusted to fit the scene when all the files have been loaded.
+         * @param file_names The file names.
+         * @related add_model(const std::string&, bool).
+         */
+        void add_models(const std::vector<std::string>& file_names);
+
         /**
          * @brief Delete a model. The memory of the model will be released and its existing drawables
          *        also be deleted.
@@ -462,6 +475,9 @@ namespace easy3d {
         void copy_view();
         void paste_view();
 
+        // Adds (a limited amount of) the models loaded in the background. Called before drawing each frame.
+        void add_loaded_models();
+
     protected:
 		GLFWwindow*	window_;
 		bool        should_exit_;
@@ -510,6 +526,9 @@ namespace easy3d {
 		std::vector<Model*> models_;
 		int model_idx_;
 
+        // loads models in the background
+        SceneLoader* scene_loader_;
+
         // drawables independent of any model
         std::vector<Drawable*> drawables_;
 	};
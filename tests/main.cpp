@@ -43,6 +43,8 @@ int test_graph();
 int test_point_cloud_algorithms();
 int test_surface_mesh_algorithms();
 
+int test_texture_decoder();
+
 int test_viewer_imgui(int duration);
 int test_composite_view(int duration);
 int test_real_camera();
@@ -51,6 +53,7 @@ int test_imposters(int duration);
 int test_scalar_field(int duration);
 int test_vector_field(int duration);
 int test_texture(int duration);
+int test_texture_async(int duration);
 int test_image(int duration);
 int test_tessellator(int duration);
 int test_texture_mesh(int duration);
@@ -94,6 +97,8 @@ int main(int argc, char* argv[]) {
     result += test_point_cloud_algorithms();
     result += test_surface_mesh_algorithms();
 
+    result += test_texture_decoder();
+
     const int duration = 1500; // in millisecond
     result += test_viewer_imgui(duration);
     result += test_composite_view(duration);
@@ -103,6 +108,7 @@ int main(int argc, char* argv[]) {
     result += test_scalar_field(duration);
     result += test_vector_field(duration);
     result += test_texture(duration);
+    result += test_texture_async(duration);
     result += test_image(duration);
     result += test_tessellator(duration);
     result += test_texture_mesh(duration);
@@ -27,9 +27,12 @@
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/core/random.h>
 #include <easy3d/fileio/point_cloud_io.h>
+#include <easy3d/fileio/point_cloud_io_ptx.h>
 #include <easy3d/fileio/resources.h>
 #include <easy3d/util/file_system.h>
 
+#include <fstream>
+
 
 using namespace easy3d;
 
@@ -110,6 +113,154 @@ int test_point_cloud() {
                 std::cerr << "failed to delete the saved file" << std::endl;
         }
     }
-    
+
+
+    //  - save a subset of the points;
+    //  - save a point cloud having deleted (but not yet collected) points.
+    {
+        PointCloud grid;
+        auto colors = grid.add_vertex_property<vec3>("v:color");
+        for (int i = 0; i < 50; ++i) {
+            auto v = grid.add_vertex(vec3(static_cast<float>(i) * 0.1f, static_cast<float>(i % 7), 1.0f / (i + 1.0f)));
+            colors[v] = vec3(static_cast<float>(i) / 50.0f, 0.5f, 1.0f);
+        }
+        auto points = grid.get_vertex_property<vec3>("v:point");
+
+        // checks if the points (and colors, if required) of a saved file match the given vertices of 'grid'
+        auto matches = [&](const std::string &file, const std::vector<PointCloud::Vertex> &expected, bool check_colors) {
+            PointCloud *copy = PointCloudIO::load(file);
+            file_system::delete_file(file);
+            if (!copy || copy->n_vertices() != expected.size()) {
+                delete copy;
+                return false;
+            }
+            auto copy_points = copy->get_vertex_property<vec3>("v:point");
+            auto copy_colors = copy->get_vertex_property<vec3>("v:color");
+            bool same = !check_colors || copy_colors;
+            for (std::size_t i = 0; i < expected.size() && same; ++i) {
+                const PointCloud::Vertex v(static_cast<int>(i));
+                same = distance(copy_points[v], points[expected[i]]) < 1e-6f;
+                if (check_colors)   // colors may be saved as 8-bit integers
+                    same = same && distance(copy_colors[v], colors[expected[i]]) < 0.01f;
+            }
+            delete copy;
+            return same;
+        };
+
+        const std::vector<int> subset = {7, 3, 42, 0, 19};
+        std::vector<PointCloud::Vertex> expected;
+        for (auto id : subset)
+            expected.push_back(PointCloud::Vertex(id));
+        for (const std::string ext : {"xyz", "bin", "ply"}) {
+            const std::string file = "./subset." + ext;
+            if (!PointCloudIO::save(file, &grid, subset) || !matches(file, expected, ext != "xyz")) {
+                LOG(ERROR) << "failed saving a subset of the points to a " << ext << " file";
+                return EXIT_FAILURE;
+            }
+        }
+
+        // the deleted points are not saved (neither in full saves nor in subsets)
+        for (int id : {0, 10, 11, 49})
+            grid.delete_vertex(PointCloud::Vertex(id));
+        expected.clear();
+        for (auto v : grid.vertices())
+            expected.push_back(v);
+        for (const std::string ext : {"xyz", "bxyz", "bin", "ply"}) {
+            const std::string file = "./garbage." + ext;
+            if (!PointCloudIO::save(file, &grid) || !matches(file, expected, ext == "bin" || ext == "ply")) {
+                LOG(ERROR) << "failed saving a point cloud with deleted points to a " << ext << " file";
+                return EXIT_FAILURE;
+            }
+        }
+        if (PointCloudIO::save("./deleted.xyz", &grid, std::vector<int>{1, 10})) {
+            file_system::delete_file("./deleted.xyz");
+            LOG(ERROR) << "deleted points should not be accepted in a subset";
+            return EXIT_FAILURE;
+        }
+        std::cout << "subsets and point clouds with deleted points saved and verified" << std::endl;
+    }
+
+    //  - read the headers of the scans of a PTX file, and then load the scans lazily (in reverse order).
+    {
+        // Three scans (the points are transformed by a translation of the index of the scan along x):
+        //  - #0: 3 x 4 points of different line lengths, some of which are missing;
+        //  - #1: 2 x 5 missing points with colors, i.e., the shortest lines possible (all of the same length, so the
+        //        position of the next header is computed);
+        //  - #2: 4 x 2 points with colors, after an empty line, and without a line break at the end of the file.
+        const std::string ptx_file_name = "./scans.ptx";
+        const unsigned int sizes[3][2] = {{3, 4}, {2, 5}, {4, 2}};
+        auto point_of = [](int scan, unsigned int i) -> vec3 {
+            if (scan == 1 || i % 5 == 2)
+                return vec3(0, 0, 0); // missing
+            return vec3(static_cast<float>(i) * 0.25f, 1.0f / static_cast<float>(i + 1), 123.5f * static_cast<float>(scan));
+        };
+        {
+            std::ofstream output(ptx_file_name.c_str());
+            for (int scan = 0; scan < 3; ++scan) {
+                if (scan == 2)
+                    output << "\n";
+                output << sizes[scan][0] << "\n" << sizes[scan][1] << "\n";
+                output << scan << " 0 0\n1 0 0\n0 1 0\n0 0 1\n";
+                output << "1 0 0 0\n0 1 0 0\n0 0 1 0\n" << scan << " 0 0 1\n";
+                const unsigned int num = sizes[scan][0] * sizes[scan][1];
+                for (unsigned int i = 0; i < num; ++i) {
+                    const vec3 p = point_of(scan, i);
+                    if (p == vec3(0, 0, 0))
+                        output << "0 0 0 0";
+                    else
+                        output << p << " 0.5";
+                    if (scan > 0)
+                        output << " " << (p == vec3(0, 0, 0) ? "0 0 0" : "255 0 51");
+                    if (scan < 2 || i + 1 < num)
+                        output << "\n";
+                }
+            }
+        }
+
+        bool success = true;
+        for (bool compute_bounding_boxes : {false, true}) {
+            io::PointCloudIO_ptx serializer(ptx_file_name);
+            success = success && serializer.read_scans(compute_bounding_boxes) && serializer.num_scans() == 3;
+            for (int scan = 2; success && scan >= 0; --scan) {
+                const auto &header = serializer.scan(scan);
+                success = header.num_columns == sizes[scan][0] && header.num_rows == sizes[scan][1] &&
+                          header.has_colors == (scan > 0) && header.scanner_position == vec3(static_cast<float>(scan), 0, 0);
+                const Box3 bbox = header.bbox;
+                PointCloud *cloud = serializer.load_scan(scan);
+                success = success && cloud;
+                if (!success)
+                    break;
+                auto grid = cloud->get_vertex_property<ivec2>("v:grid");
+                auto colors = cloud->get_vertex_property<vec3>("v:color");
+                success = grid && (colors || scan == 0);
+                std::size_t count = 0;
+                for (unsigned int i = 0; success && i < header.num_columns * header.num_rows; ++i) {
+                    const vec3 p = point_of(scan, i);
+                    if (p == vec3(0, 0, 0))
+                        continue;
+                    const PointCloud::Vertex v(static_cast<int>(count++));
+                    success = distance(cloud->position(v), p + vec3(static_cast<float>(scan), 0, 0)) < 1e-5f &&
+                              grid[v] == ivec2(static_cast<int>(i % header.num_rows), static_cast<int>(i / header.num_rows));
+                    if (colors)
+                        success = success && distance(colors[v], vec3(1.0f, 0.0f, 0.2f)) < 1e-6f;
+                }
+                success = success && cloud->n_vertices() == count;
+                // the bounding boxes computed by read_scans() and load_scan() are the same
+                if (compute_bounding_boxes && count > 0)
+                    success = success && bbox.min_point() == serializer.scan(scan).bbox.min_point() &&
+                              bbox.max_point() == serializer.scan(scan).bbox.max_point();
+                delete cloud;
+            }
+        }
+        file_system::delete_file(ptx_file_name);
+
+        if (success)
+            std::cout << "scans of the PTX file read lazily and verified" << std::endl;
+        else {
+            LOG(ERROR) << "the scans loaded from the PTX file differ from the expected ones";
+            return EXIT_FAILURE;
+        }
+    }
+
     return EXIT_SUCCESS;
 }
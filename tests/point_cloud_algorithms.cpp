@@ -32,9 +32,17 @@
 #include <easy3d/algo/delaunay_2d.h>
 #include <easy3d/algo/delaunay_3d.h>
 #include <easy3d/algo/point_cloud_simplification.h>
+#include <easy3d/algo/connected_components.h>
+#include <easy3d/kdtree/kdtree_search_eth.h>
+#include <easy3d/kdtree/kdtree_search_nanoflann.h>
 #include <easy3d/fileio/point_cloud_io.h>
 #include <easy3d/fileio/resources.h>
 
+#include <set>
+#include <array>
+#include <cmath>
+#include <algorithm>
+
 
 using namespace easy3d;
 
@@ -123,6 +131,123 @@ bool test_algo_point_cloud_poisson_reconstruction() {
 }
 
 
+// Checks that the triangulation is a valid Delaunay triangulation: the adjacency is symmetric, and no vertex of a
+// neighboring cell is strictly inside the circumscribed circle/sphere of a cell.
+bool check_delaunay(const Delaunay &dt) {
+    const unsigned int dim = dt.dimension();
+    for (unsigned int c = 0; c < dt.nb_cells(); ++c) {
+        dvec3 p[4];
+        for (unsigned int lv = 0; lv < dt.cell_size(); ++lv) {
+            for (unsigned int k = 0; k < dim; ++k)
+                p[lv][k] = dt.vertex_ptr(dt.cell_vertex(c, lv))[k];
+        }
+        // the circumcenter
+        const dvec3 u = p[1] - p[0], v = p[2] - p[0];
+        dvec3 center;
+        if (dim == 2) {
+            const double d = 2.0 * (u.x * v.y - u.y * v.x);
+            center = p[0] + dvec3(v.y * u.length2() - u.y * v.length2(), u.x * v.length2() - v.x * u.length2(), 0) / d;
+        } else {
+            const dvec3 w = p[3] - p[0];
+            const double d = 2.0 * dot(u, cross(v, w));
+            center = p[0] + (u.length2() * cross(v, w) + v.length2() * cross(w, u) + w.length2() * cross(u, v)) / d;
+        }
+        const double radius2 = distance2(center, p[0]);
+
+        for (unsigned int lf = 0; lf < dt.cell_size(); ++lf) {
+            const int n = dt.cell_adjacent(c, lf);
+            if (n == -1)
+                continue;
+            unsigned int lv = 0;
+            if (n >= 0 && n < static_cast<int>(dt.nb_cells())) {
+                while (lv < dt.cell_size() && dt.cell_adjacent(n, lv) != static_cast<int>(c))
+                    ++lv;
+            }
+            if (n < 0 || n >= static_cast<int>(dt.nb_cells()) || lv == dt.cell_size()) {
+                std::cerr << "Error: the adjacency of cell " << c << " is not symmetric" << std::endl;
+                return false;
+            }
+            dvec3 q;
+            for (unsigned int k = 0; k < dim; ++k)
+                q[k] = dt.vertex_ptr(dt.cell_vertex(n, lv))[k];
+            if (distance2(center, q) < radius2 * (1.0 - 1e-5)) {
+                std::cerr << "Error: a vertex is inside the circumscribed circle/sphere of cell " << c << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// Checks the point location: the centroids of (some of) the cells are located, one by one and in a batch, and the
+// located cell must contain the query point. A point outside the convex hull is not in any cell.
+bool check_locate(const Delaunay &dt) {
+    const unsigned int dim = dt.dimension();
+    // the signed area/volume of a triangle/tetrahedron
+    auto det = [dim](const dvec3 *p) -> double {
+        const dvec3 u = p[1] - p[0], v = p[2] - p[0];
+        return dim == 2 ? u.x * v.y - u.y * v.x : dot(u, cross(v, p[3] - p[0]));
+    };
+    // the minimum barycentric coordinate of q in cell c
+    auto min_barycentric = [&](int c, const float *q) -> double {
+        dvec3 p[4], query;
+        for (unsigned int k = 0; k < dim; ++k)
+            query[k] = q[k];
+        for (unsigned int lv = 0; lv < dt.cell_size(); ++lv) {
+            for (unsigned int k = 0; k < dim; ++k)
+                p[lv][k] = dt.vertex_ptr(dt.cell_vertex(c, lv))[k];
+        }
+        const double total = det(p);
+        double result = 1.0;
+        for (unsigned int lv = 0; lv < dt.cell_size(); ++lv) {
+            dvec3 sub[4] = {p[0], p[1], p[2], p[3]};
+            sub[lv] = query;
+            result = std::min(result, det(sub) / total);
+        }
+        return result;
+    };
+
+    std::vector<float> queries;
+    const unsigned int step = std::max(1u, dt.nb_cells() / 1000);
+    for (unsigned int c = 0; c < dt.nb_cells(); c += step) {
+        for (unsigned int k = 0; k < dim; ++k) {
+            float sum = 0.0f;
+            for (unsigned int lv = 0; lv < dt.cell_size(); ++lv)
+                sum += dt.vertex_ptr(dt.cell_vertex(c, lv))[k];
+            queries.push_back(sum / static_cast<float>(dt.cell_size()));
+        }
+    }
+    const unsigned int num = static_cast<unsigned int>(queries.size() / dim);
+    std::vector<int> cells;
+    dt.locate(num, queries.data(), cells);
+    for (unsigned int i = 0; i < num; ++i) {
+        const float *q = queries.data() + i * dim;
+        const int single = dt.locate(q);
+        if (single < 0 || cells[i] < 0 || min_barycentric(single, q) < -1e-4 || min_barycentric(cells[i], q) < -1e-4) {
+            std::cerr << "Error: the located cell does not contain the query point" << std::endl;
+            return false;
+        }
+    }
+
+    // a point outside the bounding box of the vertices
+    float outside[3] = {0, 0, 0};
+    for (unsigned int k = 0; k < dim; ++k) {
+        float min_value = dt.vertex_ptr(0)[k], max_value = dt.vertex_ptr(0)[k];
+        for (unsigned int v = 1; v < dt.nb_vertices(); ++v) {
+            min_value = std::min(min_value, dt.vertex_ptr(v)[k]);
+            max_value = std::max(max_value, dt.vertex_ptr(v)[k]);
+        }
+        outside[k] = max_value + (max_value - min_value);
+    }
+    if (dt.locate(outside) != -1) {
+        std::cerr << "Error: a point outside the convex hull must not be in any cell" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
 bool test_algo_point_cloud_delaunay_triangulation_2D() {
     const std::string file = resource::directory() + "/data/bunny.bin";
     PointCloud *cloud = PointCloudIO::load(file);
@@ -142,6 +267,32 @@ bool test_algo_point_cloud_delaunay_triangulation_2D() {
     Delaunay2 delaunay;
     delaunay.set_vertices(points);
 
+    std::cout << "nearest vertex and point location..." << std::endl;
+    std::vector<unsigned int> nearest;
+    delaunay.nearest_vertices(points, nearest);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (distance2(delaunay.vertex(nearest[i]), points[i]) > 0) {
+            std::cerr << "Error: the nearest vertex of a vertex must be itself (or a duplicate)" << std::endl;
+            delete cloud;
+            return false;
+        }
+    }
+    if (!check_locate(delaunay)) {
+        delete cloud;
+        return false;
+    }
+
+    std::cout << "incremental Delaunay triangulation 2D (in two batches)..." << std::endl;
+    Delaunay2 incremental;
+    const std::size_t half = points.size() / 2;
+    incremental.insert_vertices(std::vector<vec2>(points.begin(), points.begin() + half));
+    incremental.insert_vertices(std::vector<vec2>(points.begin() + half, points.end()));
+    if (incremental.nb_triangles() != delaunay.nb_triangles() || !check_delaunay(incremental)) {
+        std::cerr << "Error: incremental and batch triangulations differ" << std::endl;
+        delete cloud;
+        return false;
+    }
+
     delete cloud;
     return true;
 }
@@ -161,6 +312,83 @@ bool test_algo_point_cloud_delaunay_triangulation_3D() {
     Delaunay3 delaunay;
     delaunay.set_vertices(points);
 
+    std::cout << "nearest vertex and point location..." << std::endl;
+    std::vector<unsigned int> nearest;
+    delaunay.nearest_vertices(points, nearest);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (distance2(delaunay.vertex(nearest[i]), points[i]) > 0) {
+            std::cerr << "Error: the nearest vertex of a vertex must be itself (or a duplicate)" << std::endl;
+            delete cloud;
+            return false;
+        }
+    }
+    if (!check_locate(delaunay)) {
+        delete cloud;
+        return false;
+    }
+
+    std::cout << "Voronoi cells clipped by the bounding box..." << std::endl;
+    VoronoiCells3d cells;
+    delaunay.get_voronoi_cells(cloud->bounding_box(), cells);
+    if (cells.nb_cells() != delaunay.nb_vertices()) {
+        std::cerr << "Error: each vertex should have a Voronoi cell" << std::endl;
+        delete cloud;
+        return false;
+    }
+    std::cout << cells.nb_cells() << " cells, " << cells.nb_faces() << " faces, " << cells.vertices().size()
+              << " vertices" << std::endl;
+    // the cells partition the box, and the vertices are shared by the neighboring cells
+    double volume = 0.0;
+    std::size_t num_cell_vertices = 0;
+    for (unsigned int c = 0; c < cells.nb_cells(); ++c) {
+        std::set<unsigned int> vertices;
+        for (unsigned int f = cells.cell_begin(c); f < cells.cell_end(c); ++f) {
+            const dvec3 a(cells.vertex(cells.face_vertex(cells.face_begin(f))).data());
+            for (unsigned int i = cells.face_begin(f); i < cells.face_end(f); ++i) {
+                vertices.insert(cells.face_vertex(i));
+                if (i + 2 < cells.face_end(f)) {
+                    const dvec3 b(cells.vertex(cells.face_vertex(i + 1)).data());
+                    const dvec3 d(cells.vertex(cells.face_vertex(i + 2)).data());
+                    volume += dot(a, cross(b, d)) / 6.0;
+                }
+            }
+        }
+        num_cell_vertices += vertices.size();
+    }
+    const vec3 size = cloud->bounding_box().max_point() - cloud->bounding_box().min_point();
+    const double box_volume = static_cast<double>(size.x) * size.y * size.z;
+    if (std::abs(volume - box_volume) > 1e-4 * box_volume) {
+        std::cerr << "Error: the volumes of the Voronoi cells sum to " << volume << " (box volume " << box_volume
+                  << ")" << std::endl;
+        delete cloud;
+        return false;
+    }
+    // a Voronoi vertex (in general position) is shared by four cells
+    if (cells.vertices().size() * 3 > num_cell_vertices) {
+        std::cerr << "Error: the vertices of the Voronoi cells are not shared (" << cells.vertices().size()
+                  << " vertices for " << num_cell_vertices << " cell corners)" << std::endl;
+        delete cloud;
+        return false;
+    }
+
+    std::cout << "incremental Delaunay triangulation 3D (in two batches)..." << std::endl;
+    Delaunay3 incremental;
+    const std::size_t half = points.size() / 2;
+    incremental.insert_vertices(std::vector<vec3>(points.begin(), points.begin() + half));
+    incremental.insert_vertices(std::vector<vec3>(points.begin() + half, points.end()));
+    if (incremental.nb_tets() != delaunay.nb_tets() || !check_delaunay(incremental)) {
+        std::cerr << "Error: incremental and batch triangulations differ" << std::endl;
+        delete cloud;
+        return false;
+    }
+    for (std::size_t i = 0; i < points.size(); i += 97) {
+        if (distance2(incremental.vertex(incremental.nearest_vertex(points[i])), points[i]) > 0) {
+            std::cerr << "Error: the nearest vertex of a vertex must be itself (or a duplicate)" << std::endl;
+            delete cloud;
+            return false;
+        }
+    }
+
     delete cloud;
     return true;
 }
@@ -177,6 +405,19 @@ bool test_algo_point_cloud_downsampling() {
     int total_num = cloud->n_vertices();
 
     float threshold = 0.01;
+
+    // the (non-empty) cells of the grid, each cell keeps exactly one point
+    auto cells_of = [threshold](const PointCloud *pcd) -> std::set<std::array<int64_t, 3> > {
+        std::set<std::array<int64_t, 3> > cells;
+        for (const auto &p : pcd->points()) {
+            cells.insert({static_cast<int64_t>(std::floor(p.x / threshold)),
+                          static_cast<int64_t>(std::floor(p.y / threshold)),
+                          static_cast<int64_t>(std::floor(p.z / threshold))});
+        }
+        return cells;
+    };
+    const std::size_t num_cells = cells_of(cloud).size();
+
     std::cout << "grid downsampling using distance threshold " << threshold << "...";
     {
         PointCloud pcd = *cloud;
@@ -185,6 +426,56 @@ bool test_algo_point_cloud_downsampling() {
             pcd.delete_vertex(PointCloud::Vertex(id));
         pcd.collect_garbage();
         std::cout << " " << total_num << " -> " << pcd.n_vertices() << std::endl;
+        if (pcd.n_vertices() != num_cells || cells_of(&pcd).size() != num_cells) {
+            std::cerr << "Error: grid simplification must keep exactly one point per cell" << std::endl;
+            delete cloud;
+            return false;
+        }
+    }
+
+    const std::vector<std::pair<PointCloudSimplification::Representative, std::string> > representatives = {
+            {PointCloudSimplification::FIRST,    "first points"},
+            {PointCloudSimplification::CENTROID, "cell centroids"},
+            {PointCloudSimplification::MEDOID,   "cell medoids"}
+    };
+    for (const auto &rep : representatives) {
+        std::cout << "grid downsampling (keeping " << rep.second << ") using distance threshold " << threshold
+                  << "...";
+        PointCloud pcd = *cloud;
+        const unsigned int num = PointCloudSimplification::grid_downsampling(&pcd, threshold, rep.first);
+        std::cout << " " << total_num << " -> " << num << std::endl;
+        // the centroids may be (numerically) on the border of their cells, so only the number is checked for them
+        const bool distinct = rep.first == PointCloudSimplification::CENTROID || cells_of(&pcd).size() == num_cells;
+        if (num != num_cells || pcd.n_vertices() != num || !distinct) {
+            std::cerr << "Error: grid downsampling must keep exactly one point per cell" << std::endl;
+            delete cloud;
+            return false;
+        }
+    }
+
+    std::cout << "grid downsampling (keeping cell centroids) across windows of a few cells...";
+    {
+        // clusters of identical points just below the upper borders of their cells, so their (float) centroids may be
+        // rounded onto the next cell, which is in another slab and a later window
+        PointCloud pcd;
+        const int num_clusters = 200;
+        for (int k = 0; k < num_clusters; ++k) {
+            float x = static_cast<float>(k + 1) * threshold;
+            while (std::floor(x / threshold) > static_cast<float>(k))
+                x = std::nextafter(x, 0.0f);
+            for (int j = 0; j < 3; ++j)
+                pcd.add_vertex(vec3(x, 0.0f, 0.0f));
+        }
+        PointCloud windowed = pcd;
+        const unsigned int num = PointCloudSimplification::grid_downsampling(&pcd, threshold);
+        const unsigned int num_windowed = PointCloudSimplification::grid_downsampling(
+                &windowed, threshold, PointCloudSimplification::CENTROID, 8);
+        std::cout << " " << num_clusters * 3 << " -> " << num_windowed << std::endl;
+        if (num != num_clusters || num_windowed != num || windowed.points() != pcd.points()) {
+            std::cerr << "Error: grid downsampling must not depend on the window size" << std::endl;
+            delete cloud;
+            return false;
+        }
     }
 
     std::cout << "uniform downsampling using distance threshold " << threshold << "...";
@@ -208,6 +499,57 @@ bool test_algo_point_cloud_downsampling() {
         std::cout << " " << total_num << " -> " << pcd.n_vertices() << std::endl;
     }
 
+    // the clusters are the same as those of a sequential flood fill (also numbered in the order of their first
+    // points), using either a thread-safe kd-tree (queried in parallel) or not
+    KdTreeSearch_NanoFLANN nanoflann;
+    KdTreeSearch_ETH eth;
+    for (KdTreeSearch *kdtree : {static_cast<KdTreeSearch *>(&nanoflann), static_cast<KdTreeSearch *>(&eth)}) {
+        kdtree->begin();
+        kdtree->add_point_cloud(cloud);
+        kdtree->end();
+    }
+    const float diagonal = cloud->bounding_box().diagonal_length();
+    for (float radius : {threshold, 0.007f * diagonal, 0.008f * diagonal, 0.009f * diagonal}) {
+        std::cout << "clustering using distance threshold " << radius << "...";
+        std::vector<int> flood_fill(cloud->n_vertices(), -1);
+        int num_flood_fill = 0;
+        std::vector<int> queue, neighbors;
+        for (auto v : cloud->vertices()) {
+            if (flood_fill[v.idx()] >= 0)
+                continue;
+            flood_fill[v.idx()] = num_flood_fill;
+            queue.assign(1, v.idx());
+            while (!queue.empty()) {
+                const int i = queue.back();
+                queue.pop_back();
+                nanoflann.find_points_in_range(cloud->points()[i], radius * radius, neighbors);
+                for (auto j : neighbors) {
+                    if (flood_fill[j] < 0) {
+                        flood_fill[j] = num_flood_fill;
+                        queue.push_back(j);
+                    }
+                }
+            }
+            ++num_flood_fill;
+        }
+
+        for (const KdTreeSearch *kdtree : {static_cast<const KdTreeSearch *>(nullptr),
+                                           static_cast<const KdTreeSearch *>(&eth)}) {
+            auto label = cloud->vertex_property<int>("v:cluster");
+            std::vector<ConnectedComponents::Stats> stats;
+            const int num = ConnectedComponents::label(cloud, radius, label, &stats, kdtree);
+            std::size_t count = 0;
+            for (const auto &s : stats)
+                count += s.size;
+            if (num != num_flood_fill || count != cloud->n_vertices() || label.vector() != flood_fill) {
+                std::cerr << "Error: the clusters differ from those of a flood fill" << std::endl;
+                delete cloud;
+                return false;
+            }
+        }
+        std::cout << " " << num_flood_fill << " clusters" << std::endl;
+    }
+
     delete cloud;
     return true;
 }
@@ -27,9 +27,16 @@
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/surface_mesh_builder.h>
 #include <easy3d/fileio/surface_mesh_io.h>
+#include <easy3d/fileio/ply_reader_writer.h>
 #include <easy3d/fileio/resources.h>
+#include <easy3d/fileio/translator.h>
 #include <easy3d/util/file_system.h>
 
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+
 
 using namespace easy3d;
 
@@ -315,6 +322,330 @@ int test_surface_mesh() {
             std::cout << "the saved file has been deleted"  << std::endl;
         else
             std::cerr << "failed to delete the saved file" << std::endl;
+
+        //	- save the mesh (with all its properties) into the native *.e3d format;
+        //	- load only the connectivity, the vertex coordinates, and a selected property back.
+        auto quality = mesh->vertex_property<float>("v:quality");
+        for (auto v : mesh->vertices())
+            quality[v] = mesh->position(v).z;
+
+        const std::string e3d_file_name = "./sphere-copy.e3d";
+        if (!SurfaceMeshIO::save(e3d_file_name, mesh)) {
+            std::cerr << "failed create the e3d file" << std::endl;
+            delete mesh;
+            return EXIT_FAILURE;
+        }
+
+        // checks if 'copy' has the same elements and vertex coordinates as 'mesh' (after a translation)
+        auto same_geometry = [&](const SurfaceMesh &copy, const dvec3 &offset) -> bool {
+            if (copy.n_vertices() != mesh->n_vertices() || copy.n_edges() != mesh->n_edges() ||
+                copy.n_faces() != mesh->n_faces())
+                return false;
+            for (auto v : mesh->vertices()) {
+                const vec3 &p = mesh->position(v);
+                const vec3 expected(static_cast<float>(p.x + offset.x), static_cast<float>(p.y + offset.y),
+                                    static_cast<float>(p.z + offset.z));
+                if (distance(copy.position(v), expected) > 1e-6f * (1.0f + length(expected)))
+                    return false;
+            }
+            return true;
+        };
+
+        // all the properties
+        SurfaceMesh copy;
+        bool success = io::load_e3d(e3d_file_name, &copy) && same_geometry(copy, dvec3(0, 0, 0));
+        auto copy_quality = copy.get_vertex_property<float>("v:quality");
+        success = success && copy_quality && copy_quality.vector() == quality.vector();
+        for (const auto &name : mesh->face_properties())
+            success = success && copy.get_face_property_type(name) == mesh->get_face_property_type(name);
+
+        // only the selected property
+        SurfaceMesh partial;
+        success = success && io::load_e3d(e3d_file_name, &partial, {"v:quality"}) &&
+                  same_geometry(partial, dvec3(0, 0, 0)) && partial.get_vertex_property<float>("v:quality");
+        for (const auto &name : partial.vertex_properties())
+            success = success && (name == "v:quality" || name == "v:point" || name == "v:connectivity" ||
+                                  name == "v:deleted");
+
+        // a translated model is restored to its original coordinates, or translated again by the Translator
+        const dvec3 origin(1.0e6, -2.0e6, 3.0e5);
+        mesh->add_model_property<dvec3>("translation", origin)[0] = origin;
+        success = success && SurfaceMeshIO::save(e3d_file_name, mesh);
+        SurfaceMesh restored;
+        success = success && io::load_e3d(e3d_file_name, &restored) && same_geometry(restored, origin) &&
+                  !restored.get_model_property<dvec3>("translation");
+        Translator::instance()->set_status(Translator::TRANSLATE_USE_LAST_KNOWN_OFFSET);
+        Translator::instance()->set_translation(origin);
+        SurfaceMesh translated;
+        success = success && io::load_e3d(e3d_file_name, &translated) && same_geometry(translated, dvec3(0, 0, 0));
+        auto trans = translated.get_model_property<dvec3>("translation");
+        success = success && trans && trans[0] == origin;
+        Translator::instance()->set_status(Translator::DISABLED);
+
+        if (success)
+            std::cout << "e3d file saved, loaded, and verified" << std::endl;
+        else {
+            std::cerr << "the model loaded from the e3d file differs from the original one" << std::endl;
+            file_system::delete_file(e3d_file_name);
+            delete mesh;
+            return EXIT_FAILURE;
+        }
+        file_system::delete_file(e3d_file_name);
+        delete mesh;
+    }
+
+    //	- save a surface mesh (with texture coordinates) into a binary PLY file and load it back;
+    //	- load binary PLY files with faces of the same size (decoded directly into flat arrays) and of different
+    //	  sizes (read by the generic reader).
+    {
+        // the vertex indices of each face, starting from the smallest one (the start of a face is not preserved)
+        auto faces_of = [](const SurfaceMesh &m) -> std::vector<std::vector<int> > {
+            std::vector<std::vector<int> > faces;
+            for (auto f : m.faces()) {
+                std::vector<int> indices;
+                for (auto v : m.vertices(f))
+                    indices.push_back(v.idx());
+                std::rotate(indices.begin(), std::min_element(indices.begin(), indices.end()), indices.end());
+                faces.push_back(indices);
+            }
+            return faces;
+        };
+
+        SurfaceMesh *mesh = SurfaceMeshIO::load(resource::directory() + "/data/sphere.obj");
+        if (!mesh) {
+            LOG(ERROR) << "Error: failed to load model. Please make sure the file exists and format is correct.";
+            return EXIT_FAILURE;
+        }
+        auto texcoords = mesh->halfedge_property<vec2>("h:texcoord");
+        for (auto h : mesh->halfedges())
+            texcoords[h] = vec2(mesh->position(mesh->target(h)));
+
+        const std::string ply_file_name = "./sphere-copy.ply";
+        SurfaceMesh *copy = SurfaceMeshIO::save(ply_file_name, mesh) ? SurfaceMeshIO::load(ply_file_name) : nullptr;
+        bool success = copy && copy->n_vertices() == mesh->n_vertices() && faces_of(*copy) == faces_of(*mesh);
+        if (success) {
+            for (auto v : mesh->vertices())
+                success = success && copy->position(v) == mesh->position(v);
+            auto copy_texcoords = copy->get_halfedge_property<vec2>("h:texcoord");
+            success = success && copy_texcoords;
+            for (auto h : copy->halfedges()) {
+                if (success && !copy->is_border(h))
+                    success = copy_texcoords[h] == vec2(copy->position(copy->target(h)));
+            }
+        }
+        delete copy;
+        delete mesh;
+        file_system::delete_file(ply_file_name);
+
+        // a pyramid in big-endian binary PLY files (with colors and an empty element): all triangles, or a quad as
+        // the bottom
+        const float points[5][3] = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0.5f, 0.5f, 1}};
+        const std::vector<std::vector<int> > triangles = {{0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {0, 4, 3}, {0, 2, 1}, {0, 3, 2}};
+        const std::vector<std::vector<int> > polygons = {{0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {0, 4, 3}, {0, 3, 2, 1}};
+        const int one = 1;
+        const bool little_endian = *reinterpret_cast<const char *>(&one) == 1;
+        auto write_ply = [&](const std::string &file_name, const std::vector<std::vector<int> > &faces) {
+            std::ofstream output(file_name.c_str(), std::ios::binary);
+            output << "ply\nformat binary_big_endian 1.0\nelement vertex 5\n"
+                   << "property float x\nproperty float y\nproperty float z\n"
+                   << "property uchar red\nproperty uchar green\nproperty uchar blue\n"
+                   << "element face " << faces.size() << "\nproperty list uchar int vertex_indices\n"
+                   << "element camera 0\nproperty float view_px\nend_header\n";
+            auto put = [&](const void *value, std::size_t size) {
+                const char *bytes = static_cast<const char *>(value);
+                for (std::size_t i = 0; i < size; ++i)
+                    output.put(bytes[little_endian ? size - 1 - i : i]);
+            };
+            for (int i = 0; i < 5; ++i) {
+                for (int k = 0; k < 3; ++k)
+                    put(&points[i][k], sizeof(float));
+                for (int k = 0; k < 3; ++k)
+                    output.put(static_cast<char>(50 * i));
+            }
+            for (const auto &face : faces) {
+                output.put(static_cast<char>(face.size()));
+                for (auto id : face)
+                    put(&id, sizeof(int));
+            }
+        };
+        for (const auto &faces : {triangles, polygons}) {
+            write_ply(ply_file_name, faces);
+            SurfaceMesh *pyramid = SurfaceMeshIO::load(ply_file_name);
+            success = success && pyramid && pyramid->n_vertices() == 5 && faces_of(*pyramid) == faces;
+            auto colors = pyramid ? pyramid->get_vertex_property<vec3>("v:color") : SurfaceMesh::VertexProperty<vec3>();
+            success = success && colors;
+            // the empty element is kept by both readers (as a model property, because it is unknown)
+            auto camera = pyramid ? pyramid->get_model_property<io::Element>("element-camera")
+                                  : SurfaceMesh::ModelProperty<io::Element>();
+            success = success && camera && camera.vector().back().num_instances == 0 &&
+                      camera.vector().back().float_properties.size() == 1 &&
+                      camera.vector().back().float_properties[0].name == "view_px" &&
+                      camera.vector().back().float_properties[0].empty();
+            for (int i = 0; success && i < 5; ++i) {
+                const SurfaceMesh::Vertex v(i);
+                success = pyramid->position(v) == vec3(points[i][0], points[i][1], points[i][2]) &&
+                          std::abs(colors[v].x - 50.0f * i / 255.0f) < 1e-6f;
+            }
+            delete pyramid;
+            file_system::delete_file(ply_file_name);
+        }
+
+        if (success)
+            std::cout << "binary PLY files saved, loaded, and verified" << std::endl;
+        else {
+            std::cerr << "the model loaded from the binary PLY file differs from the original one" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    //	- load an OBJ file that is parsed in parallel: relative indices referring to vertices in other segments, a line
+    //	  split between two blocks, a face with a duplicate vertex, a duplicate face (so the builder has to copy
+    //	  vertices), and a face with coincident vertices. The texture coordinates of each corner must follow its vertex.
+    {
+        const std::string obj_file_name = "./grid.obj";
+        const int n = 200; // a grid of n x n quads, with the texture coordinates equal to the xy of the vertices
+        {
+            std::ofstream output(obj_file_name.c_str());
+            // the first block (32 MB) ends within the first line after the comments
+            const std::size_t block_size = 32 * 1024 * 1024;
+            const std::string comment = "#" + std::string(1022, '-') + "\n";
+            std::size_t padding = block_size - 10;
+            for (; padding >= comment.size(); padding -= comment.size())
+                output << comment;
+            output << "#" << std::string(padding - 2, '-') << "\n";
+
+            auto coord = [n](int i) -> std::string { return std::to_string(static_cast<double>(i) / n); };
+            for (int j = 0; j <= n; ++j) {
+                for (int i = 0; i <= n; ++i) {
+                    output << "v " << coord(i) << " " << coord(j) << " 0.0\n";
+                    output << "vt " << coord(i) << " " << coord(j) << "\n";
+                }
+                if (j == 0)
+                    continue;
+                // the faces between rows j-1 and j, all with relative indices
+                const int count = (j + 1) * (n + 1);
+                for (int i = 0; i < n; ++i) {
+                    const int corners[4] = {(j - 1) * (n + 1) + i, (j - 1) * (n + 1) + i + 1,
+                                            j * (n + 1) + i + 1, j * (n + 1) + i};
+                    output << "f";
+                    for (int c : corners)
+                        output << " " << c - count << "/" << c - count;
+                    output << "\n";
+                }
+            }
+            // a face with a duplicate vertex (a triangle), and a duplicate of the first quad (absolute indices)
+            output << "v 2.0 0.0 1.0\nvt 2.0 0.0\nv 3.0 0.0 1.0\nvt 3.0 0.0\nv 3.0 1.0 1.0\nvt 3.0 1.0\n";
+            output << "f -3/-3 -2/-2 -2/-2 -1/-1\n";
+            output << "f 1/1 2/2 " << n + 3 << "/" << n + 3 << " " << n + 2 << "/" << n + 2 << "\n";
+            // a (folded) quad whose opposite vertices are coincident, but with different texture coordinates
+            output << "v 4.0 0.0 2.0\nvt 4.0 0.0\nv 5.0 0.0 2.0\nvt 5.0 0.0\n";
+            output << "v 4.0 0.0 2.0\nvt 4.0 1.0\nv 5.0 0.0 2.0\nvt 5.0 1.0\n";
+            output << "f -4/-4 -3/-3 -2/-2 -1/-1\n";
+        }
+
+        SurfaceMesh *grid = SurfaceMeshIO::load(obj_file_name);
+        bool success = grid && grid->n_faces() == static_cast<unsigned int>(n * n + 3);
+        auto texcoords = grid ? grid->get_halfedge_property<vec2>("h:texcoord") : SurfaceMesh::HalfedgeProperty<vec2>();
+        success = success && texcoords;
+        if (success) {
+            // the vertices of the folded quad keep their order, so its texture coordinates are checked in that order
+            const std::vector<vec2> folded = {vec2(4, 0), vec2(5, 0), vec2(4, 1), vec2(5, 1)};
+            for (auto f : grid->faces()) {
+                std::map<int, vec2> corners; // the texture coordinates of the corners ordered by their vertices
+                for (auto h : grid->halfedges(f)) {
+                    corners[grid->target(h).idx()] = texcoords[h];
+                    if (grid->position(grid->target(h)).z < 2.0f)
+                        success = success && texcoords[h] == vec2(grid->position(grid->target(h)));
+                }
+                if (grid->position(grid->target(grid->halfedge(f))).z == 2.0f) {
+                    std::vector<vec2> ordered;
+                    for (const auto &corner : corners)
+                        ordered.push_back(corner.second);
+                    success = success && ordered == folded;
+                }
+            }
+        }
+        delete grid;
+        file_system::delete_file(obj_file_name);
+
+        if (success)
+            std::cout << "OBJ file parsed in parallel and verified" << std::endl;
+        else {
+            std::cerr << "the model loaded from the OBJ file differs from the expected one" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    //	- load STL files: a binary file whose header starts with "solid" (detected by its size) and an ASCII file;
+    //	- weld the vertices of the triangles, exactly or in the cells of a grid.
+    {
+        // a square of two triangles. In the second triangle, the shared vertices are slightly off.
+        const float offset = 1.0e-4f;
+        const float triangles[2][3][3] = {{{0, 0, 0}, {1, 0, 0}, {1, 1, 0}},
+                                          {{offset, 0, 0}, {1, 1 + offset, 0}, {0, 1, 0}}};
+        const std::string stl_file_name = "./square.stl";
+
+        bool success = true;
+        for (bool binary : {true, false}) {
+            {
+                std::ofstream output(stl_file_name.c_str(), std::ios::binary);
+                if (binary) {
+                    // STL is little-endian
+                    auto put = [&](const void *value, std::size_t size) {
+                        const int one = 1;
+                        const bool little_endian = *reinterpret_cast<const char *>(&one) == 1;
+                        const char *bytes = static_cast<const char *>(value);
+                        for (std::size_t i = 0; i < size; ++i)
+                            output.put(bytes[little_endian ? i : size - 1 - i]);
+                    };
+                    const std::string header = "solid square (but binary)";
+                    output << header << std::string(80 - header.size(), ' ');
+                    const uint32_t num = 2;
+                    put(&num, sizeof(num));
+                    const float normal[3] = {0, 0, 1};
+                    for (const auto &t : triangles) {
+                        for (float v : normal)
+                            put(&v, sizeof(float));
+                        for (const auto &p : t) {
+                            for (float v : p)
+                                put(&v, sizeof(float));
+                        }
+                        output.put(0).put(0);
+                    }
+                } else {
+                    output << "solid square\n";
+                    for (const auto &t : triangles) {
+                        output << "  facet normal 0 0 1\n    outer loop\n";
+                        for (const auto &p : t)
+                            output << "      vertex " << p[0] << " " << p[1] << " " << p[2] << "\n";
+                        output << "    endloop\n  endfacet\n";
+                    }
+                    output << "endsolid square\n";
+                }
+            }
+
+            // exact welding: the off vertices are not welded, so the triangles are separate
+            SurfaceMesh exact;
+            success = success && io::load_stl(stl_file_name, &exact) && exact.n_faces() == 2 &&
+                      exact.n_vertices() == 6;
+            // welding in the cells of a grid
+            SurfaceMesh welded;
+            success = success && io::load_stl(stl_file_name, &welded, 0.01f) && welded.n_faces() == 2 &&
+                      welded.n_vertices() == 4 && welded.n_edges() == 5;
+            for (auto v : welded.vertices()) {
+                const vec3 &p = welded.position(v);
+                success = success && (p == vec3(0, 0, 0) || p == vec3(1, 0, 0) || p == vec3(1, 1, 0) ||
+                                      p == vec3(0, 1, 0));
+            }
+            file_system::delete_file(stl_file_name);
+        }
+
+        if (success)
+            std::cout << "binary and ASCII STL files loaded and verified" << std::endl;
+        else {
+            std::cerr << "the model loaded from the STL file differs from the expected one" << std::endl;
+            return EXIT_FAILURE;
+        }
     }
 
     return EXIT_SUCCESS;
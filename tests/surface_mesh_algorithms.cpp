@@ -27,16 +27,22 @@
 #include <easy3d/core/point_cloud.h>
 #include <easy3d/core/surface_mesh.h>
 #include <easy3d/core/poly_mesh.h>
+#include <easy3d/algo/surface_mesh_boolean.h>
 #include <easy3d/algo/surface_mesh_components.h>
+#include <easy3d/algo/connected_components.h>
+#include <easy3d/algo/marching_cubes.h>
 #include <easy3d/algo/surface_mesh_curvature.h>
 #include <easy3d/algo/surface_mesh_enumerator.h>
+#include <easy3d/algo/surface_mesh_factory.h>
 #include <easy3d/algo/surface_mesh_fairing.h>
 #include <easy3d/algo/surface_mesh_geodesic.h>
+#include <easy3d/algo/surface_mesh_heat_geodesic.h>
 #include <easy3d/algo/surface_mesh_hole_filling.h>
 #include <easy3d/algo/surface_mesh_parameterization.h>
 #include <easy3d/algo/surface_mesh_polygonization.h>
 #include <easy3d/algo/surface_mesh_remeshing.h>
 #include <easy3d/algo/surface_mesh_sampler.h>
+#include <easy3d/algo/surface_mesh_sdf.h>
 #include <easy3d/algo/surface_mesh_simplification.h>
 #include <easy3d/algo/surface_mesh_smoothing.h>
 #include <easy3d/algo/surface_mesh_stitching.h>
@@ -44,12 +50,25 @@
 #include <easy3d/algo/surface_mesh_tetrahedralization.h>
 #include <easy3d/algo/surface_mesh_topology.h>
 #include <easy3d/algo/surface_mesh_triangulation.h>
+#include <easy3d/algo/surface_mesh_winding_number.h>
 #include <easy3d/algo/surface_mesh_features.h>
+#include <easy3d/algo/triangle_mesh_kdtree.h>
 #include <easy3d/fileio/surface_mesh_io.h>
 #include <easy3d/fileio/resources.h>
 
+#include <random>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #if HAS_CGAL
 #include <easy3d/algo_ext/surfacer.h>
+#include <easy3d/algo_ext/box_intersection.h>
+#include <easy3d/algo_ext/self_intersection.h>
 #endif
 
 
@@ -76,6 +95,16 @@ bool test_algo_surface_mesh_components() {
         std::cout << "        " << i << ": " << comp.n_faces() << " faces, " << comp.n_vertices() << " vertices, " << comp.n_edges() << " edges, surface area " << comp.area() << ", border_length " << comp.border_length() << "\n";
     }
 
+    std::cout << "labeling connected components of the vertices..." << std::endl;
+    auto label = mesh->add_vertex_property<int>("v:component");
+    std::vector<ConnectedComponents::Stats> stats;
+    const int num_labels = ConnectedComponents::label(mesh, label, &stats);
+    if (num_labels != static_cast<int>(components.size()) || stats[0].size != components[0].n_vertices()) {
+        delete mesh;
+        return false;
+    }
+    std::cout << "    the first component has surface area " << stats[0].area << std::endl;
+
     delete mesh;
     return true;
 }
@@ -151,8 +180,52 @@ bool test_algo_surface_mesh_curvature() {
 
     std::cout << "computing surface mesh max absolute curvatures..." << std::endl;
     analyzer.compute_max_abs_curvature();
-
     delete mesh;
+
+    // on a sphere of radius r, the mean curvature is 1/r and the Gaussian curvature is 1/r^2 (up to the sign)
+    const float radius = 2.0f;
+    SurfaceMesh sphere = SurfaceMeshFactory::icosphere(4);
+    for (auto v : sphere.vertices())
+        sphere.position(v) *= radius;
+    for (int tensor = 0; tensor < 2; ++tensor) {
+        std::cout << "computing the curvatures of a sphere (" << (tensor ? "curvature tensor" : "Laplace-Beltrami")
+                  << ")..." << std::endl;
+        // the results must not depend on the number of threads
+        std::vector<float> serial;
+        for (int run = 0; run < 2; ++run) {
+#ifdef _OPENMP
+            const int num_threads = omp_get_max_threads();
+            omp_set_num_threads(run == 0 ? 1 : std::max(4, num_threads));
+#endif
+            SurfaceMeshCurvature curvature(&sphere);
+            if (tensor)
+                curvature.analyze_tensor(0, true);
+            else
+                curvature.analyze(0);
+#ifdef _OPENMP
+            omp_set_num_threads(num_threads);
+#endif
+            float max_mean_error = 0.0f, max_gauss_error = 0.0f;
+            std::size_t idx = 0;
+            for (auto v : sphere.vertices()) {
+                const float mean = curvature.mean_curvature(v), gauss = curvature.gauss_curvature(v);
+                max_mean_error = std::max(max_mean_error, std::abs(std::abs(mean) * radius - 1.0f));
+                max_gauss_error = std::max(max_gauss_error, std::abs(gauss * radius * radius - 1.0f));
+                if (run == 0) {
+                    serial.push_back(mean);
+                    serial.push_back(gauss);
+                } else if (serial[idx++] != mean || serial[idx++] != gauss) {
+                    std::cerr << "Error: the curvatures computed in parallel differ from the serial ones" << std::endl;
+                    return false;
+                }
+            }
+            if (max_mean_error > 0.05f || max_gauss_error > 0.1f) {
+                std::cerr << "Error: wrong curvatures of a sphere (relative errors: " << max_mean_error << " (mean), "
+                          << max_gauss_error << " (Gaussian))" << std::endl;
+                return false;
+            }
+        }
+    }
     return true;
 }
 
@@ -226,6 +299,63 @@ bool test_algo_surface_mesh_geodesic() {
     // compute geodesic distance
     SurfaceMeshGeodesic geodist(mesh);
     geodist.compute(seeds);
+    std::vector<float> exact(mesh->n_vertices());
+    for (auto v : mesh->vertices())
+        exact[v.idx()] = geodist(v);
+
+    std::cout << "computing geodesic distance (heat method) from the first vertex..." << std::endl;
+    SurfaceMeshHeatGeodesic heat(mesh);
+    if (!heat.compute(seeds)) {
+        delete mesh;
+        return false;
+    }
+
+    // the heat method approximates the distances computed by SurfaceMeshGeodesic (reachable vertices only)
+    float max_distance = 0.0f;
+    double sum_error = 0.0;
+    std::size_t num_reachable = 0;
+    for (auto v : mesh->vertices()) {
+        if (exact[v.idx()] >= FLT_MAX)
+            continue;
+        max_distance = std::max(max_distance, exact[v.idx()]);
+        sum_error += std::abs(heat(v) - exact[v.idx()]);
+        ++num_reachable;
+    }
+    const double mean_error = num_reachable > 0 ? sum_error / num_reachable : 0.0;
+    std::cout << "    mean error w.r.t. the maximum distance: " << mean_error / max_distance << std::endl;
+    if (num_reachable < 2 || mean_error > 0.03 * max_distance) {
+        std::cerr << "Error: the distances computed by the heat method differ from the exact ones" << std::endl;
+        delete mesh;
+        return false;
+    }
+
+    std::cout << "computing geodesic distance (heat method) for a batch of seed sets..." << std::endl;
+    std::vector< std::vector<SurfaceMesh::Vertex> > seed_sets = {
+            {SurfaceMesh::Vertex(0)},
+            {SurfaceMesh::Vertex(1), SurfaceMesh::Vertex(2)},
+            {SurfaceMesh::Vertex(mesh->n_vertices() / 2)}
+    };
+    std::vector< std::vector<float> > distances;
+    if (!heat.compute(seed_sets, distances) || distances.size() != seed_sets.size()) {
+        delete mesh;
+        return false;
+    }
+
+    // the results of a batch equal those computed from each seed set separately
+    for (std::size_t i = 0; i < seed_sets.size(); ++i) {
+        if (!heat.compute(seed_sets[i]) || distances[i].size() != mesh->n_vertices()) {
+            delete mesh;
+            return false;
+        }
+        for (auto v : mesh->vertices()) {
+            if (std::abs(distances[i][v.idx()] - heat(v)) > 1e-6f * max_distance) {
+                std::cerr << "Error: the distances computed in a batch differ from the ones computed separately"
+                          << std::endl;
+                delete mesh;
+                return false;
+            }
+        }
+    }
 
     delete mesh;
     return true;
@@ -388,14 +518,162 @@ bool test_algo_surface_mesh_sampler() {
 
     std::cout << "sampling surface mesh..." << std::endl;
     SurfaceMeshSampler sampler;
-    PointCloud *cloud = sampler.apply(mesh, 100000);
+    const int num = 100000;
+    PointCloud *cloud = sampler.apply(mesh, num);
+    PointCloud *again = sampler.apply(mesh, num);
+    bool ok = cloud && again && cloud->n_vertices() == static_cast<unsigned int>(num) &&
+              again->n_vertices() == static_cast<unsigned int>(num);
+    if (ok) {
+        // the samples are on the surface (thus inside the bounding box) and are the same for the same seed
+        const Box3 &box = mesh->bounding_box();
+        const float tolerance = 1e-5f * box.diagonal_length();
+        const auto &points = cloud->points();
+        const auto &points_again = again->points();
+        for (std::size_t i = 0; i < points.size() && ok; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                if (points[i][k] < box.min_coord(k) - tolerance || points[i][k] > box.max_coord(k) + tolerance)
+                    ok = false;
+            }
+            ok = ok && points[i] == points_again[i];
+        }
+        if (!ok)
+            std::cerr << "the samples are outside the model or not deterministic" << std::endl;
+    }
+    delete cloud;
+    delete again;
+    if (!ok) {
+        delete mesh;
+        return false;
+    }
+
+    std::cout << "sampling surface mesh (Poisson disk)..." << std::endl;
+    const int num_blue_noise = 10000;
+    PointCloud *blue_noise = sampler.apply_poisson_disk(mesh, num_blue_noise);
+    double area = 0.0;
+    for (auto f : mesh->faces()) {
+        std::vector<vec3> vts;
+        for (auto v : mesh->vertices(f))
+            vts.push_back(mesh->position(v));
+        area += geom::triangle_area(vts[0], vts[1], vts[2]);
+    }
     delete mesh;
+    if (!blue_noise)
+        return false;
 
-    if (cloud) {
-        delete cloud;
+    // roughly the expected number of points, and no two of them are closer than the radius (estimated from the
+    // area in the same way as the sampler does)
+    const auto &points = blue_noise->points();
+    ok = points.size() > static_cast<std::size_t>(num_blue_noise / 2) &&
+         points.size() < static_cast<std::size_t>(num_blue_noise * 2);
+    const float radius = static_cast<float>(std::sqrt(area / (1.9 * num_blue_noise)));
+    const float sqr_min_distance = radius * radius * 0.999f;
+    for (std::size_t i = 0; i < points.size() && ok; ++i) {
+        for (std::size_t j = i + 1; j < points.size(); ++j) {
+            if (distance2(points[i], points[j]) < sqr_min_distance) {
+                ok = false;
+                break;
+            }
+        }
+    }
+    if (!ok)
+        std::cerr << "the Poisson-disk samples are too many, too few, or too close" << std::endl;
+    delete blue_noise;
+    return ok;
+}
+
+
+bool test_algo_surface_mesh_boolean() {
+    const std::string file = resource::directory() + "/data/bunny.ply";
+    SurfaceMesh *mesh = SurfaceMeshIO::load(file);
+    if (!mesh) {
+        std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                  << std::endl;
+        return false;
+    }
+
+    // a shifted copy of the model
+    SurfaceMesh copy = *mesh;
+    const vec3 offset = mesh->bounding_box().diagonal_vector() * 0.2f;
+    for (auto v : copy.vertices())
+        copy.position(v) += offset;
+
+    const std::vector<std::pair<SurfaceMeshBoolean::Operation, std::string> > operations = {
+            {SurfaceMeshBoolean::UNION,        "union"},
+            {SurfaceMeshBoolean::INTERSECTION, "intersection"},
+            {SurfaceMeshBoolean::DIFFERENCE,   "difference"}
+    };
+    for (const auto &op : operations) {
+        std::cout << "computing the " << op.second << " of two surface meshes..." << std::endl;
+        SurfaceMesh *result = SurfaceMeshBoolean::apply(mesh, &copy, op.first);
+        if (!result) {
+            delete mesh;
+            return false;
+        }
+        std::cout << "    result has " << result->n_faces() << " faces" << std::endl;
+        delete result;
+    }
+    delete mesh;
+
+    // two overlapping spheres: the results must be closed, and vol(A U B) + vol(A n B) = vol(A) + vol(B)
+    auto volume = [](const SurfaceMesh *m) -> double {
+        double sum = 0.0;
+        for (auto f : m->faces()) {
+            std::vector<dvec3> p;
+            for (auto v : m->vertices(f))
+                p.push_back(dvec3(m->position(v)));
+            for (std::size_t i = 1; i + 1 < p.size(); ++i)
+                sum += dot(p[0], cross(p[i], p[i + 1])) / 6.0;
+        }
+        return sum;
+    };
+    auto is_closed = [](const SurfaceMesh *m) -> bool {
+        for (auto h : m->halfedges()) {
+            if (m->is_border(h))
+                return false;
+        }
         return true;
+    };
+
+    const SurfaceMesh sphere_a = SurfaceMeshFactory::icosphere(3);
+    SurfaceMesh sphere_b = SurfaceMeshFactory::icosphere(4);
+    const mat3 rot = mat3::rotation(normalize(vec3(1, 2, 3)), 0.3f);
+    for (auto v : sphere_b.vertices())
+        sphere_b.position(v) = rot * sphere_b.position(v) + vec3(0.7f, 0.3f, 0.2f);
+
+    std::cout << "computing the union and intersection of two spheres..." << std::endl;
+    double volumes[2] = {0.0, 0.0};
+    const SurfaceMeshBoolean::Operation ops[2] = {SurfaceMeshBoolean::UNION, SurfaceMeshBoolean::INTERSECTION};
+    for (int i = 0; i < 2; ++i) {
+        SurfaceMesh *result = SurfaceMeshBoolean::apply(&sphere_a, &sphere_b, ops[i]);
+        if (!result || result->n_faces() == 0 || !is_closed(result)) {
+            std::cerr << "the result is empty or not closed" << std::endl;
+            delete result;
+            return false;
+        }
+        volumes[i] = volume(result);
+        delete result;
     }
-    return false;
+    const double va = volume(&sphere_a), vb = volume(&sphere_b);
+    if (volumes[1] <= 0.0 || std::abs(volumes[0] + volumes[1] - va - vb) > 1e-6 * (va + vb)) {
+        std::cerr << "inconsistent volumes: " << volumes[0] << " + " << volumes[1] << " vs. " << va << " + " << vb
+                  << std::endl;
+        return false;
+    }
+
+    // an empty operand
+    SurfaceMesh empty;
+    SurfaceMesh *result = SurfaceMeshBoolean::apply(&sphere_a, &empty, SurfaceMeshBoolean::UNION);
+    const bool copied = result && result->n_faces() == sphere_a.n_faces();
+    delete result;
+    result = SurfaceMeshBoolean::apply(&empty, &sphere_b, SurfaceMeshBoolean::INTERSECTION);
+    const bool cleared = result && result->n_faces() == 0;
+    delete result;
+    if (!copied || !cleared) {
+        std::cerr << "unexpected result with an empty operand" << std::endl;
+        return false;
+    }
+
+    return true;
 }
 
 
@@ -431,27 +709,128 @@ bool test_algo_surface_mesh_smoothing() {
         return false;
     }
 
+    // the average length of the uniform Laplacian of the interior vertices: it decreases when the mesh is smoothed
+    auto roughness = [](const SurfaceMesh *m) -> float {
+        float sum = 0.0f;
+        int count = 0;
+        for (auto v : m->vertices()) {
+            if (m->is_border(v))
+                continue;
+            vec3 center(0, 0, 0);
+            for (auto vv : m->vertices(v))
+                center += m->position(vv);
+            sum += distance(center / static_cast<float>(m->valence(v)), m->position(v));
+            ++count;
+        }
+        return count > 0 ? sum / static_cast<float>(count) : 0.0f;
+    };
+
+    // the largest distance between the corresponding vertices of two meshes with the same connectivity
+    auto max_deviation = [](const SurfaceMesh *a, const SurfaceMesh *b) -> float {
+        float dist = 0.0f;
+        for (auto v : a->vertices())
+            dist = std::max(dist, distance(a->position(v), b->position(v)));
+        return dist;
+    };
+
+    const float diagonal = mesh->bounding_box().diagonal_length();
+    const float tolerance = 1e-5f * diagonal;
+
+    // does the mesh have a boundary?
+    bool has_boundary = false;
+    for (auto v: mesh->vertices())
+        if (mesh->is_border(v))
+            has_boundary = true;
+
+    // only re-scale if we don't have a (fixed) boundary
+    const bool rescale = !has_boundary;
+
     std::cout << "explicit smoothing..." << std::endl;
     {
-        SurfaceMeshSmoothing smoother(mesh);
+        SurfaceMesh copy(*mesh);
+        SurfaceMeshSmoothing smoother(&copy);
         smoother.explicit_smoothing(2, true);
+        if (roughness(&copy) >= roughness(mesh)) {
+            std::cerr << "explicit smoothing didn't reduce the roughness of the mesh" << std::endl;
+            delete mesh;
+            return false;
+        }
+
+        // switching the Laplacian must recompute the edge weights: the result must equal that of a new smoother
+        SurfaceMesh fresh(*mesh);
+        smoother.explicit_smoothing(2, false);
+        {
+            SurfaceMeshSmoothing another(&fresh);
+            another.explicit_smoothing(2, true);
+        }
+        {
+            SurfaceMeshSmoothing another(&fresh);
+            another.explicit_smoothing(2, false);
+        }
+        if (max_deviation(&copy, &fresh) > tolerance) {
+            std::cerr << "explicit smoothing after switching the Laplacian used stale edge weights" << std::endl;
+            delete mesh;
+            return false;
+        }
     }
 
     std::cout << "implicit smoothing..." << std::endl;
     {
         const float timestep = 0.001f;
 
-        // does the mesh have a boundary?
-        bool has_boundary = false;
-        for (auto v: mesh->vertices())
-            if (mesh->is_border(v))
-                has_boundary = true;
-
-        // only re-scale if we don't have a (fixed) boundary
-        const bool rescale = !has_boundary;
+        SurfaceMesh cached(*mesh), fresh(*mesh);
+        SurfaceMeshSmoothing smoother(&cached);
+        smoother.implicit_smoothing(timestep, true, rescale);
+        if (roughness(&cached) >= roughness(mesh)) {
+            std::cerr << "implicit smoothing didn't reduce the roughness of the mesh" << std::endl;
+            delete mesh;
+            return false;
+        }
 
-        SurfaceMeshSmoothing smoother(mesh);
+        std::cout << "implicit smoothing (reusing the factorized system)..." << std::endl;
         smoother.implicit_smoothing(timestep, true, rescale);
+
+        // the uniform Laplacian doesn't depend on the geometry: reusing the factorized system must give the same
+        // result as two smoothing steps with a new system each
+        for (int i = 0; i < 2; ++i) {
+            SurfaceMeshSmoothing another(&fresh);
+            another.implicit_smoothing(timestep, true, rescale);
+        }
+        if (max_deviation(&cached, &fresh) > tolerance) {
+            std::cerr << "implicit smoothing with the cached system differs from that with a new system" << std::endl;
+            delete mesh;
+            return false;
+        }
+    }
+
+    std::cout << "implicit smoothing (after the geometry was modified elsewhere)..." << std::endl;
+    {
+        const float timestep = 0.001f * diagonal * diagonal;
+
+        SurfaceMesh cached(*mesh), fresh(*mesh);
+        SurfaceMeshSmoothing smoother(&cached);
+        smoother.implicit_smoothing(timestep, false, false);
+        {
+            SurfaceMeshSmoothing another(&fresh);
+            another.implicit_smoothing(timestep, false, false);
+        }
+
+        // the cotan Laplacian (the vertex weights) depends on the scale, so the cached system must be rebuilt
+        for (auto v : cached.vertices())
+            cached.position(v) *= 2.0f;
+        for (auto v : fresh.vertices())
+            fresh.position(v) *= 2.0f;
+
+        smoother.implicit_smoothing(timestep, false, false);
+        {
+            SurfaceMeshSmoothing another(&fresh);
+            another.implicit_smoothing(timestep, false, false);
+        }
+        if (max_deviation(&cached, &fresh) > 2.0f * tolerance) {
+            std::cerr << "the cached system was not rebuilt after the geometry was modified" << std::endl;
+            delete mesh;
+            return false;
+        }
     }
 
     delete mesh;
@@ -557,6 +936,253 @@ bool test_algo_surface_mesh_triangulation() {
 }
 
 
+bool test_algo_surface_mesh_winding_number() {
+    const std::string file = resource::directory() + "/data/bunny.ply";
+    SurfaceMesh *mesh = SurfaceMeshIO::load(file);
+    if (!mesh) {
+        std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                  << std::endl;
+        return false;
+    }
+
+    std::cout << "computing generalized winding numbers..." << std::endl;
+    const SurfaceMeshWindingNumber winding(mesh);
+
+    // the points of a regular grid in the bounding box
+    const Box3 &box = mesh->bounding_box();
+    const int res = 64;
+    const vec3 step = box.diagonal_vector() / static_cast<float>(res);
+    std::vector<vec3> points;
+    for (int i = 0; i < res; ++i) {
+        for (int j = 0; j < res; ++j) {
+            for (int k = 0; k < res; ++k)
+                points.push_back(box.min_point() + vec3(step.x * (i + 0.5f), step.y * (j + 0.5f), step.z * (k + 0.5f)));
+        }
+    }
+    const std::vector<float> values = winding.winding_numbers(points);
+
+    std::size_t num_inside = 0;
+    for (auto v : values) {
+        if (std::abs(v) > 0.5f)
+            ++num_inside;
+    }
+    std::cout << "    " << num_inside << " of " << points.size() << " grid points are inside" << std::endl;
+
+    // a point outside of the bounding box is outside of the model
+    const bool outside = !winding.is_inside(box.min_point() - box.diagonal_vector());
+    if (num_inside == 0 || num_inside == points.size() || !outside) {
+        delete mesh;
+        return false;
+    }
+
+    // the exact winding number: the sum of the solid angles of the triangles (Van Oosterom and Strackee)
+    auto exact_winding_number = [](const SurfaceMesh *m, const vec3 &p) -> double {
+        double sum = 0.0;
+        for (auto f : m->faces()) {
+            std::vector<dvec3> vts;
+            for (auto v : m->vertices(f))
+                vts.push_back(dvec3(m->position(v) - p));
+            for (std::size_t i = 1; i + 1 < vts.size(); ++i) {
+                const dvec3 &a = vts[0], &b = vts[i], &c = vts[i + 1];
+                const double la = a.norm(), lb = b.norm(), lc = c.norm();
+                const double det = dot(a, cross(b, c));
+                const double div = la * lb * lc + dot(a, b) * lc + dot(b, c) * la + dot(c, a) * lb;
+                sum += 2.0 * std::atan2(det, div);
+            }
+        }
+        return sum / (4.0 * M_PI);
+    };
+
+    // the error of the far-field approximation is below 0.01 (random points around the model)
+    std::mt19937 rng(123);
+    std::uniform_real_distribution<float> uniform(-0.1f, 1.1f);
+    double max_error = 0.0;
+    for (int i = 0; i < 100; ++i) {
+        const vec3 p(box.min_coord(0) + box.range(0) * uniform(rng), box.min_coord(1) + box.range(1) * uniform(rng),
+                     box.min_coord(2) + box.range(2) * uniform(rng));
+        max_error = std::max(max_error, std::abs(winding.winding_number(p) - exact_winding_number(mesh, p)));
+    }
+    std::cout << "    max error of the approximation: " << max_error << std::endl;
+    delete mesh;
+    if (max_error > 0.01) {
+        std::cerr << "Error: the approximated winding numbers differ from the exact ones" << std::endl;
+        return false;
+    }
+
+    // a closed mesh: 1 inside and 0 outside
+    const SurfaceMesh sphere = SurfaceMeshFactory::icosphere(3);
+    const SurfaceMeshWindingNumber sphere_winding(&sphere);
+    std::vector<vec3> inside, outside_points;
+    for (int i = 0; i < 100; ++i) {
+        const vec3 dir = normalize(vec3(uniform(rng), uniform(rng), uniform(rng)) - vec3(0.5f));
+        inside.push_back(dir * (0.8f * uniform(rng) + 0.08f));      // radius in [0, 0.96]
+        outside_points.push_back(dir * (2.0f * uniform(rng) + 1.3f)); // radius in [1.1, 3.5]
+    }
+    const std::vector<float> inside_values = sphere_winding.winding_numbers(inside);
+    const std::vector<float> outside_values = sphere_winding.winding_numbers(outside_points);
+    for (std::size_t i = 0; i < inside.size(); ++i) {
+        if (std::abs(inside_values[i] - 1.0f) > 0.01f || std::abs(outside_values[i]) > 0.01f) {
+            std::cerr << "Error: the winding numbers of a closed mesh must be 1 inside and 0 outside" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool test_algo_surface_mesh_sdf() {
+    const std::string file = resource::directory() + "/data/bunny.ply";
+    SurfaceMesh *mesh = SurfaceMeshIO::load(file);
+    if (!mesh) {
+        std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                  << std::endl;
+        return false;
+    }
+
+    const float voxel_size = mesh->bounding_box().diagonal_length() / 64.0f;
+    const float band_width = 3.0f * voxel_size;
+
+    std::cout << "computing the signed distance field..." << std::endl;
+    const SparseGrid<float> sdf = SurfaceMeshSDF::signed_distance(mesh, voxel_size, band_width);
+    std::size_t num_inside = 0, num_outside = 0;
+    for (std::size_t b = 0; b < sdf.num_blocks(); ++b) {
+        for (auto v : sdf.block(b).values) {
+            if (v < 0.0f)
+                ++num_inside;
+            else
+                ++num_outside;
+        }
+    }
+    std::cout << "    " << sdf.num_blocks() << " blocks, " << num_inside << " grid points inside, "
+              << num_outside << " grid points outside" << std::endl;
+
+    std::cout << "voxelizing the model..." << std::endl;
+    const SparseGrid<unsigned char> voxels = SurfaceMeshSDF::voxelize(mesh, voxel_size);
+    std::size_t num_voxels = 0;
+    for (std::size_t b = 0; b < voxels.num_blocks(); ++b) {
+        for (auto v : voxels.block(b).values)
+            num_voxels += v;
+    }
+    std::cout << "    " << voxels.num_blocks() << " blocks, " << num_voxels << " voxels inside" << std::endl;
+    if (num_inside == 0 || num_outside == 0 || num_voxels == 0) {
+        delete mesh;
+        return false;
+    }
+
+    // Checks the grid points in the band (i.e., not clamped): their distances to the surface (within one voxel),
+    // and their signs (except on the surface) against the voxelization and, if the mesh is closed, the signs computed
+    // with the winding numbers.
+    auto verify = [](const SurfaceMesh *m, float size, bool closed) -> bool {
+        const float band = 3.0f * size;
+        const SparseGrid<float> pseudo_normal = SurfaceMeshSDF::signed_distance(m, size, band);
+        const SparseGrid<float> winding = SurfaceMeshSDF::signed_distance(m, size, band, SurfaceMeshSDF::WINDING_NUMBER);
+        const SparseGrid<unsigned char> solid = SurfaceMeshSDF::voxelize(m, size);
+        const TriangleMeshKdTree tree(m);
+        int shift[3]; // the grid of the voxelization is shifted by a whole number of grid points
+        for (int k = 0; k < 3; ++k)
+            shift[k] = static_cast<int>(std::lround((pseudo_normal.origin()[k] - solid.origin()[k]) / size));
+
+        std::size_t num_samples = 0, num_distance_errors = 0, num_sign_errors = 0, num_voxel_errors = 0;
+        for (const SparseGrid<float> *grid : {&pseudo_normal, &winding}) {
+            for (std::size_t b = 0; b < grid->num_blocks(); ++b) {
+                const auto &block = grid->block(b);
+                for (int v = 0; v < SparseGrid<float>::block_volume; ++v) {
+                    const float value = block.values[v];
+                    if (std::abs(value) >= band)
+                        continue;
+                    int i, j, k;
+                    block.grid_point(v, i, j, k);
+                    ++num_samples;
+                    if (std::abs(std::abs(value) - tree.nearest(grid->position(i, j, k)).dist) > size)
+                        ++num_distance_errors;
+                    if (std::abs(value) < 1e-3f * size || (grid == &pseudo_normal && !closed))
+                        continue;
+                    if (closed && (value < 0.0f) != (winding.value(i, j, k) < 0.0f))
+                        ++num_sign_errors;
+                    if ((value < 0.0f) != (solid.value(i + shift[0], j + shift[1], k + shift[2]) == 1))
+                        ++num_voxel_errors;
+                }
+            }
+        }
+        std::cout << "    " << num_samples << " grid points in the band: " << num_distance_errors
+                  << " distance errors, " << num_sign_errors << " sign errors, " << num_voxel_errors
+                  << " voxelization errors" << std::endl;
+        return num_samples > 0 && num_distance_errors == 0 && num_sign_errors == 0 && num_voxel_errors == 0;
+    };
+
+    // the pseudo-normals give wrong signs near the holes of the bunny, so their signs are checked on a closed mesh
+    std::cout << "verifying the signed distance fields of the model..." << std::endl;
+    const bool success = verify(mesh, voxel_size, false);
+    delete mesh;
+    if (!success)
+        return false;
+
+    std::cout << "verifying the signed distance fields of a sphere..." << std::endl;
+    const SurfaceMesh sphere = SurfaceMeshFactory::icosphere(4);
+    return verify(&sphere, sphere.bounding_box().diagonal_length() / 64.0f, true);
+}
+
+bool test_algo_marching_cubes() {
+    const std::string file = resource::directory() + "/data/bunny.ply";
+    SurfaceMesh *mesh = SurfaceMeshIO::load(file);
+    if (!mesh) {
+        std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                  << std::endl;
+        return false;
+    }
+
+    const float voxel_size = mesh->bounding_box().diagonal_length() / 128.0f;
+    const SparseGrid<float> sdf = SurfaceMeshSDF::signed_distance(mesh, voxel_size, 2.0f * voxel_size,
+                                                                  SurfaceMeshSDF::WINDING_NUMBER);
+    delete mesh;
+
+    std::cout << "extracting the iso-surface of the signed distance field..." << std::endl;
+    SurfaceMesh *result = MarchingCubes::apply(sdf);
+    std::size_t num_borders = 0;
+    for (auto h : result->halfedges()) {
+        if (result->is_border(h))
+            ++num_borders;
+    }
+    std::cout << "    " << result->n_vertices() << " vertices, " << result->n_faces() << " faces, "
+              << num_borders << " border edges" << std::endl;
+
+    // the iso-surface of a sphere (sampled on a dense grid) is closed, and the iso-surface of a sphere cut by the
+    // grid boundary has its borders on the boundary. Sizes 2^k + 1 have a last block containing only the boundary.
+    bool closed = true, cut = true;
+    for (int res : {32, 33}) {
+        const float c = 0.5f * static_cast<float>(res - 1);
+        std::vector<float> values(res * res * res), cut_values(res * res * res);
+        for (int k = 0; k < res; ++k) {
+            for (int j = 0; j < res; ++j) {
+                for (int i = 0; i < res; ++i) {
+                    values[i + res * (j + res * k)] = distance(vec3(i, j, k), vec3(c, c, c)) - 10.0f;
+                    cut_values[i + res * (j + res * k)] = distance(vec3(i, j, k), vec3(res - 1, c, c)) - 10.0f;
+                }
+            }
+        }
+
+        SurfaceMesh *sphere = MarchingCubes::apply(values, res, res, res, vec3(0, 0, 0), 1.0f);
+        closed = closed && sphere->n_faces() > 0 && sphere->is_closed();
+        std::cout << "    sphere (" << res << "^3 grid): " << sphere->n_vertices() << " vertices, "
+                  << sphere->n_faces() << " faces" << std::endl;
+        delete sphere;
+
+        SurfaceMesh *half = MarchingCubes::apply(cut_values, res, res, res, vec3(0, 0, 0), 1.0f);
+        cut = cut && half->n_faces() > 0 && !half->is_closed();
+        for (auto v : half->vertices()) {
+            if (half->is_border(v) && std::abs(half->position(v).x - static_cast<float>(res - 1)) > 1e-4f)
+                cut = false;
+        }
+        std::cout << "    cut sphere (" << res << "^3 grid): " << half->n_vertices() << " vertices, "
+                  << half->n_faces() << " faces" << std::endl;
+        delete half;
+    }
+
+    const bool success = result->n_faces() > 0 && num_borders == 0 && closed && cut;
+    delete result;
+    return success;
+}
+
 #ifdef HAS_CGAL
 
 int test_surface_mesh_remesh_self_intersections() {
@@ -580,6 +1206,117 @@ int test_surface_mesh_remesh_self_intersections() {
     return false;
 }
 
+bool test_algo_box_self_intersection() {
+    std::cout << "box self intersection..." << std::endl;
+
+    // small and large boxes, flat boxes, touching boxes, and invalid boxes
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(0.0f, 1.0f), extent(0.0f, 0.03f);
+    const int num = 3000;
+    std::vector<Box3> boxes(num);
+    for (int i = 0; i < num; ++i) {
+        if (i % 101 == 7)
+            continue;   // invalid
+        if (i % 53 == 11) { // touching the previous box
+            const vec3 corner = boxes[i - 1].max_point();
+            boxes[i].grow(corner);
+            boxes[i].grow(corner + vec3(extent(rng), extent(rng), extent(rng)));
+            continue;
+        }
+        const vec3 p(position(rng), position(rng), position(rng));
+        vec3 size(extent(rng), extent(rng), i % 7 == 0 ? 0.0f : extent(rng));
+        if (i % 97 == 0)
+            size *= 15.0f;
+        boxes[i].grow(p);
+        boxes[i].grow(p + size);
+    }
+
+    std::vector<std::pair<int, int> > pairs;
+    box_self_intersection(boxes, pairs);
+
+    std::vector<std::pair<int, int> > expected;
+    for (int i = 0; i < num; ++i) {
+        for (int j = i + 1; j < num; ++j) {
+            if (!boxes[i].is_valid() || !boxes[j].is_valid())
+                continue;
+            bool overlap = true;
+            for (int k = 0; k < 3; ++k) {
+                overlap = overlap && boxes[i].min_coord(k) <= boxes[j].max_coord(k) &&
+                          boxes[j].min_coord(k) <= boxes[i].max_coord(k);
+            }
+            if (overlap)
+                expected.emplace_back(i, j);
+        }
+    }
+    if (pairs != expected) {
+        std::cerr << "Error: " << pairs.size() << " intersecting pairs of boxes found (" << expected.size()
+                  << " expected)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool test_surface_mesh_self_intersection_filter() {
+    // Two overlapping spheres, and three coplanar grids: the second one shifted by half a cell (overlapping
+    // triangles) and the third one by a cell (geometrically shared vertices and overlapping edges).
+    const std::string file = resource::directory() + "/data/sphere.obj";
+    SurfaceMesh *sphere = SurfaceMeshIO::load(file);
+    if (!sphere) {
+        std::cerr << "Error: failed to load model. Please make sure the file exists and format is correct."
+                  << std::endl;
+        return false;
+    }
+    SurfaceMesh mesh;
+    const float radius = sphere->bounding_box().radius();
+    for (const vec3 &offset : {vec3(0, 0, 0), vec3(0.7f * radius, 0.1f * radius, 0)}) {
+        std::vector<SurfaceMesh::Vertex> vertices;
+        for (auto v : sphere->vertices())
+            vertices.push_back(mesh.add_vertex(sphere->position(v) + offset));
+        for (auto f : sphere->faces()) {
+            std::vector<SurfaceMesh::Vertex> face;
+            for (auto v : sphere->vertices(f))
+                face.push_back(vertices[v.idx()]);
+            mesh.add_face(face);
+        }
+    }
+    delete sphere;
+    const int n = 8;
+    const float cell = radius / n;
+    for (const vec3 &offset : {vec3(0, 0, 0), vec3(0.5f * cell, 0.5f * cell, 0), vec3(cell, 0, 0)}) {
+        std::vector<SurfaceMesh::Vertex> vertices;
+        for (int j = 0; j <= n; ++j) {
+            for (int i = 0; i <= n; ++i)
+                vertices.push_back(mesh.add_vertex(vec3(i * cell, j * cell, 3 * radius) + offset));
+        }
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                const int a = j * (n + 1) + i, b = a + 1, c = a + n + 2, d = a + n + 1;
+                mesh.add_triangle(vertices[a], vertices[b], vertices[c]);
+                mesh.add_triangle(vertices[a], vertices[c], vertices[d]);
+            }
+        }
+    }
+
+    std::cout << "detecting self intersections with and without the floating-point filter..." << std::endl;
+    auto detect = [&mesh](bool filter) -> std::vector<std::pair<int, int> > {
+        SelfIntersection algo;
+        algo.set_filter_enabled(filter);
+        std::vector<std::pair<int, int> > pairs;
+        for (const auto &p : algo.detect(&mesh))
+            pairs.emplace_back(std::min(p.first.idx(), p.second.idx()), std::max(p.first.idx(), p.second.idx()));
+        std::sort(pairs.begin(), pairs.end());
+        return pairs;
+    };
+    const auto filtered = detect(true);
+    const auto exact = detect(false);
+    if (exact.empty() || filtered != exact) {
+        std::cerr << "Error: " << filtered.size() << " intersecting pairs of faces found with the filter ("
+                  << exact.size() << " without)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 int test_surface_mesh_remove_overlapping_faces() {
     const std::string file = resource::directory() + "/data/house/house.obj";
     SurfaceMesh *mesh = SurfaceMeshIO::load(file);
@@ -667,13 +1404,83 @@ int test_surface_mesh_slice() {
         planes[i] = Plane3(vec3(0, 0, minz + i * step), vec3(0, 0, 1));
 
     const std::vector< std::vector<Surfacer::Polyline> >& all_polylines = Surfacer::slice(mesh, planes);
-    if (!all_polylines.empty()) {
-        delete mesh;
-        return true;
-    }
-
     delete mesh;
-    return false;
+    if (all_polylines.size() != num)
+        return false;
+
+    // A unit sphere (with 32 rings and 48 segments) sliced by horizontal planes gives exactly one closed polyline per
+    // plane. The mesh has a deleted face before the sphere, so the last faces are only visited if the deleted ones
+    // are accounted for.
+    std::cout << "slicing a sphere (by planes with opposite normals)..." << std::endl;
+    SurfaceMesh sphere;
+    const auto d0 = sphere.add_vertex(vec3(10, 10, 10));
+    const auto d1 = sphere.add_vertex(vec3(11, 10, 10));
+    const auto d2 = sphere.add_vertex(vec3(10, 11, 10));
+    const auto dummy = sphere.add_triangle(d0, d1, d2);
+    const int rings = 32, segments = 48;
+    const auto north = sphere.add_vertex(vec3(0, 0, 1));
+    std::vector<SurfaceMesh::Vertex> vts;
+    for (int i = 1; i < rings; ++i) {
+        const float theta = static_cast<float>(M_PI) * i / rings;
+        for (int j = 0; j < segments; ++j) {
+            const float phi = 2.0f * static_cast<float>(M_PI) * j / segments;
+            const vec3 p(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+            vts.push_back(sphere.add_vertex(p));
+        }
+    }
+    const auto south = sphere.add_vertex(vec3(0, 0, -1));
+    for (int j = 0; j < segments; ++j) {
+        const int k = (j + 1) % segments;
+        sphere.add_triangle(north, vts[j], vts[k]);
+        for (int i = 0; i + 2 < rings; ++i) {
+            sphere.add_triangle(vts[i * segments + j], vts[(i + 1) * segments + j], vts[(i + 1) * segments + k]);
+            sphere.add_triangle(vts[i * segments + j], vts[(i + 1) * segments + k], vts[i * segments + k]);
+        }
+        sphere.add_triangle(vts[(rings - 2) * segments + j], south, vts[(rings - 2) * segments + k]);
+    }
+    sphere.delete_face(dummy);
+
+    // the last plane crosses the last face
+    std::vector<float> levels = {-0.77f, -0.31f, 0.05f, 0.42f, 0.88f};
+    float last_level = 0.0f;
+    for (auto v : sphere.vertices(SurfaceMesh::Face(static_cast<int>(sphere.faces_size() - 1))))
+        last_level += sphere.position(v).z / 3.0f;
+    levels.push_back(last_level);
+    std::vector<Plane3> sphere_planes;
+    for (auto level : levels) {
+        sphere_planes.push_back(Plane3(vec3(0, 0, level), vec3(0, 0, 1)));
+        sphere_planes.push_back(Plane3(vec3(0, 0, level), vec3(0, 0, -1)));
+    }
+    const auto sections = Surfacer::slice(&sphere, sphere_planes);
+    for (std::size_t i = 0; i < levels.size(); ++i) {
+        const auto &up = sections[i * 2];
+        const auto &down = sections[i * 2 + 1];
+        if (up.size() != 1 || down.size() != 1 || up[0].size() < 4 || up[0].front() != up[0].back()) {
+            std::cerr << "Error: a sphere should be sliced into a single closed polyline" << std::endl;
+            return false;
+        }
+        // the polylines of opposite planes are reversed, and those w.r.t. the upward planes are counterclockwise
+        // (seen from above)
+        if (!std::equal(up[0].begin(), up[0].end(), down[0].rbegin())) {
+            std::cerr << "Error: planes with opposite normals should give reversed polylines" << std::endl;
+            return false;
+        }
+        float area = 0.0f;
+        for (std::size_t j = 0; j + 1 < up[0].size(); ++j) {
+            const vec3 &p = up[0][j];
+            const vec3 &q = up[0][j + 1];
+            area += p.x * q.y - q.x * p.y;
+            if (std::abs(p.z - levels[i]) > 1e-5f || p.length() > 1.0f + 1e-5f || p.length() < 0.99f) {
+                std::cerr << "Error: a point of the polyline is not on the sphere and the plane" << std::endl;
+                return false;
+            }
+        }
+        if (area <= 0.0f) {
+            std::cerr << "Error: the polylines should be oriented counterclockwise w.r.t. the plane normal" << std::endl;
+            return false;
+        }
+    }
+    return true;
 }
 
 #endif
@@ -713,6 +1520,9 @@ int test_surface_mesh_algorithms() {
     if (!test_algo_surface_mesh_sampler())
         return EXIT_FAILURE;
 
+    if (!test_algo_surface_mesh_boolean())
+        return EXIT_FAILURE;
+
     if (!test_algo_surface_mesh_simplification())
         return EXIT_FAILURE;
 
@@ -731,7 +1541,22 @@ int test_surface_mesh_algorithms() {
     if (!test_algo_surface_mesh_triangulation())
         return EXIT_FAILURE;
 
+    if (!test_algo_surface_mesh_winding_number())
+        return EXIT_FAILURE;
+
+    if (!test_algo_surface_mesh_sdf())
+        return EXIT_FAILURE;
+
+    if (!test_algo_marching_cubes())
+        return EXIT_FAILURE;
+
 #ifdef HAS_CGAL
+    if (!test_algo_box_self_intersection())
+        return EXIT_FAILURE;
+
+    if (!test_surface_mesh_self_intersection_filter())
+        return EXIT_FAILURE;
+
     if (!test_surface_mesh_remesh_self_intersections())
         return EXIT_FAILURE;
 
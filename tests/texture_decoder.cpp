@@ -0,0 +1,373 @@
+/********************************************************************
+ * Copyright (C) 2015 Liangliang Nan <liangliang.nan@gmail.com>
+ * https://3d.bk.tudelft.nl/liangliang/
+ *
+ * This file is part of Easy3D. If it is useful in your research/work,
+ * I would be grateful if you show your appreciation by citing it:
+ * ------------------------------------------------------------------
+ *      Liangliang Nan.
+ *      Easy3D: a lightweight, easy-to-use, and efficient C++ library
+ *      for processing and rendering 3D data.
+ *      Journal of Open Source Software, 6(64), 3255, 2021.
+ * ------------------------------------------------------------------
+ *
+ * Easy3D is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License Version 3
+ * as published by the Free Software Foundation.
+ *
+ * Easy3D is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ ********************************************************************/
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+
+#include <easy3d/renderer/texture_decoder.h>
+#include <easy3d/fileio/image_io.h>
+#include <easy3d/util/file_system.h>
+
+using namespace easy3d;
+
+
+namespace {
+
+    // decodes a BC1 block (8 bytes) into 16 RGB pixels
+    void decode_bc1_block(const unsigned char *in, unsigned char out[16][3]) {
+        const unsigned short c[2] = {static_cast<unsigned short>(in[0] | (in[1] << 8)),
+                                     static_cast<unsigned short>(in[2] | (in[3] << 8))};
+        int palette[4][3];
+        for (int i = 0; i < 2; ++i) {
+            const int r = (c[i] >> 11) & 31, g = (c[i] >> 5) & 63, b = c[i] & 31;
+            palette[i][0] = (r << 3) | (r >> 2);
+            palette[i][1] = (g << 2) | (g >> 4);
+            palette[i][2] = (b << 3) | (b >> 2);
+        }
+        for (int k = 0; k < 3; ++k) {
+            if (c[0] > c[1]) {
+                palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+                palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+            } else {
+                palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+                palette[3][k] = 0;
+            }
+        }
+        const unsigned int indices = in[4] | (in[5] << 8) | (in[6] << 16) | (static_cast<unsigned int>(in[7]) << 24);
+        for (int i = 0; i < 16; ++i) {
+            for (int k = 0; k < 3; ++k)
+                out[i][k] = static_cast<unsigned char>(palette[(indices >> (2 * i)) & 3][k]);
+        }
+    }
+
+    // decodes the alpha part (8 bytes) of a BC3 block into 16 alpha values
+    void decode_bc3_alpha(const unsigned char *in, unsigned char out[16]) {
+        int palette[8] = {in[0], in[1]};
+        for (int i = 1; i < 7; ++i)
+            palette[i + 1] = in[0] > in[1] ? ((7 - i) * in[0] + i * in[1]) / 7 : 0;
+        if (in[0] <= in[1]) {
+            for (int i = 1; i < 5; ++i)
+                palette[i + 1] = ((5 - i) * in[0] + i * in[1]) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        unsigned long long indices = 0;
+        for (int i = 0; i < 6; ++i)
+            indices |= static_cast<unsigned long long>(in[2 + i]) << (8 * i);
+        for (int i = 0; i < 16; ++i)
+            out[i] = static_cast<unsigned char>(palette[(indices >> (3 * i)) & 7]);
+    }
+
+    // the root mean square error (per channel) of a compressed level w.r.t. its source
+    double compression_error(const std::vector<unsigned char> &source, const std::vector<unsigned char> &compressed,
+                             int w, int h, int channels) {
+        const int nbx = (w + 3) / 4, nby = (h + 3) / 4;
+        const int block_size = (channels == 4) ? 16 : 8;
+        double sum = 0.0;
+        for (int by = 0; by < nby; ++by) {
+            for (int bx = 0; bx < nbx; ++bx) {
+                const unsigned char *block = compressed.data() + (static_cast<std::size_t>(by) * nbx + bx) * block_size;
+                unsigned char rgb[16][3], alpha[16];
+                if (channels == 4) {
+                    decode_bc3_alpha(block, alpha);
+                    block += 8;
+                }
+                decode_bc1_block(block, rgb);
+                for (int j = 0; j < 4 && by * 4 + j < h; ++j) {
+                    for (int i = 0; i < 4 && bx * 4 + i < w; ++i) {
+                        const unsigned char *p = source.data() + ((by * 4 + j) * w + (bx * 4 + i)) * channels;
+                        for (int k = 0; k < channels; ++k) {
+                            const double d = static_cast<double>(p[k]) - (k < 3 ? rgb[j * 4 + i][k] : alpha[j * 4 + i]);
+                            sum += d * d;
+                        }
+                    }
+                }
+            }
+        }
+        return std::sqrt(sum / (static_cast<double>(w) * h * channels));
+    }
+
+    // the number and the total size of the cache files (and the number of temporary files) in a directory
+    void cache_files(const std::string &dir, int &num_files, std::size_t &size, int &num_temporary_files) {
+        std::vector<std::string> names;
+        file_system::get_files(dir, names, false);
+        num_files = 0;
+        size = 0;
+        num_temporary_files = 0;
+        for (const auto &name : names) {
+            if (file_system::extension(name) == "tex") {
+                ++num_files;
+                size += static_cast<std::size_t>(file_system::file_size(dir + "/" + name));
+            } else if (file_system::extension(name) == "tmp")
+                ++num_temporary_files;
+        }
+    }
+
+}
+
+
+// The decoding, the mip levels, the compression, and the caches of TextureDecoder don't require OpenGL.
+int test_texture_decoder() {
+    // mip levels of a 5x3 RGB image: a constant red channel, and a green/blue channel depending on x/y
+    {
+        TextureDecoder::Image image;
+        image.channels = 3;
+        image.widths.assign(1, 5);
+        image.heights.assign(1, 3);
+        image.levels.resize(1);
+        for (int y = 0; y < 3; ++y) {
+            for (int x = 0; x < 5; ++x) {
+                image.levels[0].push_back(100);
+                image.levels[0].push_back(static_cast<unsigned char>(x * 10));
+                image.levels[0].push_back(static_cast<unsigned char>(y * 10));
+            }
+        }
+        TextureDecoder::generate_mipmaps(image);
+
+        // 5x3 -> 2x1 -> 1x1
+        if (image.levels.size() != 3 || image.widths[1] != 2 || image.heights[1] != 1 || image.widths[2] != 1 ||
+            image.heights[2] != 1) {
+            std::cerr << "wrong number or sizes of mip levels" << std::endl;
+            return EXIT_FAILURE;
+        }
+        for (std::size_t i = 0; i < image.levels.size(); ++i) {
+            if (image.levels[i].size() != static_cast<std::size_t>(image.widths[i] * image.heights[i] * 3)) {
+                std::cerr << "wrong size of mip level " << i << std::endl;
+                return EXIT_FAILURE;
+            }
+            for (std::size_t j = 0; j < image.levels[i].size(); j += 3) {
+                if (image.levels[i][j] != 100) {
+                    std::cerr << "a constant channel changed in mip level " << i << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        // level 1: the left pixel averages columns 0-1 (x: 0, 10), the right one columns 2-4 (x: 20, 30, 40), and
+        // both average all the 3 rows (y: 0, 10, 20)
+        const std::vector<unsigned char> expected = {100, 5, 10, 100, 30, 10};
+        if (image.levels[1] != expected) {
+            std::cerr << "wrong pixels of mip level 1" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // write a few images (of different sizes) to be decoded
+    const std::string dir = "./texture_decoder_test";
+    file_system::create_directory(dir);
+    std::vector<std::string> files;
+    for (int i = 0; i < 4; ++i) {
+        const int size = 64 << i;
+        std::vector<unsigned char> data(static_cast<std::size_t>(size) * size * 4);
+        for (std::size_t j = 0; j < data.size(); ++j)
+            data[j] = static_cast<unsigned char>((j * 7 + i * 31) % 251);
+        const std::string file = dir + "/image-" + std::to_string(i) + ".png";
+        if (!ImageIO::save(file, data, size, size, 4)) {
+            std::cerr << "failed writing image file: " << file << std::endl;
+            return EXIT_FAILURE;
+        }
+        files.push_back(file);
+    }
+
+    // decoding in the calling thread
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        auto image = TextureDecoder::decode(files[i]);
+        const int size = 64 << i;
+        if (!image || image->channels != 4 || image->widths[0] != size || image->heights[0] != size ||
+            image->levels.size() != static_cast<std::size_t>(7 + i) || image->widths.back() != 1) {
+            std::cerr << "failed decoding image file: " << files[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // decoding in the background: the cache only keeps the most recently used images that fit in its capacity
+    {
+        std::atomic<int> num_decoded(0);
+        {
+            // a 128x128 RGBA image with its mip levels (about 85 KB) exceeds the capacity
+            const std::size_t capacity = 64 * 1024;
+            TextureDecoder decoder(2, capacity);
+            decoder.set_callback([&]() { ++num_decoded; });
+
+            for (const auto &file : files)
+                decoder.request(file);
+            for (const auto &file : files)
+                decoder.wait(file);
+
+            int num_cached = 0;
+            for (const auto &file : files)
+                num_cached += (decoder.status(file) == TextureDecoder::READY);
+            if (num_cached != 1) {
+                std::cerr << "the cache keeps " << num_cached << " images (expected: 1)" << std::endl;
+                return EXIT_FAILURE;
+            }
+        } // the callback may be still running after wait() returns, so check it after the workers have finished
+
+        if (num_decoded != static_cast<int>(files.size())) {
+            std::cerr << "the callback was called " << num_decoded << " times for " << files.size() << " images"
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // pinned images are kept (even if they exceed the capacity) until they are unpinned or evicted
+    {
+        TextureDecoder decoder(2, 1024);
+        for (const auto &file : files)
+            decoder.request(file, true);
+        std::size_t total = 0;
+        for (const auto &file : files) {
+            auto image = decoder.wait(file);
+            if (!image) {
+                std::cerr << "failed decoding image file: " << file << std::endl;
+                return EXIT_FAILURE;
+            }
+            total += image->size_in_bytes();
+        }
+        for (const auto &file : files) {
+            if (decoder.status(file) != TextureDecoder::READY || !decoder.get(file)) {
+                std::cerr << "a pinned image has been evicted: " << file << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        if (decoder.cache_size() != total) {
+            std::cerr << "wrong cache size: " << decoder.cache_size() << " (expected: " << total << ")" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        decoder.evict(files[0]);
+        for (std::size_t i = 1; i < files.size(); ++i)
+            decoder.unpin(files[i]);
+        int num_cached = 0;
+        for (const auto &file : files)
+            num_cached += (decoder.status(file) == TextureDecoder::READY);
+        if (decoder.status(files[0]) != TextureDecoder::NONE || num_cached != 1) {
+            std::cerr << "unpinned images are not evicted from the cache" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // block compression (BC1 for RGB and BC3 for RGBA) of smooth images. The sizes are not multiples of 4.
+    for (int channels = 3; channels <= 4; ++channels) {
+        TextureDecoder::Image image;
+        image.channels = channels;
+        image.widths.assign(1, 70);
+        image.heights.assign(1, 45);
+        image.levels.resize(1);
+        for (int y = 0; y < 45; ++y) {
+            for (int x = 0; x < 70; ++x) {
+                image.levels[0].push_back(static_cast<unsigned char>(x * 255 / 69));
+                image.levels[0].push_back(static_cast<unsigned char>(y * 255 / 44));
+                image.levels[0].push_back(static_cast<unsigned char>(128 + 100 * std::sin(0.1 * (x + y))));
+                if (channels == 4)
+                    image.levels[0].push_back(static_cast<unsigned char>((x + 2 * y) * 255 / 157));
+            }
+        }
+        TextureDecoder::generate_mipmaps(image);
+        const TextureDecoder::Image source = image;
+
+        if (!TextureDecoder::compress(image) || !image.compressed) {
+            std::cerr << "failed compressing an image with " << channels << " channels" << std::endl;
+            return EXIT_FAILURE;
+        }
+        const int block_size = (channels == 4) ? 16 : 8;
+        for (std::size_t i = 0; i < image.levels.size(); ++i) {
+            const int w = image.widths[i], h = image.heights[i];
+            if (image.levels[i].size() != static_cast<std::size_t>((w + 3) / 4 * ((h + 3) / 4) * block_size)) {
+                std::cerr << "wrong size of compressed level " << i << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        // the finest level is smooth at the scale of the blocks (the coarser levels are not, and a block can only
+        // represent colors on a line segment)
+        const double error = compression_error(source.levels[0], image.levels[0], 70, 45, channels);
+        if (error > 5.0) {
+            std::cerr << "large error of the compressed image (" << channels << " channels): " << error << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // the disk cache: decoded (and compressed) images are written into the cache and read back unchanged
+    const std::string cache_dir = dir + "/cache";
+    for (int compress = 0; compress <= 1; ++compress) {
+        auto decoded = TextureDecoder::decode(files[1], cache_dir, compress != 0);  // the cache file is written
+        auto cached = TextureDecoder::decode(files[1], cache_dir, compress != 0);   // the cache file is read
+        auto expected = TextureDecoder::decode(files[1]);
+        if (compress)
+            TextureDecoder::compress(*expected);
+        if (!decoded || !cached || cached->levels != expected->levels || cached->widths != expected->widths ||
+            cached->heights != expected->heights || cached->compressed != (compress != 0) ||
+            decoded->levels != expected->levels) {
+            std::cerr << "the image read from the disk cache differs from the decoded one" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    int num_files = 0, num_temporary_files = 0;
+    std::size_t size = 0;
+    cache_files(cache_dir, num_files, size, num_temporary_files);
+    if (num_files != 2 || num_temporary_files != 0) {
+        std::cerr << "the cache has " << num_files << " files and " << num_temporary_files
+                  << " temporary files (expected: 2 and 0)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // the total size of the cache files is bounded (all the images take about 1.9 MB)
+    const std::size_t cache_capacity = 1536 * 1024;
+    for (const auto &file : files)
+        TextureDecoder::decode(file, cache_dir, false, cache_capacity);
+    cache_files(cache_dir, num_files, size, num_temporary_files);
+    if (size > cache_capacity || num_files == 0) {
+        std::cerr << "the cache has " << num_files << " files of " << size << " bytes (capacity: " << cache_capacity
+                  << ")" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // the cache settings also apply to the images requested after the decoder has started
+    {
+        const std::string another_cache_dir = dir + "/another_cache";
+        TextureDecoder decoder(1);
+        decoder.request(files[0]);
+        decoder.wait(files[0]);
+        decoder.set_cache_directory(another_cache_dir);
+        decoder.set_compression(true);
+        decoder.request(files[1]);
+        auto image = decoder.wait(files[1]);
+        cache_files(another_cache_dir, num_files, size, num_temporary_files);
+        if (!image || !image->compressed || num_files != 1) {
+            std::cerr << "the cache settings are not applied to a running decoder" << std::endl;
+            return EXIT_FAILURE;
+        }
+        file_system::delete_contents(another_cache_dir);
+        file_system::delete_directory(another_cache_dir);
+    }
+
+    file_system::delete_contents(cache_dir);
+    file_system::delete_directory(cache_dir);
+    file_system::delete_contents(dir);
+    file_system::delete_directory(dir);
+    std::cout << "texture decoder tested" << std::endl;
+    return EXIT_SUCCESS;
+}
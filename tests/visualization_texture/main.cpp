@@ -83,3 +83,49 @@ int test_texture(int duration) {
     return viewer.run();
 }
 
+
+
+int test_texture_async(int duration) {
+    Viewer viewer("TextureAsync");
+    viewer.camera()->setUpVector(vec3(0, 1, 0));
+    viewer.camera()->setViewDirection(vec3(0, 0, -1));
+
+    //------------- Request a texture decoded in the background ---------------------
+
+    // the returned texture is a 1x1 placeholder until the image has been decoded. Its mip levels are then uploaded
+    // (from the coarsest one) by the viewer before drawing the next frames.
+    const std::string texture_file = resource::directory() + "/images/logo.jpg";
+    Texture *tex = TextureManager::request_async(texture_file);
+    if (!tex) {
+        LOG(ERROR) << "Error: failed to create texture. Please make sure the file exists and format is correct.";
+        return EXIT_FAILURE;
+    }
+
+    //--------------- create a mesh (which contains a single quad) -------------------
+
+    SurfaceMesh *mesh = new SurfaceMesh;
+    auto texcoord = mesh->add_vertex_property<vec2>("v:texcoord");
+
+    // the size of the image is unknown before it is decoded, so the quad is a square
+    auto v0 = mesh->add_vertex(vec3(0, 0, 0));
+    texcoord[v0] = vec2(0, 0);
+    auto v1 = mesh->add_vertex(vec3(1, 0, 0));
+    texcoord[v1] = vec2(1, 0);
+    auto v2 = mesh->add_vertex(vec3(1, 1, 0));
+    texcoord[v2] = vec2(1, 1);
+    auto v3 = mesh->add_vertex(vec3(0, 1, 0));
+    texcoord[v3] = vec2(0, 1);
+    mesh->add_quad(v0, v1, v2, v3);
+
+    // add the model to the viewer and create the default drawable "faces"
+    viewer.add_model(mesh, true);
+
+    // set the texture of the default drawable "faces"
+    auto drawable = mesh->renderer()->get_triangles_drawable("faces");
+    drawable->set_texture_coloring(easy3d::State::VERTEX, "v:texcoord", tex);
+
+    viewer.usage_string_ = "testing asynchronous texture loading...";
+
+    Timer<>::single_shot(duration, (Viewer*)&viewer, &Viewer::exit);
+    return viewer.run();
+}
@@ -45,6 +45,7 @@
 #include <easy3d/fileio/surface_mesh_io.h>
 #include <easy3d/fileio/poly_mesh_io.h>
 #include <easy3d/fileio/ply_reader_writer.h>
+#include <easy3d/fileio/chunked_file.h>
 #include <easy3d/fileio/point_cloud_io_ptx.h>
 #include <easy3d/util/file_system.h>
 #include <easy3d/util/logging.h>
@@ -114,11 +115,12 @@ bool MainWindow::onOpen() {
                 this,
                 "Open file(s)",
                 curDataDirectory_,
-                "Supported formats (*.ply *.obj *.off *.stl *.sm *.geojson *.trilist *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.ptx *.plm *.pm *.mesh)\n"
+                "Supported formats (*.ply *.obj *.off *.stl *.sm *.geojson *.trilist *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.ptx *.plm *.pm *.mesh *.e3d)\n"
                 "Surface Mesh (*.ply *.obj *.off *.stl *.sm *.geojson *.trilist)\n"
                 "Point Cloud (*.ply *.bin *.ptx *.las *.laz *.xyz *.bxyz *.vg *.bvg *.ptx)\n"
                 "Polyhedral Mesh (*.plm *.pm *.mesh)\n"
                 "Graph (*.ply)\n"
+                "Easy3D native format (*.e3d)\n"
                 "All formats (*.*)"
             );
 
@@ -161,11 +163,12 @@ bool MainWindow::onSave() {
                 this,
                 "Open file(s)",
                 QString::fromStdString(default_file_name),
-                "Supported formats (*.ply *.obj *.off *.stl *.sm *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.plm *.pm *.mesh)\n"
+                "Supported formats (*.ply *.obj *.off *.stl *.sm *.bin *.las *.laz *.xyz *.bxyz *.vg *.bvg *.plm *.pm *.mesh *.e3d)\n"
                 "Surface Mesh (*.ply *.obj *.off *.stl *.sm)\n"
                 "Point Cloud (*.ply *.bin *.ptx *.las *.laz *.xyz *.bxyz *.vg *.bvg)\n"
                 "Polyhedral Mesh (*.plm *.pm *.mesh)\n"
                 "Graph (*.ply)\n"
+                "Easy3D native format (*.e3d)\n"
                 "All formats (*.*)"
     );
 
@@ -209,14 +212,17 @@ Model* MainWindow::open(const std::string& file_name) {
     bool is_ply_mesh = false;
     if (ext == "ply")
         is_ply_mesh = (io::PlyReader::num_instances(file_name, "face") > 0);
+    std::string e3d_type;   // the *.e3d format can store any type of models
+    if (ext == "e3d")
+        e3d_type = io::ChunkedFileReader(file_name).model_type();
 
     Model* model = nullptr;
-    if ((ext == "ply" && is_ply_mesh) || ext == "obj" || ext == "off" || ext == "stl" || ext == "sm" || ext == "plg") { // mesh
+    if ((ext == "ply" && is_ply_mesh) || ext == "obj" || ext == "off" || ext == "stl" || ext == "sm" || ext == "plg" || e3d_type == "SurfaceMesh") { // mesh
         model = SurfaceMeshIO::load(file_name);
     }
-    else if (ext == "ply" && io::PlyReader::num_instances(file_name, "edge") > 0) {
+    else if ((ext == "ply" && io::PlyReader::num_instances(file_name, "edge") > 0) || e3d_type == "Graph") {
         model = GraphIO::load(file_name);
-    } else if (ext == "plm" || ext == "pm" || ext == "mesh") {
+    } else if (ext == "plm" || ext == "pm" || ext == "mesh" || e3d_type == "PolyMesh") {
         model = PolyMeshIO::load(file_name);
     }
     else { // point cloud
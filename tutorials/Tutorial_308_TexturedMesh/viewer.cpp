@@ -271,11 +271,12 @@ namespace easy3d {
             drawable->set_smooth_shading(false);
             if (prop_texcoords) {
                 if (!group.tex_file.empty()) {
-                    Texture *tex = TextureManager::request(group.tex_file, Texture::REPEAT);
+                    // the image is decoded in the background and the texture is uploaded progressively
+                    Texture *tex = TextureManager::request_async(group.tex_file, Texture::REPEAT);
                     if (tex) {
                         drawable->set_texture_coloring(State::HALFEDGE, "h:texcoord", tex);
                         drawable->set_distinct_back_color(false);
-                        LOG(INFO) << "texture created from " << group.tex_file;
+                        LOG(INFO) << "texture requested from " << group.tex_file;
                     }
                 }
             }